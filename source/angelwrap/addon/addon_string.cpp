@@ -27,29 +27,122 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define CONST_STRING_BITFLAG    ( 1 << 31 )
 #define ENABLE_STRING_IMPLICIT_CASTS
 
-static inline asstring_t *objectString_Alloc( void ) {
-	static asstring_t *object;
+// Strings are allocated as fixed size blocks with the object followed by an inline buffer,
+// which is enough for most of strings scripts produce. Released blocks are recycled,
+// longer strings keep the block and switch to a separately allocated buffer.
+#define STRING_BLOCK_SIZE       128
+#define STRING_INLINE_SIZE      ( STRING_BLOCK_SIZE - sizeof( asstring_t ) )
+#define STRING_MAX_FREE_BLOCKS  4096
+
+#define objectString_InlineBuffer( obj ) ( (char *)( ( obj ) + 1 ) )
+
+typedef struct stringblock_s {
+	struct stringblock_s *next;
+} stringblock_t;
+
+static stringblock_t *stringFreeBlocks;
+static unsigned int stringNumFreeBlocks;
+
+static struct {
+	uint64_t created;
+	uint64_t blockAllocs;
+	uint64_t bufferAllocs;
+} stringStats;
+
+static inline asstring_t *objectString_Alloc( unsigned int length ) {
+	asstring_t *object;
+	unsigned int size = ( length + 1 ) & ~CONST_STRING_BITFLAG;
+
+	stringStats.created++;
+
+	if( stringFreeBlocks ) {
+		object = ( asstring_t * )stringFreeBlocks;
+		stringFreeBlocks = stringFreeBlocks->next;
+		stringNumFreeBlocks--;
+	} else {
+		object = ( asstring_t * )new uint8_t[STRING_BLOCK_SIZE];
+		stringStats.blockAllocs++;
+	}
 
-	object = new asstring_t;
 	object->asRefCount = 1;
+	object->len = 0;
+	if( size <= STRING_INLINE_SIZE ) {
+		object->buffer = objectString_InlineBuffer( object );
+		object->size = STRING_INLINE_SIZE;
+	} else {
+		object->buffer = new char[size];
+		object->size = size;
+		stringStats.bufferAllocs++;
+	}
+	object->buffer[0] = '\0';
 	return object;
 }
 
+static void objectString_Free( asstring_t *object ) {
+	if( object->buffer != objectString_InlineBuffer( object ) ) {
+		delete[] object->buffer;
+	}
+
+	if( stringNumFreeBlocks >= STRING_MAX_FREE_BLOCKS ) {
+		delete[] ( uint8_t * )object;
+		return;
+	}
+
+	stringblock_t *block = ( stringblock_t * )object;
+	block->next = stringFreeBlocks;
+	stringFreeBlocks = block;
+	stringNumFreeBlocks++;
+}
+
+/*
+* objectString_Grow
+*
+* Makes the buffer large enough for a string of the given length, keeping the contents.
+* The capacity grows geometrically so repeated appends are amortized.
+*/
+static void objectString_Grow( asstring_t *self, unsigned int length ) {
+	unsigned int size;
+	char *buffer;
+
+	if( length < self->size ) {
+		return;
+	}
+
+	size = std::max( ( length + 1 ) & ~CONST_STRING_BITFLAG, std::min( self->size * 2, (unsigned int)~CONST_STRING_BITFLAG ) );
+	buffer = new char[size];
+	memcpy( buffer, self->buffer, self->len + 1 );
+	stringStats.bufferAllocs++;
+
+	if( self->buffer != objectString_InlineBuffer( self ) ) {
+		delete[] self->buffer;
+	}
+	self->buffer = buffer;
+	self->size = size;
+}
+
+void objectString_PrintStats( void ) {
+	QAS_Printf( "%" PRIu64 " strings created, %" PRIu64 " blocks and %" PRIu64 " buffers allocated, %u blocks free\n",
+				stringStats.created, stringStats.blockAllocs, stringStats.bufferAllocs, stringNumFreeBlocks );
+}
+
+void objectString_FreeBlocks( void ) {
+	while( stringFreeBlocks ) {
+		stringblock_t *next = stringFreeBlocks->next;
+		delete[] ( uint8_t * )stringFreeBlocks;
+		stringFreeBlocks = next;
+	}
+	stringNumFreeBlocks = 0;
+}
+
 asstring_t *objectString_FactoryBuffer( const char *buffer, unsigned int length ) {
 	asstring_t *object;
-	unsigned int size = ( length + 1 ) & ~CONST_STRING_BITFLAG;
 
-	length = size - 1;
-	object = objectString_Alloc();
-	object->buffer = new char[size];
-	object->len = length;
-	object->size = size;
+	object = objectString_Alloc( length );
 	if( buffer ) {
+		length = std::min( length, object->size - 1 );
 		memcpy( object->buffer, buffer, length );
 		object->buffer[length] = '\0';
-	} else {
-		object->len = 0;
-		object->buffer[0] = '\0';
+		object->len = length;
 	}
 	return object;
 }
@@ -73,19 +166,20 @@ const asstring_t *objectString_ConstFactoryBuffer( const char *buffer, unsigned
 }
 
 asstring_t *objectString_AssignString( asstring_t *self, const char *string, size_t strlen_ ) {
-	unsigned int size;
-
 	if( strlen_ >= self->size ) {
-		delete[] self->buffer;
-
-		size = ( strlen_ + 1 ) & ~CONST_STRING_BITFLAG;
-		self->size = size;
-		self->buffer = new char[size];
-		strlen_ = size - 1;
+		if( string >= self->buffer && string < self->buffer + self->size ) {
+			// a part of itself, which always fits
+			strlen_ = self->size - 1;
+		} else {
+			self->len = 0;
+			self->buffer[0] = '\0';
+			objectString_Grow( self, strlen_ );
+			strlen_ = std::min( strlen_, (size_t)self->size - 1 );
+		}
 	}
 
 	self->len = strlen_;
-	memcpy( self->buffer, string, strlen_ );
+	memmove( self->buffer, string, strlen_ );
 	self->buffer[strlen_] = '\0';
 
 	return self;
@@ -104,18 +198,23 @@ static asstring_t *objectString_AssignPattern( asstring_t *self, const char *pat
 
 static asstring_t *objectString_AddAssignString( asstring_t *self, const char *string, size_t strlen_ ) {
 	if( strlen_ ) {
-		char *tem = self->buffer;
-		unsigned int length = strlen_ + self->len;
-		unsigned int size = ( length + 1 ) & ~CONST_STRING_BITFLAG;
+		size_t length = std::min( strlen_ + self->len, (size_t)~CONST_STRING_BITFLAG - 1 );
 
-		length = size - 1;
-		self->len = length;
-		self->size = size;
-		self->buffer = new char[size];
+		if( length >= self->size ) {
+			// appending a part of itself
+			ptrdiff_t offset = string - self->buffer;
+			bool self_ = string >= self->buffer && string < self->buffer + self->size;
 
-		Q_snprintfz( self->buffer, size, "%s%s", tem, string );
+			objectString_Grow( self, length );
+			if( self_ ) {
+				string = self->buffer + offset;
+			}
+		}
 
-		delete[] tem;
+		strlen_ = length - self->len;
+		memcpy( self->buffer + self->len, string, strlen_ );
+		self->len = length;
+		self->buffer[length] = '\0';
 	}
 
 	return self;
@@ -133,11 +232,11 @@ static asstring_t *objectString_AddAssignPattern( asstring_t *self, const char *
 }
 
 static asstring_t *objectString_AddString( asstring_t *first, const char *second, size_t seclen ) {
-	asstring_t *self = objectString_FactoryBuffer( NULL, first->len + seclen );
+	asstring_t *self = objectString_Alloc( first->len + seclen );
 
-	Q_snprintfz( self->buffer, self->size, "%s%s", first->buffer, second );
-	self->len = self->size - 1;
-	return self;
+	memcpy( self->buffer, first->buffer, first->len + 1 );
+	self->len = first->len;
+	return objectString_AddAssignString( self, second, seclen );
 }
 
 static asstring_t *objectString_AddPattern( asstring_t *first, const char *pattern, ... ) {
@@ -185,8 +284,7 @@ void objectString_Release( asstring_t *obj ) {
 
 	if( !obj->asRefCount ) {
 		if( ( obj->size & CONST_STRING_BITFLAG ) == 0 ) {
-			delete[] obj->buffer;
-			delete obj;
+			objectString_Free( obj );
 		} else {
 			uint8_t *rawmem = ( uint8_t * )obj;
 			delete[] rawmem;
@@ -308,6 +406,27 @@ static bool objectString_Empty( asstring_t *self ) {
 	return self->len == 0;
 }
 
+static void objectString_Reserve( unsigned int length, asstring_t *self ) {
+	objectString_Grow( self, length );
+}
+
+static void objectString_Clear( asstring_t *self ) {
+	self->len = 0;
+	self->buffer[0] = '\0';
+}
+
+static asstring_t *objectString_AppendString( const asstring_t &other, asstring_t *self ) {
+	return objectString_AddAssignString( self, other.buffer, other.len );
+}
+
+static asstring_t *objectString_AppendInt( int other, asstring_t *self ) {
+	return objectString_AddAssignPattern( self, "%i", other );
+}
+
+static asstring_t *objectString_AppendDouble( double other, asstring_t *self ) {
+	return objectString_AddAssignPattern( self, "%g", other );
+}
+
 static asstring_t *objectString_ToLower( asstring_t *self ) {
 	asstring_t *string = objectString_FactoryBuffer( self->buffer, self->len );
 	if( string->len ) {
@@ -527,6 +646,11 @@ void RegisterStringAddon( asIScriptEngine *engine ) {
 	r = engine->RegisterObjectMethod( "String", "uint len() const", asFUNCTION( objectString_Len ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
 	r = engine->RegisterObjectMethod( "String", "uint length() const", asFUNCTION( objectString_Len ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
 	r = engine->RegisterObjectMethod( "String", "bool empty() const", asFUNCTION( objectString_Empty ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
+	r = engine->RegisterObjectMethod( "String", "void reserve(uint)", asFUNCTION( objectString_Reserve ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
+	r = engine->RegisterObjectMethod( "String", "void clear()", asFUNCTION( objectString_Clear ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
+	r = engine->RegisterObjectMethod( "String", "String &append(const String &in)", asFUNCTION( objectString_AppendString ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
+	r = engine->RegisterObjectMethod( "String", "String &append(int)", asFUNCTION( objectString_AppendInt ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
+	r = engine->RegisterObjectMethod( "String", "String &append(double)", asFUNCTION( objectString_AppendDouble ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
 	r = engine->RegisterObjectMethod( "String", "String @tolower() const", asFUNCTION( objectString_ToLower ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
 	r = engine->RegisterObjectMethod( "String", "String @toupper() const", asFUNCTION( objectString_ToUpper ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
 	r = engine->RegisterObjectMethod( "String", "String @trim() const", asFUNCTION( objectString_Trim ), asCALL_CDECL_OBJLAST ); assert( r >= 0 );
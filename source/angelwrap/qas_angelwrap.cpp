@@ -153,7 +153,7 @@ void qasReleaseEngine( asIScriptEngine *engine ) {
 	engine->Release();
 }
 
-static asIScriptContext *qasCreateContext( asIScriptEngine *engine ) {
+asIScriptContext *qasCreateContext( asIScriptEngine *engine ) {
 	asIScriptContext *ctx;
 	int error;
 
@@ -179,9 +179,6 @@ static asIScriptContext *qasCreateContext( asIScriptEngine *engine ) {
 		return NULL;
 	}
 
-	qasContextList &ctxList = contexts[engine];
-	ctxList.push_back( ctx );
-
 	return ctx;
 }
 
@@ -212,7 +209,11 @@ asIScriptContext *qasAcquireContext( asIScriptEngine *engine ) {
 	}
 
 	// if no context was available, create a new one
-	return qasCreateContext( engine );
+	asIScriptContext *ctx = qasCreateContext( engine );
+	if( ctx ) {
+		ctxList.push_back( ctx );
+	}
+	return ctx;
 }
 
 asIScriptContext *qasGetActiveContext( void ) {
@@ -265,6 +266,301 @@ static char *qasLoadScriptSection( const char *rootDir, const char *dir, const c
 	return (char *)data;
 }
 
+/*
+* Bytecode cache
+*
+* Compiled modules are saved to the cache directory and loaded directly on next builds
+* as long as neither script sources nor the application interface have changed.
+*/
+
+#define QAS_BYTECODE_CACHE_DIR      "cache/scripts"
+#define QAS_BYTECODE_EXTENSION      ".asbc"
+#define QAS_BYTECODE_MAGIC          "QASB"
+#define QAS_BYTECODE_VERSION        1
+
+typedef struct {
+	char magic[4];
+	int version;
+	uint64_t hash;
+	unsigned size;          // of the following bytecode
+} qasBytecodeHeader_t;
+
+static cvar_t *as_bytecodecache;
+
+class qasBytecodeStream : public asIBinaryStream {
+public:
+	uint8_t *data;
+	size_t size, capacity;
+	size_t readPos;
+	bool overflowed;
+
+	qasBytecodeStream() : data( NULL ), size( 0 ), capacity( 0 ), readPos( 0 ), overflowed( false ) {
+	}
+
+	~qasBytecodeStream() {
+		if( data ) {
+			qasFree( data );
+		}
+	}
+
+	void Write( const void *ptr, asUINT length ) {
+		if( size + length > capacity ) {
+			size_t newCapacity = capacity ? capacity : 0x10000;
+			while( newCapacity < size + length )
+				newCapacity *= 2;
+
+			uint8_t *newData = ( uint8_t * )qasAlloc( newCapacity );
+			if( data ) {
+				memcpy( newData, data, size );
+				qasFree( data );
+			}
+			data = newData;
+			capacity = newCapacity;
+		}
+
+		memcpy( data + size, ptr, length );
+		size += length;
+	}
+
+	void Read( void *ptr, asUINT length ) {
+		if( readPos + length > size ) {
+			// truncated file, the loaded module is discarded
+			memset( ptr, 0, length );
+			readPos = size;
+			overflowed = true;
+			return;
+		}
+
+		memcpy( ptr, data + readPos, length );
+		readPos += length;
+	}
+};
+
+/*
+* qasHashData
+*
+* 64-bit FNV-1a
+*/
+static uint64_t qasHashData( uint64_t hash, const void *data, size_t length ) {
+	const uint8_t *bytes = ( const uint8_t * )data;
+
+	for( size_t i = 0; i < length; i++ ) {
+		hash ^= bytes[i];
+		hash *= UINT64_C( 0x100000001b3 );
+	}
+	return hash;
+}
+
+static uint64_t qasHashString( uint64_t hash, const char *string ) {
+	// include the terminator so that adjacent strings can't be merged
+	return qasHashData( hash, string ? string : "", string ? strlen( string ) + 1 : 1 );
+}
+
+static uint64_t qasHashFunction( uint64_t hash, const asIScriptFunction *func ) {
+	return qasHashString( hash, func ? func->GetDeclaration( true, true ) : NULL );
+}
+
+/*
+* qasHashEngineInterface
+*
+* Bytecode refers to application functions, types and properties by their declarations,
+* so everything that has been registered by the application is a part of the cache key.
+*/
+static uint64_t qasHashEngineInterface( uint64_t hash, asIScriptEngine *asEngine ) {
+	int i, j, count;
+
+	count = asEngine->GetObjectTypeCount();
+	for( i = 0; i < count; i++ ) {
+		asIObjectType *objectType = asEngine->GetObjectTypeByIndex( i );
+		if( !objectType ) {
+			continue;
+		}
+
+		hash = qasHashString( hash, objectType->GetNamespace() );
+		hash = qasHashString( hash, objectType->GetName() );
+		hash = qasHashString( hash, va( "%" PRIu64 " %i", (uint64_t)objectType->GetFlags(), objectType->GetSize() ) );
+
+		for( j = 0; j < (int)objectType->GetPropertyCount(); j++ ) {
+			hash = qasHashString( hash, objectType->GetPropertyDeclaration( j, true ) );
+		}
+		for( j = 0; j < (int)objectType->GetBehaviourCount(); j++ ) {
+			asEBehaviours behaviourType;
+			hash = qasHashFunction( hash, objectType->GetBehaviourByIndex( j, &behaviourType ) );
+			hash = qasHashData( hash, &behaviourType, sizeof( behaviourType ) );
+		}
+		for( j = 0; j < (int)objectType->GetFactoryCount(); j++ ) {
+			hash = qasHashFunction( hash, objectType->GetFactoryByIndex( j ) );
+		}
+		for( j = 0; j < (int)objectType->GetMethodCount(); j++ ) {
+			hash = qasHashFunction( hash, objectType->GetMethodByIndex( j, false ) );
+		}
+	}
+
+	count = asEngine->GetGlobalFunctionCount();
+	for( i = 0; i < count; i++ ) {
+		hash = qasHashFunction( hash, asEngine->GetGlobalFunctionByIndex( i ) );
+	}
+
+	count = asEngine->GetFuncdefCount();
+	for( i = 0; i < count; i++ ) {
+		hash = qasHashFunction( hash, asEngine->GetFuncdefByIndex( i ) );
+	}
+
+	count = asEngine->GetGlobalPropertyCount();
+	for( i = 0; i < count; i++ ) {
+		const char *name, *nameSpace;
+		int typeId;
+		bool isConst;
+
+		if( asEngine->GetGlobalPropertyByIndex( i, &name, &nameSpace, &typeId, &isConst ) < 0 ) {
+			continue;
+		}
+		hash = qasHashString( hash, nameSpace );
+		hash = qasHashString( hash, name );
+		hash = qasHashString( hash, asEngine->GetTypeDeclaration( typeId, true ) );
+		hash = qasHashData( hash, &isConst, sizeof( isConst ) );
+	}
+
+	count = asEngine->GetEnumCount();
+	for( i = 0; i < count; i++ ) {
+		const char *nameSpace;
+		int typeId;
+
+		hash = qasHashString( hash, asEngine->GetEnumByIndex( i, &typeId, &nameSpace ) );
+		hash = qasHashString( hash, nameSpace );
+		for( j = 0; j < asEngine->GetEnumValueCount( typeId ); j++ ) {
+			int value;
+			hash = qasHashString( hash, asEngine->GetEnumValueByIndex( typeId, j, &value ) );
+			hash = qasHashData( hash, &value, sizeof( value ) );
+		}
+	}
+
+	count = asEngine->GetTypedefCount();
+	for( i = 0; i < count; i++ ) {
+		const char *nameSpace;
+		int typeId;
+
+		hash = qasHashString( hash, asEngine->GetTypedefByIndex( i, &typeId, &nameSpace ) );
+		hash = qasHashString( hash, nameSpace );
+		hash = qasHashString( hash, asEngine->GetTypeDeclaration( typeId, true ) );
+	}
+
+	return hash;
+}
+
+/*
+* qasBytecodeCacheName
+*
+* There is a single cached file per module and project, its header tells whether it is up to date.
+*/
+static void qasBytecodeCacheName( const char *moduleName, const char *scriptName, char *filename, size_t size ) {
+	Q_snprintfz( filename, size, "%s/%s/%s%s", QAS_BYTECODE_CACHE_DIR, moduleName, scriptName, QAS_BYTECODE_EXTENSION );
+}
+
+/*
+* qasLoadCachedBytecode
+*
+* Stale files are removed, so they never pile up.
+*/
+static bool qasLoadCachedBytecode( asIScriptModule *asModule, const char *filename, uint64_t hash ) {
+	int length, filenum;
+	qasBytecodeHeader_t header;
+	qasBytecodeStream stream;
+
+	length = trap_FS_FOpenFile( filename, &filenum, FS_READ | FS_CACHE );
+	if( length == -1 ) {
+		return false;
+	}
+
+	if( length < (int)sizeof( header ) || trap_FS_Read( &header, sizeof( header ), filenum ) != (int)sizeof( header ) ||
+		memcmp( header.magic, QAS_BYTECODE_MAGIC, sizeof( header.magic ) ) || header.version != QAS_BYTECODE_VERSION ||
+		header.hash != hash || header.size != length - sizeof( header ) ) {
+		trap_FS_FCloseFile( filenum );
+		trap_FS_RemoveFile( filename );
+		return false;
+	}
+
+	stream.data = ( uint8_t * )qasAlloc( header.size );
+	stream.size = stream.capacity = header.size;
+	if( trap_FS_Read( stream.data, header.size, filenum ) != (int)header.size ) {
+		trap_FS_FCloseFile( filenum );
+		trap_FS_RemoveFile( filename );
+		return false;
+	}
+	trap_FS_FCloseFile( filenum );
+
+	if( asModule->LoadByteCode( &stream ) < 0 || stream.overflowed ) {
+		trap_FS_RemoveFile( filename );
+		return false;
+	}
+
+	QAS_Printf( "* Loaded cached bytecode '%s'\n", filename );
+	return true;
+}
+
+/*
+* qasRemoveOrphanedBytecode
+*
+* Removes cached files of the module projects that are next to the given one and no longer exist.
+*/
+static void qasRemoveOrphanedBytecode( const char *moduleName, const char *scriptName ) {
+	char dir[MAX_QPATH], scriptDir[MAX_QPATH];
+	char buffer[1024], source[1024];
+	const char *name;
+	const char *slash;
+	int i, numFiles, start;
+
+	slash = strrchr( scriptName, '/' );
+	if( !slash ) {
+		return;
+	}
+
+	Q_snprintfz( scriptDir, sizeof( scriptDir ), "%.*s", (int)( slash - scriptName ), scriptName );
+	Q_snprintfz( dir, sizeof( dir ), "%s/%s/%s", QAS_BYTECODE_CACHE_DIR, moduleName, scriptDir );
+
+	// the listing is cached by the filesystem, so removals don't shift it
+	for( start = 0; ( numFiles = trap_FS_GetFileList( dir, QAS_BYTECODE_EXTENSION, buffer, sizeof( buffer ), start, 0 ) ) > 0; start += numFiles ) {
+		for( i = 0, name = buffer; i < numFiles; i++, name += strlen( name ) + 1 ) {
+			Q_snprintfz( source, sizeof( source ), "%s/%s", scriptDir, name );
+			COM_StripExtension( source );
+			if( trap_FS_FOpenFile( source, NULL, FS_READ ) == -1 ) {
+				trap_FS_RemoveFile( va( "%s/%s", dir, name ) );
+			}
+		}
+	}
+}
+
+/*
+* qasStoreCachedBytecode
+*/
+static void qasStoreCachedBytecode( asIScriptModule *asModule, const char *filename, uint64_t hash ) {
+	int filenum;
+	qasBytecodeHeader_t header;
+	qasBytecodeStream stream;
+
+	if( asModule->SaveByteCode( &stream ) < 0 ) {
+		return;
+	}
+
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, QAS_BYTECODE_MAGIC, sizeof( header.magic ) );
+	header.version = QAS_BYTECODE_VERSION;
+	header.hash = hash;
+	header.size = stream.size;
+
+	if( trap_FS_FOpenFile( filename, &filenum, FS_WRITE | FS_CACHE ) == -1 ) {
+		QAS_Printf( S_COLOR_YELLOW "* Couldn't open '%s' for writing\n", filename );
+		return;
+	}
+
+	if( trap_FS_Write( &header, sizeof( header ), filenum ) != (int)sizeof( header ) ||
+		trap_FS_Write( stream.data, stream.size, filenum ) != (int)stream.size ) {
+		// a truncated file fails the size check on load
+		QAS_Printf( S_COLOR_YELLOW "* Failed to write '%s'\n", filename );
+	}
+	trap_FS_FCloseFile( filenum );
+}
+
 /*
 * qasBuildScriptProject
 */
@@ -272,7 +568,11 @@ static asIScriptModule *qasBuildScriptProject( asIScriptEngine *asEngine, const
 	int error;
 	int numSections, sectionNum;
 	char *section;
+	char **sections;
 	asIScriptModule *asModule;
+	uint64_t hash;
+	bool useCache;
+	char cacheName[1024];
 
 	if( asEngine == NULL ) {
 		QAS_Printf( S_COLOR_RED "qasBuildGameScript: Angelscript API unavailable\n" );
@@ -289,39 +589,88 @@ static asIScriptModule *qasBuildScriptProject( asIScriptEngine *asEngine, const
 		return NULL;
 	}
 
-	// load up the script sections
+	// load up the script sections, all sources are needed to check the cached bytecode
+	sections = ( char ** )qasAlloc( numSections * sizeof( char * ) );
+	for( sectionNum = 0; sectionNum < numSections; sectionNum++ ) {
+		sections[sectionNum] = qasLoadScriptSection( rootDir, dir, script, sectionNum );
+		if( !sections[sectionNum] ) {
+			break;
+		}
+	}
+
+	if( sectionNum != numSections ) {
+		QAS_Printf( S_COLOR_RED "* Error: couldn't load all script sections.\n" );
+		asModule = NULL;
+		goto done;
+	}
+
+	if( !as_bytecodecache ) {
+		as_bytecodecache = trap_Cvar_Get( "as_bytecodecache", "1", CVAR_ARCHIVE );
+	}
+	useCache = as_bytecodecache->integer != 0;
+
+	hash = UINT64_C( 0xcbf29ce484222325 );
+	if( useCache ) {
+		hash = qasHashString( hash, ANGELSCRIPT_VERSION_STRING );
+		hash = qasHashString( hash, va( "%i", (int)sizeof( void * ) ) );
+		hash = qasHashString( hash, moduleName );
+		for( sectionNum = 0; sectionNum < numSections; sectionNum++ ) {
+			hash = qasHashString( hash, COM_ListNameForPosition( script, sectionNum, QAS_SECTIONS_SEPARATOR ) );
+			hash = qasHashString( hash, sections[sectionNum] );
+		}
+		hash = qasHashEngineInterface( hash, asEngine );
+		qasBytecodeCacheName( moduleName, scriptName, cacheName, sizeof( cacheName ) );
+	}
 
 	asModule = asEngine->GetModule( moduleName, asGM_CREATE_IF_NOT_EXISTS );
 	if( asModule == NULL ) {
 		QAS_Printf( S_COLOR_RED "qasBuildGameScript: GetModule '%s' failed\n", moduleName );
-		return NULL;
+		goto done;
 	}
 
-	for( sectionNum = 0; ( section = qasLoadScriptSection( rootDir, dir, script, sectionNum ) ) != NULL; sectionNum++ ) {
-		const char *sectionName = COM_ListNameForPosition( script, sectionNum, QAS_SECTIONS_SEPARATOR );
-		error = asModule->AddScriptSection( sectionName, section, strlen( section ) );
+	if( useCache ) {
+		if( qasLoadCachedBytecode( asModule, cacheName, hash ) ) {
+			goto done;
+		}
 
-		qasFree( section );
+		// start over from a clean module
+		asModule = asEngine->GetModule( moduleName, asGM_ALWAYS_CREATE );
+		if( asModule == NULL ) {
+			QAS_Printf( S_COLOR_RED "qasBuildGameScript: GetModule '%s' failed\n", moduleName );
+			goto done;
+		}
+	}
+
+	for( sectionNum = 0; sectionNum < numSections; sectionNum++ ) {
+		const char *sectionName = COM_ListNameForPosition( script, sectionNum, QAS_SECTIONS_SEPARATOR );
+		error = asModule->AddScriptSection( sectionName, sections[sectionNum], strlen( sections[sectionNum] ) );
 
 		if( error ) {
 			QAS_Printf( S_COLOR_RED "* Failed to add the script section %s with error %i\n", sectionName, error );
 			asEngine->DiscardModule( moduleName );
-			return NULL;
+			asModule = NULL;
+			goto done;
 		}
 	}
 
-	if( sectionNum != numSections ) {
-		QAS_Printf( S_COLOR_RED "* Error: couldn't load all script sections.\n" );
-		asEngine->DiscardModule( moduleName );
-		return NULL;
-	}
-
 	error = asModule->Build();
 	if( error ) {
 		QAS_Printf( S_COLOR_RED "* Failed to build script '%s'\n", scriptName );
 		asEngine->DiscardModule( moduleName );
-		return NULL;
+		asModule = NULL;
+		goto done;
+	}
+
+	if( useCache ) {
+		qasStoreCachedBytecode( asModule, cacheName, hash );
+		qasRemoveOrphanedBytecode( moduleName, scriptName );
+	}
+
+done:
+	for( sectionNum = 0; sectionNum < numSections && sections[sectionNum]; sectionNum++ ) {
+		qasFree( sections[sectionNum] );
 	}
+	qasFree( sections );
 
 	return asModule;
 }
@@ -81,6 +81,7 @@ __declspec( noreturn ) void QAS_Error( _Printf_format_string_ const char *format
 
 /******* C++ objects *******/
 asIScriptEngine *qasCreateEngine( bool *asMaxPortability );
+asIScriptContext *qasCreateContext( asIScriptEngine *engine );
 asIScriptContext *qasAcquireContext( asIScriptEngine *engine );
 void qasReleaseContext( asIScriptContext *ctx );
 void qasReleaseEngine( asIScriptEngine *engine );
@@ -19,6 +19,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 
 #include "qas_precompiled.h"
+#include "addon/addon_string.h"
 
 struct mempool_s *angelwrappool;
 
@@ -36,6 +37,7 @@ void QAS_InitAngelExport( void ) {
 	angelExport.asCreateEngine = qasCreateEngine;
 	angelExport.asReleaseEngine = qasReleaseEngine;
 
+	angelExport.asCreateContext = qasCreateContext;
 	angelExport.asAcquireContext = qasAcquireContext;
 	angelExport.asReleaseContext = qasReleaseContext;
 	angelExport.asGetActiveContext = qasGetActiveContext;
@@ -67,10 +69,15 @@ int QAS_Init( void ) {
 	srand( time( NULL ) );
 
 	QAS_InitAngelExport();
+
+	trap_Cmd_AddCommand( "as_stringstats", objectString_PrintStats );
 	return 1;
 }
 
 void QAS_ShutDown( void ) {
+	trap_Cmd_RemoveCommand( "as_stringstats" );
+	objectString_FreeBlocks();
+
 	QAS_MemFreePool( &angelwrappool );
 }
 
@@ -81,11 +81,11 @@ static inline char *trap_Cmd_Args( void ) {
 	return ANGELWRAP_IMPORT.Cmd_Args();
 }
 
-static inline void trap_Cmd_AddCommand( char *name, void ( *cmd )( void ) ) {
+static inline void trap_Cmd_AddCommand( const char *name, void ( *cmd )( void ) ) {
 	ANGELWRAP_IMPORT.Cmd_AddCommand( name, cmd );
 }
 
-static inline void trap_Cmd_RemoveCommand( char *cmd_name ) {
+static inline void trap_Cmd_RemoveCommand( const char *cmd_name ) {
 	ANGELWRAP_IMPORT.Cmd_RemoveCommand( cmd_name );
 }
 
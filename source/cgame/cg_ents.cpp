@@ -387,7 +387,7 @@ bool CG_NewFrameSnap( snapshot_t *frame, snapshot_t *lerpframe ) {
 	CG_UpdateEntities();
 	CG_CheckPredictionError();
 
-	cg.predictFrom = 0; // force the prediction to be restarted from the new snapshot
+	CG_ValidatePredictionCache(); // keep only predicted commands the new snapshot agrees with
 	cg.fireEvents = true;
 
 	for( i = 0; i < cg.frame.numgamecommands; i++ ) {
@@ -1093,7 +1093,7 @@ void CG_Reset( void ) {
 	chaseCam.cmd_mode_delay = 0; // cg.time
 
 	// reset prediction optimization
-	cg.predictFrom = 0;
+	CG_ClearPredictionCache();
 
 	memset( cg_entities, 0, sizeof( cg_entities ) );
 }
@@ -27,6 +27,62 @@ int cg_numTriggers;
 static entity_state_t *cg_triggersList[MAX_PARSE_ENTITIES];
 static bool cg_triggersListTriggered[MAX_PARSE_ENTITIES];
 
+// A uniform horizontal grid over the bounds of listed entities of the current frame.
+// Every cell has a bit for every list entry that might touch it, so queries
+// visit entries in the list order and give results identical to a linear scan.
+#define CG_GRID_SIZE        16
+#define CG_GRID_WORDS       ( MAX_PARSE_ENTITIES / 32 )
+
+typedef struct {
+	int numWords;
+	vec2_t origin;
+	vec2_t invCellSize;
+	unsigned cells[CG_GRID_SIZE * CG_GRID_SIZE][CG_GRID_WORDS];
+} cg_entgrid_t;
+
+static cg_entgrid_t cg_solidGrid;
+static cg_entgrid_t cg_triggersGrid;
+
+// What prediction traces see of a listed entity
+typedef struct {
+	int number;
+	int type;
+	int solid;
+	int modelindex;
+	vec3_t origin;                      // extrapolated for movers
+	vec3_t angles;
+	vec3_t absmins, absmaxs;
+} cg_collider_t;
+
+// solids go first, then triggers
+static cg_collider_t cg_colliders[2][MAX_PARSE_ENTITIES];
+static int cg_numColliders[2];
+static int cg_currentColliders;
+static int cg_colliderNums[MAX_EDICTS];
+
+// bounds of colliders that have appeared, disappeared or changed since the last frame
+static vec3_t cg_dirtyMins[2 * MAX_PARSE_ENTITIES], cg_dirtyMaxs[2 * MAX_PARSE_ENTITIES];
+static int cg_numDirty;
+
+// Predicted states after closed commands. Commands ( cg_predictCacheBase, cg_predictCacheLast ]
+// are cached, cg_predictCacheBase is the command the current snapshot has been built after.
+typedef struct {
+	int64_t ucmd;
+	player_state_t playerState;
+	int weapon;
+	vec3_t absmins, absmaxs;            // bounds of all collision queries of the command
+} cg_predictedcmd_t;
+
+static cg_predictedcmd_t cg_predictCache[CMD_BACKUP];
+static int64_t cg_predictCacheBase, cg_predictCacheLast;
+static game_state_t cg_predictGameState;
+
+// snapshots that have kept or dropped the cache, printed by cg_showMiss
+static unsigned cg_predictCacheHits, cg_predictCacheMisses;
+
+static bool cg_predictRecording;
+static vec3_t cg_predictQueryMins, cg_predictQueryMaxs;
+
 static bool ucmdReady = false;
 
 /*
@@ -106,6 +162,242 @@ void CG_CheckPredictionError( void ) {
 	}
 }
 
+/*
+* CG_EntityAbsBounds
+*
+* Conservative world bounds of an entity for both traces and contents checks.
+*/
+static void CG_EntityAbsBounds( const entity_state_t *ent, vec3_t absmins, vec3_t absmaxs ) {
+	int i, x, zd, zu;
+	struct cmodel_s *cmodel;
+	vec3_t mins, maxs, origin;
+
+	if( ent->solid == SOLID_BMODEL ) {
+		cmodel = trap_CM_InlineModel( ent->modelindex );
+		if( cmodel ) {
+			trap_CM_InlineModelBounds( cmodel, mins, maxs );
+		} else {
+			VectorClear( mins );
+			VectorClear( maxs );
+		}
+
+		if( ent->angles[0] || ent->angles[1] || ent->angles[2] ) {
+			const float radius = RadiusFromBounds( mins, maxs );
+			VectorSet( mins, -radius, -radius, -radius );
+			VectorSet( maxs, radius, radius, radius );
+		}
+	} else {
+		x = 8 * ( ent->solid & 31 );
+		zd = 8 * ( ( ent->solid >> 5 ) & 31 );
+		zu = 8 * ( ( ent->solid >> 10 ) & 63 ) - 32;
+
+		VectorSet( mins, -x, -x, -zd );
+		VectorSet( maxs, x, x, zu );
+	}
+
+	VectorAdd( ent->origin, mins, absmins );
+	VectorAdd( ent->origin, maxs, absmaxs );
+
+	// traces of movers use the extrapolated origin while contents checks use the current one
+	if( ent->solid == SOLID_BMODEL && ent->linearMovement ) {
+		GS_LinearMovement( ent, cg.frame.serverTime, origin );
+		for( i = 0; i < 3; i++ ) {
+			absmins[i] = min( absmins[i], origin[i] + mins[i] );
+			absmaxs[i] = max( absmaxs[i], origin[i] + maxs[i] );
+		}
+	}
+
+	// do not let the epsilon of collision code miss a contact
+	for( i = 0; i < 3; i++ ) {
+		absmins[i] -= 1;
+		absmaxs[i] += 1;
+	}
+}
+
+/*
+* CG_GridCellRange
+*/
+static void CG_GridCellRange( const cg_entgrid_t *grid, const vec3_t mins, const vec3_t maxs, int *cellmins, int *cellmaxs ) {
+	int i;
+
+	for( i = 0; i < 2; i++ ) {
+		cellmins[i] = (int)( ( mins[i] - grid->origin[i] ) * grid->invCellSize[i] );
+		cellmaxs[i] = (int)( ( maxs[i] - grid->origin[i] ) * grid->invCellSize[i] );
+		clamp( cellmins[i], 0, CG_GRID_SIZE - 1 );
+		clamp( cellmaxs[i], 0, CG_GRID_SIZE - 1 );
+	}
+}
+
+/*
+* CG_BuildGrid
+*/
+static void CG_BuildGrid( cg_entgrid_t *grid, const cg_collider_t *colliders, int numEnts ) {
+	int i, x, y;
+	int cellmins[2], cellmaxs[2];
+	vec3_t gridmins, gridmaxs;
+
+	grid->numWords = ( numEnts + 31 ) / 32;
+	if( !numEnts ) {
+		return;
+	}
+
+	ClearBounds( gridmins, gridmaxs );
+	for( i = 0; i < numEnts; i++ ) {
+		AddPointToBounds( colliders[i].absmins, gridmins, gridmaxs );
+		AddPointToBounds( colliders[i].absmaxs, gridmins, gridmaxs );
+	}
+
+	for( i = 0; i < 2; i++ ) {
+		grid->origin[i] = gridmins[i];
+		grid->invCellSize[i] = (float)CG_GRID_SIZE / max( gridmaxs[i] - gridmins[i], 1.0f );
+	}
+
+	for( i = 0; i < CG_GRID_SIZE * CG_GRID_SIZE; i++ ) {
+		memset( grid->cells[i], 0, grid->numWords * sizeof( unsigned ) );
+	}
+
+	for( i = 0; i < numEnts; i++ ) {
+		CG_GridCellRange( grid, colliders[i].absmins, colliders[i].absmaxs, cellmins, cellmaxs );
+		for( y = cellmins[1]; y <= cellmaxs[1]; y++ ) {
+			for( x = cellmins[0]; x <= cellmaxs[0]; x++ ) {
+				grid->cells[y * CG_GRID_SIZE + x][i >> 5] |= 1u << ( i & 31 );
+			}
+		}
+	}
+}
+
+/*
+* CG_GridQuery
+*
+* Fills the mask of list entries that might touch the box. Returns false if there are none.
+*/
+static bool CG_GridQuery( const cg_entgrid_t *grid, const vec3_t mins, const vec3_t maxs, unsigned *mask ) {
+	int i, x, y;
+	int cellmins[2], cellmaxs[2];
+	unsigned any = 0;
+
+	if( !grid->numWords ) {
+		return false;
+	}
+
+	memset( mask, 0, grid->numWords * sizeof( unsigned ) );
+
+	CG_GridCellRange( grid, mins, maxs, cellmins, cellmaxs );
+	for( y = cellmins[1]; y <= cellmaxs[1]; y++ ) {
+		for( x = cellmins[0]; x <= cellmaxs[0]; x++ ) {
+			const unsigned *cell = grid->cells[y * CG_GRID_SIZE + x];
+			for( i = 0; i < grid->numWords; i++ ) {
+				mask[i] |= cell[i];
+				any |= cell[i];
+			}
+		}
+	}
+
+	return any != 0;
+}
+
+/*
+* CG_GridNext
+*
+* Returns the next list entry that is set in the mask starting from the given one, or -1.
+*/
+static int CG_GridNext( const cg_entgrid_t *grid, const unsigned *mask, int start ) {
+	int word = start >> 5;
+	unsigned bits;
+
+	if( word >= grid->numWords ) {
+		return -1;
+	}
+
+	bits = mask[word] & ( ~0u << ( start & 31 ) );
+	while( !bits ) {
+		if( ++word >= grid->numWords ) {
+			return -1;
+		}
+		bits = mask[word];
+	}
+
+	return ( word << 5 ) + Q_bsf( bits );
+}
+
+/*
+* CG_SetCollider
+*/
+static void CG_SetCollider( cg_collider_t *collider, const entity_state_t *ent ) {
+	collider->number = ent->number;
+	collider->type = ent->type;
+	collider->solid = ent->solid;
+	collider->modelindex = ent->modelindex;
+	if( ent->solid == SOLID_BMODEL && ent->linearMovement ) {
+		GS_LinearMovement( ent, cg.frame.serverTime, collider->origin );
+	} else {
+		VectorCopy( ent->origin, collider->origin );
+	}
+	VectorCopy( ent->angles, collider->angles );
+	CG_EntityAbsBounds( ent, collider->absmins, collider->absmaxs );
+}
+
+/*
+* CG_CollidersEqual
+*/
+static bool CG_CollidersEqual( const cg_collider_t *c1, const cg_collider_t *c2 ) {
+	return c1->type == c2->type && c1->solid == c2->solid && c1->modelindex == c2->modelindex &&
+		   VectorCompare( c1->origin, c2->origin ) && VectorCompare( c1->angles, c2->angles ) &&
+		   VectorCompare( c1->absmins, c2->absmins ) && VectorCompare( c1->absmaxs, c2->absmaxs );
+}
+
+/*
+* CG_AddDirtyBounds
+*/
+static void CG_AddDirtyBounds( const cg_collider_t *collider ) {
+	// the local player is ignored by its own prediction traces
+	if( collider->number == (int)cgs.playerNum + 1 ) {
+		return;
+	}
+
+	VectorCopy( collider->absmins, cg_dirtyMins[cg_numDirty] );
+	VectorCopy( collider->absmaxs, cg_dirtyMaxs[cg_numDirty] );
+	cg_numDirty++;
+}
+
+/*
+* CG_FindDirtyColliders
+*/
+static void CG_FindDirtyColliders( void ) {
+	int i, j;
+	const cg_collider_t *oldColliders = cg_colliders[cg_currentColliders ^ 1];
+	const cg_collider_t *colliders = cg_colliders[cg_currentColliders];
+	const int numOldColliders = cg_numColliders[cg_currentColliders ^ 1];
+
+	cg_numDirty = 0;
+
+	for( i = 0; i < numOldColliders; i++ ) {
+		cg_colliderNums[oldColliders[i].number] = i + 1;
+	}
+
+	for( i = 0; i < cg_numColliders[cg_currentColliders]; i++ ) {
+		j = cg_colliderNums[colliders[i].number] - 1;
+		if( j < 0 ) {
+			CG_AddDirtyBounds( &colliders[i] );
+			continue;
+		}
+
+		cg_colliderNums[colliders[i].number] = 0;
+		if( !CG_CollidersEqual( &colliders[i], &oldColliders[j] ) ) {
+			CG_AddDirtyBounds( &oldColliders[j] );
+			CG_AddDirtyBounds( &colliders[i] );
+		}
+	}
+
+	// the ones that are left have disappeared
+	for( i = 0; i < numOldColliders; i++ ) {
+		if( cg_colliderNums[oldColliders[i].number] ) {
+			cg_colliderNums[oldColliders[i].number] = 0;
+			CG_AddDirtyBounds( &oldColliders[i] );
+		}
+	}
+}
+
 /*
 * CG_BuildSolidList
 */
@@ -149,6 +441,34 @@ void CG_BuildSolidList( void ) {
 			}
 		}
 	}
+
+	cg_currentColliders ^= 1;
+	cg_numColliders[cg_currentColliders] = cg_numSolids + cg_numTriggers;
+
+	cg_collider_t *colliders = cg_colliders[cg_currentColliders];
+	for( i = 0; i < cg_numSolids; i++ ) {
+		CG_SetCollider( &colliders[i], cg_solidList[i] );
+	}
+	for( i = 0; i < cg_numTriggers; i++ ) {
+		CG_SetCollider( &colliders[cg_numSolids + i], cg_triggersList[i] );
+	}
+
+	CG_BuildGrid( &cg_solidGrid, colliders, cg_numSolids );
+	CG_BuildGrid( &cg_triggersGrid, colliders + cg_numSolids, cg_numTriggers );
+
+	CG_FindDirtyColliders();
+}
+
+/*
+* CG_RecordPredictionQuery
+*
+* Accumulates bounds of the collision queries of the predicted command.
+*/
+static void CG_RecordPredictionQuery( const vec3_t mins, const vec3_t maxs ) {
+	if( cg_predictRecording ) {
+		AddPointToBounds( mins, cg_predictQueryMins, cg_predictQueryMaxs );
+		AddPointToBounds( maxs, cg_predictQueryMins, cg_predictQueryMaxs );
+	}
 }
 
 /*
@@ -203,13 +523,22 @@ static bool CG_ClipEntityContact( const vec3_t origin, const vec3_t mins, const
 void CG_Predict_TouchTriggers( pmove_t *pm, vec3_t previous_origin ) {
 	int i;
 	entity_state_t *state;
+	vec3_t absmins, absmaxs;
+	unsigned mask[CG_GRID_WORDS];
 
 	// fixme: more accurate check for being able to touch or not
 	if( pm->playerState->pmove.pm_type != PM_NORMAL ) {
 		return;
 	}
 
-	for( i = 0; i < cg_numTriggers; i++ ) {
+	VectorAdd( pm->playerState->pmove.origin, pm->mins, absmins );
+	VectorAdd( pm->playerState->pmove.origin, pm->maxs, absmaxs );
+	CG_RecordPredictionQuery( absmins, absmaxs );
+	if( !CG_GridQuery( &cg_triggersGrid, absmins, absmaxs, mask ) ) {
+		return;
+	}
+
+	for( i = CG_GridNext( &cg_triggersGrid, mask, 0 ); i >= 0; i = CG_GridNext( &cg_triggersGrid, mask, i + 1 ) ) {
 		state = cg_triggersList[i];
 
 		if( state->type == ET_PUSH_TRIGGER ) {
@@ -233,9 +562,28 @@ static void CG_ClipMoveToEntities( const vec3_t start, const vec3_t mins, const
 	entity_state_t *ent;
 	struct cmodel_s *cmodel;
 	vec3_t bmins, bmaxs;
+	vec3_t absmins, absmaxs;
+	unsigned mask[CG_GRID_WORDS];
 	int64_t serverTime = cg.frame.serverTime;
 
-	for( i = 0; i < cg_numSolids; i++ ) {
+	if( !mins ) {
+		mins = vec3_origin;
+	}
+	if( !maxs ) {
+		maxs = vec3_origin;
+	}
+
+	// the box that is swept by the move
+	for( i = 0; i < 3; i++ ) {
+		absmins[i] = min( start[i], end[i] ) + mins[i];
+		absmaxs[i] = max( start[i], end[i] ) + maxs[i];
+	}
+	CG_RecordPredictionQuery( absmins, absmaxs );
+	if( !CG_GridQuery( &cg_solidGrid, absmins, absmaxs, mask ) ) {
+		return;
+	}
+
+	for( i = CG_GridNext( &cg_solidGrid, mask, 0 ); i >= 0; i = CG_GridNext( &cg_solidGrid, mask, i + 1 ) ) {
 		ent = cg_solidList[i];
 
 		if( ent->number == ignore ) {
@@ -316,10 +664,16 @@ int CG_PointContents( const vec3_t point ) {
 	entity_state_t *ent;
 	struct cmodel_s *cmodel;
 	int contents;
+	unsigned mask[CG_GRID_WORDS];
 
 	contents = trap_CM_TransformedPointContents( (vec_t *)point, NULL, NULL, NULL );
 
-	for( i = 0; i < cg_numSolids; i++ ) {
+	CG_RecordPredictionQuery( point, point );
+	if( !CG_GridQuery( &cg_solidGrid, point, point, mask ) ) {
+		return contents;
+	}
+
+	for( i = CG_GridNext( &cg_solidGrid, mask, 0 ); i >= 0; i = CG_GridNext( &cg_solidGrid, mask, i + 1 ) ) {
 		ent = cg_solidList[i];
 		if( ent->solid != SOLID_BMODEL ) { // special value for bmodel
 			continue;
@@ -335,6 +689,139 @@ int CG_PointContents( const vec3_t point ) {
 }
 
 
+/*
+* CG_PredictableStatesEqual
+*
+* Compares everything prediction reads or writes, except fields that are only copied from the snapshot.
+* View angles are left out: they follow from the command angles and delta_angles, and the snapshot
+* only has their quantized wire values, so they would never match the predicted ones.
+*/
+static bool CG_PredictableStatesEqual( const player_state_t *ps1, const player_state_t *ps2 ) {
+	const pmove_state_t *pm1 = &ps1->pmove, *pm2 = &ps2->pmove;
+
+	if( pm1->pm_type != pm2->pm_type || pm1->pm_flags != pm2->pm_flags || pm1->pm_time != pm2->pm_time ||
+		pm1->skim_time != pm2->skim_time || pm1->gravity != pm2->gravity ) {
+		return false;
+	}
+	if( !VectorCompare( pm1->origin, pm2->origin ) || !VectorCompare( pm1->velocity, pm2->velocity ) ) {
+		return false;
+	}
+	if( memcmp( pm1->stats, pm2->stats, sizeof( pm1->stats ) ) ||
+		memcmp( pm1->delta_angles, pm2->delta_angles, sizeof( pm1->delta_angles ) ) ) {
+		return false;
+	}
+
+	if( ps1->viewheight != ps2->viewheight ) {
+		return false;
+	}
+	if( ps1->POVnum != ps2->POVnum || ps1->playerNum != ps2->playerNum || ps1->weaponState != ps2->weaponState ) {
+		return false;
+	}
+
+	return !memcmp( ps1->stats, ps2->stats, sizeof( ps1->stats ) ) &&
+		   !memcmp( ps1->inventory, ps2->inventory, sizeof( ps1->inventory ) );
+}
+
+/*
+* CG_CachePredictedCommand
+*/
+static void CG_CachePredictedCommand( int64_t ucmd ) {
+	cg_predictedcmd_t *cmd = &cg_predictCache[ucmd & CMD_MASK];
+
+	cmd->ucmd = ucmd;
+	cmd->playerState = cg.predictedPlayerState;
+	cmd->weapon = cg_entities[cg.predictedPlayerState.POVnum].current.weapon;
+	VectorCopy( cg_predictQueryMins, cmd->absmins );
+	VectorCopy( cg_predictQueryMaxs, cmd->absmaxs );
+
+	cg_predictCacheLast = ucmd;
+}
+
+/*
+* CG_RestorePredictedCommand
+*/
+static void CG_RestorePredictedCommand( const cg_predictedcmd_t *cmd ) {
+	player_state_t *ps = &cg.predictedPlayerState;
+	const player_state_t *frameState = &cg.frame.playerState;
+
+	*ps = cmd->playerState;
+
+	// these are not predicted, the snapshot might have newer ones
+	memcpy( ps->event, frameState->event, sizeof( ps->event ) );
+	memcpy( ps->eventParm, frameState->eventParm, sizeof( ps->eventParm ) );
+	ps->fov = frameState->fov;
+	ps->plrkeys = frameState->plrkeys;
+
+	cg_entities[ps->POVnum].current.weapon = cmd->weapon;
+}
+
+/*
+* CG_ClearPredictionCache
+*/
+void CG_ClearPredictionCache( void ) {
+	cg_predictCacheBase = cg_predictCacheLast = 0;
+}
+
+/*
+* CG_ValidatePredictionCache
+*
+* Resumes the prediction from the cached command the new snapshot has been built after,
+* if the server agrees with the predicted state. Drops cached commands starting from
+* the first one that has looked for collisions near a changed entity.
+*/
+void CG_ValidatePredictionCache( void ) {
+	int64_t ucmd;
+	int i;
+	const int64_t ucmdExecuted = cg.frame.ucmdExecuted;
+	const cg_predictedcmd_t *cmd;
+	const char *reason = NULL;
+
+	if( cg_predictCacheLast <= cg_predictCacheBase ) {
+		// nothing to validate
+		CG_ClearPredictionCache();
+		return;
+	}
+
+	cmd = &cg_predictCache[ucmdExecuted & CMD_MASK];
+	if( ucmdExecuted <= cg_predictCacheBase || ucmdExecuted > cg_predictCacheLast || cmd->ucmd != ucmdExecuted ) {
+		reason = "command not cached";
+	} else if( !CG_PredictableStatesEqual( &cmd->playerState, &cg.frame.playerState ) ) {
+		reason = "player state differs";
+	} else if( memcmp( &cg_predictGameState, &cg.frame.gameState, sizeof( game_state_t ) ) ) {
+		reason = "game state changed";
+	}
+
+	if( reason ) {
+		cg_predictCacheMisses++;
+		if( cg_showMiss->integer ) {
+			CG_Printf( "prediction cache miss on %" PRIi64 ": %s (%u hits, %u misses)\n",
+					   cg.frame.serverFrame, reason, cg_predictCacheHits, cg_predictCacheMisses );
+		}
+		CG_ClearPredictionCache();
+		return;
+	}
+
+	cg_predictCacheBase = ucmdExecuted;
+	for( ucmd = ucmdExecuted + 1; ucmd <= cg_predictCacheLast; ucmd++ ) {
+		cmd = &cg_predictCache[ucmd & CMD_MASK];
+		for( i = 0; i < cg_numDirty; i++ ) {
+			if( BoundsIntersect( cmd->absmins, cmd->absmaxs, cg_dirtyMins[i], cg_dirtyMaxs[i] ) ) {
+				break;
+			}
+		}
+		if( i < cg_numDirty ) {
+			break;
+		}
+	}
+	cg_predictCacheLast = ucmd - 1;
+
+	cg_predictCacheHits++;
+	if( cg_showMiss->integer > 1 ) {
+		CG_Printf( "prediction cache hit on %" PRIi64 ": %i commands kept (%u hits, %u misses)\n",
+				   cg.frame.serverFrame, (int)( cg_predictCacheLast - cg_predictCacheBase ), cg_predictCacheHits, cg_predictCacheMisses );
+	}
+}
+
 static float predictedSteps[CMD_BACKUP]; // for step smoothing
 /*
 * CG_PredictAddStep
@@ -408,16 +895,18 @@ void CG_PredictMovement( void ) {
 	trap_NET_GetCurrentState( NULL, &ucmdHead, NULL );
 	ucmdExecuted = cg.frame.ucmdExecuted;
 
-	if( !cg_predict_optimize->integer || ( ucmdHead - cg.predictFrom >= CMD_BACKUP ) ) {
-		cg.predictFrom = 0;
+	if( !cg_predict_optimize->integer || cg_predictCacheBase != ucmdExecuted || ucmdHead - ucmdExecuted >= CMD_BACKUP ) {
+		CG_ClearPredictionCache();
+		cg_predictCacheBase = cg_predictCacheLast = ucmdExecuted;
+		cg_predictGameState = cg.frame.gameState;
 	}
 
-	if( cg.predictFrom > 0 ) {
-		ucmdExecuted = cg.predictFrom;
-		cg.predictedPlayerState = cg.predictFromPlayerState;
-		cg_entities[cg.frame.playerState.POVnum].current = cg.predictFromEntityState;
-	} else {
-		cg.predictedPlayerState = cg.frame.playerState; // start from the final position
+	cg.predictedPlayerState = cg.frame.playerState; // start from the final position
+
+	// skip the closed commands that have already been predicted
+	if( cg_predictCacheLast > ucmdExecuted ) {
+		ucmdExecuted = min( cg_predictCacheLast, ucmdHead - 1 );
+		CG_RestorePredictedCommand( &cg_predictCache[ucmdExecuted & CMD_MASK] );
 	}
 
 	cg.predictedPlayerState.POVnum = cgs.playerNum + 1;
@@ -449,6 +938,10 @@ void CG_PredictMovement( void ) {
 			cg.predictingTimeStamp = pm.cmd.serverTimeStamp;
 		}
 
+		// remember where the closed commands look for collisions
+		cg_predictRecording = cg_predict_optimize->integer && ucmdExecuted < ucmdHead && ucmdExecuted == cg_predictCacheLast + 1;
+		ClearBounds( cg_predictQueryMins, cg_predictQueryMaxs );
+
 		Pmove( &pm );
 
 		// copy for stair smoothing
@@ -465,13 +958,9 @@ void CG_PredictMovement( void ) {
 		// save for debug checking
 		VectorCopy( cg.predictedPlayerState.pmove.origin, cg.predictedOrigins[frame] ); // store for prediction error checks
 
-		// backup the last predicted ucmd which has a timestamp (it's closed)
-		if( cg_predict_optimize->integer && ucmdExecuted == ucmdHead - 1 ) {
-			if( ucmdExecuted != cg.predictFrom ) {
-				cg.predictFrom = ucmdExecuted;
-				cg.predictFromPlayerState = cg.predictedPlayerState;
-				cg.predictFromEntityState = cg_entities[cg.frame.playerState.POVnum].current;
-			}
+		if( cg_predictRecording ) {
+			cg_predictRecording = false;
+			CG_CachePredictedCommand( ucmdExecuted );
 		}
 	}
 
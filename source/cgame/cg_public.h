@@ -43,7 +43,7 @@ typedef void ( *cg_fdrawchar_t )( int x, int y, int w, int h, float s1, float t1
 
 // cg_public.h -- client game dll information visible to engine
 
-#define CGAME_API_VERSION   102
+#define CGAME_API_VERSION   103
 
 //
 // structs and variables shared with the main engine
@@ -248,6 +248,15 @@ typedef struct {
 	void *( *Mem_Alloc )( size_t size, const char *filename, int fileline );
 	void ( *Mem_Free )( void *data, const char *filename, int fileline );
 
+	// engine-wide worker threads
+	unsigned ( *Tasks_NumWorkers )( void );
+	struct qtaskgroup_s *( *TaskGroup_Create )( void );
+	void ( *TaskGroup_Destroy )( struct qtaskgroup_s **pgroup );
+	void ( *TaskGroup_Wait )( struct qtaskgroup_s *group );
+	void ( *Task_Spawn )( struct qtaskgroup_s *group, qtaskfunc_t func, const void *arg, size_t argSize );
+	void ( *Task_ParallelFor )( struct qtaskgroup_s *group, qtaskrangefunc_t func, const void *arg, size_t argSize,
+								unsigned items, unsigned grain );
+
 	// l10n
 	void ( *L10n_ClearDomain )( void );
 	void ( *L10n_LoadLangPOFile )( const char *filepath );
@@ -503,6 +503,31 @@ static inline void trap_MemFree( void *data, const char *filename, int fileline
 	CGAME_IMPORT.Mem_Free( data, filename, fileline );
 }
 
+static inline unsigned trap_Tasks_NumWorkers( void ) {
+	return CGAME_IMPORT.Tasks_NumWorkers();
+}
+
+static inline struct qtaskgroup_s *trap_TaskGroup_Create( void ) {
+	return CGAME_IMPORT.TaskGroup_Create();
+}
+
+static inline void trap_TaskGroup_Destroy( struct qtaskgroup_s **pgroup ) {
+	CGAME_IMPORT.TaskGroup_Destroy( pgroup );
+}
+
+static inline void trap_TaskGroup_Wait( struct qtaskgroup_s *group ) {
+	CGAME_IMPORT.TaskGroup_Wait( group );
+}
+
+static inline void trap_Task_Spawn( struct qtaskgroup_s *group, qtaskfunc_t func, const void *arg, size_t argSize ) {
+	CGAME_IMPORT.Task_Spawn( group, func, arg, argSize );
+}
+
+static inline void trap_Task_ParallelFor( struct qtaskgroup_s *group, qtaskrangefunc_t func, const void *arg, size_t argSize,
+										  unsigned items, unsigned grain ) {
+	CGAME_IMPORT.Task_ParallelFor( group, func, arg, argSize, items, grain );
+}
+
 static inline void trap_AsyncStream_UrlEncode( const char *src, char *dst, size_t size ) {
 	CGAME_IMPORT.AsyncStream_UrlEncode( src, dst, size );
 }
@@ -48,6 +48,7 @@ typedef struct {
 	bool ( *need_next_frame )( cinematics_t *cin );
 	uint8_t *( *read_next_frame )( cinematics_t * cin, bool * redraw );
 	cin_yuv_t *( *read_next_frame_yuv )( cinematics_t * cin, bool * redraw );
+	bool async;             // frames are paced by the frame rate only, so they can be decoded ahead
 } cin_type_t;
 
 static const cin_type_t cin_types[] =
@@ -65,7 +66,8 @@ static const cin_type_t cin_types[] =
 #else
 		NULL,
 #endif
-		Theora_ReadNextFrameYUV_CIN
+		Theora_ReadNextFrameYUV_CIN,
+		false
 	},
 
 	// RoQ - http://wiki.multimedia.cx/index.php?title=ROQ
@@ -77,7 +79,8 @@ static const cin_type_t cin_types[] =
 		RoQ_Reset_CIN,
 		RoQ_NeedNextFrame_CIN,
 		NULL,
-		RoQ_ReadNextFrameYUV_CIN
+		RoQ_ReadNextFrameYUV_CIN,
+		true
 	},
 
 	// NULL safe guard
@@ -89,12 +92,494 @@ static const cin_type_t cin_types[] =
 		NULL,
 		NULL,
 		NULL,
-		NULL
+		NULL,
+		false
 	}
 };
 
 // =====================================================================
 
+#define CIN_MAX_ASYNC_FRAMES    16
+
+typedef struct {
+	unsigned int samples;
+	unsigned int rate;
+	unsigned short width;
+	unsigned short channels;
+} cin_samples_header_t;
+
+typedef struct {
+	cin_yuv_t yuv;
+	uint8_t *pixels;
+	size_t pixels_size;
+
+	// raw samples that have been read along with the frame,
+	// every chunk of samples is prefixed with cin_samples_header_t
+	uint8_t *samples;
+	size_t samples_len, samples_size;
+
+	bool redraw;
+	bool restart;                   // the first frame after the cinematic has been looped
+} cin_frame_t;
+
+typedef struct cin_async_s {
+	cinematics_t *cin;
+	struct cin_async_s *next;
+
+	// a ring of decoded frames, the presented frame is kept intact until the next one is read
+	cin_frame_t frames[CIN_MAX_ASYNC_FRAMES];
+	int num_frames;
+	int head;                       // the next frame to present
+	int count;                      // decoded frames that have not been presented yet
+	int current;                    // the presented frame
+
+	bool busy;                      // the decoding thread works on this cinematic
+	bool restart;                   // the decoder must be reset before decoding the next frame
+	bool eos;
+	unsigned int generation;        // incremented when queued frames are discarded
+
+	cin_frame_t *decode_frame;      // the frame that receives raw samples, only accessed by the decoding thread
+
+	unsigned int frame;             // the number of presented frames since the start, used for pacing
+
+	// statistics
+	unsigned int decoded;
+	unsigned int starved;
+	uint64_t decode_micros;
+	uint64_t max_decode_micros;
+} cin_async_t;
+
+static cvar_t *cin_async;
+
+static struct qmutex_s *cin_asyncLock;
+static struct qcondvar_s *cin_asyncCond;        // wakes the decoding thread up
+static struct qcondvar_s *cin_asyncDoneCond;    // signalled when the decoding thread finishes a frame
+static struct qthread_s *cin_asyncThread;
+static volatile bool cin_asyncQuit;
+static cin_async_t *cin_asyncList;
+
+/*
+* CIN_SendRawSamples
+*/
+static void CIN_SendRawSamples( cinematics_t *cin, unsigned int samples, unsigned int rate,
+								unsigned short width, unsigned short channels, const uint8_t *data ) {
+	int i;
+
+	for( i = 0; i < cin->num_listeners; i++ ) {
+		cin->listeners[i].raw_samples( cin->listeners[i].listener, samples, rate, width, channels, data );
+	}
+
+	cin->haveAudio = true;
+	cin->s_samples_length = CIN_GetRawSamplesLengthFromListeners( cin );
+}
+
+/*
+* CIN_StoreAsyncRawSamples
+*
+* Keeps raw samples along with the decoded frame so they are sent to listeners when the frame is presented.
+*/
+static void CIN_StoreAsyncRawSamples( cinematics_t *cin, unsigned int samples, unsigned int rate,
+									  unsigned short width, unsigned short channels, const uint8_t *data ) {
+	cin_frame_t *frame = cin->async->decode_frame;
+	cin_samples_header_t header;
+	size_t size, chunk_size;
+
+	if( !frame ) {
+		return;
+	}
+
+	size = samples * width * channels;
+	chunk_size = sizeof( header ) + ( ( size + 3 ) & ~3 );
+
+	if( frame->samples_len + chunk_size > frame->samples_size ) {
+		size_t new_size = max( frame->samples_size * 2, frame->samples_len + chunk_size );
+		uint8_t *new_samples = CIN_Alloc( cin->mempool, new_size );
+
+		if( frame->samples ) {
+			memcpy( new_samples, frame->samples, frame->samples_len );
+			CIN_Free( frame->samples );
+		}
+		frame->samples = new_samples;
+		frame->samples_size = new_size;
+	}
+
+	header.samples = samples;
+	header.rate = rate;
+	header.width = width;
+	header.channels = channels;
+	memcpy( frame->samples + frame->samples_len, &header, sizeof( header ) );
+	memcpy( frame->samples + frame->samples_len + sizeof( header ), data, size );
+	frame->samples_len += chunk_size;
+}
+
+/*
+* CIN_SendQueuedRawSamples
+*/
+static void CIN_SendQueuedRawSamples( cinematics_t *cin, const cin_frame_t *frame ) {
+	size_t pos;
+	cin_samples_header_t header;
+
+	for( pos = 0; pos < frame->samples_len; ) {
+		memcpy( &header, frame->samples + pos, sizeof( header ) );
+		pos += sizeof( header );
+
+		CIN_SendRawSamples( cin, header.samples, header.rate, header.width, header.channels, frame->samples + pos );
+		pos += ( header.samples * header.width * header.channels + 3 ) & ~3;
+	}
+}
+
+/*
+* CIN_CopyAsyncFrame
+*/
+static void CIN_CopyAsyncFrame( cinematics_t *cin, cin_frame_t *frame, const cin_yuv_t *cyuv ) {
+	int i;
+	size_t size, offset;
+
+	for( i = 0, size = 0; i < 3; i++ ) {
+		size += (size_t)cyuv->yuv[i].stride * cyuv->yuv[i].height;
+	}
+
+	if( size > frame->pixels_size ) {
+		if( frame->pixels ) {
+			CIN_Free( frame->pixels );
+		}
+		frame->pixels = CIN_Alloc( cin->mempool, size );
+		frame->pixels_size = size;
+	}
+
+	frame->yuv = *cyuv;
+	for( i = 0, offset = 0; i < 3; i++ ) {
+		size = (size_t)cyuv->yuv[i].stride * cyuv->yuv[i].height;
+		frame->yuv.yuv[i].data = frame->pixels + offset;
+		memcpy( frame->yuv.yuv[i].data, cyuv->yuv[i].data, size );
+		offset += size;
+	}
+}
+
+/*
+* CIN_PickAsyncCinematic
+*
+* Returns the cinematic with the least number of decoded frames that has a free frame in the ring.
+*/
+static cin_async_t *CIN_PickAsyncCinematic( void ) {
+	cin_async_t *async, *best = NULL;
+
+	for( async = cin_asyncList; async; async = async->next ) {
+		if( async->busy || async->eos || async->count >= async->num_frames - 1 ) {
+			continue;
+		}
+		if( !best || async->count < best->count ) {
+			best = async;
+		}
+	}
+
+	return best;
+}
+
+/*
+* CIN_DecodeAsyncFrame
+*
+* Must be called with the lock held, releases it while decoding.
+*/
+static void CIN_DecodeAsyncFrame( cin_async_t *async ) {
+	int i;
+	bool redraw = false;
+	cin_yuv_t *cyuv = NULL;
+	cinematics_t *cin = async->cin;
+	const cin_type_t *type = &cin_types[cin->type];
+	const unsigned int generation = async->generation;
+	const bool restart = async->restart;
+	// stays the same when frames are presented meanwhile
+	cin_frame_t *frame = &async->frames[( async->head + async->count ) % async->num_frames];
+	uint64_t micros;
+
+	async->busy = true;
+	async->restart = false;
+	trap_Mutex_Unlock( cin_asyncLock );
+
+	micros = trap_Microseconds();
+
+	if( restart ) {
+		type->reset( cin );
+		cin->frame = 0;
+	}
+
+	frame->samples_len = 0;
+	frame->restart = false;
+	async->decode_frame = frame;
+
+	for( i = 0; i < 2; i++ ) {
+		redraw = false;
+		cyuv = type->read_next_frame_yuv( cin, &redraw );
+		if( cyuv || !( cin->flags & CIN_LOOP ) ) {
+			break;
+		}
+
+		// try again from the beginning if looping
+		type->reset( cin );
+		cin->frame = 0;
+		frame->restart = true;
+	}
+
+	async->decode_frame = NULL;
+
+	if( cyuv ) {
+		CIN_CopyAsyncFrame( cin, frame, cyuv );
+		frame->redraw = redraw;
+	}
+
+	micros = trap_Microseconds() - micros;
+
+	trap_Mutex_Lock( cin_asyncLock );
+
+	async->busy = false;
+
+	// discard the frame if the cinematic has been reset meanwhile
+	if( async->generation == generation ) {
+		if( cyuv ) {
+			async->count++;
+			async->decoded++;
+			async->decode_micros += micros;
+			async->max_decode_micros = max( async->max_decode_micros, micros );
+		} else {
+			async->eos = true;
+		}
+	}
+
+	trap_CondVar_Wake( cin_asyncDoneCond );
+}
+
+/*
+* CIN_AsyncThreadProc
+*/
+static void *CIN_AsyncThreadProc( void *param ) {
+	cin_async_t *async;
+
+	trap_Mutex_Lock( cin_asyncLock );
+
+	while( !cin_asyncQuit ) {
+		async = CIN_PickAsyncCinematic();
+		if( !async ) {
+			trap_CondVar_Wait( cin_asyncCond, cin_asyncLock, 100 );
+			continue;
+		}
+
+		CIN_DecodeAsyncFrame( async );
+	}
+
+	trap_Mutex_Unlock( cin_asyncLock );
+
+	return NULL;
+}
+
+/*
+* CIN_OpenAsync
+*/
+static void CIN_OpenAsync( cinematics_t *cin ) {
+	cin_async_t *async;
+
+	async = CIN_Alloc( cin->mempool, sizeof( *async ) );
+	memset( async, 0, sizeof( *async ) );
+
+	async->cin = cin;
+	async->num_frames = bound( 2, cin_async->integer + 1, CIN_MAX_ASYNC_FRAMES );
+	async->current = -1;
+	cin->async = async;
+
+	trap_Mutex_Lock( cin_asyncLock );
+
+	if( !cin_asyncThread ) {
+		cin_asyncQuit = false;
+		cin_asyncThread = trap_Thread_Create( CIN_AsyncThreadProc, NULL );
+	}
+
+	async->next = cin_asyncList;
+	cin_asyncList = async;
+
+	trap_CondVar_Wake( cin_asyncCond );
+	trap_Mutex_Unlock( cin_asyncLock );
+}
+
+/*
+* CIN_CloseAsync
+*/
+static void CIN_CloseAsync( cinematics_t *cin ) {
+	int i;
+	cin_async_t *async = cin->async, **prev;
+
+	trap_Mutex_Lock( cin_asyncLock );
+
+	for( prev = &cin_asyncList; *prev; prev = &( *prev )->next ) {
+		if( *prev == async ) {
+			*prev = async->next;
+			break;
+		}
+	}
+
+	// the decoding thread might still be working on the last frame
+	while( async->busy ) {
+		trap_CondVar_Wait( cin_asyncDoneCond, cin_asyncLock, 1 );
+	}
+
+	trap_Mutex_Unlock( cin_asyncLock );
+
+	for( i = 0; i < async->num_frames; i++ ) {
+		if( async->frames[i].pixels ) {
+			CIN_Free( async->frames[i].pixels );
+		}
+		if( async->frames[i].samples ) {
+			CIN_Free( async->frames[i].samples );
+		}
+	}
+
+	CIN_Free( async );
+	cin->async = NULL;
+}
+
+/*
+* CIN_ResetAsync
+*/
+static void CIN_ResetAsync( cinematics_t *cin ) {
+	cin_async_t *async = cin->async;
+
+	trap_Mutex_Lock( cin_asyncLock );
+
+	// the presented frame stays valid
+	async->count = 0;
+	async->restart = true;
+	async->eos = false;
+	async->generation++;
+
+	trap_CondVar_Wake( cin_asyncCond );
+	trap_Mutex_Unlock( cin_asyncLock );
+
+	async->frame = 0;
+}
+
+/*
+* CIN_NeedNextAsyncFrame
+*/
+static bool CIN_NeedNextAsyncFrame( cinematics_t *cin ) {
+	bool ready;
+	unsigned int frame;
+	cin_async_t *async = cin->async;
+
+	if( cin->cur_time <= cin->start_time ) {
+		return false;
+	}
+
+	frame = ( cin->cur_time - cin->start_time ) * cin->framerate / 1000.0;
+	if( frame <= async->frame ) {
+		return false;
+	}
+
+	if( frame > async->frame + 1 ) {
+		Com_DPrintf( "Dropped frame: %i > %i\n", frame, async->frame + 1 );
+		cin->start_time = cin->cur_time - async->frame * 1000 / cin->framerate;
+	}
+
+	trap_Mutex_Lock( cin_asyncLock );
+	ready = async->count > 0 || async->eos;
+	if( !ready ) {
+		async->starved++;
+	}
+	trap_Mutex_Unlock( cin_asyncLock );
+
+	return ready;
+}
+
+/*
+* CIN_ReadNextAsyncFrame
+*
+* Presents the oldest decoded frame. Returns the presented frame if no frame is ready yet.
+*/
+static cin_yuv_t *CIN_ReadNextAsyncFrame( cinematics_t *cin, bool *redraw ) {
+	cin_frame_t *frame;
+	cin_async_t *async = cin->async;
+
+	trap_Mutex_Lock( cin_asyncLock );
+
+	if( !async->count ) {
+		frame = ( async->eos || async->current < 0 ) ? NULL : &async->frames[async->current];
+		trap_Mutex_Unlock( cin_asyncLock );
+		return frame ? &frame->yuv : NULL;
+	}
+
+	async->current = async->head;
+	async->head = ( async->head + 1 ) % async->num_frames;
+	async->count--;
+
+	trap_CondVar_Wake( cin_asyncCond );
+	trap_Mutex_Unlock( cin_asyncLock );
+
+	frame = &async->frames[async->current];
+	if( frame->restart ) {
+		async->frame = 0;
+		cin->start_time = cin->cur_time;
+	}
+	async->frame++;
+
+	CIN_SendQueuedRawSamples( cin, frame );
+
+	*redraw = frame->redraw;
+	return &frame->yuv;
+}
+
+/*
+* CIN_InitAsync
+*/
+void CIN_InitAsync( void ) {
+	// the number of frames decoded ahead for cinematics opened with CIN_ASYNC, 0 to decode synchronously
+	cin_async = trap_Cvar_Get( "cin_async", "4", CVAR_ARCHIVE );
+
+	cin_asyncLock = trap_Mutex_Create();
+	cin_asyncCond = trap_CondVar_Create();
+	cin_asyncDoneCond = trap_CondVar_Create();
+}
+
+/*
+* CIN_ShutdownAsync
+*/
+void CIN_ShutdownAsync( void ) {
+	if( cin_asyncThread ) {
+		trap_Mutex_Lock( cin_asyncLock );
+		cin_asyncQuit = true;
+		trap_CondVar_Wake( cin_asyncCond );
+		trap_Mutex_Unlock( cin_asyncLock );
+
+		trap_Thread_Join( cin_asyncThread );
+		cin_asyncThread = NULL;
+	}
+
+	trap_CondVar_Destroy( &cin_asyncDoneCond );
+	trap_CondVar_Destroy( &cin_asyncCond );
+	trap_Mutex_Destroy( &cin_asyncLock );
+}
+
+/*
+* CIN_Stats_f
+*/
+void CIN_Stats_f( void ) {
+	cin_async_t *async;
+
+	trap_Mutex_Lock( cin_asyncLock );
+
+	if( !cin_asyncList ) {
+		Com_Printf( "No cinematics are decoded in background\n" );
+	}
+
+	for( async = cin_asyncList; async; async = async->next ) {
+		Com_Printf( "%s: %i/%i frames queued, %u decoded in %.2f ms avg, %.2f ms max, %u times starved%s\n",
+					async->cin->name, async->count, async->num_frames - 1, async->decoded,
+					async->decoded ? async->decode_micros * 0.001 / async->decoded : 0.0,
+					async->max_decode_micros * 0.001, async->starved, async->eos ? ", finished" : "" );
+	}
+
+	trap_Mutex_Unlock( cin_asyncLock );
+}
+
+// =====================================================================
+
 /*
 * CIN_Open
 */
@@ -182,6 +667,10 @@ cinematics_t *CIN_Open( const char *name, int64_t start_time,
 		return NULL;
 	}
 
+	if( ( flags & CIN_ASYNC ) && type->async && cin_async->integer > 0 ) {
+		CIN_OpenAsync( cin );
+	}
+
 	if( yuv ) {
 		*yuv = cin->yuv;
 	}
@@ -234,6 +723,10 @@ bool CIN_NeedNextFrame( cinematics_t *cin, int64_t curtime ) {
 		return false;
 	}
 
+	if( cin->async ) {
+		return CIN_NeedNextAsyncFrame( cin );
+	}
+
 	return type->need_next_frame( cin );
 }
 
@@ -246,6 +739,7 @@ static uint8_t *CIN_ReadNextFrame_( cinematics_t *cin, int *width, int *height,
 	uint8_t *frame = NULL;
 	const cin_type_t *type;
 	bool redraw_ = false;
+	int frame_width, frame_height;
 
 	assert( cin );
 	assert( cin->type > CIN_TYPE_NONE && cin->type < CIN_NUM_TYPES );
@@ -254,28 +748,40 @@ static uint8_t *CIN_ReadNextFrame_( cinematics_t *cin, int *width, int *height,
 
 	cin->haveAudio = false;
 
-	for( i = 0; i < 2; i++ ) {
-		redraw_ = false;
-		if( yuv ) {
-			frame = ( uint8_t * )type->read_next_frame_yuv( cin, &redraw_ );
-		} else {
-			frame = type->read_next_frame( cin, &redraw_ );
-		}
-		if( frame || !( cin->flags & CIN_LOOP ) ) {
-			break;
+	if( cin->async ) {
+		// the decoder state belongs to the decoding thread, take the dimensions from the frame
+		cin_yuv_t *cyuv = CIN_ReadNextAsyncFrame( cin, &redraw_ );
+
+		frame = ( uint8_t * )cyuv;
+		frame_width = cyuv ? cyuv->image_width : 0;
+		frame_height = cyuv ? cyuv->image_height : 0;
+	} else {
+		for( i = 0; i < 2; i++ ) {
+			redraw_ = false;
+			if( yuv ) {
+				frame = ( uint8_t * )type->read_next_frame_yuv( cin, &redraw_ );
+			} else {
+				frame = type->read_next_frame( cin, &redraw_ );
+			}
+			if( frame || !( cin->flags & CIN_LOOP ) ) {
+				break;
+			}
+
+			// try again from the beginning if looping
+			type->reset( cin );
+			cin->frame = 0;
+			cin->start_time = cin->cur_time;
 		}
 
-		// try again from the beginning if looping
-		type->reset( cin );
-		cin->frame = 0;
-		cin->start_time = cin->cur_time;
+		frame_width = cin->width;
+		frame_height = cin->height;
 	}
 
 	if( width ) {
-		*width = cin->width;
+		*width = frame_width;
 	}
 	if( height ) {
-		*height = cin->height;
+		*height = frame_height;
 	}
 	if( aspect_numerator ) {
 		*aspect_numerator = cin->aspect_numerator;
@@ -360,18 +866,17 @@ bool CIN_AddRawSamplesListener( cinematics_t *cin, void *listener,
 */
 void CIN_RawSamplesToListeners( cinematics_t *cin, unsigned int samples, unsigned int rate,
 								unsigned short width, unsigned short channels, const uint8_t *data ) {
-	int i;
-
 	if( cin->flags & CIN_NOAUDIO ) {
 		return;
 	}
 
-	for( i = 0; i < cin->num_listeners; i++ ) {
-		cin->listeners[i].raw_samples( cin->listeners[i].listener, samples, rate, width, channels, data );
+	// called by the decoding thread, the samples are sent when the frame is presented
+	if( cin->async ) {
+		CIN_StoreAsyncRawSamples( cin, samples, rate, width, channels, data );
+		return;
 	}
 
-	cin->haveAudio = true;
-	cin->s_samples_length = CIN_GetRawSamplesLengthFromListeners( cin );
+	CIN_SendRawSamples( cin, samples, rate, width, channels, data );
 }
 
 /*
@@ -404,8 +909,12 @@ void CIN_Reset( cinematics_t *cin, int64_t cur_time ) {
 
 	type = &cin_types[cin->type];
 
-	type->reset( cin );
-	cin->frame = 0;
+	if( cin->async ) {
+		CIN_ResetAsync( cin );
+	} else {
+		type->reset( cin );
+		cin->frame = 0;
+	}
 	cin->cur_time = cur_time;
 	cin->start_time = cur_time;
 }
@@ -426,6 +935,10 @@ void CIN_Close( cinematics_t *cin ) {
 	mempool = cin->mempool;
 	assert( mempool != NULL );
 
+	if( cin->async ) {
+		CIN_CloseAsync( cin );
+	}
+
 	type = &cin_types[cin->type];
 	type->shutdown( cin );
 
@@ -455,3 +968,86 @@ void CIN_Close( cinematics_t *cin ) {
 	CIN_Free( cin );
 	CIN_FreePool( &mempool );
 }
+
+/*
+* CIN_BenchmarkFile
+*/
+static bool CIN_BenchmarkFile( const char *name, unsigned *frames, uint64_t *micros ) {
+	cinematics_t *cin;
+	uint64_t start;
+
+	*frames = 0;
+	*micros = 0;
+
+	cin = CIN_Open( name, 0, CIN_NOAUDIO, NULL, NULL );
+	if( !cin ) {
+		return false;
+	}
+
+	// Theora frames are decoded at the playback pace
+	if( cin->type != CIN_TYPE_ROQ ) {
+		CIN_Close( cin );
+		return false;
+	}
+
+	start = trap_Microseconds();
+	while( CIN_ReadNextFrameYUV( cin, NULL, NULL, NULL, NULL, NULL ) ) {
+		( *frames )++;
+	}
+	*micros = trap_Microseconds() - start;
+
+	CIN_Close( cin );
+	return true;
+}
+
+/*
+* CIN_Benchmark_f
+*
+* Decodes every frame of the given cinematic or of all RoQ files in the video directory
+* as fast as possible, without uploading frames to the renderer and without audio.
+*/
+void CIN_Benchmark_f( void ) {
+	int i, j, total, len;
+	char names[2048], path[MAX_QPATH];
+	unsigned frames, total_frames = 0;
+	uint64_t micros, total_micros = 0;
+
+	if( trap_Cmd_Argc() > 1 ) {
+		if( CIN_BenchmarkFile( trap_Cmd_Argv( 1 ), &frames, &micros ) ) {
+			Com_Printf( "%s: %u frames in %.1f ms (%.1f fps)\n", trap_Cmd_Argv( 1 ), frames,
+						micros * 0.001, micros ? frames * 1000000.0 / micros : 0.0 );
+		} else {
+			Com_Printf( "Couldn't open %s as a RoQ file\n", trap_Cmd_Argv( 1 ) );
+		}
+		return;
+	}
+
+	total = trap_FS_GetFileList( "video", ROQ_FILE_EXTENSIONS, NULL, 0, 0, 0 );
+
+	for( i = 0; i < total; ) {
+		memset( names, 0, sizeof( names ) );
+		j = trap_FS_GetFileList( "video", ROQ_FILE_EXTENSIONS, names, sizeof( names ), i, total );
+
+		// the name is too long or the end of the list
+		if( !j ) {
+			i++;
+			continue;
+		}
+		i += j;
+
+		for( len = 0; j-- && names[len]; len += strlen( names + len ) + 1 ) {
+			Q_snprintfz( path, sizeof( path ), "video/%s", names + len );
+			if( !CIN_BenchmarkFile( path, &frames, &micros ) ) {
+				continue;
+			}
+
+			Com_Printf( "%s: %u frames in %.1f ms (%.1f fps)\n", path, frames,
+						micros * 0.001, micros ? frames * 1000000.0 / micros : 0.0 );
+			total_frames += frames;
+			total_micros += micros;
+		}
+	}
+
+	Com_Printf( "%i cinematics, %u frames in %.1f ms (%.1f fps)\n", total, total_frames,
+				total_micros * 0.001, total_micros ? total_frames * 1000000.0 / total_micros : 0.0 );
+}
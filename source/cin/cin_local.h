@@ -77,6 +77,7 @@ typedef struct cinematics_s {
 
 	int type;
 	void        *fdata;             // format-dependent data
+	struct cin_async_s *async;      // non-NULL if frames are decoded by the background thread
 	struct mempool_s *mempool;
 } cinematics_t;
 
@@ -116,4 +117,10 @@ void CIN_Reset( cinematics_t *cin, int64_t cur_time );
 
 void CIN_Close( cinematics_t *cin );
 
+void CIN_InitAsync( void );
+void CIN_ShutdownAsync( void );
+
+void CIN_Benchmark_f( void );
+void CIN_Stats_f( void );
+
 #endif
@@ -38,6 +38,11 @@ bool CIN_Init( bool verbose ) {
 
 	Theora_LoadTheoraLibraries();
 
+	CIN_InitAsync();
+
+	trap_Cmd_AddCommand( "cin_benchmark", CIN_Benchmark_f );
+	trap_Cmd_AddCommand( "cin_stats", CIN_Stats_f );
+
 	return true;
 }
 
@@ -45,6 +50,11 @@ bool CIN_Init( bool verbose ) {
 * CIN_Shutdown
 */
 void CIN_Shutdown( bool verbose ) {
+	trap_Cmd_RemoveCommand( "cin_benchmark" );
+	trap_Cmd_RemoveCommand( "cin_stats" );
+
+	CIN_ShutdownAsync();
+
 	Theora_UnloadTheoraLibraries();
 
 	CIN_FreePool( &cinPool );
@@ -176,6 +176,80 @@ static void RoQ_ReadCodebook( cinematics_t *cin ) {
 	trap_FS_Read( roq->qcells, sizeof( roq_qcell_t ) * nv2, cin->file );
 }
 
+/*
+* RoQ_CopyRow8
+*/
+static inline void RoQ_CopyRow8( uint8_t *dst, const uint8_t *src ) {
+#if defined( QF_SSE2 )
+	_mm_storel_epi64( ( __m128i * )dst, _mm_loadl_epi64( ( const __m128i * )src ) );
+#elif defined( QF_NEON )
+	vst1_u8( dst, vld1_u8( src ) );
+#else
+	memcpy( dst, src, 8 );
+#endif
+}
+
+/*
+* RoQ_ExpandCellPair
+*
+* Writes 4 rows of 8 luma samples of two horizontally adjacent 4x4 blocks,
+* each of them is a 2x2 codebook cell scaled up twice.
+*/
+static inline void RoQ_ExpandCellPair( uint8_t *dst, int stride, const roq_cell_t *left, const roq_cell_t *right ) {
+#if defined( QF_SSE2 )
+	int32_t l, r;
+	__m128i a, b, rows;
+
+	memcpy( &l, left->y, 4 );
+	memcpy( &r, right->y, 4 );
+
+	// y0 y0 y1 y1 y2 y2 y3 y3 for both cells
+	a = _mm_cvtsi32_si128( l );
+	a = _mm_unpacklo_epi8( a, a );
+	b = _mm_cvtsi32_si128( r );
+	b = _mm_unpacklo_epi8( b, b );
+
+	// the low half is the top row, the high half is the bottom row
+	rows = _mm_unpacklo_epi32( a, b );
+	_mm_storel_epi64( ( __m128i * )dst, rows );
+	_mm_storel_epi64( ( __m128i * )( dst + stride ), rows );
+	rows = _mm_unpackhi_epi64( rows, rows );
+	_mm_storel_epi64( ( __m128i * )( dst + stride * 2 ), rows );
+	_mm_storel_epi64( ( __m128i * )( dst + stride * 3 ), rows );
+#elif defined( QF_NEON )
+	uint32_t l, r;
+	uint8x8_t a, b;
+	uint32x2x2_t rows;
+
+	memcpy( &l, left->y, 4 );
+	memcpy( &r, right->y, 4 );
+
+	a = vreinterpret_u8_u32( vdup_n_u32( l ) );
+	a = vzip_u8( a, a ).val[0];
+	b = vreinterpret_u8_u32( vdup_n_u32( r ) );
+	b = vzip_u8( b, b ).val[0];
+
+	rows = vzip_u32( vreinterpret_u32_u8( a ), vreinterpret_u32_u8( b ) );
+	vst1_u8( dst, vreinterpret_u8_u32( rows.val[0] ) );
+	vst1_u8( dst + stride, vreinterpret_u8_u32( rows.val[0] ) );
+	vst1_u8( dst + stride * 2, vreinterpret_u8_u32( rows.val[1] ) );
+	vst1_u8( dst + stride * 3, vreinterpret_u8_u32( rows.val[1] ) );
+#else
+	int i;
+	uint8_t p[8];
+
+	for( i = 0; i < 4; i += 2 ) {
+		p[0] = p[1] = left->y[i];
+		p[2] = p[3] = left->y[i + 1];
+		p[4] = p[5] = right->y[i];
+		p[6] = p[7] = right->y[i + 1];
+		memcpy( dst, p, 8 );
+		memcpy( dst + stride, p, 8 );
+		dst += stride * 2;
+	}
+#endif
+}
+
 /*
 * RoQ_ApplyVector2x2
 */
@@ -199,62 +273,57 @@ static void RoQ_ApplyVector2x2( cinematics_t *cin, int xpos, int ypos, const roq
 	plane = &roq->cyuv[0].yuv[2];
 	dst_v = plane->data + ypos_2 * plane->stride + xpos_2;
 
-	dst_y0[0] = cell->y[0];
-	dst_y0[1] = cell->y[1];
-	dst_y1[0] = cell->y[2];
-	dst_y1[1] = cell->y[3];
+	memcpy( dst_y0, cell->y, 2 );
+	memcpy( dst_y1, cell->y + 2, 2 );
 	*dst_u = cell->u;
 	*dst_v = cell->v;
 }
 
 /*
-* RoQ_ApplyVector4x4
+* RoQ_ApplyVector8x8
+*
+* Applies four 2x2 codebook cells of the quad cell, scaled up to 4x4 each.
 */
-static void RoQ_ApplyVector4x4( cinematics_t *cin, int xpos, int ypos, const roq_cell_t *cell ) {
-	uint8_t *dst_y0, *dst_y1;
-	uint8_t *dst_u0, *dst_v0;
-	uint8_t p[4], u[2], v[2];
+static void RoQ_ApplyVector8x8( cinematics_t *cin, int xpos, int ypos, const roq_qcell_t *qcell ) {
+	int i;
+	uint8_t *dst;
+	uint8_t u[4], v[4];
 	roq_info_t *roq = cin->fdata;
+	const roq_cell_t *cells[4];
 	cin_img_plane_t *y_plane, *u_plane, *v_plane;
+	uint8_t *dst_u, *dst_v;
 	int xpos_2 = xpos / 2, ypos_2 = ypos / 2;
 
+	for( i = 0; i < 4; i++ ) {
+		cells[i] = roq->cells + qcell->idx[i];
+	}
+
 	// Y
 	y_plane = &roq->cyuv[0].yuv[0];
-	dst_y0 = y_plane->data + ypos * y_plane->stride + xpos;
-	dst_y1 = dst_y0 + y_plane->stride;
-
-	p[0] = p[1] = cell->y[0];
-	p[2] = p[3] = cell->y[1];
-	*(int *)dst_y0 = *(int *)p;
-	*(int *)dst_y1 = *(int *)p;
+	dst = y_plane->data + ypos * y_plane->stride + xpos;
+	RoQ_ExpandCellPair( dst, y_plane->stride, cells[0], cells[1] );
+	RoQ_ExpandCellPair( dst + y_plane->stride * 4, y_plane->stride, cells[2], cells[3] );
 
-	dst_y0 += y_plane->stride * 2;
-	dst_y1 += y_plane->stride * 2;
-
-	p[0] = p[1] = cell->y[2];
-	p[2] = p[3] = cell->y[3];
-	*(int *)dst_y0 = *(int *)p;
-	*(int *)dst_y1 = *(int *)p;
-
-	// U
+	// UV
 	u_plane = &roq->cyuv[0].yuv[1];
-	dst_u0 = u_plane->data + ypos_2 * u_plane->stride + xpos_2;
-
-	// V
 	v_plane = &roq->cyuv[0].yuv[2];
-	dst_v0 = v_plane->data + ypos_2 * v_plane->stride + xpos_2;
-
-	u[0] = u[1] = cell->u;
-	v[0] = v[1] = cell->v;
-
-	*(short *)dst_u0 = *(short *)u;
-	*(short *)dst_v0 = *(short *)v;
-
-	dst_u0 += u_plane->stride;
-	dst_v0 += v_plane->stride;
-
-	*(short *)dst_u0 = *(short *)u;
-	*(short *)dst_v0 = *(short *)v;
+	dst_u = u_plane->data + ypos_2 * u_plane->stride + xpos_2;
+	dst_v = v_plane->data + ypos_2 * v_plane->stride + xpos_2;
+
+	for( i = 0; i < 4; i += 2 ) {
+		u[0] = u[1] = cells[i]->u;
+		u[2] = u[3] = cells[i + 1]->u;
+		v[0] = v[1] = cells[i]->v;
+		v[2] = v[3] = cells[i + 1]->v;
+
+		memcpy( dst_u, u, 4 );
+		memcpy( dst_u + u_plane->stride, u, 4 );
+		memcpy( dst_v, v, 4 );
+		memcpy( dst_v + v_plane->stride, v, 4 );
+
+		dst_u += u_plane->stride * 2;
+		dst_v += v_plane->stride * 2;
+	}
 }
 
 /*
@@ -264,7 +333,8 @@ static void RoQ_ApplyMotion4x4( cinematics_t *cin, int xpos, int ypos, uint8_t m
 	int i, j;
 	int xpos_2, ypos_2;
 	int xpos1, ypos1, xpos1_2, ypos1_2;
-	uint8_t *src, *dst;
+	const uint8_t *src;
+	uint8_t *dst;
 	roq_info_t *roq = cin->fdata;
 	cin_img_plane_t *plane, *plane1;
 
@@ -283,7 +353,7 @@ static void RoQ_ApplyMotion4x4( cinematics_t *cin, int xpos, int ypos, uint8_t m
 	dst = plane->data  + ( ypos *  plane->stride  + xpos );
 	src = plane1->data + ( ypos1 * plane1->stride + xpos1 );
 	for( j = 0; j < 4; j++ ) {
-		*(int *)dst = *(int *)src;
+		memcpy( dst, src, 4 );
 		src += plane1->stride;
 		dst += plane->stride;
 	}
@@ -294,11 +364,8 @@ static void RoQ_ApplyMotion4x4( cinematics_t *cin, int xpos, int ypos, uint8_t m
 		plane1 = &roq->cyuv[1].yuv[i];
 		dst = plane->data  + ( ypos_2 *  plane->stride  + xpos_2 );
 		src = plane1->data + ( ypos1_2 * plane1->stride + xpos1_2 );
-		for( j = 0; j < 2; j++ ) {
-			*(short *)dst = *(short *)src;
-			src += plane1->stride;
-			dst += plane->stride;
-		}
+		memcpy( dst, src, 2 );
+		memcpy( dst + plane->stride, src + plane1->stride, 2 );
 	}
 }
 
@@ -309,7 +376,8 @@ static void RoQ_ApplyMotion8x8( cinematics_t *cin, int xpos, int ypos, uint8_t m
 	int i, j;
 	int xpos_2, ypos_2;
 	int xpos1, ypos1, xpos1_2, ypos1_2;
-	uint8_t *src, *dst;
+	const uint8_t *src;
+	uint8_t *dst;
 	roq_info_t *roq = cin->fdata;
 	cin_img_plane_t *plane, *plane1;
 
@@ -328,7 +396,7 @@ static void RoQ_ApplyMotion8x8( cinematics_t *cin, int xpos, int ypos, uint8_t m
 	dst = plane->data  + ( ypos *  plane->stride  + xpos );
 	src = plane1->data + ( ypos1 * plane1->stride + xpos1 );
 	for( j = 0; j < 8; j++ ) {
-		memcpy( dst, src, 8 );
+		RoQ_CopyRow8( dst, src );
 		src += plane1->stride;
 		dst += plane->stride;
 	}
@@ -340,7 +408,7 @@ static void RoQ_ApplyMotion8x8( cinematics_t *cin, int xpos, int ypos, uint8_t m
 		dst = plane->data  + ( ypos_2 *  plane->stride  + xpos_2 );
 		src = plane1->data + ( ypos1_2 * plane1->stride + xpos1_2 );
 		for( j = 0; j < 4; j++ ) {
-			*(int *)dst = *(int *)src;
+			memcpy( dst, src, 4 );
 			src += plane1->stride;
 			dst += plane->stride;
 		}
@@ -390,11 +458,7 @@ static cin_yuv_t *RoQ_ReadVideo( cinematics_t *cin ) {
 
 					case RoQ_ID_SLD:
 						RoQ_ReadByte( c );
-						qcell = roq->qcells + c;
-						RoQ_ApplyVector4x4( cin, xp, yp, roq->cells + qcell->idx[0] );
-						RoQ_ApplyVector4x4( cin, xp + 4, yp, roq->cells + qcell->idx[1] );
-						RoQ_ApplyVector4x4( cin, xp, yp + 4, roq->cells + qcell->idx[2] );
-						RoQ_ApplyVector4x4( cin, xp + 4, yp + 4, roq->cells + qcell->idx[3] );
+						RoQ_ApplyVector8x8( cin, xp, yp, roq->qcells + c );
 						break;
 
 					case RoQ_ID_CCC:
@@ -532,8 +596,13 @@ cin_yuv_t *RoQ_ReadNextFrameYUV_CIN( cinematics_t *cin, bool *redraw ) {
 		if( chunk->id == RoQ_INFO ) {
 			RoQ_ReadInfo( cin );
 		} else if( ( chunk->id == RoQ_SOUND_MONO || chunk->id == RoQ_SOUND_STEREO ) ) {
-			assert( cin->num_listeners != 0 );
-			RoQ_ReadAudio( cin );
+			if( cin->flags & CIN_NOAUDIO ) {
+				RoQ_SkipChunk( cin );
+			} else {
+				// samples of background decoded frames are kept until the frame is presented
+				assert( cin->async || cin->num_listeners != 0 );
+				RoQ_ReadAudio( cin );
+			}
 		} else if( chunk->id == RoQ_QUAD_VQ ) {
 			*redraw = true;
 			cyuv = RoQ_ReadVideo( cin );
@@ -129,6 +129,17 @@ void CIN_LoadLibrary( bool verbose ) {
 	import.Sys_LoadLibrary = Com_LoadSysLibrary;
 	import.Sys_UnloadLibrary = Com_UnloadLibrary;
 
+	import.Thread_Create = QThread_Create;
+	import.Thread_Join = QThread_Join;
+	import.Mutex_Create = QMutex_Create;
+	import.Mutex_Destroy = QMutex_Destroy;
+	import.Mutex_Lock = QMutex_Lock;
+	import.Mutex_Unlock = QMutex_Unlock;
+	import.CondVar_Create = QCondVar_Create;
+	import.CondVar_Destroy = QCondVar_Destroy;
+	import.CondVar_Wait = QCondVar_Wait;
+	import.CondVar_Wake = QCondVar_Wake;
+
 	import.Mem_AllocPool = &CL_CinModule_MemAllocPool;
 	import.Mem_Alloc = &CL_CinModule_MemAlloc;
 	import.Mem_Free = &CL_CinModule_MemFree;
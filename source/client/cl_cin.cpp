@@ -252,7 +252,7 @@ static void SCR_PlayCinematic( const char *arg, int flags ) {
 
 	CL_SoundModule_StopAllSounds( true, true );
 
-	cin = CIN_Open( name, 0, has_ogg ? CIN_NOAUDIO : 0, &yuv, &framerate );
+	cin = CIN_Open( name, 0, CIN_ASYNC | ( has_ogg ? CIN_NOAUDIO : 0 ), &yuv, &framerate );
 	if( !cin ) {
 		Com_Printf( "SCR_PlayCinematic: (FIXME) couldn't find %s\n", name );
 		return;
@@ -38,6 +38,29 @@ void CL_WriteDemoMessage( msg_t *msg ) {
 	SNAP_RecordDemoMessage( cls.demo.file, msg, 8 );
 }
 
+/*
+* CL_WriteDemoKeyframe
+*
+* Called for every parsed frame while recording, before the message that contains the frame is written.
+* The client can't produce nodelta frames on its own, so one is requested from the server when a keyframe is due.
+*/
+void CL_WriteDemoKeyframe( const snapshot_t *snap ) {
+	if( !SNAP_DemoKeyframeDue( &cls.demo.index, snap->serverTime ) ) {
+		return;
+	}
+
+	if( snap->delta ) {
+		if( !cls.demo.keyframe_requested ) {
+			CL_AddReliableCommand( "nodelta" );
+			cls.demo.keyframe_requested = true;
+		}
+		return;
+	}
+
+	SNAP_RecordDemoKeyframe( cls.demo.file, NULL, &cls.demo.index, snap->serverTime, cl.configstrings[0] );
+	cls.demo.keyframe_requested = false;
+}
+
 /*
 * CL_Stop_f
 *
@@ -79,6 +102,8 @@ void CL_Stop_f( void ) {
 	CL_SetDemoMetaKeyValue( "matchname", cl.configstrings[CS_MATCHNAME] );
 	CL_SetDemoMetaKeyValue( "matchscore", cl.configstrings[CS_MATCHSCORE] );
 	CL_SetDemoMetaKeyValue( "matchuuid", cl.configstrings[CS_MATCHUUID] );
+	cls.demo.meta_data_realsize = SNAP_SetDemoMetaIndex( cls.demo.meta_data, sizeof( cls.demo.meta_data ),
+														 cls.demo.meta_data_realsize, &cls.demo.index );
 
 	FS_FCloseFile( cls.demo.file );
 
@@ -201,6 +226,10 @@ void CL_Record_f( void ) {
 static int demofilehandle;
 static int demofilelen, demofilelentotal;
 
+// keyframes index of the demo, demos recorded by older versions do not have it
+static snapDemoKeyframe_t demokeyframes[SNAP_MAX_DEMO_KEYFRAMES];
+static unsigned numdemokeyframes;
+
 /*
 * CL_BeginDemoAviDump
 */
@@ -260,6 +289,7 @@ void CL_DemoCompleted( void ) {
 		demofilehandle = 0;
 	}
 	demofilelen = demofilelentotal = 0;
+	numdemokeyframes = 0;
 
 	cls.demo.playing = false;
 	cls.demo.basetime = cls.demo.duration = cls.demo.time = 0;
@@ -338,6 +368,9 @@ void CL_ReadDemoPackets( void ) {
 * See if it's time to read a new demo packet
 */
 void CL_LatchedDemoJump( void ) {
+	const snapDemoKeyframe_t *keyframe;
+	int64_t lastSnapTime;
+
 	if( cls.demo.paused || !cls.demo.play_jump_latched ) {
 		return;
 	}
@@ -350,7 +383,23 @@ void CL_LatchedDemoJump( void ) {
 
 	CL_AdjustServerTime( 1 );
 
-	if( cl.serverTime < cl.snapShots[cl.receivedSnapNum & UPDATE_MASK].serverTime ) {
+	// the meta data is read from the demo file on the playback start
+	numdemokeyframes = SNAP_ReadDemoMetaIndex( cls.demo.meta_data, cls.demo.meta_data_realsize,
+											   demokeyframes, SNAP_MAX_DEMO_KEYFRAMES );
+	keyframe = SNAP_FindDemoKeyframe( demokeyframes, numdemokeyframes, cl.serverTime );
+	lastSnapTime = cl.snapShots[cl.receivedSnapNum & UPDATE_MASK].serverTime;
+
+	if( keyframe && ( cl.serverTime < lastSnapTime || keyframe->serverTime > lastSnapTime ) ) {
+		// decode from the nearest keyframe instead of replaying all preceding snapshots
+		FS_Seek( demofilehandle, keyframe->offset, FS_SEEK_SET );
+		cl.currentSnapNum = cl.receivedSnapNum = 0;
+		CL_BeginDemoKeyframe();
+
+		// do the same as the precache on a jump to the demo start does
+		CL_GameModule_Reset();
+		CL_SoundModule_StopAllSounds( false, false );
+		cls.demo.play_ignore_next_frametime = true;
+	} else if( cl.serverTime < lastSnapTime ) {
 		demofilelen = demofilelentotal;
 		FS_Seek( demofilehandle, 0, FS_SEEK_SET );
 		cl.currentSnapNum = cl.receivedSnapNum = 0;
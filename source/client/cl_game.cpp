@@ -512,6 +512,13 @@ void CL_GameModule_Init( void ) {
 	import.Mem_Alloc = CL_GameModule_MemAlloc;
 	import.Mem_Free = CL_GameModule_MemFree;
 
+	import.Tasks_NumWorkers = QTasks_NumWorkers;
+	import.TaskGroup_Create = QTaskGroup_Create;
+	import.TaskGroup_Destroy = QTaskGroup_Destroy;
+	import.TaskGroup_Wait = QTaskGroup_Wait;
+	import.Task_Spawn = QTask_Spawn;
+	import.Task_ParallelFor = QTask_ParallelFor;
+
 	import.L10n_LoadLangPOFile = &CL_GameModule_L10n_LoadLangPOFile;
 	import.L10n_TranslateString = &CL_GameModule_L10n_TranslateString;
 	import.L10n_ClearDomain = &CL_GameModule_L10n_ClearDomain;
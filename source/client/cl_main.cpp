@@ -77,6 +77,7 @@ cvar_t *cl_debug_timeDelta;
 cvar_t *cl_downloads;
 cvar_t *cl_downloads_from_web;
 cvar_t *cl_downloads_from_web_timeout;
+cvar_t *cl_downloads_chunks;
 cvar_t *cl_download_allow_modules;
 cvar_t *cl_checkForUpdate;
 
@@ -1973,6 +1974,7 @@ static void CL_InitLocal( void ) {
 	cl_downloads =      Cvar_Get( "cl_downloads", "1", CVAR_ARCHIVE );
 	cl_downloads_from_web = Cvar_Get( "cl_downloads_from_web", "1", CVAR_ARCHIVE | CVAR_READONLY );
 	cl_downloads_from_web_timeout = Cvar_Get( "cl_downloads_from_web_timeout", "600", CVAR_ARCHIVE );
+	cl_downloads_chunks = Cvar_Get( "cl_downloads_chunks", "3", CVAR_ARCHIVE );
 	cl_download_allow_modules = Cvar_Get( "cl_download_allow_modules", "1", CVAR_ARCHIVE );
 	cl_checkForUpdate = Cvar_Get( "cl_checkForUpdate", "1", CVAR_ARCHIVE );
 
@@ -2060,6 +2062,7 @@ static void CL_InitLocal( void ) {
 	Cmd_AddCommand( "demoavi", CL_PlayDemoToAvi_f );
 	Cmd_AddCommand( "next", CL_SetNext_f );
 	Cmd_AddCommand( "pingserver", CL_PingServer_f );
+	Cmd_AddCommand( "serverbrowser_bench", CL_ServerBrowser_Bench_f );
 	Cmd_AddCommand( "demopause", CL_PauseDemo_f );
 	Cmd_AddCommand( "demojump", CL_DemoJump_f );
 	Cmd_AddCommand( "showserverip", CL_ShowServerIP_f );
@@ -2099,6 +2102,7 @@ static void CL_ShutdownLocal( void ) {
 	Cmd_RemoveCommand( "demoavi" );
 	Cmd_RemoveCommand( "next" );
 	Cmd_RemoveCommand( "pingserver" );
+	Cmd_RemoveCommand( "serverbrowser_bench" );
 	Cmd_RemoveCommand( "demopause" );
 	Cmd_RemoveCommand( "demojump" );
 	Cmd_RemoveCommand( "showserverip" );
@@ -2867,7 +2871,7 @@ void CL_AsyncStreamRequest( const char *url, const char **headers, int timeout,
 	}
 
 	AsyncStream_PerformRequestExt( cl_async_stream, safeUrl, "GET", NULL, headers, timeout,
-								   resumeFrom, read_cb, done_cb, (async_stream_header_cb_t)header_cb, NULL );
+								   resumeFrom, read_cb, done_cb, (async_stream_header_cb_t)header_cb, privatep );
 
 	if( urlencodeUnsafe ) {
 		Mem_TempFree( tmpUrl );
@@ -21,6 +21,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "client.h"
 
+// files smaller than this per request are downloaded by a single request
+#define MIN_DOWNLOAD_CHUNK_SIZE     ( 1024 * 1024 )
+
 static void CL_InitServerDownload( const char *filename, size_t size, unsigned checksum, bool allow_localhttpdownload,
 								   const char *url, bool initial );
 void CL_StopServerDownload( void );
@@ -235,6 +238,7 @@ void CL_DownloadDone( void ) {
 	cls.download.timestart = 0;
 	cls.download.offset = cls.download.baseoffset = 0;
 	cls.download.web = false;
+	cls.download.web_nochunks = false;
 	cls.download.filenum = 0;
 	cls.download.cancelled = false;
 
@@ -251,15 +255,207 @@ void CL_DownloadDone( void ) {
 	}
 }
 
+/*
+* CL_WebDownloadChunkName
+*
+* Chunks other than the first one are stored next to the temporary file until they are all downloaded.
+* The number of chunks is a part of the name so a resumed download never mixes up different layouts.
+*/
+static const char *CL_WebDownloadChunkName( int chunk, int numchunks ) {
+	return va( "%s.%i_%i", cls.download.tempname, chunk, numchunks );
+}
+
+/*
+* CL_RemoveWebDownloadChunks
+*
+* Removes chunk files of all layouts except the given one.
+*/
+static void CL_RemoveWebDownloadChunks( int keepnumchunks ) {
+	int i, j;
+
+	for( i = 2; i <= MAX_DOWNLOAD_CHUNKS; i++ ) {
+		if( i == keepnumchunks ) {
+			continue;
+		}
+		for( j = 1; j < i; j++ ) {
+			FS_RemoveBaseFile( CL_WebDownloadChunkName( j, i ) );
+		}
+	}
+}
+
+/*
+* CL_CloseWebDownloadChunks
+*/
+static void CL_CloseWebDownloadChunks( void ) {
+	int i;
+
+	// the first chunk is written to the temporary file itself
+	for( i = 1; i < cls.download.web_numchunks; i++ ) {
+		download_chunk_t *chunk = &cls.download.web_chunks[i];
+		if( chunk->filenum > 0 ) {
+			FS_FCloseFile( chunk->filenum );
+		}
+		chunk->filenum = 0;
+	}
+}
+
+/*
+* CL_InitWebDownloadChunks
+*
+* Splits the web download into byte ranges that are requested concurrently,
+* resuming the ranges from files left by a previous attempt. Leaves web_numchunks
+* at 0 if the file has to be downloaded by a single request.
+*/
+static void CL_InitWebDownloadChunks( void ) {
+	int i, numchunks;
+	size_t chunksize, offset;
+
+	cls.download.web_numchunks = 0;
+	cls.download.web_chunksleft = 0;
+
+	numchunks = cls.download.web_nochunks ? 1 : bound( 1, cl_downloads_chunks->integer, MAX_DOWNLOAD_CHUNKS );
+	numchunks = std::min( numchunks, (int)( cls.download.size / MIN_DOWNLOAD_CHUNK_SIZE ) );
+	chunksize = numchunks > 1 ? cls.download.size / numchunks : 0;
+
+	// a download that has been resumed from a single request can't be split anymore
+	if( numchunks < 2 || cls.download.offset > chunksize ) {
+		CL_RemoveWebDownloadChunks( 0 );
+		return;
+	}
+
+	CL_RemoveWebDownloadChunks( numchunks );
+
+	offset = 0;
+	for( i = 0; i < numchunks; i++ ) {
+		download_chunk_t *chunk = &cls.download.web_chunks[i];
+		size_t length;
+
+		chunk->begin = i * chunksize;
+		chunk->end = ( i == numchunks - 1 ) ? cls.download.size : chunk->begin + chunksize;
+		chunk->done = chunk->failed = false;
+
+		if( !i ) {
+			chunk->filenum = cls.download.filenum;
+			length = cls.download.offset;
+		} else {
+			const char *name = CL_WebDownloadChunkName( i, numchunks );
+
+			length = (size_t)FS_FOpenBaseFile( name, &chunk->filenum, FS_APPEND );
+			if( chunk->filenum && length > chunk->end - chunk->begin ) {
+				FS_FCloseFile( chunk->filenum );
+				length = 0;
+				FS_FOpenBaseFile( name, &chunk->filenum, FS_WRITE );
+			}
+
+			if( !chunk->filenum ) {
+				Com_Printf( "Can't open %s for writing, using a single request\n", name );
+				cls.download.web_numchunks = i;
+				CL_CloseWebDownloadChunks();
+				cls.download.web_numchunks = 0;
+				CL_RemoveWebDownloadChunks( 0 );
+				return;
+			}
+		}
+
+		chunk->offset = chunk->begin + length;
+		offset += length;
+	}
+
+	cls.download.web_numchunks = numchunks;
+	cls.download.offset = offset;
+}
+
+/*
+* CL_MergeWebDownloadChunks
+*
+* Appends downloaded chunks to the temporary file. Returns false if any chunk is incomplete,
+* in which case chunk files are kept so the download can be resumed later.
+*/
+static bool CL_MergeWebDownloadChunks( void ) {
+	int i, numchunks = cls.download.web_numchunks;
+	uint8_t *buffer;
+	const size_t buffer_size = 0x10000;
+	bool success = true;
+
+	CL_CloseWebDownloadChunks();
+	cls.download.web_numchunks = 0;
+
+	for( i = 0; i < numchunks; i++ ) {
+		if( cls.download.web_chunks[i].offset != cls.download.web_chunks[i].end ) {
+			return false;
+		}
+	}
+
+	buffer = (uint8_t *)Mem_TempMalloc( buffer_size );
+
+	for( i = 1; i < numchunks && success; i++ ) {
+		const char *name = CL_WebDownloadChunkName( i, numchunks );
+		int filenum, read;
+
+		if( FS_FOpenBaseFile( name, &filenum, FS_READ ) == -1 || !filenum ) {
+			success = false;
+			break;
+		}
+
+		while( ( read = FS_Read( buffer, buffer_size, filenum ) ) > 0 ) {
+			if( FS_Write( buffer, read, cls.download.filenum ) != read ) {
+				success = false;
+				break;
+			}
+		}
+
+		FS_FCloseFile( filenum );
+	}
+
+	Mem_TempFree( buffer );
+
+	if( success ) {
+		for( i = 1; i < numchunks; i++ ) {
+			FS_RemoveBaseFile( CL_WebDownloadChunkName( i, numchunks ) );
+		}
+	} else {
+		Com_Printf( "Failed to merge chunks of %s\n", cls.download.tempname );
+	}
+
+	return success;
+}
+
 /*
 * CL_WebDownloadDoneCb
 */
 static void CL_WebDownloadDoneCb( int status, const char *contentType, void *privatep ) {
+	download_chunk_t *chunk = (download_chunk_t *)privatep;
+
+	bool chunked = cls.download.web_numchunks != 0;
+
+	if( chunk ) {
+		chunk->done = true;
+		if( status < 0 || chunk->offset != chunk->end ) {
+			chunk->failed = true;
+		}
+
+		// wait for the remaining requests
+		if( --cls.download.web_chunksleft > 0 ) {
+			return;
+		}
+
+		for( int i = 0; i < cls.download.web_numchunks; i++ ) {
+			if( cls.download.web_chunks[i].failed ) {
+				status = -1;
+			}
+		}
+	}
+
+	if( cls.download.web_numchunks && !CL_MergeWebDownloadChunks() ) {
+		status = -1;
+	}
+
 	download_t download = cls.download;
 	bool disconnect = download.disconnect;
 	bool cancelled = download.cancelled;
 	bool success = ( download.offset == download.size ) && ( status > -1 );
 	bool try_non_official = download.web_official && !download.web_official_only;
+	bool try_single = chunked && !download.web_nochunks;
 
 	Com_Printf( "Web download %s: %s (%i)\n", success ? "successful" : "failed", download.tempname, status );
 
@@ -276,8 +472,9 @@ static void CL_WebDownloadDoneCb( int status, const char *contentType, void *pri
 		return;
 	}
 
-	// try a non-official mirror (the builtin HTTP server or a remote mirror)
-	if( !success && !cancelled && try_non_official ) {
+	// try a non-official mirror (the builtin HTTP server or a remote mirror),
+	// or the same mirror by a single request in case it doesn't handle ranges properly
+	if( !success && !cancelled && ( try_non_official || try_single ) ) {
 		int size = download.size;
 		char *filename = ZoneCopyString( download.origname );
 		unsigned checksum = download.checksum;
@@ -285,6 +482,7 @@ static void CL_WebDownloadDoneCb( int status, const char *contentType, void *pri
 		bool allow_localhttp = download.web_local_http;
 
 		cls.download.cancelled = true; // remove the temp file
+		cls.download.web_nochunks = try_single;
 		CL_StopServerDownload();
 		CL_InitServerDownload( filename, size, checksum, allow_localhttp, url, false );
 
@@ -301,11 +499,31 @@ static void CL_WebDownloadDoneCb( int status, const char *contentType, void *pri
 */
 static size_t CL_WebDownloadReadCb( const void *buf, size_t numb, float percentage, int status,
 									const char *contentType, void *privatep ) {
+	download_chunk_t *chunk = (download_chunk_t *)privatep;
 	bool stop = cls.download.disconnect || cls.download.cancelled || status < 0 || status >= 300;
-	size_t write = 0;
+	size_t write = 0, accepted = 0;
+
+	// a server that doesn't support ranges sends the whole file to every chunk request
+	if( chunk && status != HTTP_RESP_PARTIAL_CONTENT ) {
+		stop = true;
+	}
 
 	if( !stop ) {
-		write = FS_Write( buf, numb, cls.download.filenum );
+		if( chunk ) {
+			size_t towrite = std::min( numb, chunk->end - chunk->offset );
+
+			write = FS_Write( buf, towrite, chunk->filenum );
+			chunk->offset += write;
+
+			// anything past the end of the requested range is dropped
+			accepted = ( write == towrite ) ? numb : write;
+		} else {
+			write = accepted = FS_Write( buf, numb, cls.download.filenum );
+		}
+	}
+
+	if( chunk && ( stop || accepted != numb ) ) {
+		chunk->failed = true;
 	}
 
 	// ignore percentage passed by the downloader as it doesn't account for total file size
@@ -319,7 +537,7 @@ static size_t CL_WebDownloadReadCb( const void *buf, size_t numb, float percenta
 	cls.download.timeout = 0;
 
 	// abort if disconnected, canclled or writing failed
-	return stop ? !numb : write;
+	return stop ? !numb : accepted;
 }
 
 /*
@@ -478,6 +696,8 @@ static void CL_InitServerDownload( const char *filename, size_t size, unsigned c
 	cls.download.web_official_only = official_web_only;
 	cls.download.web_url = ZoneCopyString( url );
 	cls.download.web_local_http = allow_localhttpdownload;
+	cls.download.web_numchunks = 0;
+	cls.download.web_chunksleft = 0;
 	cls.download.cancelled = false;
 	cls.download.disconnect = false;
 	cls.download.size = size;
@@ -532,7 +752,17 @@ static void CL_InitServerDownload( const char *filename, size_t size, unsigned c
 
 	if( cls.download.web ) {
 		char *referer, *fullurl;
-		const char *headers[] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+		char range[64];
+		int i, numheaders;
+		const char *headers[] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+		// official mirrors are requested by a single request since they might not support ranges
+		// and a failed download falls back to other mirrors anyway
+		if( !official_web_download ) {
+			CL_InitWebDownloadChunks();
+		} else {
+			cls.download.web_numchunks = 0;
+		}
 
 		if( cls.download.offset == cls.download.size ) {
 			// special case for completed downloads to avoid passing empty HTTP range
@@ -564,10 +794,37 @@ static void CL_InitServerDownload( const char *filename, size_t size, unsigned c
 		headers[0] = "Referer";
 		headers[1] = referer;
 
-		CL_AddSessionHttpRequestHeaders( fullurl, &headers[2] );
+		numheaders = 2 + CL_AddSessionHttpRequestHeaders( fullurl, &headers[2] );
 
-		CL_AsyncStreamRequest( fullurl, headers, cl_downloads_from_web_timeout->integer / 100, (int)cls.download.offset,
-							   CL_WebDownloadReadCb, CL_WebDownloadDoneCb, NULL, NULL, false );
+		if( !cls.download.web_numchunks ) {
+			CL_AsyncStreamRequest( fullurl, headers, cl_downloads_from_web_timeout->integer / 100, (int)cls.download.offset,
+								   CL_WebDownloadReadCb, CL_WebDownloadDoneCb, NULL, NULL, false );
+			return;
+		}
+
+		// count the requests before issuing any of them
+		cls.download.web_chunksleft = 0;
+		for( i = 0; i < cls.download.web_numchunks; i++ ) {
+			if( cls.download.web_chunks[i].offset < cls.download.web_chunks[i].end ) {
+				cls.download.web_chunksleft++;
+			}
+		}
+
+		for( i = 0; i < cls.download.web_numchunks; i++ ) {
+			download_chunk_t *chunk = &cls.download.web_chunks[i];
+
+			if( chunk->offset >= chunk->end ) {
+				chunk->done = true;
+				continue;
+			}
+
+			Q_snprintfz( range, sizeof( range ), "bytes=%" PRIu64 "-%" PRIu64, (uint64_t)chunk->offset, (uint64_t)chunk->end - 1 );
+			headers[numheaders] = "Range";
+			headers[numheaders + 1] = range;
+
+			CL_AsyncStreamRequest( fullurl, headers, cl_downloads_from_web_timeout->integer / 100, 0,
+								   CL_WebDownloadReadCb, CL_WebDownloadDoneCb, NULL, chunk, false );
+		}
 
 		return;
 	}
@@ -607,6 +864,10 @@ static void CL_InitDownload_f( void ) {
 * CL_StopServerDownload
 */
 void CL_StopServerDownload( void ) {
+	CL_CloseWebDownloadChunks();
+	cls.download.web_numchunks = 0;
+	cls.download.web_chunksleft = 0;
+
 	if( cls.download.filenum > 0 ) {
 		FS_FCloseFile( cls.download.filenum );
 		cls.download.filenum = 0;
@@ -614,6 +875,7 @@ void CL_StopServerDownload( void ) {
 
 	if( cls.download.cancelled ) {
 		FS_RemoveBaseFile( cls.download.tempname );
+		CL_RemoveWebDownloadChunks( 0 );
 	}
 
 	Mem_ZoneFree( cls.download.name );
@@ -978,6 +1240,8 @@ static void CL_ParseFrame( msg_t *msg ) {
 
 				// clear demo meta data, we'll write some keys later
 				cls.demo.meta_data_realsize = SNAP_ClearDemoMeta( cls.demo.meta_data, sizeof( cls.demo.meta_data ) );
+				SNAP_ClearDemoIndex( &cls.demo.index );
+				cls.demo.keyframe_requested = false;
 
 				// write out messages to hold the startup information
 				SNAP_BeginDemoRecording( cls.demo.file, 0x10000 + cl.servercount, cl.snapFrameTime,
@@ -989,6 +1253,7 @@ static void CL_ParseFrame( msg_t *msg ) {
 
 			if( !cls.demo.waiting ) {
 				cls.demo.duration = snap->serverTime - cls.demo.basetime;
+				CL_WriteDemoKeyframe( snap );
 			}
 			cls.demo.time = cls.demo.duration;
 		}
@@ -1135,6 +1400,61 @@ static void CL_ParseConfigstringCommand( void ) {
 	}
 }
 
+// configstrings carried by the keyframe the demo playback has jumped to
+static bool cl_keyframeConfigstrings[MAX_CONFIGSTRINGS];
+
+/*
+* CL_BeginDemoKeyframe
+*
+* Called when the demo playback has been moved to the configstrings of a keyframe.
+*/
+void CL_BeginDemoKeyframe( void ) {
+	memset( cl_keyframeConfigstrings, 0, sizeof( cl_keyframeConfigstrings ) );
+	cls.demo.play_keyframe = true;
+}
+
+/*
+* CL_FinishDemoKeyframe
+*
+* Keyframes carry only non-empty configstrings. Slots that have been set
+* after the keyframe must be empty after jumping back to it, as they are on a replay from the start.
+*/
+static void CL_FinishDemoKeyframe( void ) {
+	int i;
+
+	cls.demo.play_keyframe = false;
+
+	for( i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
+		if( !cl_keyframeConfigstrings[i] && cl.configstrings[i][0] ) {
+			CL_UpdateConfigString( i, "" );
+		}
+	}
+}
+
+/*
+* CL_ParseDemoKeyframeConfigstring
+*/
+static void CL_ParseDemoKeyframeConfigstring( msg_t *msg ) {
+	int idx;
+	const char *s;
+
+	idx = MSG_ReadInt16( msg );
+	s = MSG_ReadString( msg );
+
+	if( idx < 0 || idx >= MAX_CONFIGSTRINGS ) {
+		Com_Error( ERR_DROP, "configstring > MAX_CONFIGSTRINGS" );
+	}
+
+	if( cls.demo.play_keyframe ) {
+		cl_keyframeConfigstrings[idx] = true;
+	}
+
+	// most configstrings are the same, don't make cgame reload anything needlessly
+	if( strcmp( cl.configstrings[idx], s ) ) {
+		CL_UpdateConfigString( idx, s );
+	}
+}
+
 typedef struct {
 	const char *name;
 	void ( *func )();
@@ -1284,6 +1604,9 @@ void CL_ParseServerMessage( msg_t *msg ) {
 				break;
 
 			case svc_frame:
+				if( cls.demo.play_keyframe ) {
+					CL_FinishDemoKeyframe();
+				}
 				CL_ParseFrame( msg );
 				break;
 
@@ -1319,6 +1642,14 @@ void CL_ParseServerMessage( msg_t *msg ) {
 				len = MSG_ReadInt16( msg ); // command length
 
 				switch( ext ) {
+					case SNAP_DEMO_EXT_CONFIGSTRING:
+						// configstrings of a demo keyframe are only needed when jumping to it
+						if( cls.demo.playing && cls.demo.play_jump ) {
+							CL_ParseDemoKeyframeConfigstring( msg );
+						} else {
+							MSG_SkipData( msg, len );
+						}
+						break;
 					default:
 						// unsupported
 						MSG_SkipData( msg, len );
@@ -741,6 +741,7 @@ void SCR_UpdateScreen( void ) {
 			SCR_DrawNotify();
 		}
 
+		FTLIB_EndFrame();
 		re.EndFrame();
 	}
 }
@@ -0,0 +1,1170 @@
+// cl_serverbrowser.cpp -- queries master and game servers on a dedicated thread
+//
+// The main thread hands master queries, LAN broadcasts and pings over to the browser thread,
+// which owns its own sockets. Pings are queued and sent in rate limited bursts, every wakeup
+// drains all datagrams that are pending on the sockets. Parsed replies are timed right
+// where they are received and passed back through a lock-free pipe that is read once
+// per client frame, so the UI is updated incrementally without waiting for the frame
+// to pick the packets up.
+//
+// serverbrowser_bench starts a stand-in master and a set of fake game servers
+// on the loopback interface and measures how fast the whole list is fetched.
+
+#include "client.h"
+
+#define SB_COMMANDS_QUEUE_SIZE      0x10000
+#define SB_RESULTS_QUEUE_SIZE       0x40000
+#define SB_IDLE_MSEC                20      // commands are picked up at least this often
+#define SB_MAX_BURST_MSEC           20      // never send more than this many milliseconds worth of pings at once
+#define SB_MAX_BURST_PINGS          64      // replies are read between bursts so they don't overflow the socket buffer
+#define SB_MAX_REQUEST_CHARS        256
+#define SB_MAX_SERVERS_PER_RESULT   256
+
+#define SB_BENCH_DEFAULT_SERVERS    256
+#define SB_BENCH_MAX_SERVERS        1024
+#define SB_BENCH_DEFAULT_PORT       44400
+#define SB_BENCH_TIMEOUT_MSEC       10000
+#define SB_BENCH_SERVERS_PER_PACKET 128
+
+enum {
+	SB_CMD_SEND,
+	SB_CMD_BROADCAST,
+	SB_CMD_PING,
+	SB_CMD_SETRATE,
+	SB_CMD_BENCH,
+	SB_CMD_QUIT,
+
+	NUM_SB_CMDS
+};
+
+enum {
+	SB_RESULT_SERVERS,
+	SB_RESULT_INFO,
+	SB_RESULT_BENCH,
+
+	NUM_SB_RESULTS
+};
+
+typedef struct {
+	int id;
+	netadr_t address;
+	unsigned length;
+	char request[SB_MAX_REQUEST_CHARS];
+} sbRequestCmd_t;
+
+typedef struct {
+	int id;
+	int rate;
+} sbRateCmd_t;
+
+typedef struct {
+	int id;
+	netadr_t master;
+	int numServers;
+} sbBenchCmd_t;
+
+typedef struct {
+	int id;
+} sbQuitCmd_t;
+
+typedef struct {
+	int id;
+	int numServers;
+	netadr_t servers[SB_MAX_SERVERS_PER_RESULT];
+} sbServersResult_t;
+
+typedef struct {
+	int id;
+	netadr_t address;
+	int ping;               // -1 if the reply hasn't been timed
+	unsigned length;
+	char info[1];
+} sbInfoResult_t;
+
+typedef struct {
+	int id;
+	int numServers;
+	int numListed;
+	int numReplies;
+	uint64_t listMicros;    // until the master has listed all servers
+	uint64_t totalMicros;
+	uint64_t pingSum;
+	uint64_t pingMax;
+} sbBenchResult_t;
+
+typedef struct {
+	netadr_t address;
+	uint64_t pingTime;      // microseconds, 0 if not awaiting a reply
+	bool queued;
+} sbServer_t;
+
+typedef struct {
+	bool active;
+	netadr_t master;
+	unsigned short firstPort, lastPort;
+	int numServers;
+	int numListed;
+	int numReplies;
+	uint64_t startTime;
+	uint64_t listTime;
+	uint64_t endTime;       // 0 until the result is final
+	uint64_t pingSum;
+	uint64_t pingMax;
+} sbBench_t;
+
+typedef struct {
+	qthread_t *thread;
+	volatile bool quit;
+	int numServers;
+	socket_t master;
+	socket_t *servers;
+	uint8_t packetData[MAX_MSGLEN];
+} sbFakeServers_t;
+
+typedef struct {
+	// owned by the main thread
+	qthread_t *thread;
+	qbufPipe_t *cmdQueue;
+	qbufPipe_t *resultQueue;
+	sbFakeServers_t *fake;
+
+	// opened before the thread is started and closed after it has quit
+	socket_t socket_udp;
+	socket_t socket_udp6;
+
+	// owned by the browser thread
+	bool quit;
+	int rate;                           // pings per second
+	double sendBudget;
+	uint64_t budgetTime;
+	uint64_t lanQueryTime;
+	char pingRequest[SB_MAX_REQUEST_CHARS];
+
+	sbServer_t *servers;
+	int numServers, maxServers;
+	int *hash;                          // indices of servers plus one, open addressing
+	int hashSize;
+
+	int *pingQueue;
+	int pingQueueHead, pingQueueTail, pingQueueSize;
+
+	// master lists that didn't fit in the result pipe yet
+	netadr_t *listedServers;
+	int numListedServers, maxListedServers;
+
+	sbBench_t bench;
+
+	uint8_t packetData[MAX_MSGLEN];
+	netadr_t packetServers[MAX_MSGLEN / 7 + 1];
+	uint8_t resultData[( sizeof( sbInfoResult_t ) + MAX_MSGLEN + 7 ) & ~7];
+} serverbrowser_t;
+
+static serverbrowser_t *sb;
+
+static cvar_t *cl_serverbrowser_pps;
+
+//=========================================================
+
+/*
+* CL_ParseMasterServerList
+*
+* Reads addresses of game servers from a getservers(Ext)Response packet,
+* the data must start right after the name of the response.
+*/
+int CL_ParseMasterServerList( const uint8_t *data, size_t size, bool extended, netadr_t *servers, int maxServers ) {
+	size_t pos = 0;
+	int numServers = 0;
+
+	while( pos + 7 <= size && numServers < maxServers ) {
+		netadr_t *adr = &servers[numServers];
+		const uint8_t *port;
+
+		memset( adr, 0, sizeof( *adr ) );
+
+		switch( data[pos++] ) {
+			case '\\':
+				adr->type = NA_IP;
+				memcpy( adr->address.ipv4.ip, data + pos, 4 );
+				port = data + pos + 4;
+				pos += 6;
+				break;
+
+			case '/':
+				if( !extended ) {
+					Com_Printf( "Invalid master packet ( IPv6 prefix in a non-extended response )\n" );
+					return numServers;
+				}
+				if( pos + 18 > size ) {
+					return numServers;
+				}
+				adr->type = NA_IP6;
+				memcpy( adr->address.ipv6.ip, data + pos, 16 );
+				port = data + pos + 16;
+				pos += 18;
+				break;
+
+			default:
+				Com_Printf( "Invalid master packet ( missing separator )\n" );
+				return numServers;
+		}
+
+		// ports are big endian
+		if( !port[0] && !port[1] ) { // last server seen
+			break;
+		}
+
+		NET_SetAddressPort( adr, ( port[0] << 8 ) | port[1] );
+		numServers++;
+	}
+
+	return numServers;
+}
+
+//=========================================================
+
+/*
+* CL_SB_HashAddress
+*/
+static unsigned CL_SB_HashAddress( const netadr_t *address ) {
+	const uint8_t *ip;
+	size_t i, size;
+	unsigned short port;
+	unsigned hash = 2166136261u;
+
+	if( address->type == NA_IP6 ) {
+		ip = address->address.ipv6.ip;
+		size = sizeof( address->address.ipv6.ip );
+		port = address->address.ipv6.port;
+	} else {
+		ip = address->address.ipv4.ip;
+		size = sizeof( address->address.ipv4.ip );
+		port = address->address.ipv4.port;
+	}
+
+	for( i = 0; i < size; i++ ) {
+		hash = ( hash ^ ip[i] ) * 16777619u;
+	}
+	hash = ( hash ^ ( port & 0xff ) ) * 16777619u;
+	hash = ( hash ^ ( port >> 8 ) ) * 16777619u;
+	return hash;
+}
+
+/*
+* CL_SB_FindServer
+*/
+static sbServer_t *CL_SB_FindServer( const netadr_t *address ) {
+	int i;
+
+	if( !sb->hashSize ) {
+		return NULL;
+	}
+
+	for( i = CL_SB_HashAddress( address ) & ( sb->hashSize - 1 ); sb->hash[i]; i = ( i + 1 ) & ( sb->hashSize - 1 ) ) {
+		sbServer_t *server = &sb->servers[sb->hash[i] - 1];
+		if( NET_CompareAddress( &server->address, address ) ) {
+			return server;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+* CL_SB_RehashServers
+*/
+static void CL_SB_RehashServers( int hashSize ) {
+	int i, j;
+
+	Q_free( sb->hash );
+	sb->hash = (int *)Q_malloc( hashSize * sizeof( *sb->hash ) );
+	memset( sb->hash, 0, hashSize * sizeof( *sb->hash ) );
+	sb->hashSize = hashSize;
+
+	for( i = 0; i < sb->numServers; i++ ) {
+		for( j = CL_SB_HashAddress( &sb->servers[i].address ) & ( hashSize - 1 ); sb->hash[j]; j = ( j + 1 ) & ( hashSize - 1 ) );
+		sb->hash[j] = i + 1;
+	}
+}
+
+/*
+* CL_SB_AddServer
+*/
+static sbServer_t *CL_SB_AddServer( const netadr_t *address ) {
+	sbServer_t *server = CL_SB_FindServer( address );
+
+	if( server ) {
+		return server;
+	}
+
+	if( sb->numServers == sb->maxServers ) {
+		sb->maxServers = sb->maxServers ? sb->maxServers * 2 : 256;
+		sb->servers = (sbServer_t *)Q_realloc( sb->servers, sb->maxServers * sizeof( *sb->servers ) );
+	}
+
+	server = &sb->servers[sb->numServers++];
+	memset( server, 0, sizeof( *server ) );
+	server->address = *address;
+
+	// keep the table at most half full
+	if( sb->numServers * 2 > sb->hashSize ) {
+		CL_SB_RehashServers( std::max( sb->hashSize * 2, 512 ) );
+	} else {
+		int i;
+		for( i = CL_SB_HashAddress( address ) & ( sb->hashSize - 1 ); sb->hash[i]; i = ( i + 1 ) & ( sb->hashSize - 1 ) );
+		sb->hash[i] = sb->numServers;
+	}
+
+	return server;
+}
+
+//=========================================================
+
+/*
+* CL_SB_SendRequest
+*/
+static void CL_SB_SendRequest( const netadr_t *address, const char *request ) {
+	uint8_t data[4 + SB_MAX_REQUEST_CHARS];
+	const socket_t *socket;
+	size_t length = strlen( request );
+
+	socket = ( address->type == NA_IP6 ? &sb->socket_udp6 : &sb->socket_udp );
+	if( !socket->open ) {
+		return;
+	}
+
+	// connectionless packets start with -1
+	memset( data, 0xff, 4 );
+	memcpy( data + 4, request, length );
+
+	if( !NET_SendPacket( socket, data, 4 + length, address ) ) {
+		Com_DPrintf( "Server browser: error sending a request: %s\n", NET_ErrorString() );
+	}
+}
+
+/*
+* CL_SB_QueuePing
+*/
+static void CL_SB_QueuePing( const netadr_t *address, uint64_t now ) {
+	sbServer_t *server = CL_SB_AddServer( address );
+
+	// never request a second ping while awaiting for a ping reply
+	if( server->queued || ( server->pingTime && server->pingTime + SERVER_PINGING_TIMEOUT * 1000 > now ) ) {
+		return;
+	}
+
+	if( sb->pingQueueTail == sb->pingQueueSize ) {
+		if( sb->pingQueueHead ) {
+			// reuse the space of sent pings
+			memmove( sb->pingQueue, sb->pingQueue + sb->pingQueueHead, ( sb->pingQueueTail - sb->pingQueueHead ) * sizeof( int ) );
+			sb->pingQueueTail -= sb->pingQueueHead;
+			sb->pingQueueHead = 0;
+		} else {
+			sb->pingQueueSize = sb->pingQueueSize ? sb->pingQueueSize * 2 : 256;
+			sb->pingQueue = (int *)Q_realloc( sb->pingQueue, sb->pingQueueSize * sizeof( int ) );
+		}
+	}
+
+	server->queued = true;
+	sb->pingQueue[sb->pingQueueTail++] = server - sb->servers;
+}
+
+/*
+* CL_SB_SendPings
+*
+* Sends as many queued pings as the rate allows.
+*/
+static void CL_SB_SendPings( uint64_t now ) {
+	int numSent = 0;
+
+	const double maxBudget = std::max( 1.0, sb->rate * SB_MAX_BURST_MSEC / 1000.0 );
+
+	sb->sendBudget = std::min( maxBudget, sb->sendBudget + ( now - sb->budgetTime ) * sb->rate / 1000000.0 );
+	sb->budgetTime = now;
+
+	while( sb->pingQueueHead < sb->pingQueueTail && sb->sendBudget >= 1.0 && numSent++ < SB_MAX_BURST_PINGS ) {
+		sbServer_t *server = &sb->servers[sb->pingQueue[sb->pingQueueHead++]];
+
+		server->queued = false;
+		server->pingTime = now;
+		CL_SB_SendRequest( &server->address, sb->pingRequest );
+
+		sb->sendBudget -= 1.0;
+	}
+
+	if( sb->pingQueueHead == sb->pingQueueTail ) {
+		sb->pingQueueHead = sb->pingQueueTail = 0;
+	}
+}
+
+/*
+* CL_SB_SleepMsec
+*/
+static int CL_SB_SleepMsec( void ) {
+	int msec;
+
+	if( sb->pingQueueHead == sb->pingQueueTail ) {
+		return SB_IDLE_MSEC;
+	}
+
+	// the burst has been cut short, only check for replies
+	if( sb->sendBudget >= 1.0 ) {
+		return 0;
+	}
+
+	// wake up when the next ping can be sent
+	msec = (int)ceil( ( 1.0 - sb->sendBudget ) * 1000.0 / sb->rate );
+	return bound( 1, msec, SB_IDLE_MSEC );
+}
+
+//=========================================================
+
+/*
+* CL_SB_IsBenchServer
+*/
+static bool CL_SB_IsBenchServer( const netadr_t *address ) {
+	unsigned short port;
+
+	if( !sb->bench.active || !NET_CompareBaseAddress( address, &sb->bench.master ) ) {
+		return false;
+	}
+
+	port = NET_GetAddressPort( address );
+	return port >= sb->bench.firstPort && port <= sb->bench.lastPort;
+}
+
+/*
+* CL_SB_CheckBench
+*/
+static void CL_SB_CheckBench( uint64_t now ) {
+	sbBench_t *bench = &sb->bench;
+	sbBenchResult_t result;
+
+	if( !bench->active ) {
+		return;
+	}
+	if( !bench->endTime ) {
+		if( bench->numReplies < bench->numServers && bench->startTime + SB_BENCH_TIMEOUT_MSEC * 1000 > now ) {
+			return;
+		}
+		bench->endTime = now;
+	}
+
+	result.id = SB_RESULT_BENCH;
+	result.numServers = bench->numServers;
+	result.numListed = bench->numListed;
+	result.numReplies = bench->numReplies;
+	result.listMicros = bench->listTime ? bench->listTime - bench->startTime : 0;
+	result.totalMicros = bench->endTime - bench->startTime;
+	result.pingSum = bench->pingSum;
+	result.pingMax = bench->pingMax;
+
+	// the client stops the fake servers once it gets the result,
+	// so stay active and retry on the next wakeup if it doesn't fit
+	if( QBufPipe_TryWriteCmd( sb->resultQueue, &result, sizeof( result ) ) ) {
+		bench->active = false;
+	}
+}
+
+/*
+* CL_SB_FlushServers
+*
+* Master lists are never dropped, whatever doesn't fit in the result pipe
+* while the client is stalled is kept and written on the next wakeup.
+*/
+static void CL_SB_FlushServers( void ) {
+	sbServersResult_t result;
+	int i;
+
+	result.id = SB_RESULT_SERVERS;
+	for( i = 0; i < sb->numListedServers; i += result.numServers ) {
+		result.numServers = std::min( sb->numListedServers - i, SB_MAX_SERVERS_PER_RESULT );
+		memcpy( result.servers, sb->listedServers + i, result.numServers * sizeof( netadr_t ) );
+		if( !QBufPipe_TryWriteCmd( sb->resultQueue, &result, offsetof( sbServersResult_t, servers ) + result.numServers * sizeof( netadr_t ) ) ) {
+			break;
+		}
+	}
+
+	sb->numListedServers -= i;
+	memmove( sb->listedServers, sb->listedServers + i, sb->numListedServers * sizeof( netadr_t ) );
+}
+
+/*
+* CL_SB_ParseServers
+*/
+static void CL_SB_ParseServers( const netadr_t *from, const uint8_t *data, size_t size, bool extended, uint64_t now ) {
+	int i, numServers;
+
+	numServers = CL_ParseMasterServerList( data, size, extended, sb->packetServers, sizeof( sb->packetServers ) / sizeof( sb->packetServers[0] ) );
+
+	if( sb->bench.active && NET_CompareAddress( from, &sb->bench.master ) ) {
+		if( sb->bench.endTime ) {
+			return;
+		}
+		for( i = 0; i < numServers; i++ ) {
+			CL_SB_QueuePing( &sb->packetServers[i], now );
+		}
+		sb->bench.numListed += numServers;
+		if( sb->bench.numListed >= sb->bench.numServers && !sb->bench.listTime ) {
+			sb->bench.listTime = now;
+		}
+		return;
+	}
+
+	if( sb->numListedServers + numServers > sb->maxListedServers ) {
+		sb->maxListedServers = std::max( sb->maxListedServers * 2, sb->numListedServers + numServers );
+		sb->listedServers = (netadr_t *)Q_realloc( sb->listedServers, sb->maxListedServers * sizeof( netadr_t ) );
+	}
+	memcpy( sb->listedServers + sb->numListedServers, sb->packetServers, numServers * sizeof( netadr_t ) );
+	sb->numListedServers += numServers;
+
+	CL_SB_FlushServers();
+}
+
+/*
+* CL_SB_ParseInfo
+*/
+static void CL_SB_ParseInfo( const netadr_t *from, const char *info, size_t size, uint64_t now ) {
+	sbInfoResult_t *result = (sbInfoResult_t *)sb->resultData;
+	sbServer_t *server = CL_SB_FindServer( from );
+	const char *end;
+	int64_t ping = -1;
+
+	if( server && server->pingTime ) { // valid ping
+		ping = ( now - server->pingTime ) / 1000;
+		server->pingTime = 0;
+	} else if( NET_IsLANAddress( from ) && sb->lanQueryTime + LAN_SERVER_PINGING_TIMEOUT * 1000 > now ) {
+		// assume LAN response
+		ping = ( now - sb->lanQueryTime ) / 1000;
+	}
+
+	if( CL_SB_IsBenchServer( from ) ) {
+		if( ping >= 0 && !sb->bench.endTime ) {
+			sb->bench.numReplies++;
+			sb->bench.pingSum += ping;
+			sb->bench.pingMax = std::max( sb->bench.pingMax, (uint64_t)ping );
+		}
+		return;
+	}
+
+	end = (const char *)memchr( info, '\0', size );
+	if( end ) {
+		size = end - info;
+	}
+
+	result->id = SB_RESULT_INFO;
+	result->address = *from;
+	result->ping = (int)ping;
+	result->length = size;
+	memcpy( result->info, info, size );
+	result->info[size] = '\0';
+	if( !QBufPipe_TryWriteCmd( sb->resultQueue, result, ( offsetof( sbInfoResult_t, info ) + size + 1 + 7 ) & ~7 ) ) {
+		// the client is stalled, this isn't packet loss so ask again
+		// rather than letting the server time out in the list
+		CL_SB_QueuePing( from, now );
+	}
+}
+
+/*
+* CL_SB_ParsePacket
+*/
+static void CL_SB_ParsePacket( const netadr_t *from, const msg_t *msg, uint64_t now ) {
+	const char *s = (const char *)msg->data + 4;
+	size_t size;
+
+	if( msg->cursize < 4 || *(int *)msg->data != -1 ) {
+		return;
+	}
+
+	size = msg->cursize - 4;
+
+	// the separator of the first server follows the name of the response
+	if( size >= 19 && !memcmp( s, "getserversResponse\\", 19 ) ) {
+		CL_SB_ParseServers( from, (const uint8_t *)s + 18, size - 18, false, now );
+		return;
+	}
+	if( size >= 21 && !memcmp( s, "getserversExtResponse", 21 ) ) {
+		CL_SB_ParseServers( from, (const uint8_t *)s + 21, size - 21, true, now );
+		return;
+	}
+
+	// server responding to a status broadcast
+	if( size >= 5 && !memcmp( s, "info\n", 5 ) ) {
+		CL_SB_ParseInfo( from, s + 5, size - 5, now );
+		return;
+	}
+}
+
+/*
+* CL_SB_ReadPackets
+*
+* Drains everything that is pending on the sockets.
+*/
+static void CL_SB_ReadPackets( void ) {
+	msg_t msg;
+	netadr_t address;
+	socket_t *sockets[] = { &sb->socket_udp, &sb->socket_udp6 };
+	size_t i;
+	int ret;
+
+	for( i = 0; i < sizeof( sockets ) / sizeof( sockets[0] ); i++ ) {
+		socket_t *socket = sockets[i];
+
+		MSG_Init( &msg, sb->packetData, sizeof( sb->packetData ) );
+
+		while( socket->open && ( ret = NET_GetPacket( socket, &address, &msg ) ) != 0 ) {
+			if( ret == -1 ) {
+				Com_DPrintf( "Server browser: error receiving packet: %s\n", NET_ErrorString() );
+				continue;
+			}
+
+			// time every packet separately, the reading might take a while
+			CL_SB_ParsePacket( &address, &msg, Sys_Microseconds() );
+		}
+	}
+}
+
+//=========================================================
+
+/*
+* CL_SB_RequestCmdSize
+*/
+static unsigned CL_SB_RequestCmdSize( unsigned length ) {
+	// keep commands aligned in the pipe
+	return (unsigned)( ( offsetof( sbRequestCmd_t, request ) + length + 1 + 7 ) & ~7 );
+}
+
+/*
+* CL_SB_HandleSendCmd
+*/
+static unsigned CL_SB_HandleSendCmd( const void *pcmd ) {
+	const sbRequestCmd_t *cmd = (const sbRequestCmd_t *)pcmd;
+	CL_SB_SendRequest( &cmd->address, cmd->request );
+	return CL_SB_RequestCmdSize( cmd->length );
+}
+
+/*
+* CL_SB_HandleBroadcastCmd
+*/
+static unsigned CL_SB_HandleBroadcastCmd( const void *pcmd ) {
+	const sbRequestCmd_t *cmd = (const sbRequestCmd_t *)pcmd;
+	int i;
+
+	sb->lanQueryTime = Sys_Microseconds();
+
+	for( i = 0; i < NUM_BROADCAST_PORTS; i++ ) {
+		netadr_t broadcastAddress;
+		NET_BroadcastAddress( &broadcastAddress, PORT_SERVER + i );
+		CL_SB_SendRequest( &broadcastAddress, cmd->request );
+	}
+
+	return CL_SB_RequestCmdSize( cmd->length );
+}
+
+/*
+* CL_SB_HandlePingCmd
+*/
+static unsigned CL_SB_HandlePingCmd( const void *pcmd ) {
+	const sbRequestCmd_t *cmd = (const sbRequestCmd_t *)pcmd;
+
+	// the filters are the same for all servers of a single query
+	Q_strncpyz( sb->pingRequest, cmd->request, sizeof( sb->pingRequest ) );
+	CL_SB_QueuePing( &cmd->address, Sys_Microseconds() );
+
+	return CL_SB_RequestCmdSize( cmd->length );
+}
+
+/*
+* CL_SB_HandleRateCmd
+*/
+static unsigned CL_SB_HandleRateCmd( const void *pcmd ) {
+	const sbRateCmd_t *cmd = (const sbRateCmd_t *)pcmd;
+	sb->rate = cmd->rate;
+	return sizeof( *cmd );
+}
+
+/*
+* CL_SB_HandleBenchCmd
+*/
+static unsigned CL_SB_HandleBenchCmd( const void *pcmd ) {
+	const sbBenchCmd_t *cmd = (const sbBenchCmd_t *)pcmd;
+	sbBench_t *bench = &sb->bench;
+	sbServer_t *server;
+	char request[SB_MAX_REQUEST_CHARS];
+	int i;
+
+	memset( bench, 0, sizeof( *bench ) );
+	bench->active = true;
+	bench->master = cmd->master;
+	bench->firstPort = NET_GetAddressPort( &cmd->master ) + 1;
+	bench->lastPort = NET_GetAddressPort( &cmd->master ) + cmd->numServers;
+	bench->numServers = cmd->numServers;
+
+	// forget about previous runs so all fake servers get pinged again
+	for( i = 0, server = sb->servers; i < sb->numServers; i++, server++ ) {
+		if( CL_SB_IsBenchServer( &server->address ) ) {
+			server->pingTime = 0;
+		}
+	}
+
+	Q_snprintfz( sb->pingRequest, sizeof( sb->pingRequest ), "info %i full empty", APP_PROTOCOL_VERSION );
+
+	Q_snprintfz( request, sizeof( request ), "getservers %s %i full empty", APPLICATION, APP_PROTOCOL_VERSION );
+
+	bench->startTime = Sys_Microseconds();
+	CL_SB_SendRequest( &bench->master, request );
+
+	return sizeof( *cmd );
+}
+
+/*
+* CL_SB_HandleQuitCmd
+*/
+static unsigned CL_SB_HandleQuitCmd( const void *pcmd ) {
+	sb->quit = true;
+	return 0;
+}
+
+/*
+* CL_SB_ThreadProc
+*/
+static void *CL_SB_ThreadProc( void *param ) {
+	unsigned( *cmdHandlers[NUM_SB_CMDS] )( const void * ) =
+	{
+		CL_SB_HandleSendCmd,
+		CL_SB_HandleBroadcastCmd,
+		CL_SB_HandlePingCmd,
+		CL_SB_HandleRateCmd,
+		CL_SB_HandleBenchCmd,
+		CL_SB_HandleQuitCmd,
+	};
+	socket_t *sockets[3];
+	int numSockets = 0;
+
+	sockets[numSockets++] = &sb->socket_udp;
+	if( sb->socket_udp6.open ) {
+		sockets[numSockets++] = &sb->socket_udp6;
+	}
+	sockets[numSockets] = NULL;
+
+	sb->budgetTime = Sys_Microseconds();
+
+	while( !sb->quit ) {
+		if( QBufPipe_ReadCmds( sb->cmdQueue, cmdHandlers ) < 0 ) {
+			break;
+		}
+
+		CL_SB_FlushServers();
+
+		CL_SB_ReadPackets();
+
+		CL_SB_SendPings( Sys_Microseconds() );
+
+		CL_SB_CheckBench( Sys_Microseconds() );
+
+		// replies wake us up right away
+		NET_Sleep( CL_SB_SleepMsec(), sockets );
+	}
+
+	return NULL;
+}
+
+//=========================================================
+
+/*
+* CL_SB_WriteRequestCmd
+*/
+static bool CL_SB_WriteRequestCmd( int id, const netadr_t *address, const char *request ) {
+	sbRequestCmd_t cmd;
+
+	if( !sb ) {
+		return false;
+	}
+
+	cmd.id = id;
+	if( address ) {
+		cmd.address = *address;
+	} else {
+		NET_InitAddress( &cmd.address, NA_NOTRANSMIT );
+	}
+	Q_strncpyz( cmd.request, request, sizeof( cmd.request ) );
+	cmd.length = strlen( cmd.request );
+
+	QBufPipe_WriteCmd( sb->cmdQueue, &cmd, CL_SB_RequestCmdSize( cmd.length ) );
+	return true;
+}
+
+/*
+* CL_ServerBrowser_SendRequest
+*
+* Sends a connectionless request, a master query for instance, from the browser thread.
+* Returns false if the thread isn't running and the caller has to send it on its own.
+*/
+bool CL_ServerBrowser_SendRequest( const netadr_t *address, const char *request ) {
+	if( sb && address->type == NA_IP6 && !sb->socket_udp6.open ) {
+		return false;
+	}
+	return CL_SB_WriteRequestCmd( SB_CMD_SEND, address, request );
+}
+
+/*
+* CL_ServerBrowser_Broadcast
+*/
+bool CL_ServerBrowser_Broadcast( const char *request ) {
+	return CL_SB_WriteRequestCmd( SB_CMD_BROADCAST, NULL, request );
+}
+
+/*
+* CL_ServerBrowser_Ping
+*
+* Queues a ping, the browser thread never pings the same server twice at once.
+*/
+bool CL_ServerBrowser_Ping( const netadr_t *address, const char *request ) {
+	if( sb && address->type == NA_IP6 && !sb->socket_udp6.open ) {
+		return false;
+	}
+	return CL_SB_WriteRequestCmd( SB_CMD_PING, address, request );
+}
+
+//=========================================================
+
+/*
+* CL_SB_FakeServerReply
+*/
+static void CL_SB_FakeServerReply( sbFakeServers_t *fake, const socket_t *socket, const netadr_t *address, const msg_t *msg ) {
+	const char *s = (const char *)msg->data + 4;
+	uint8_t *data = fake->packetData;
+	size_t size = msg->cursize - 4;
+	size_t length;
+	int i;
+
+	if( socket == &fake->master ) {
+		if( size < 10 || memcmp( s, "getservers", 10 ) ) {
+			return;
+		}
+
+		for( i = 0; i < fake->numServers; ) {
+			length = 4 + strlen( "getserversResponse" );
+			memset( data, 0xff, 4 );
+			memcpy( data + 4, "getserversResponse", length - 4 );
+
+			for( ; i < fake->numServers && length < 4 + 18 + SB_BENCH_SERVERS_PER_PACKET * 7; i++ ) {
+				const netadr_t *server = &fake->servers[i].address;
+				unsigned short port = NET_GetAddressPort( server );
+
+				data[length++] = '\\';
+				memcpy( data + length, server->address.ipv4.ip, 4 );
+				data[length + 4] = port >> 8;
+				data[length + 5] = port & 0xff;
+				length += 6;
+			}
+
+			if( i == fake->numServers ) {
+				memcpy( data + length, "\\EOT\0\0\0", 7 );
+				length += 7;
+			}
+
+			NET_SendPacket( socket, data, length, address );
+		}
+		return;
+	}
+
+	if( size < 4 || memcmp( s, "info", 4 ) ) {
+		return;
+	}
+
+	memset( data, 0xff, 4 );
+	length = 4 + Q_snprintfz( (char *)data + 4, sizeof( fake->packetData ) - 4,
+							  "info\n\\\\n\\\\fake server %i\\\\m\\\\   bench\\\\u\\\\ 0/16\\\\g\\\\    ffa\\\\s\\\\0\\\\EOT",
+							  (int)( socket - fake->servers ) );
+	NET_SendPacket( socket, data, length, address );
+}
+
+/*
+* CL_SB_FakeReadPackets
+*/
+static int CL_SB_FakeReadPackets( sbFakeServers_t *fake, const socket_t *socket ) {
+	msg_t msg;
+	netadr_t address;
+	uint8_t data[MAX_PACKETLEN];
+	int ret, numPackets = 0;
+
+	MSG_Init( &msg, data, sizeof( data ) );
+
+	while( ( ret = NET_GetPacket( socket, &address, &msg ) ) != 0 ) {
+		if( ret == 1 && msg.cursize >= 4 && *(int *)msg.data == -1 ) {
+			CL_SB_FakeServerReply( fake, socket, &address, &msg );
+		}
+		numPackets++;
+	}
+
+	return numPackets;
+}
+
+/*
+* CL_SB_FakeServersThreadProc
+*
+* Polls all sockets as there may be more of them than select can handle.
+*/
+static void *CL_SB_FakeServersThreadProc( void *param ) {
+	sbFakeServers_t *fake = (sbFakeServers_t *)param;
+	int i, numPackets;
+
+	while( !fake->quit ) {
+		numPackets = CL_SB_FakeReadPackets( fake, &fake->master );
+		for( i = 0; i < fake->numServers; i++ ) {
+			numPackets += CL_SB_FakeReadPackets( fake, &fake->servers[i] );
+		}
+
+		if( !numPackets ) {
+			Sys_Sleep( 1 );
+		}
+	}
+
+	return NULL;
+}
+
+/*
+* CL_SB_StopFakeServers
+*/
+static void CL_SB_StopFakeServers( void ) {
+	sbFakeServers_t *fake = sb->fake;
+	int i;
+
+	if( !fake ) {
+		return;
+	}
+
+	if( fake->thread ) {
+		fake->quit = true;
+		QThread_Join( fake->thread );
+	}
+
+	NET_CloseSocket( &fake->master );
+	for( i = 0; i < fake->numServers; i++ ) {
+		NET_CloseSocket( &fake->servers[i] );
+	}
+
+	Mem_ZoneFree( fake->servers );
+	Mem_ZoneFree( fake );
+	sb->fake = NULL;
+}
+
+/*
+* CL_SB_StartFakeServers
+*/
+static bool CL_SB_StartFakeServers( int numServers, int port ) {
+	sbFakeServers_t *fake;
+	netadr_t address;
+	int i;
+
+	fake = sb->fake = (sbFakeServers_t *)Mem_ZoneMalloc( sizeof( *fake ) );
+	fake->servers = (socket_t *)Mem_ZoneMalloc( numServers * sizeof( socket_t ) );
+
+	NET_StringToAddress( "127.0.0.1", &address );
+	NET_SetAddressPort( &address, port );
+	if( !NET_OpenSocket( &fake->master, SOCKET_UDP, &address, true ) ) {
+		Com_Printf( "Couldn't open the fake master socket: %s\n", NET_ErrorString() );
+		CL_SB_StopFakeServers();
+		return false;
+	}
+
+	for( i = 0; i < numServers; i++ ) {
+		NET_SetAddressPort( &address, port + 1 + i );
+		if( !NET_OpenSocket( &fake->servers[i], SOCKET_UDP, &address, true ) ) {
+			Com_Printf( "Couldn't open a fake server socket: %s\n", NET_ErrorString() );
+			CL_SB_StopFakeServers();
+			return false;
+		}
+		fake->numServers++;
+	}
+
+	fake->thread = QThread_Create( CL_SB_FakeServersThreadProc, fake );
+	if( !fake->thread ) {
+		Com_Printf( "Couldn't start the fake servers\n" );
+		CL_SB_StopFakeServers();
+		return false;
+	}
+
+	return true;
+}
+
+/*
+* CL_ServerBrowser_Bench_f
+*/
+void CL_ServerBrowser_Bench_f( void ) {
+	sbBenchCmd_t cmd;
+	int numServers, port;
+
+	if( !sb ) {
+		Com_Printf( "The server browser thread isn't running\n" );
+		return;
+	}
+	if( sb->fake ) {
+		Com_Printf( "The server browser is already being benchmarked\n" );
+		return;
+	}
+
+	numServers = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : SB_BENCH_DEFAULT_SERVERS;
+	port = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : SB_BENCH_DEFAULT_PORT;
+	if( numServers < 1 || numServers > SB_BENCH_MAX_SERVERS || port < 1 || port + numServers > 65535 ) {
+		Com_Printf( "Usage: %s [servers (1-%i)] [first port]\n", Cmd_Argv( 0 ), SB_BENCH_MAX_SERVERS );
+		return;
+	}
+
+	if( !CL_SB_StartFakeServers( numServers, port ) ) {
+		return;
+	}
+
+	Com_Printf( "Querying %i fake servers at %s at %i pings per second...\n", numServers,
+				NET_AddressToString( &sb->fake->master.address ), cl_serverbrowser_pps->integer );
+
+	cmd.id = SB_CMD_BENCH;
+	cmd.master = sb->fake->master.address;
+	cmd.numServers = numServers;
+	QBufPipe_WriteCmd( sb->cmdQueue, &cmd, sizeof( cmd ) );
+}
+
+//=========================================================
+
+/*
+* CL_SB_HandleServersResult
+*/
+static unsigned CL_SB_HandleServersResult( const void *pcmd ) {
+	const sbServersResult_t *result = (const sbServersResult_t *)pcmd;
+	CL_AddMasterServers( result->servers, result->numServers );
+	return offsetof( sbServersResult_t, servers ) + result->numServers * sizeof( netadr_t );
+}
+
+/*
+* CL_SB_HandleInfoResult
+*/
+static unsigned CL_SB_HandleInfoResult( const void *pcmd ) {
+	const sbInfoResult_t *result = (const sbInfoResult_t *)pcmd;
+	CL_AddServerInfo( &result->address, result->ping, result->info );
+	return ( offsetof( sbInfoResult_t, info ) + result->length + 1 + 7 ) & ~7;
+}
+
+/*
+* CL_SB_HandleBenchResult
+*/
+static unsigned CL_SB_HandleBenchResult( const void *pcmd ) {
+	const sbBenchResult_t *result = (const sbBenchResult_t *)pcmd;
+	const double seconds = result->totalMicros * 1e-6;
+
+	Com_Printf( "Master listed %i of %i servers in %.1f ms\n", result->numListed, result->numServers, result->listMicros * 1e-3 );
+	Com_Printf( "%i replies in %.1f ms (%.1f servers per second), ping %.1f ms average, %" PRIu64 " ms max\n",
+				result->numReplies, result->totalMicros * 1e-3, seconds > 0 ? result->numReplies / seconds : 0.0,
+				result->numReplies ? (double)result->pingSum / result->numReplies : 0.0, result->pingMax );
+
+	CL_SB_StopFakeServers();
+
+	return sizeof( *result );
+}
+
+/*
+* CL_ServerBrowser_Frame
+*
+* Passes everything the browser thread has received so far to the UI.
+*/
+void CL_ServerBrowser_Frame( void ) {
+	unsigned( *resultHandlers[NUM_SB_RESULTS] )( const void * ) =
+	{
+		CL_SB_HandleServersResult,
+		CL_SB_HandleInfoResult,
+		CL_SB_HandleBenchResult,
+	};
+
+	if( !sb ) {
+		return;
+	}
+
+	if( cl_serverbrowser_pps->modified ) {
+		sbRateCmd_t cmd;
+
+		cmd.id = SB_CMD_SETRATE;
+		// replies to unpaced pings would overflow the socket buffer
+		cmd.rate = std::max( cl_serverbrowser_pps->integer, 1 );
+		QBufPipe_WriteCmd( sb->cmdQueue, &cmd, sizeof( cmd ) );
+
+		cl_serverbrowser_pps->modified = false;
+	}
+
+	QBufPipe_ReadCmds( sb->resultQueue, resultHandlers );
+}
+
+/*
+* CL_ServerBrowser_Init
+*/
+void CL_ServerBrowser_Init( void ) {
+	netadr_t address;
+
+	cl_serverbrowser_pps = Cvar_Get( "cl_serverbrowser_pps", "200", CVAR_ARCHIVE );
+	cl_serverbrowser_pps->modified = true;
+
+	if( sb ) {
+		return;
+	}
+
+	sb = (serverbrowser_t *)Mem_ZoneMalloc( sizeof( *sb ) );
+
+	// ephemeral ports, replies never get mixed with the game traffic
+	NET_InitAddress( &address, NA_IP );
+	if( !NET_OpenSocket( &sb->socket_udp, SOCKET_UDP, &address, false ) ) {
+		Com_Printf( "Couldn't open the server browser socket, querying servers from the main thread: %s\n", NET_ErrorString() );
+		Mem_ZoneFree( sb );
+		sb = NULL;
+		return;
+	}
+
+	NET_InitAddress( &address, NA_IP6 );
+	if( !NET_OpenSocket( &sb->socket_udp6, SOCKET_UDP, &address, false ) ) {
+		Com_DPrintf( "Couldn't open the server browser IPv6 socket: %s\n", NET_ErrorString() );
+	}
+
+	sb->cmdQueue = QBufPipe_Create( SB_COMMANDS_QUEUE_SIZE, QBUFPIPE_BLOCKWRITE );
+	QBufPipe_SetName( sb->cmdQueue, "server browser commands" );
+
+	// the thread never blocks on results if the client stalls, master lists are
+	// kept until they fit and servers whose info didn't fit are pinged again
+	sb->resultQueue = QBufPipe_Create( SB_RESULTS_QUEUE_SIZE, 0 );
+	QBufPipe_SetName( sb->resultQueue, "server browser results" );
+
+	sb->thread = QThread_Create( CL_SB_ThreadProc, NULL );
+	if( !sb->thread ) {
+		Com_Printf( "Couldn't start the server browser thread, querying servers from the main thread\n" );
+		CL_ServerBrowser_Shutdown();
+	}
+}
+
+/*
+* CL_ServerBrowser_Shutdown
+*/
+void CL_ServerBrowser_Shutdown( void ) {
+	if( !sb ) {
+		return;
+	}
+
+	if( sb->thread ) {
+		sbQuitCmd_t cmd;
+
+		cmd.id = SB_CMD_QUIT;
+		QBufPipe_WriteCmd( sb->cmdQueue, &cmd, sizeof( cmd ) );
+		QThread_Join( sb->thread );
+	}
+
+	CL_SB_StopFakeServers();
+
+	QBufPipe_Destroy( &sb->cmdQueue );
+	QBufPipe_Destroy( &sb->resultQueue );
+
+	NET_CloseSocket( &sb->socket_udp );
+	NET_CloseSocket( &sb->socket_udp6 );
+
+	Q_free( sb->servers );
+	Q_free( sb->hash );
+	Q_free( sb->pingQueue );
+	Q_free( sb->listedServers );
+
+	Mem_ZoneFree( sb );
+	sb = NULL;
+}
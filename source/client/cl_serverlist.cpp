@@ -342,6 +342,15 @@ void CL_PingServer_f( void ) {
 		return;
 	}
 
+	Q_snprintfz( requestString, sizeof( requestString ), "info %i %s %s", SERVERBROWSER_PROTOCOL_VERSION,
+				 filter_allow_full ? "full" : "",
+				 filter_allow_empty ? "empty" : "" );
+
+	// the browser thread paces the pings and times them itself
+	if( CL_ServerBrowser_Ping( &adr, requestString ) ) {
+		return;
+	}
+
 	// never request a second ping while awaiting for a ping reply
 	if( pingserver->pingTimeStamp + SERVER_PINGING_TIMEOUT > Sys_Milliseconds() ) {
 		return;
@@ -349,10 +358,6 @@ void CL_PingServer_f( void ) {
 
 	pingserver->pingTimeStamp = Sys_Milliseconds();
 
-	Q_snprintfz( requestString, sizeof( requestString ), "info %i %s %s", SERVERBROWSER_PROTOCOL_VERSION,
-				 filter_allow_full ? "full" : "",
-				 filter_allow_empty ? "empty" : "" );
-
 	socket = ( adr.type == NA_IP6 ? &cls.socket_udp6 : &cls.socket_udp );
 	Netchan_OutOfBandPrint( socket, &adr, "%s", requestString );
 }
@@ -396,86 +401,52 @@ void CL_ParseStatusMessage( const socket_t *socket, const netadr_t *address, msg
 }
 
 /*
-* CL_ParseGetServersResponseMessage
-* Handle a reply from getservers message to master server
+* CL_AddServerInfo
+* Handle a reply from a ping that has been timed by the server browser thread
 */
-static void CL_ParseGetServersResponseMessage( msg_t *msg, bool extended ) {
-	const char *header;
+void CL_AddServerInfo( const netadr_t *address, int ping, const char *info ) {
+	serverlist_t *pingserver;
 	char adrString[64];
-	uint8_t addr[16];
-	unsigned short port;
-	netadr_t adr;
 
-	MSG_BeginReading( msg );
-	MSG_ReadInt32( msg ); // skip the -1
+	Com_DPrintf( "%s\n", info );
 
-	//jump over the command name
-	header = ( extended ? "getserversExtResponse" : "getserversResponse" );
-	if( !MSG_SkipData( msg, strlen( header ) ) ) {
-		Com_Printf( "Invalid master packet ( missing %s )\n", header );
+	Q_strncpyz( adrString, NET_AddressToString( address ), sizeof( adrString ) );
+
+	if( ping < 0 ) {
+		// add the server info, but ignore the ping, cause it's not valid
+		CL_UIModule_AddToServerList( adrString, info );
 		return;
 	}
 
-	while( msg->readcount + 7 <= msg->cursize ) {
-		char prefix = MSG_ReadInt8( msg );
-
-		switch( prefix ) {
-			case '\\':
-				MSG_ReadData( msg, addr, 4 );
-				port = ShortSwap( MSG_ReadInt16( msg ) ); // both endians need this swapped.
-				Q_snprintfz( adrString, sizeof( adrString ), "%u.%u.%u.%u:%u", addr[0], addr[1], addr[2], addr[3], port );
-				break;
-
-			case '/':
-				if( extended ) {
-					MSG_ReadData( msg, addr, 16 );
-					port = ShortSwap( MSG_ReadInt16( msg ) ); // both endians need this swapped.
-					Q_snprintfz( adrString, sizeof( adrString ), "[%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x]:%hu",
-								 addr[ 0], addr[ 1], addr[ 2], addr[ 3], addr[ 4], addr[ 5], addr[ 6], addr[ 7],
-								 addr[ 8], addr[ 9], addr[10], addr[11], addr[12], addr[13], addr[14], addr[15],
-								 port );
-				} else {
-					Com_Printf( "Invalid master packet ( IPv6 prefix in a non-extended response )\n" );
-					return;
-				}
-
-				break;
-
-			default:
-				Com_Printf( "Invalid master packet ( missing separator )\n" );
-				return;
-		}
-
-		if( port == 0 ) { // last server seen
-			return;
-		}
-
-		Com_DPrintf( "%s\n", adrString );
-		if( !NET_StringToAddress( adrString, &adr ) ) {
-			Com_Printf( "Bad address: %s\n", adrString );
-			continue;
-		}
-
-		CL_AddServerToList( &masterList, adrString, 0 );
+	pingserver = CL_ServerFindInList( masterList, adrString );
+	if( !pingserver ) {
+		pingserver = CL_ServerFindInList( favoritesList, adrString );
 	}
+	if( pingserver ) {
+		pingserver->lastValidPing = Com_DaysSince1900();
+	}
+
+	CL_UIModule_AddToServerList( adrString, va( "\\\\ping\\\\%i%s", ping, info ) );
 }
 
 /*
-* CL_ParseGetServersResponse
-* Handle a reply from getservers message to master server
+* CL_AddMasterServers
+* Handle game servers listed by a master server
 */
-void CL_ParseGetServersResponse( const socket_t *socket, const netadr_t *address, msg_t *msg, bool extended ) {
+void CL_AddMasterServers( const netadr_t *servers, int numServers ) {
 	serverlist_t *server;
+	char adrString[64];
 	netadr_t adr;
-
-//	CL_ReadServerCache();
+	int i;
 
 	// add the new server addresses to the local addresses list
 	masterServerUpdateSeq++;
 
-	CL_ParseGetServersResponseMessage( msg, extended );
-
-//	CL_WriteServerCache();
+	for( i = 0; i < numServers; i++ ) {
+		Q_strncpyz( adrString, NET_AddressToString( &servers[i] ), sizeof( adrString ) );
+		Com_DPrintf( "%s\n", adrString );
+		CL_AddServerToList( &masterList, adrString, 0 );
+	}
 
 	// dump servers we just received an update on from the master server
 	server = masterList;
@@ -490,6 +461,37 @@ void CL_ParseGetServersResponse( const socket_t *socket, const netadr_t *address
 	}
 }
 
+/*
+* CL_ParseGetServersResponse
+* Handle a reply from getservers message to master server
+*/
+void CL_ParseGetServersResponse( const socket_t *socket, const netadr_t *address, msg_t *msg, bool extended ) {
+	const char *header;
+	netadr_t *servers;
+	int numServers, maxServers;
+	size_t size;
+
+	MSG_BeginReading( msg );
+	MSG_ReadInt32( msg ); // skip the -1
+
+	//jump over the command name
+	header = ( extended ? "getserversExtResponse" : "getserversResponse" );
+	if( !MSG_SkipData( msg, strlen( header ) ) ) {
+		Com_Printf( "Invalid master packet ( missing %s )\n", header );
+		return;
+	}
+
+	// every address takes at least 7 bytes
+	size = msg->cursize - msg->readcount;
+	maxServers = size / 7 + 1;
+	servers = (netadr_t *)Mem_TempMalloc( maxServers * sizeof( *servers ) );
+
+	numServers = CL_ParseMasterServerList( msg->data + msg->readcount, size, extended, servers, maxServers );
+	CL_AddMasterServers( servers, numServers );
+
+	Mem_TempFree( servers );
+}
+
 /*
 * CL_MasterResolverThreadFunc
 */
@@ -609,6 +611,10 @@ static void CL_SendMasterServerQuery( netadr_t *adr, const char *modname ) {
 
 	Com_DPrintf( "Querying %s: %s\n", NET_AddressToString( adr ), requeststring );
 
+	if( CL_ServerBrowser_SendRequest( adr, requeststring ) ) {
+		return;
+	}
+
 	Netchan_OutOfBandPrint( socket, adr, "%s", requeststring );
 }
 
@@ -649,6 +655,10 @@ void CL_GetServers_f( void ) {
 							filter_allow_full ? "full" : "",
 							filter_allow_empty ? "empty" : "" );
 
+		if( CL_ServerBrowser_Broadcast( requeststring ) ) {
+			return;
+		}
+
 		for( i = 0; i < NUM_BROADCAST_PORTS; i++ ) {
 			netadr_t broadcastAddress;
 			NET_BroadcastAddress( &broadcastAddress, PORT_SERVER + i );
@@ -723,6 +733,8 @@ void CL_ServerListFrame( void ) {
 		}
 		master->delayedRequestModName[0] = '\0';
 	}
+
+	CL_ServerBrowser_Frame();
 }
 
 /*
@@ -735,6 +747,8 @@ void CL_InitServerList( void ) {
 //	CL_ReadServerCache();
 
 	CL_MasterAddressCache_Init();
+
+	CL_ServerBrowser_Init();
 }
 
 /*
@@ -746,5 +760,7 @@ void CL_ShutDownServerList( void ) {
 	CL_FreeServerlist( &masterList );
 	CL_FreeServerlist( &favoritesList );
 
+	CL_ServerBrowser_Shutdown();
+
 	CL_MasterAddressCache_Shutdown();
 }
@@ -344,6 +344,7 @@ void CL_SoundModule_Init( bool verbose ) {
 	import.Mutex_Unlock = QMutex_Unlock;
 
 	import.BufPipe_Create = QBufPipe_Create;
+	import.BufPipe_SetName = QBufPipe_SetName;
 	import.BufPipe_Destroy = QBufPipe_Destroy;
 	import.BufPipe_Finish = QBufPipe_Finish;
 	import.BufPipe_WriteCmd = QBufPipe_WriteCmd;
@@ -352,6 +353,13 @@ void CL_SoundModule_Init( bool verbose ) {
 
 	import.GetNumberOfProcessors = Sys_GetNumberOfProcessors;
 
+	import.Tasks_NumWorkers = QTasks_NumWorkers;
+	import.TaskGroup_Create = QTaskGroup_Create;
+	import.TaskGroup_Destroy = QTaskGroup_Destroy;
+	import.TaskGroup_Wait = QTaskGroup_Wait;
+	import.Task_Spawn = QTask_Spawn;
+	import.Task_ParallelFor = QTask_ParallelFor;
+
 	if ( !CL_SoundModule_Load( "openal_soft", &import, verbose ) ) {
 		Cvar_ForceSet( "s_module", "0" );
 	}
@@ -327,7 +327,7 @@ static void VID_RefModule_MemEmptyPool( mempool_t *pool, const char *filename, i
 }
 
 static struct cinematics_s *VID_RefModule_CIN_Open( const char *name, int64_t start_time, bool *yuv, float *framerate ) {
-	return CIN_Open( name, start_time, CIN_LOOP, yuv, framerate );
+	return CIN_Open( name, start_time, CIN_LOOP | CIN_ASYNC, yuv, framerate );
 }
 
 /*
@@ -392,6 +392,7 @@ static bool VID_LoadRefresh( const char *name ) {
 	import.FS_WriteDirectory = &FS_WriteDirectory;
 	import.FS_MediaDirectory = &FS_MediaDirectory;
 	import.FS_AddFileToMedia = &FS_AddFileToMedia;
+	import.FS_LoadFilesBatch = &FS_LoadFilesBatch;
 
 	import.CIN_Open = &VID_RefModule_CIN_Open;
 	import.CIN_NeedNextFrame = &CIN_NeedNextFrame;
@@ -417,12 +418,22 @@ static bool VID_LoadRefresh( const char *name ) {
 	import.Mutex_Unlock = QMutex_Unlock;
 
 	import.BufPipe_Create = QBufPipe_Create;
+	import.BufPipe_SetName = QBufPipe_SetName;
 	import.BufPipe_Destroy = QBufPipe_Destroy;
 	import.BufPipe_Finish = QBufPipe_Finish;
 	import.BufPipe_WriteCmd = QBufPipe_WriteCmd;
 	import.BufPipe_ReadCmds = QBufPipe_ReadCmds;
 	import.BufPipe_Wait = QBufPipe_Wait;
 
+	import.GetNumberOfProcessors = Sys_GetNumberOfProcessors;
+
+	import.Tasks_NumWorkers = QTasks_NumWorkers;
+	import.TaskGroup_Create = QTaskGroup_Create;
+	import.TaskGroup_Destroy = QTaskGroup_Destroy;
+	import.TaskGroup_Wait = QTaskGroup_Wait;
+	import.Task_Spawn = QTask_Spawn;
+	import.Task_ParallelFor = QTask_ParallelFor;
+
 	file_size = strlen( LIB_DIRECTORY "/" LIB_PREFIX ) + strlen( name ) + 1 + strlen( ARCH ) + strlen( LIB_SUFFIX ) + 1;
 	file = (char *)Mem_TempMalloc( file_size );
 	Q_snprintfz( file, file_size, LIB_DIRECTORY "/" LIB_PREFIX "%s_" ARCH LIB_SUFFIX, name );
@@ -152,6 +152,17 @@ struct download_list_s {
 	download_list_t *next;
 };
 
+#define MAX_DOWNLOAD_CHUNKS     4
+
+// a byte range of a web download that is fetched by its own request
+typedef struct {
+	int filenum;
+	size_t begin, end;              // end is exclusive
+	size_t offset;                  // position in the downloaded file the next received byte belongs to
+	bool done;
+	bool failed;
+} download_chunk_t;
+
 typedef struct {
 	// for request
 	char *requestname;              // file we requested from the server (NULL if none requested)
@@ -183,6 +194,10 @@ typedef struct {
 	bool web_official_only;
 	char *web_url;                  // download URL, passed by the server
 	bool web_local_http;
+	int web_numchunks;              // 0 if the file is downloaded by a single request
+	bool web_nochunks;              // set when a chunked attempt has failed, until the download is done
+	int web_chunksleft;             // requests that are still in progress
+	download_chunk_t web_chunks[MAX_DOWNLOAD_CHUNKS];
 
 	bool disconnect;            // set when user tries to disconnect, to allow cleaning up webdownload
 	bool pending_reconnect;     // set when we ignored a map change command to avoid stopping the download
@@ -208,6 +223,7 @@ typedef struct {
 	bool play_jump_latched;
 	int64_t play_jump_time;
 	bool play_ignore_next_frametime;
+	bool play_keyframe;     // jumped to a keyframe, slots it doesn't carry are cleared on its frame
 
 	bool avi;
 	bool avi_video, avi_audio;
@@ -217,6 +233,9 @@ typedef struct {
 
 	char meta_data[SNAP_MAX_DEMO_META_DATA_SIZE];
 	size_t meta_data_realsize;
+
+	snapDemoIndex_t index;
+	bool keyframe_requested;    // a nodelta frame has been requested for the next keyframe
 } cl_demo_t;
 
 typedef cl_demo_t demorec_t;
@@ -344,6 +363,7 @@ extern cvar_t *cl_debug_timeDelta;
 extern cvar_t *cl_downloads;
 extern cvar_t *cl_downloads_from_web;
 extern cvar_t *cl_downloads_from_web_timeout;
+extern cvar_t *cl_downloads_chunks;
 extern cvar_t *cl_download_allow_modules;
 
 // delta from this if not from a previous frame
@@ -503,6 +523,20 @@ void CL_PingServer_f( void );
 void CL_ServerListFrame( void );
 void CL_InitServerList( void );
 void CL_ShutDownServerList( void );
+void CL_AddMasterServers( const netadr_t *servers, int numServers );
+void CL_AddServerInfo( const netadr_t *address, int ping, const char *info );
+
+//
+// cl_serverbrowser.c
+//
+int CL_ParseMasterServerList( const uint8_t *data, size_t size, bool extended, netadr_t *servers, int maxServers );
+bool CL_ServerBrowser_SendRequest( const netadr_t *address, const char *request );
+bool CL_ServerBrowser_Broadcast( const char *request );
+bool CL_ServerBrowser_Ping( const netadr_t *address, const char *request );
+void CL_ServerBrowser_Bench_f( void );
+void CL_ServerBrowser_Frame( void );
+void CL_ServerBrowser_Init( void );
+void CL_ServerBrowser_Shutdown( void );
 
 //
 // cl_input.c
@@ -532,6 +566,7 @@ void CL_ClearInputState( void );
 // cl_demo.c
 //
 void CL_WriteDemoMessage( msg_t *msg );
+void CL_WriteDemoKeyframe( const snapshot_t *snap );
 void CL_DemoCompleted( void );
 void CL_PlayDemo_f( void );
 void CL_PlayDemoToAvi_f( void );
@@ -541,6 +576,7 @@ void CL_Stop_f( void );
 void CL_Record_f( void );
 void CL_PauseDemo_f( void );
 void CL_DemoJump_f( void );
+void CL_BeginDemoKeyframe( void );
 void CL_BeginDemoAviDump( void );
 size_t CL_ReadDemoMetaData( const char *demopath, char *meta_data, size_t meta_data_size );
 char **CL_DemoComplete( const char *partial );
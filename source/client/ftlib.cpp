@@ -271,6 +271,15 @@ void FTLIB_FreeFonts( bool verbose ) {
 	}
 }
 
+/*
+* FTLIB_EndFrame
+*/
+void FTLIB_EndFrame( void ) {
+	if( ftlib_export ) {
+		ftlib_export->EndFrame();
+	}
+}
+
 // drawing functions
 
 /*
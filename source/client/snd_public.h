@@ -20,7 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // snd_public.h -- sound dll information visible to engine
 
-#define SOUND_API_VERSION   46
+#define SOUND_API_VERSION   48
 
 #define ATTN_NONE 0
 
@@ -116,6 +116,7 @@ typedef struct {
 	void ( *Mutex_Unlock )( struct qmutex_s *mutex );
 
 	struct qbufPipe_s *( *BufPipe_Create )( size_t bufSize, int flags );
+	void ( *BufPipe_SetName )( struct qbufPipe_s *queue, const char *name );
 	void ( *BufPipe_Destroy )( struct qbufPipe_s **pqueue );
 	void ( *BufPipe_Finish )( struct qbufPipe_s *queue );
 	void ( *BufPipe_WriteCmd )( struct qbufPipe_s *queue, const void *cmd, unsigned cmd_size );
@@ -124,6 +125,15 @@ typedef struct {
 							unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec );
 
 	bool ( *GetNumberOfProcessors )( unsigned *physical, unsigned *logical );
+
+	// engine-wide worker threads
+	unsigned ( *Tasks_NumWorkers )( void );
+	struct qtaskgroup_s *( *TaskGroup_Create )( void );
+	void ( *TaskGroup_Destroy )( struct qtaskgroup_s **pgroup );
+	void ( *TaskGroup_Wait )( struct qtaskgroup_s *group );
+	void ( *Task_Spawn )( struct qtaskgroup_s *group, qtaskfunc_t func, const void *arg, size_t argSize );
+	void ( *Task_ParallelFor )( struct qtaskgroup_s *group, qtaskrangefunc_t func, const void *arg, size_t argSize,
+								unsigned items, unsigned grain );
 } sound_import_t;
 
 //
@@ -0,0 +1,267 @@
+// da_json.cpp -- writing of decoded demo data as JSON lines
+
+#include "../qcommon/qcommon.h"
+#include "../qcommon/snap_read.h"
+#include "../gameshared/gs_public.h"
+
+#include "da_public.h"
+
+#define DA_JSON_BUFFER_SIZE     ( 256 * 1024 )
+// a limit of a formatted part of a line that is not a string
+#define DA_JSON_MAX_CHUNK       ( 1024 )
+
+typedef struct {
+	int file;
+	int flags;
+	bool failed;
+	size_t len;
+	char buffer[DA_JSON_BUFFER_SIZE];
+} da_json_t;
+
+/*
+* DA_JsonFlush
+*/
+static void DA_JsonFlush( da_json_t *json ) {
+	if( json->len && !json->failed ) {
+		if( FS_Write( json->buffer, json->len, json->file ) != (int)json->len ) {
+			json->failed = true;
+		}
+	}
+	json->len = 0;
+}
+
+/*
+* DA_JsonReserve
+*/
+static char *DA_JsonReserve( da_json_t *json, size_t size ) {
+	if( json->len + size > sizeof( json->buffer ) ) {
+		DA_JsonFlush( json );
+	}
+	return json->buffer + json->len;
+}
+
+#ifndef _MSC_VER
+static void DA_JsonPrintf( da_json_t *json, const char *format, ... ) __attribute__( ( format( printf, 2, 3 ) ) );
+#endif
+
+/*
+* DA_JsonPrintf
+*/
+static void DA_JsonPrintf( da_json_t *json, const char *format, ... ) {
+	va_list argptr;
+	char *p = DA_JsonReserve( json, DA_JSON_MAX_CHUNK );
+
+	va_start( argptr, format );
+	int len = Q_vsnprintfz( p, DA_JSON_MAX_CHUNK, format, argptr );
+	va_end( argptr );
+
+	if( len > 0 ) {
+		json->len += min( (size_t)len, (size_t)DA_JSON_MAX_CHUNK - 1 );
+	}
+}
+
+/*
+* DA_JsonString
+*
+* Appends a quoted escaped string.
+*/
+static void DA_JsonString( da_json_t *json, const char *s ) {
+	// every character might take 6 bytes in the worst case
+	char *const start = DA_JsonReserve( json, strlen( s ) * 6 + 2 );
+	char *p = start;
+
+	*p++ = '"';
+	for( ; *s; s++ ) {
+		const unsigned char c = (unsigned char)*s;
+		if( c == '"' || c == '\\' ) {
+			*p++ = '\\';
+			*p++ = c;
+		} else if( c == '\n' ) {
+			*p++ = '\\';
+			*p++ = 'n';
+		} else if( c < 0x20 ) {
+			p += sprintf( p, "\\u%04x", c );
+		} else {
+			*p++ = c;
+		}
+	}
+	*p++ = '"';
+
+	json->len += p - start;
+}
+
+/*
+* DA_JsonVec3
+*/
+static void DA_JsonVec3( da_json_t *json, const char *key, const float *v ) {
+	DA_JsonPrintf( json, ",\"%s\":[%g,%g,%g]", key, v[0], v[1], v[2] );
+}
+
+/*
+* DA_JsonEndLine
+*/
+static void DA_JsonEndLine( da_json_t *json ) {
+	*DA_JsonReserve( json, 2 ) = '}';
+	json->buffer[json->len + 1] = '\n';
+	json->len += 2;
+}
+
+static void DA_JsonMetaData( void *user, const char *key, const char *value ) {
+	da_json_t *json = (da_json_t *)user;
+
+	DA_JsonPrintf( json, "{\"type\":\"meta\",\"key\":" );
+	DA_JsonString( json, key );
+	DA_JsonPrintf( json, ",\"value\":" );
+	DA_JsonString( json, value );
+	DA_JsonEndLine( json );
+}
+
+static void DA_JsonServerData( void *user, const da_serverdata_t *serverData ) {
+	da_json_t *json = (da_json_t *)user;
+
+	DA_JsonPrintf( json, "{\"type\":\"serverdata\",\"protocol\":%i,\"spawncount\":%u,\"snapFrameTime\":%u,"
+				   "\"playerNum\":%i,\"bitflags\":%u,\"basegame\":",
+				   serverData->protocol, serverData->spawnCount, serverData->snapFrameTime,
+				   serverData->playerNum, serverData->bitflags );
+	DA_JsonString( json, serverData->baseGame );
+	DA_JsonPrintf( json, ",\"game\":" );
+	DA_JsonString( json, serverData->game );
+	DA_JsonPrintf( json, ",\"level\":" );
+	DA_JsonString( json, serverData->levelName );
+	DA_JsonEndLine( json );
+}
+
+static void DA_JsonConfigString( void *user, int64_t serverTime, int index, const char *string ) {
+	da_json_t *json = (da_json_t *)user;
+
+	DA_JsonPrintf( json, "{\"type\":\"cs\",\"time\":%" PRIi64 ",\"index\":%i,\"value\":", serverTime, index );
+	DA_JsonString( json, string );
+	DA_JsonEndLine( json );
+}
+
+static void DA_JsonServerCommand( void *user, int64_t serverTime, const char *text ) {
+	da_json_t *json = (da_json_t *)user;
+
+	DA_JsonPrintf( json, "{\"type\":\"servercmd\",\"time\":%" PRIi64 ",\"text\":", serverTime );
+	DA_JsonString( json, text );
+	DA_JsonEndLine( json );
+}
+
+static void DA_JsonFrame( void *user, const snapshot_t *frame ) {
+	da_json_t *json = (da_json_t *)user;
+
+	DA_JsonPrintf( json, "{\"type\":\"frame\",\"time\":%" PRIi64 ",\"frame\":%" PRIi64 ",\"delta\":%s,"
+				   "\"players\":%i,\"entities\":%i,\"matchState\":%" PRIi64,
+				   frame->serverTime, frame->serverFrame, frame->delta ? "true" : "false",
+				   frame->numplayers, frame->numEntities, frame->gameState.stats[GAMESTAT_MATCHSTATE] );
+	DA_JsonEndLine( json );
+
+	for( int i = 0; i < frame->numplayers; i++ ) {
+		const player_state_t *ps = &frame->playerStates[i];
+		DA_JsonPrintf( json, "{\"type\":\"player\",\"time\":%" PRIi64 ",\"num\":%u,\"pov\":%u,\"pmType\":%i,\"pmFlags\":%i",
+					   frame->serverTime, ps->playerNum, ps->POVnum, ps->pmove.pm_type, ps->pmove.pm_flags );
+		DA_JsonVec3( json, "origin", ps->pmove.origin );
+		DA_JsonVec3( json, "velocity", ps->pmove.velocity );
+		DA_JsonVec3( json, "angles", ps->viewangles );
+		DA_JsonPrintf( json, ",\"health\":%i,\"armor\":%i,\"weapon\":%i,\"score\":%i,\"team\":%i,\"keys\":%u",
+					   ps->stats[STAT_HEALTH], ps->stats[STAT_ARMOR], ps->stats[STAT_WEAPON],
+					   ps->stats[STAT_SCORE], ps->stats[STAT_TEAM], ps->plrkeys );
+		DA_JsonEndLine( json );
+	}
+
+	if( !( json->flags & DA_JSON_ENTITIES ) ) {
+		return;
+	}
+
+	for( int pnum = 0; pnum < frame->numEntities; pnum++ ) {
+		const entity_state_t *state = &frame->parsedEntities[pnum & ( MAX_PARSE_ENTITIES - 1 )];
+		DA_JsonPrintf( json, "{\"type\":\"entity\",\"time\":%" PRIi64 ",\"num\":%i,\"etype\":%i,\"solid\":%i",
+					   frame->serverTime, state->number, state->type, state->solid );
+		DA_JsonVec3( json, "origin", state->origin );
+		DA_JsonVec3( json, "angles", state->angles );
+		DA_JsonPrintf( json, ",\"modelindex\":%u,\"team\":%i,\"weapon\":%i,\"effects\":%u,\"owner\":%i",
+					   state->modelindex, state->team, state->weapon, state->effects, state->ownerNum );
+		DA_JsonEndLine( json );
+	}
+}
+
+static void DA_JsonGameCommand( void *user, const snapshot_t *frame, const gcommand_t *command, const char *text ) {
+	da_json_t *json = (da_json_t *)user;
+
+	DA_JsonPrintf( json, "{\"type\":\"gamecmd\",\"time\":%" PRIi64, frame->serverTime );
+	if( !command->all ) {
+		// client numbers the command has been sent to
+		const char *separator = "";
+		DA_JsonPrintf( json, ",\"targets\":[" );
+		for( int i = 0; i < MAX_CLIENTS; i++ ) {
+			if( command->targets[i >> 3] & ( 1 << ( i & 7 ) ) ) {
+				DA_JsonPrintf( json, "%s%i", separator, i );
+				separator = ",";
+			}
+		}
+		DA_JsonPrintf( json, "]" );
+	}
+	DA_JsonPrintf( json, ",\"text\":" );
+	DA_JsonString( json, text );
+	DA_JsonEndLine( json );
+}
+
+static void DA_JsonEntityEvent( void *user, const snapshot_t *frame, const entity_state_t *state, int event, int parm ) {
+	da_json_t *json = (da_json_t *)user;
+
+	DA_JsonPrintf( json, "{\"type\":\"event\",\"time\":%" PRIi64 ",\"ent\":%i,\"etype\":%i,\"event\":%i,\"parm\":%i",
+				   frame->serverTime, state->number, state->type, event, parm );
+	DA_JsonVec3( json, "origin", state->origin );
+	DA_JsonEndLine( json );
+}
+
+static void DA_JsonPlayerStateEvent( void *user, const snapshot_t *frame, const player_state_t *state, int event, int parm ) {
+	da_json_t *json = (da_json_t *)user;
+
+	DA_JsonPrintf( json, "{\"type\":\"psevent\",\"time\":%" PRIi64 ",\"player\":%u,\"event\":%i,\"parm\":%i",
+				   frame->serverTime, state->playerNum, event, parm );
+	DA_JsonEndLine( json );
+}
+
+/*
+* DA_WriteDemoJson
+*/
+bool DA_WriteDemoJson( const char *filename, const char *outname, int flags,
+					   da_stats_t *stats, char *error, size_t errorSize ) {
+	da_callbacks_t callbacks;
+	int file;
+
+	const int mode = FS_WRITE | ( ( flags & DA_JSON_GZ ) ? FS_GZ : 0 );
+	if( FS_FOpenAbsoluteFile( outname, &file, mode ) == -1 || !file ) {
+		memset( stats, 0, sizeof( *stats ) );
+		Q_snprintfz( error, errorSize, "Can't open %s for writing", outname );
+		return false;
+	}
+
+	da_json_t *json = (da_json_t *)Mem_ZoneMalloc( sizeof( da_json_t ) );
+	json->file = file;
+	json->flags = flags;
+
+	callbacks.MetaData = DA_JsonMetaData;
+	callbacks.ServerData = DA_JsonServerData;
+	callbacks.ConfigString = DA_JsonConfigString;
+	callbacks.KeyframeConfigString = NULL;
+	callbacks.ServerCommand = DA_JsonServerCommand;
+	callbacks.Frame = DA_JsonFrame;
+	callbacks.GameCommand = DA_JsonGameCommand;
+	callbacks.EntityEvent = DA_JsonEntityEvent;
+	callbacks.PlayerStateEvent = DA_JsonPlayerStateEvent;
+
+	bool result = DA_AnalyzeDemo( filename, &callbacks, json, stats, error, errorSize );
+
+	DA_JsonFlush( json );
+	if( json->failed && result ) {
+		Q_snprintfz( error, errorSize, "Can't write to %s", outname );
+		result = false;
+	}
+
+	Mem_ZoneFree( json );
+	FS_FCloseFile( file );
+
+	return result;
+}
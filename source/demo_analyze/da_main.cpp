@@ -0,0 +1,232 @@
+// da_main.cpp -- a headless tool that converts demos to JSON lines streams of decoded frames, players, entities and events.
+// Demos are decoded at the disk speed, different demos are processed in parallel.
+//
+// Usage: demo_analyze [+set <cvar> <value>...] [-o <output dir>] [-threads <count>] [-entities] [-gz] [-checkseek] <demos or dirs...>
+// Directories are scanned for demo files (non-recursively).
+// The output for a demo is written to <output dir>/<demo name>.jsonl (next to the demo by default).
+// -checkseek writes nothing and checks that jumping back to keyframes restores the configstrings of the playback.
+
+#include "../qcommon/qcommon.h"
+#include "../qcommon/snap_read.h"
+#include "../qcommon/compression.h"
+#include "../qcommon/sys_fs.h"
+#include "../qcommon/sys_threads.h"
+#include "../null/tool_null.h"
+
+#include "da_public.h"
+
+#define DA_MAX_THREADS  64
+#define DA_MAX_PATH     1024
+
+typedef struct {
+	char *filename;
+	char *outname;
+	bool succeeded;
+	da_stats_t stats;
+	char error[MAX_PRINTMSG];
+} da_job_t;
+
+static da_job_t *da_jobs;
+static int da_numJobs, da_maxJobs;
+static volatile int da_nextJob;
+static qmutex_t *da_jobsMutex;
+static int da_outputFlags;
+static bool da_checkSeeking;
+
+/*
+* DA_AddJob
+*/
+static void DA_AddJob( const char *filename, const char *outdir ) {
+	char outname[DA_MAX_PATH];
+
+	if( da_numJobs == da_maxJobs ) {
+		da_maxJobs = da_maxJobs ? da_maxJobs * 2 : 64;
+		da_jobs = (da_job_t *)Q_realloc( da_jobs, da_maxJobs * sizeof( da_job_t ) );
+	}
+
+	if( outdir ) {
+		Q_snprintfz( outname, sizeof( outname ), "%s/%s", outdir, COM_FileBase( filename ) );
+	} else {
+		Q_strncpyz( outname, filename, sizeof( outname ) );
+	}
+	COM_StripExtension( outname );
+	Q_strncatz( outname, ( da_outputFlags & DA_JSON_GZ ) ? ".jsonl.gz" : ".jsonl", sizeof( outname ) );
+
+	da_job_t *job = &da_jobs[da_numJobs++];
+	memset( job, 0, sizeof( *job ) );
+	job->filename = ZoneCopyString( filename );
+	job->outname = ZoneCopyString( outname );
+}
+
+/*
+* DA_AddDirectoryJobs
+*/
+static void DA_AddDirectoryJobs( const char *dir, const char *outdir ) {
+	char pattern[DA_MAX_PATH];
+
+	const unsigned canthave = SFF_SUBDIR | SFF_HIDDEN | SFF_SYSTEM;
+
+	Q_snprintfz( pattern, sizeof( pattern ), "%s/*%s", dir, APP_DEMO_EXTENSION_STR );
+	for( const char *s = Sys_FS_FindFirst( pattern, 0, canthave ); s; s = Sys_FS_FindNext( 0, canthave ) ) {
+		DA_AddJob( s, outdir );
+	}
+	Sys_FS_FindClose();
+}
+
+/*
+* DA_WorkerThreadProc
+*/
+static void *DA_WorkerThreadProc( void *param ) {
+	for( ;; ) {
+		const int jobNum = Sys_Atomic_Add( &da_nextJob, 1, da_jobsMutex );
+		if( jobNum >= da_numJobs ) {
+			break;
+		}
+
+		da_job_t *job = &da_jobs[jobNum];
+		const da_stats_t *stats = &job->stats;
+
+		if( da_checkSeeking ) {
+			unsigned numCleared;
+			job->succeeded = DA_CheckDemoSeeking( job->filename, &job->stats, &numCleared, job->error, sizeof( job->error ) );
+			if( job->succeeded ) {
+				Com_Printf( "%s: %u keyframes, %u configstrings cleared on jumps back, seeking matches the playback\n",
+							job->filename, stats->numKeyframes, numCleared );
+			} else {
+				Com_Printf( S_COLOR_RED "%s: %s\n", job->filename, job->error );
+			}
+			continue;
+		}
+
+		job->succeeded = DA_WriteDemoJson( job->filename, job->outname, da_outputFlags,
+										   &job->stats, job->error, sizeof( job->error ) );
+
+		const double megabytesPerSecond = stats->micros ? stats->numBytes / (double)stats->micros : 0.0;
+		if( job->succeeded ) {
+			Com_Printf( "%s: %u frames, %.1f s of game time in %" PRIi64 " ms (%.1f MB/s)\n",
+						job->filename, stats->numFrames, 0.001 * ( stats->lastServerTime - stats->firstServerTime ),
+						stats->micros / 1000, megabytesPerSecond );
+		} else {
+			Com_Printf( S_COLOR_RED "%s: %s (after %u frames)\n", job->filename, job->error, stats->numFrames );
+		}
+	}
+
+	return NULL;
+}
+
+int main( int argc, char **argv ) {
+	const char *outdir = NULL;
+	unsigned numThreads = 0;
+
+	// errors that occur while a demo is decoded interrupt only the analysis of the demo
+	Tool_SetDropHandler( DA_AbortAnalysis );
+
+	QThreads_Init();
+	Memory_Init();
+	COM_InitArgv( argc, argv );
+
+	Cbuf_Init();
+	Cmd_PreInit();
+	Cvar_PreInit();
+	Dynvar_PreInit();
+	Cmd_Init();
+	Cvar_Init();
+	Dynvar_Init();
+
+	Cbuf_AddEarlyCommands( false );
+	Cbuf_Execute();
+
+	dedicated = Cvar_Get( "dedicated", "1", CVAR_NOSET );
+	developer = Cvar_Get( "developer", "0", 0 );
+
+	Com_LoadCompressionLibraries();
+
+	FS_Init();
+
+	da_jobsMutex = QMutex_Create();
+
+	// Options go first so they apply to all inputs
+	for( int i = 1; i < argc; ++i ) {
+		if( !Q_stricmp( argv[i], "+set" ) ) {
+			i += 2;
+		} else if( !Q_stricmp( argv[i], "-o" ) && i + 1 < argc ) {
+			outdir = argv[++i];
+		} else if( !Q_stricmp( argv[i], "-threads" ) && i + 1 < argc ) {
+			numThreads = (unsigned)atoi( argv[++i] );
+		} else if( !Q_stricmp( argv[i], "-entities" ) ) {
+			da_outputFlags |= DA_JSON_ENTITIES;
+		} else if( !Q_stricmp( argv[i], "-gz" ) ) {
+			da_outputFlags |= DA_JSON_GZ;
+		} else if( !Q_stricmp( argv[i], "-checkseek" ) ) {
+			da_checkSeeking = true;
+		}
+	}
+
+	for( int i = 1; i < argc; ++i ) {
+		if( !Q_stricmp( argv[i], "+set" ) ) {
+			i += 2;
+		} else if( ( !Q_stricmp( argv[i], "-o" ) || !Q_stricmp( argv[i], "-threads" ) ) && i + 1 < argc ) {
+			i++;
+		} else if( argv[i][0] != '-' ) {
+			const char *extension = COM_FileExtension( argv[i] );
+			if( extension && !Q_stricmp( extension, APP_DEMO_EXTENSION_STR ) ) {
+				DA_AddJob( argv[i], outdir );
+			} else {
+				DA_AddDirectoryJobs( argv[i], outdir );
+			}
+		}
+	}
+
+	if( !numThreads ) {
+		unsigned physical, logical;
+		if( !Sys_GetNumberOfProcessors( &physical, &logical ) ) {
+			logical = 1;
+		}
+		numThreads = logical;
+	}
+	numThreads = min( numThreads, (unsigned)DA_MAX_THREADS );
+	numThreads = max( 1u, min( numThreads, (unsigned)da_numJobs ) );
+
+	Com_Printf( "Analyzing %d demos using %u threads\n", da_numJobs, numThreads );
+
+	const int64_t startedAt = (int64_t)Sys_Milliseconds();
+
+	qthread_t *threads[DA_MAX_THREADS];
+	for( unsigned i = 1; i < numThreads; ++i ) {
+		threads[i] = QThread_Create( DA_WorkerThreadProc, NULL );
+	}
+	// The main thread is a worker too
+	DA_WorkerThreadProc( NULL );
+	for( unsigned i = 1; i < numThreads; ++i ) {
+		QThread_Join( threads[i] );
+	}
+
+	int numFailures = 0;
+	uint64_t numBytes = 0;
+	unsigned numFrames = 0;
+	for( int i = 0; i < da_numJobs; ++i ) {
+		numFailures += da_jobs[i].succeeded ? 0 : 1;
+		numBytes += da_jobs[i].stats.numBytes;
+		numFrames += da_jobs[i].stats.numFrames;
+		Mem_ZoneFree( da_jobs[i].filename );
+		Mem_ZoneFree( da_jobs[i].outname );
+	}
+	Q_free( da_jobs );
+
+	const int64_t millis = (int64_t)Sys_Milliseconds() - startedAt;
+	Com_Printf( "%d demos (%d failed), %u frames, %.1f MB in %" PRIi64 " ms (%.1f MB/s)\n",
+				da_numJobs, numFailures, numFrames, numBytes * 1e-6, millis, millis ? numBytes / ( millis * 1000.0 ) : 0.0 );
+
+	QMutex_Destroy( &da_jobsMutex );
+
+	FS_Shutdown();
+	Com_UnloadCompressionLibraries();
+	Dynvar_Shutdown();
+	Cvar_Shutdown();
+	Cmd_Shutdown();
+	Cbuf_Shutdown();
+	Memory_Shutdown();
+	QThreads_Shutdown();
+
+	return numFailures ? 1 : 0;
+}
@@ -0,0 +1,436 @@
+// da_parse.cpp -- decoding of demo files without a client state.
+// The message parsing mirrors CL_ParseServerMessage() and events are reported the same way the cgame fires them.
+
+#include "../qcommon/qcommon.h"
+#include "../qcommon/snap_read.h"
+#include "../gameshared/gs_public.h"
+
+#include "da_public.h"
+
+#include <setjmp.h>
+
+// the real number of map areas is unknown without loading the map, the areabits length is sent as a byte
+#define DA_MAX_AREABYTES    256
+
+typedef struct {
+	const da_callbacks_t *callbacks;
+	void *user;
+	da_stats_t *stats;
+
+	bool reliable;
+	int64_t lastServerCommandNum;
+	int64_t receivedSnapNum;
+	int64_t serverTime;                 // of the last valid frame
+	bool inKeyframe;                    // keyframe configstrings have been read, its frame has not
+
+	snapshot_t snapShots[UPDATE_BACKUP];
+	uint8_t areabits[UPDATE_BACKUP][DA_MAX_AREABYTES];
+	entity_state_t baselines[MAX_EDICTS];
+
+	uint8_t msgbuf[MAX_MSGLEN];
+	char metaData[SNAP_MAX_DEMO_META_DATA_SIZE];
+} da_demo_t;
+
+// an ERR_DROP occured while parsing a demo by this thread, exit the entire demo
+static thread_local jmp_buf *da_abortFrame;
+static thread_local char da_abortMessage[MAX_PRINTMSG];
+
+/*
+* DA_AbortAnalysis
+*/
+bool DA_AbortAnalysis( const char *msg ) {
+	if( !da_abortFrame ) {
+		return false;
+	}
+
+	Q_strncpyz( da_abortMessage, msg, sizeof( da_abortMessage ) );
+	longjmp( *da_abortFrame, -1 );
+}
+
+/*
+* DA_ParseConfigStrings
+*
+* Parses "cs <index> "<string>" [<index> "<string>"...]" in place since Cmd_TokenizeString() is not reentrant.
+*/
+static void DA_ParseConfigStrings( da_demo_t *demo, const char *text ) {
+	char string[MAX_CONFIGSTRING_CHARS];
+	const char *s = text + 2;
+	char *end;
+
+	for( ;; ) {
+		while( *s == ' ' ) {
+			s++;
+		}
+
+		const long index = strtol( s, &end, 10 );
+		if( end == s ) {
+			break;
+		}
+
+		s = end;
+		while( *s == ' ' ) {
+			s++;
+		}
+
+		size_t len = 0;
+		const char terminator = ( *s == '"' ) ? '"' : ' ';
+		if( terminator == '"' ) {
+			s++;
+		}
+		for( ; *s && *s != terminator; s++ ) {
+			if( len < sizeof( string ) - 1 ) {
+				string[len++] = *s;
+			}
+		}
+		if( *s == '"' ) {
+			s++;
+		}
+		string[len] = '\0';
+
+		if( index >= 0 && index < MAX_CONFIGSTRINGS && demo->callbacks->ConfigString ) {
+			demo->callbacks->ConfigString( demo->user, demo->serverTime, (int)index, string );
+		}
+	}
+}
+
+/*
+* DA_ParseServerCommand
+*/
+static void DA_ParseServerCommand( da_demo_t *demo, const char *text ) {
+	if( !strncmp( text, "cs ", 3 ) ) {
+		DA_ParseConfigStrings( demo, text );
+	} else if( demo->callbacks->ServerCommand ) {
+		demo->callbacks->ServerCommand( demo->user, demo->serverTime, text );
+	}
+}
+
+/*
+* DA_ParseServerData
+*/
+static void DA_ParseServerData( da_demo_t *demo, msg_t *msg ) {
+	char baseGame[MAX_QPATH], game[MAX_QPATH], levelName[MAX_CONFIGSTRING_CHARS];
+	da_serverdata_t serverData;
+
+	serverData.protocol = MSG_ReadInt32( msg );
+	if( serverData.protocol != APP_PROTOCOL_VERSION && serverData.protocol != APP_DEMO_PROTOCOL_VERSION ) {
+		Com_Error( ERR_DROP, "Demo has protocol version %i, not %i", serverData.protocol, APP_DEMO_PROTOCOL_VERSION );
+	}
+
+	serverData.spawnCount = (unsigned)MSG_ReadInt32( msg );
+	serverData.snapFrameTime = (unsigned)MSG_ReadInt16( msg );
+	Q_strncpyz( baseGame, MSG_ReadString( msg ), sizeof( baseGame ) );
+	Q_strncpyz( game, MSG_ReadString( msg ), sizeof( game ) );
+	serverData.playerNum = MSG_ReadInt16( msg );
+	Q_strncpyz( levelName, MSG_ReadString( msg ), sizeof( levelName ) );
+	serverData.bitflags = (unsigned)MSG_ReadUint8( msg );
+
+	serverData.baseGame = baseGame;
+	serverData.game = game;
+	serverData.levelName = levelName;
+
+	demo->reliable = ( serverData.bitflags & SV_BITFLAGS_RELIABLE ) != 0;
+
+	if( serverData.bitflags & SV_BITFLAGS_HTTP ) {
+		if( serverData.bitflags & SV_BITFLAGS_HTTP_BASEURL ) {
+			MSG_ReadString( msg );
+		} else {
+			MSG_ReadInt16( msg );
+		}
+	}
+
+	// pure list
+	for( int numpure = MSG_ReadInt16( msg ); numpure > 0; numpure-- ) {
+		MSG_ReadString( msg );
+		MSG_ReadInt32( msg );
+	}
+
+	if( demo->callbacks->ServerData ) {
+		demo->callbacks->ServerData( demo->user, &serverData );
+	}
+}
+
+/*
+* DA_ParseDemoInfo
+*/
+static void DA_ParseDemoInfo( da_demo_t *demo, msg_t *msg ) {
+	size_t realsize, maxsize;
+
+	MSG_ReadInt32( msg );
+	MSG_ReadInt32( msg );
+	realsize = (size_t)MSG_ReadInt32( msg );
+	maxsize = (size_t)MSG_ReadInt32( msg );
+
+	// sanity check
+	if( realsize > maxsize ) {
+		realsize = maxsize;
+	}
+	if( realsize > sizeof( demo->metaData ) - 1 ) {
+		realsize = sizeof( demo->metaData ) - 1;
+	}
+
+	MSG_ReadData( msg, demo->metaData, realsize );
+	MSG_SkipData( msg, maxsize - realsize );
+	demo->metaData[realsize] = '\0';
+
+	if( !demo->callbacks->MetaData ) {
+		return;
+	}
+
+	// key1\0value1\0key2\0value2\0...keyN\0valueN\0
+	const char *end = demo->metaData + realsize;
+	for( const char *s = demo->metaData; s < end && *s; ) {
+		const char *key = s;
+		const char *value = key + strlen( key ) + 1;
+		if( value >= end ) {
+			break;
+		}
+		demo->callbacks->MetaData( demo->user, key, value );
+		s = value + strlen( value ) + 1;
+	}
+}
+
+/*
+* DA_FireEvents
+*
+* Does the same as CG_FireEvents() for every player in the frame.
+*/
+static void DA_FireEvents( da_demo_t *demo, const snapshot_t *frame ) {
+	const da_callbacks_t *callbacks = demo->callbacks;
+
+	if( callbacks->EntityEvent ) {
+		for( int pnum = 0; pnum < frame->numEntities; pnum++ ) {
+			const entity_state_t *state = &frame->parsedEntities[pnum & ( MAX_PARSE_ENTITIES - 1 )];
+			if( state->type == ET_SOUNDEVENT ) {
+				continue;
+			}
+			for( int j = 0; j < 2; j++ ) {
+				if( state->events[j] ) {
+					callbacks->EntityEvent( demo->user, frame, state, state->events[j], state->eventParms[j] );
+				}
+			}
+		}
+	}
+
+	if( callbacks->PlayerStateEvent ) {
+		for( int i = 0; i < frame->numplayers; i++ ) {
+			const player_state_t *state = &frame->playerStates[i];
+			for( int count = 0; count < 2; count++ ) {
+				// first byte is event number, second is parm
+				const int event = state->event[count] & 127;
+				if( event ) {
+					callbacks->PlayerStateEvent( demo->user, frame, state, event, state->eventParm[count] & 0xFF );
+				}
+			}
+		}
+	}
+}
+
+/*
+* DA_ParseFrame
+*/
+static void DA_ParseFrame( da_demo_t *demo, msg_t *msg ) {
+	const da_callbacks_t *callbacks = demo->callbacks;
+	snapshot_t *snap, *oldSnap;
+
+	oldSnap = ( demo->receivedSnapNum > 0 ) ? &demo->snapShots[demo->receivedSnapNum & UPDATE_MASK] : NULL;
+
+	demo->inKeyframe = false;
+
+	snap = SNAP_ParseFrame( msg, oldSnap, NULL, demo->snapShots, demo->baselines, 0 );
+	if( !snap->valid ) {
+		demo->stats->numInvalidFrames++;
+		return;
+	}
+
+	demo->receivedSnapNum = snap->serverFrame;
+	demo->serverTime = snap->serverTime;
+
+	if( !demo->stats->numFrames ) {
+		demo->stats->firstServerTime = snap->serverTime;
+	}
+	demo->stats->lastServerTime = snap->serverTime;
+	demo->stats->numFrames++;
+
+	if( callbacks->Frame ) {
+		callbacks->Frame( demo->user, snap );
+	}
+
+	if( callbacks->GameCommand ) {
+		for( int i = 0; i < snap->numgamecommands; i++ ) {
+			const gcommand_t *gcmd = &snap->gamecommands[i];
+			callbacks->GameCommand( demo->user, snap, gcmd, snap->gamecommandsData + gcmd->commandOffset );
+		}
+	}
+
+	DA_FireEvents( demo, snap );
+}
+
+/*
+* DA_ParseKeyframeConfigString
+*
+* Keyframe configstrings are only needed for seeking, the demo is decoded from the beginning.
+*/
+static void DA_ParseKeyframeConfigString( da_demo_t *demo, msg_t *msg ) {
+	const int index = MSG_ReadInt16( msg );
+	const char *string = MSG_ReadString( msg );
+
+	if( index < 0 || index >= MAX_CONFIGSTRINGS ) {
+		Com_Error( ERR_DROP, "DA_ParseMessage: Bad keyframe configstring index %i", index );
+	}
+
+	if( !demo->inKeyframe ) {
+		demo->inKeyframe = true;
+		demo->stats->numKeyframes++;
+	}
+
+	if( demo->callbacks->KeyframeConfigString ) {
+		demo->callbacks->KeyframeConfigString( demo->user, index, string );
+	}
+}
+
+/*
+* DA_ParseMessage
+*/
+static void DA_ParseMessage( da_demo_t *demo, msg_t *msg ) {
+	int cmd, ext, len;
+
+	while( msg->readcount < msg->cursize ) {
+		cmd = MSG_ReadUint8( msg );
+
+		switch( cmd ) {
+			default:
+				Com_Error( ERR_DROP, "DA_ParseMessage: Illegible server message %i", cmd );
+				break;
+
+			case svc_nop:
+				break;
+
+			case svc_servercmd:
+				if( !demo->reliable ) {
+					int cmdNum = MSG_ReadInt32( msg );
+					if( cmdNum < 0 ) {
+						Com_Error( ERR_DROP, "DA_ParseMessage: Invalid cmdNum value: %i", cmdNum );
+					}
+					if( cmdNum <= demo->lastServerCommandNum ) {
+						MSG_ReadString( msg ); // read but ignore
+						break;
+					}
+					demo->lastServerCommandNum = cmdNum;
+				}
+			// fall through
+			case svc_servercs:
+				DA_ParseServerCommand( demo, MSG_ReadString( msg ) );
+				break;
+
+			case svc_serverdata:
+				DA_ParseServerData( demo, msg );
+				break;
+
+			case svc_spawnbaseline:
+				SNAP_ParseBaseline( msg, demo->baselines );
+				break;
+
+			case svc_clcack:
+				MSG_ReadUintBase128( msg );
+				MSG_ReadUintBase128( msg );
+				break;
+
+			case svc_frame:
+				DA_ParseFrame( demo, msg );
+				break;
+
+			case svc_demoinfo:
+				DA_ParseDemoInfo( demo, msg );
+				break;
+
+			case svc_playerinfo:
+			case svc_packetentities:
+			case svc_match:
+				Com_Error( ERR_DROP, "Out of place frame data" );
+				break;
+
+			case svc_extension:
+				ext = MSG_ReadUint8( msg );     // extension id
+				MSG_ReadUint8( msg );           // version number
+				len = MSG_ReadInt16( msg );     // command length
+				if( ext == SNAP_DEMO_EXT_CONFIGSTRING ) {
+					DA_ParseKeyframeConfigString( demo, msg );
+				} else {
+					MSG_SkipData( msg, len );
+				}
+				break;
+		}
+	}
+
+	if( msg->readcount > msg->cursize ) {
+		Com_Error( ERR_DROP, "DA_ParseMessage: Bad server message" );
+	}
+}
+
+/*
+* DA_AnalyzeDemo
+*/
+bool DA_AnalyzeDemo( const char *filename, const da_callbacks_t *callbacks, void *user,
+					 da_stats_t *stats, char *error, size_t errorSize ) {
+	int demofile;
+	jmp_buf abortFrame;
+	msg_t msg;
+
+	memset( stats, 0, sizeof( *stats ) );
+	if( error && errorSize ) {
+		error[0] = '\0';
+	}
+
+	if( FS_FOpenAbsoluteFile( filename, &demofile, FS_READ | SNAP_DEMO_GZ ) == -1 || !demofile ) {
+		if( error ) {
+			Q_strncpyz( error, "Can't open the file", errorSize );
+		}
+		return false;
+	}
+
+	// the snapshots backup is too large for a stack of a worker thread
+	da_demo_t *const demo = (da_demo_t *)Mem_ZoneMalloc( sizeof( da_demo_t ) );
+	demo->callbacks = callbacks;
+	demo->user = user;
+	demo->stats = stats;
+	demo->reliable = false;
+	demo->lastServerCommandNum = -1;
+	demo->receivedSnapNum = 0;
+	demo->serverTime = 0;
+	demo->inKeyframe = false;
+	for( int i = 0; i < UPDATE_BACKUP; i++ ) {
+		demo->snapShots[i].areabytes = DA_MAX_AREABYTES;
+		demo->snapShots[i].areabits = demo->areabits[i];
+	}
+
+	MSG_Init( &msg, demo->msgbuf, sizeof( demo->msgbuf ) );
+
+	const int64_t startedAt = (int64_t)Sys_Microseconds();
+
+	bool result = true;
+	if( setjmp( abortFrame ) ) {
+		if( error ) {
+			Q_strncpyz( error, da_abortMessage, errorSize );
+		}
+		result = false;
+	} else {
+		da_abortFrame = &abortFrame;
+		for( ;; ) {
+			int read = SNAP_ReadDemoMessage( demofile, &msg );
+			if( read == -1 ) {
+				break;
+			}
+			stats->numMessages++;
+			stats->numBytes += (uint64_t)read + sizeof( int );
+			DA_ParseMessage( demo, &msg );
+		}
+	}
+
+	da_abortFrame = NULL;
+	stats->micros = (int64_t)Sys_Microseconds() - startedAt;
+
+	Mem_ZoneFree( demo );
+	FS_FCloseFile( demofile );
+
+	return result;
+}
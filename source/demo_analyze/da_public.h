@@ -0,0 +1,87 @@
+#ifndef QFUSION_DA_PUBLIC_H
+#define QFUSION_DA_PUBLIC_H
+
+// da_public.h -- a headless demo analysis library.
+// Demos are decoded at the disk speed by the same snapshot parsing code the client uses,
+// decoded data is reported via callbacks. Different demos might be analyzed by different threads at the same time.
+
+typedef struct {
+	int protocol;
+	unsigned spawnCount;
+	unsigned snapFrameTime;
+	int playerNum;                      // -1 for demos that have been recorded by a server
+	unsigned bitflags;                  // SV_BITFLAGS_*
+	const char *baseGame;
+	const char *game;
+	const char *levelName;
+} da_serverdata_t;
+
+// Any callback might be null. Frame callbacks are called only for valid frames
+// in the following order: Frame, GameCommand, EntityEvent, PlayerStateEvent.
+// KeyframeConfigString reports the configstrings a keyframe carries for seeking,
+// they precede the keyframe and are not a part of the regular playback.
+typedef struct {
+	void ( *MetaData )( void *user, const char *key, const char *value );
+	void ( *ServerData )( void *user, const da_serverdata_t *serverData );
+	void ( *ConfigString )( void *user, int64_t serverTime, int index, const char *string );
+	void ( *KeyframeConfigString )( void *user, int index, const char *string );
+	void ( *ServerCommand )( void *user, int64_t serverTime, const char *text );
+	void ( *Frame )( void *user, const snapshot_t *frame );
+	void ( *GameCommand )( void *user, const snapshot_t *frame, const gcommand_t *command, const char *text );
+	void ( *EntityEvent )( void *user, const snapshot_t *frame, const entity_state_t *state, int event, int parm );
+	void ( *PlayerStateEvent )( void *user, const snapshot_t *frame, const player_state_t *state, int event, int parm );
+} da_callbacks_t;
+
+typedef struct {
+	int64_t firstServerTime;
+	int64_t lastServerTime;
+	unsigned numMessages;
+	unsigned numFrames;
+	unsigned numInvalidFrames;
+	unsigned numKeyframes;
+	uint64_t numBytes;                  // uncompressed
+	int64_t micros;
+} da_stats_t;
+
+/*
+* DA_AnalyzeDemo
+*
+* Decodes the demo file (an absolute or a relative to the current directory path) from the beginning to the end.
+* Returns false and fills the error buffer if the file can't be opened or is malformed.
+* Data that has been reported before an error is still valid.
+*/
+bool DA_AnalyzeDemo( const char *filename, const da_callbacks_t *callbacks, void *user,
+					 da_stats_t *stats, char *error, size_t errorSize );
+
+#define DA_JSON_ENTITIES    ( 1 << 0 )    // write states of all entities of every frame
+#define DA_JSON_GZ          ( 1 << 1 )    // compress the output
+
+/*
+* DA_WriteDemoJson
+*
+* Analyzes the demo and writes decoded data as JSON lines (one JSON object per line) to the output file.
+* Every object has the "type" field: "meta", "serverdata", "cs", "servercmd", "frame", "player",
+* "entity", "gamecmd", "event" or "psevent". Objects that belong to a frame have the "time" field.
+*/
+bool DA_WriteDemoJson( const char *filename, const char *outname, int flags,
+					   da_stats_t *stats, char *error, size_t errorSize );
+
+/*
+* DA_CheckDemoSeeking
+*
+* Decodes the demo twice and checks that jumping back to every keyframe from the end of the demo
+* yields the same configstrings a playback from the beginning has at the keyframe.
+* Slots that are set after a keyframe have to be cleared on the jump, their number is stored to numCleared.
+* Returns false and fills the error buffer on the first mismatch.
+*/
+bool DA_CheckDemoSeeking( const char *filename, da_stats_t *stats, unsigned *numCleared, char *error, size_t errorSize );
+
+/*
+* DA_AbortAnalysis
+*
+* The drop handler of Com_Error(). Interrupts the analysis that is performed by the calling thread if any.
+* Returns false if the calling thread does not analyze a demo.
+*/
+bool DA_AbortAnalysis( const char *msg );
+
+#endif
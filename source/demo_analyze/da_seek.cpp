@@ -0,0 +1,149 @@
+// da_seek.cpp -- a round-trip check of demo keyframes.
+// The client jumps back to a keyframe with the configstrings of a later point of the demo,
+// applies the configstrings the keyframe carries and clears all other ones on the keyframe frame.
+// This must give the same configstrings a playback from the beginning has at the keyframe.
+
+#include "../qcommon/qcommon.h"
+#include "../qcommon/snap_read.h"
+
+#include "da_public.h"
+
+typedef char da_configstrings_t[MAX_CONFIGSTRINGS][MAX_CONFIGSTRING_CHARS];
+
+typedef struct {
+	da_configstrings_t last;            // at the end of the demo, backward jumps start from there
+	da_configstrings_t replayed;        // by a playback from the beginning
+	da_configstrings_t jumped;          // by a jump back to the current keyframe
+	bool carried[MAX_CONFIGSTRINGS];    // by the current keyframe
+	bool inKeyframe;
+
+	unsigned numCleared;
+	bool mismatch;
+	int64_t mismatchTime;
+	int mismatchIndex;
+	char mismatchString[MAX_CONFIGSTRING_CHARS];
+	char mismatchReplayed[MAX_CONFIGSTRING_CHARS];
+} da_seek_t;
+
+/*
+* DA_SeekSetConfigString
+*
+* Like CL_UpdateConfigString() does, ignores invalid configstrings.
+*/
+static void DA_SeekSetConfigString( da_configstrings_t configstrings, int index, const char *string ) {
+	if( COM_ValidateConfigstring( string ) ) {
+		Q_strncpyz( configstrings[index], string, sizeof( configstrings[index] ) );
+	}
+}
+
+/*
+* DA_SeekLastConfigString
+*/
+static void DA_SeekLastConfigString( void *user, int64_t serverTime, int index, const char *string ) {
+	da_seek_t *seek = (da_seek_t *)user;
+
+	DA_SeekSetConfigString( seek->last, index, string );
+}
+
+/*
+* DA_SeekConfigString
+*
+* The client applies configstrings commands that follow the keyframe configstrings too.
+*/
+static void DA_SeekConfigString( void *user, int64_t serverTime, int index, const char *string ) {
+	da_seek_t *seek = (da_seek_t *)user;
+
+	DA_SeekSetConfigString( seek->replayed, index, string );
+	if( seek->inKeyframe ) {
+		DA_SeekSetConfigString( seek->jumped, index, string );
+	}
+}
+
+/*
+* DA_SeekKeyframeConfigString
+*/
+static void DA_SeekKeyframeConfigString( void *user, int index, const char *string ) {
+	da_seek_t *seek = (da_seek_t *)user;
+
+	if( !seek->inKeyframe ) {
+		seek->inKeyframe = true;
+		memcpy( seek->jumped, seek->last, sizeof( seek->jumped ) );
+		memset( seek->carried, 0, sizeof( seek->carried ) );
+	}
+
+	DA_SeekSetConfigString( seek->jumped, index, string );
+	seek->carried[index] = true;
+}
+
+/*
+* DA_SeekFrame
+*
+* Does the same as CL_FinishDemoKeyframe() and compares the result with the playback.
+*/
+static void DA_SeekFrame( void *user, const snapshot_t *frame ) {
+	da_seek_t *seek = (da_seek_t *)user;
+	int i;
+
+	if( !seek->inKeyframe ) {
+		return;
+	}
+
+	seek->inKeyframe = false;
+
+	for( i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
+		if( !seek->carried[i] && seek->jumped[i][0] ) {
+			seek->jumped[i][0] = '\0';
+			seek->numCleared++;
+		}
+	}
+
+	if( seek->mismatch ) {
+		return;
+	}
+
+	for( i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
+		if( strcmp( seek->jumped[i], seek->replayed[i] ) ) {
+			seek->mismatch = true;
+			seek->mismatchTime = frame->serverTime;
+			seek->mismatchIndex = i;
+			Q_strncpyz( seek->mismatchString, seek->jumped[i], sizeof( seek->mismatchString ) );
+			Q_strncpyz( seek->mismatchReplayed, seek->replayed[i], sizeof( seek->mismatchReplayed ) );
+			break;
+		}
+	}
+}
+
+/*
+* DA_CheckDemoSeeking
+*/
+bool DA_CheckDemoSeeking( const char *filename, da_stats_t *stats, unsigned *numCleared, char *error, size_t errorSize ) {
+	da_callbacks_t callbacks;
+
+	*numCleared = 0;
+
+	// three sets of configstrings are too large for a stack of a worker thread
+	da_seek_t *const seek = (da_seek_t *)Mem_ZoneMalloc( sizeof( da_seek_t ) );
+
+	memset( &callbacks, 0, sizeof( callbacks ) );
+	callbacks.ConfigString = DA_SeekLastConfigString;
+
+	bool result = DA_AnalyzeDemo( filename, &callbacks, seek, stats, error, errorSize );
+	if( result ) {
+		callbacks.ConfigString = DA_SeekConfigString;
+		callbacks.KeyframeConfigString = DA_SeekKeyframeConfigString;
+		callbacks.Frame = DA_SeekFrame;
+
+		result = DA_AnalyzeDemo( filename, &callbacks, seek, stats, error, errorSize );
+	}
+
+	if( result && seek->mismatch ) {
+		Q_snprintfz( error, errorSize, "Configstring %i is \"%s\" instead of \"%s\" after jumping back to %" PRIi64,
+					 seek->mismatchIndex, seek->mismatchString, seek->mismatchReplayed, seek->mismatchTime );
+		result = false;
+	}
+
+	*numCleared = seek->numCleared;
+	Mem_ZoneFree( seek );
+
+	return result;
+}
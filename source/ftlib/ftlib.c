@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "ftlib_local.h"
 
 static qfontfamily_t *fontFamilies;
+static int64_t fontFrameNum; // the number of ended frames, for LRU of glyph images
 
 // ============================================================================
 
@@ -42,9 +43,8 @@ static qfontfamily_t *fontFamilies;
 #define QFTGLYPH_SEARCHED_FALLBACK  ( 1 << 1 )  // the fallback font has been searched for the gindex
 #define QFTGLYPH_FROM_FALLBACK      ( 1 << 2 )  // the fallback gindex should be used
 
-static uint8_t *qftGlyphTempBitmap;
-static unsigned int qftGlyphTempBitmapHeight;
-#define QFT_GLYPH_BITMAP_HEIGHT_INCREMENT 64 // must be a power of two
+#define QFT_MAX_FACE_IMAGES         8   // the least recently used images are reused when a face needs more
+#define QFT_IMAGE_FRAMES_IN_FLIGHT  3   // the renderer might still be drawing glyphs of the last frames
 
 FT_Library ftLibrary = NULL;
 
@@ -60,8 +60,16 @@ typedef struct {
 	qftfallback_t *fallbacks;
 } qftfamily_t;
 
+typedef struct {
+	uint8_t *pixels;                    // a copy of the image, glyphs are rendered here and uploaded once per frame
+	unsigned int dirtyMinY, dirtyMaxY;  // rows that haven't been uploaded yet
+	int64_t lastUsedFrame;
+} qftimage_t;
+
 typedef struct {
 	unsigned int imageCurX, imageCurY, imageCurLineHeight;
+	unsigned int curImage;
+	qftimage_t *images;                 // parallel to the shaders of the face
 
 	FT_Size ftsize, ftfallbacksize;
 	qfontfamily_t *fallbackFamily;
@@ -71,6 +79,7 @@ typedef struct {
 typedef struct {
 	qglyph_t qglyph;
 	unsigned int flags;
+	unsigned int image;                 // valid if qglyph.shader is set
 	FT_UInt gindex;
 } qftglyph_t;
 
@@ -233,7 +242,14 @@ static qglyph_t *QFT_GetGlyph( qfontface_t *qfont, void *glyphArray, unsigned in
 		}
 	}
 
-	return qftglyph->gindex ? &( qftglyph->qglyph ) : NULL;
+	if( !qftglyph->gindex ) {
+		return NULL;
+	}
+
+	if( qftglyph->qglyph.shader ) {
+		qttf->images[qftglyph->image].lastUsedFrame = fontFrameNum;
+	}
+	return &( qftglyph->qglyph );
 }
 
 /*
@@ -278,31 +294,120 @@ static int QFT_GetKerning( qfontface_t *qfont, qglyph_t *g1_, qglyph_t *g2_ ) {
 }
 
 /*
-* QFT_UploadRenderedGlyphs
+* QFT_AllocImage
 */
-static void QFT_UploadRenderedGlyphs( uint8_t *pic, struct shader_s *shader, int x, int y, int src_width, int width, int height ) {
-	int i;
-	const uint8_t *src = pic;
-	uint8_t *dest = pic;
+static void QFT_AllocImage( qfontface_t *qfont ) {
+	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
+	unsigned int imageNum = ( qfont->numShaders )++;
+	qftimage_t *image;
 
-	if( !width || !height ) {
-		return;
+	qfont->shaders = FTLIB_Realloc( qfont->shaders, qfont->numShaders * sizeof( struct shader_s * ) );
+	qfont->shaders[imageNum] = trap_R_RegisterRawAlphaMask( FTLIB_FontShaderName( qfont, imageNum ),
+															qfont->shaderWidth, qfont->shaderHeight, NULL );
+
+	qttf->images = FTLIB_Realloc( qttf->images, qfont->numShaders * sizeof( qftimage_t ) );
+	image = &qttf->images[imageNum];
+	memset( image, 0, sizeof( *image ) );
+	image->pixels = FTLIB_Alloc( ftlibPool, qfont->shaderWidth * qfont->shaderHeight );
+	image->lastUsedFrame = fontFrameNum;
+
+	qttf->curImage = imageNum;
+}
+
+/*
+* QFT_ResetImage
+*
+* Makes the glyphs in the image missing so they are rendered again when needed.
+*/
+static void QFT_ResetImage( qfontface_t *qfont, unsigned int imageNum ) {
+	unsigned int i, j;
+	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
+	qftimage_t *image = &qttf->images[imageNum];
+	qftglyph_t *qftglyphs;
+
+	for( i = 0; i < ( sizeof( qfont->glyphs ) / sizeof( qfont->glyphs[0] ) ); i++ ) {
+		qftglyphs = ( qftglyph_t * )qfont->glyphs[i];
+		if( !qftglyphs ) {
+			continue;
+		}
+		for( j = 0; j < 256; j++ ) {
+			if( qftglyphs[j].qglyph.shader && ( qftglyphs[j].image == imageNum ) ) {
+				qftglyphs[j].qglyph.shader = NULL;
+			}
+		}
 	}
 
-	for( i = 0; i < height; i++, src += src_width, dest += width ) {
-		memmove( dest, src, width );
+	memset( image->pixels, 0, qfont->shaderWidth * qfont->shaderHeight );
+	image->dirtyMinY = 0;
+	image->dirtyMaxY = qfont->shaderHeight;
+	image->lastUsedFrame = fontFrameNum;
+
+	qttf->curImage = imageNum;
+}
+
+/*
+* QFT_NextImage
+*
+* Starts rendering to a new image, or to the least recently used one if the face has too many.
+*/
+static void QFT_NextImage( qfontface_t *qfont ) {
+	unsigned int i, lru;
+	int64_t lruFrame;
+	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
+
+	qttf->imageCurX = 0;
+	qttf->imageCurY = 0;
+	qttf->imageCurLineHeight = 0;
+
+	lru = qfont->numShaders;
+	if( qfont->numShaders >= QFT_MAX_FACE_IMAGES ) {
+		lruFrame = fontFrameNum - QFT_IMAGE_FRAMES_IN_FLIGHT;
+		for( i = 0; i < qfont->numShaders; i++ ) {
+			if( qttf->images[i].lastUsedFrame < lruFrame ) {
+				lruFrame = qttf->images[i].lastUsedFrame;
+				lru = i;
+			}
+		}
+	}
+
+	if( lru < qfont->numShaders ) {
+		QFT_ResetImage( qfont, lru );
+	} else {
+		QFT_AllocImage( qfont );
+	}
+}
+
+/*
+* QFT_UploadGlyphs
+*/
+static void QFT_UploadGlyphs( qfontface_t *qfont ) {
+	unsigned int i;
+	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
+	qftimage_t *image;
+
+	for( i = 0; i < qfont->numShaders; i++ ) {
+		image = &qttf->images[i];
+		if( image->dirtyMinY >= image->dirtyMaxY ) {
+			continue;
+		}
+
+		trap_R_ReplaceRawSubPic( qfont->shaders[i], 0, image->dirtyMinY, qfont->shaderWidth,
+								 image->dirtyMaxY - image->dirtyMinY, image->pixels + image->dirtyMinY * qfont->shaderWidth );
+		image->dirtyMinY = image->dirtyMaxY = 0;
 	}
-	trap_R_ReplaceRawSubPic( shader, x, y, width, height, pic );
 }
 
 /*
 * QFT_RenderString
+*
+* Renders missing glyphs to the copy of the image, they are uploaded in QFT_UploadGlyphs.
 */
 static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 	int gc;
 	wchar_t num;
 	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
 	qftglyph_t *qftglyph;
+	qftimage_t *image;
 	qglyph_t *qglyph;
 	FT_Error fterror;
 	FT_Size ftsize;
@@ -310,17 +415,12 @@ static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 	FT_UInt pixelMode;
 	int srcStride = 0;
 	unsigned int bitmapWidth, bitmapHeight;
-	unsigned int tempWidth = 0, tempLineHeight = 0;
-	struct shader_s *shader = qfont->shaders[qfont->numShaders - 1];
-	int shaderNum;
 	int x, y;
 	uint8_t *src, *dest;
 
 	for( ; ; ) {
 		gc = Q_GrabWCharFromColorString( &str, &num, NULL );
 		if( gc == GRABCHAR_END ) {
-			QFT_UploadRenderedGlyphs( qftGlyphTempBitmap, shader, qttf->imageCurX, qttf->imageCurY, qfont->shaderWidth, tempWidth, tempLineHeight );
-			qttf->imageCurX += tempWidth;
 			break;
 		}
 
@@ -334,9 +434,6 @@ static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 		}
 
 		qglyph = &( qftglyph->qglyph );
-		if( qglyph->shader ) {
-			continue;
-		}
 
 		// from now, it is assumed that the current glyph's shader will be valid after this function
 		// so if continue is used, any shader, even an empty one, should be assigned to the glyph
@@ -347,7 +444,8 @@ static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 		if( fterror ) {
 			Com_Printf( S_COLOR_YELLOW "Warning: Failed to load and render glyph %i for '%s', error %i\n",
 						num, qfont->family->name, fterror );
-			qglyph->shader = shader;
+			qglyph->shader = qfont->shaders[qttf->curImage];
+			qftglyph->image = qttf->curImage;
 			continue;
 		}
 		ftglyph = ftsize->face->glyph;
@@ -377,36 +475,28 @@ static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 			bitmapHeight = qfont->shaderHeight;
 		}
 
-		if( ( qttf->imageCurX + tempWidth + bitmapWidth ) > qfont->shaderWidth ) {
-			QFT_UploadRenderedGlyphs( qftGlyphTempBitmap, shader, qttf->imageCurX, qttf->imageCurY, qfont->shaderWidth, tempWidth, tempLineHeight );
-			tempWidth = 0;
-			tempLineHeight = 0;
+		if( ( qttf->imageCurX + bitmapWidth ) > qfont->shaderWidth ) {
 			qttf->imageCurX = 0;
 			qttf->imageCurY += qttf->imageCurLineHeight - 1; // overlap the previous line's margin
 			qttf->imageCurLineHeight = 0;
 		}
 
-		if( bitmapHeight > qftGlyphTempBitmapHeight ) {
-			qftGlyphTempBitmapHeight = ALIGN( bitmapHeight, QFT_GLYPH_BITMAP_HEIGHT_INCREMENT );
-			qftGlyphTempBitmap = FTLIB_Realloc( qftGlyphTempBitmap, FTLIB_FONT_MAX_IMAGE_WIDTH * qftGlyphTempBitmapHeight );
+		if( ( qttf->imageCurY + bitmapHeight ) > qfont->shaderHeight ) {
+			QFT_NextImage( qfont );
 		}
 
-		if( bitmapHeight > tempLineHeight ) {
-			if( bitmapHeight > qttf->imageCurLineHeight ) {
-				if( ( qttf->imageCurY + bitmapHeight ) > qfont->shaderHeight ) {
-					QFT_UploadRenderedGlyphs( qftGlyphTempBitmap, shader, qttf->imageCurX, qttf->imageCurY, qfont->shaderWidth, tempWidth, tempLineHeight );
-					tempWidth = 0;
-					qttf->imageCurX = 0;
-					qttf->imageCurY = 0;
-					shaderNum = ( qfont->numShaders )++;
-					shader = trap_R_RegisterRawAlphaMask( FTLIB_FontShaderName( qfont, shaderNum ),
-														  qfont->shaderWidth, qfont->shaderHeight, NULL );
-					qfont->shaders = FTLIB_Realloc( qfont->shaders, qfont->numShaders * sizeof( struct shader_s * ) );
-					qfont->shaders[shaderNum] = shader;
-				}
-				qttf->imageCurLineHeight = bitmapHeight;
-			}
-			tempLineHeight = bitmapHeight;
+		if( bitmapHeight > qttf->imageCurLineHeight ) {
+			qttf->imageCurLineHeight = bitmapHeight;
+		}
+
+		image = &qttf->images[qttf->curImage];
+		image->lastUsedFrame = fontFrameNum;
+		if( image->dirtyMinY >= image->dirtyMaxY ) {
+			image->dirtyMinY = qttf->imageCurY;
+			image->dirtyMaxY = qttf->imageCurY + bitmapHeight;
+		} else {
+			image->dirtyMinY = min( image->dirtyMinY, qttf->imageCurY );
+			image->dirtyMaxY = max( image->dirtyMaxY, qttf->imageCurY + bitmapHeight );
 		}
 
 		qglyph->width = bitmapWidth - 2;
@@ -414,14 +504,15 @@ static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 		qglyph->x_advance = ( ftglyph->advance.x + ( 1 << 5 ) ) >> 6;
 		qglyph->x_offset = ftglyph->bitmap_left;
 		qglyph->y_offset = -( (int)( ftglyph->bitmap_top ) );
-		qglyph->shader = shader;
-		qglyph->s1 = ( float )( qttf->imageCurX + tempWidth + 1 ) / ( float )qfont->shaderWidth;
+		qglyph->shader = qfont->shaders[qttf->curImage];
+		qglyph->s1 = ( float )( qttf->imageCurX + 1 ) / ( float )qfont->shaderWidth;
 		qglyph->t1 = ( float )( qttf->imageCurY + 1 ) / ( float )qfont->shaderHeight;
-		qglyph->s2 = ( float )( qttf->imageCurX + tempWidth + 1 + qglyph->width ) / ( float )qfont->shaderWidth;
+		qglyph->s2 = ( float )( qttf->imageCurX + 1 + qglyph->width ) / ( float )qfont->shaderWidth;
 		qglyph->t2 = ( float )( qttf->imageCurY + 1 + qglyph->height ) / ( float )qfont->shaderHeight;
+		qftglyph->image = qttf->curImage;
 
 		src = ftglyph->bitmap.buffer;
-		dest = qftGlyphTempBitmap + tempWidth;
+		dest = image->pixels + qttf->imageCurY * qfont->shaderWidth + qttf->imageCurX;
 		memset( dest, 0, bitmapWidth );
 		dest += qfont->shaderWidth;
 		for( y = 0; y < qglyph->height; ++y, src += srcStride ) {
@@ -450,7 +541,7 @@ static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 		}
 		memset( dest, 0, bitmapWidth );
 
-		tempWidth += bitmapWidth - 1; // overlap the previous character's margin
+		qttf->imageCurX += bitmapWidth - 1; // overlap the previous character's margin
 	}
 }
 
@@ -468,7 +559,8 @@ static const qfontface_funcs_t qft_face_funcs =
 	QFT_GetGlyph,
 	QFT_RenderString,
 	QFT_GetKerning,
-	QFT_SetFallback
+	QFT_SetFallback,
+	QFT_UploadGlyphs
 };
 
 /*
@@ -557,16 +649,14 @@ static qfontface_t *QFT_LoadFace( qfontfamily_t *family, unsigned int size ) {
 		qfont->shaderHeight = maxShaderHeight;
 	}
 
-	qfont->numShaders = 1;
-	qfont->shaders = FTLIB_Alloc( ftlibPool, sizeof( struct shader_s * ) );
-	qfont->shaders[0] = trap_R_RegisterRawAlphaMask( FTLIB_FontShaderName( qfont, 0 ),
-													 qfont->shaderWidth, qfont->shaderHeight, NULL );
 	qfont->hasKerning = hasKerning;
 	qfont->f = &qft_face_funcs;
 	qfont->facedata = ( void * )qttf;
 	qfont->next = family->faces;
 	family->faces = qfont;
 
+	QFT_AllocImage( qfont );
+
 	// pre-render 32-126
 	for( i = 0; i < FTLIB_NUM_ASCII_CHARS; i++ ) {
 		renderStr[i] = FTLIB_FIRST_ASCII_CHAR + i;
@@ -581,6 +671,7 @@ static qfontface_t *QFT_LoadFace( qfontfamily_t *family, unsigned int size ) {
 * QFT_UnloadFace
 */
 static void QFT_UnloadFace( qfontface_t *qfont ) {
+	unsigned int i;
 	qftface_t *qttf;
 
 	qttf = ( qftface_t * )qfont->facedata;
@@ -590,6 +681,13 @@ static void QFT_UnloadFace( qfontface_t *qfont ) {
 
 	q_FT_Done_Size( qttf->ftsize );
 
+	for( i = 0; i < qfont->numShaders; i++ ) {
+		FTLIB_Free( qttf->images[i].pixels );
+	}
+	if( qttf->images ) {
+		FTLIB_Free( qttf->images );
+	}
+
 	FTLIB_Free( qttf );
 }
 
@@ -783,10 +881,6 @@ static void QFT_Init( bool verbose ) {
 			Com_Printf( S_COLOR_RED "Error initializing FreeType library: %i\n", error );
 		}
 	}
-
-	assert( !qftGlyphTempBitmap );
-	qftGlyphTempBitmap = FTLIB_Alloc( ftlibPool, FTLIB_FONT_MAX_IMAGE_WIDTH * QFT_GLYPH_BITMAP_HEIGHT_INCREMENT );
-	qftGlyphTempBitmapHeight = QFT_GLYPH_BITMAP_HEIGHT_INCREMENT;
 }
 
 /*
@@ -798,12 +892,6 @@ static void QFT_Shutdown( void ) {
 		ftLibrary = NULL;
 	}
 
-	if( qftGlyphTempBitmap ) {
-		FTLIB_Free( qftGlyphTempBitmap );
-		qftGlyphTempBitmap = NULL;
-		qftGlyphTempBitmapHeight = 0;
-	}
-
 	QFT_UnloadFreetypeLibrary();
 }
 
@@ -929,6 +1017,26 @@ void FTLIB_TouchAllFonts( void ) {
 	}
 }
 
+/*
+* FTLIB_EndFrame
+*
+* Uploads glyphs that have been rendered during the frame, in one go per image.
+*/
+void FTLIB_EndFrame( void ) {
+	qfontfamily_t *qfamily;
+	qfontface_t *qface;
+
+	for( qfamily = fontFamilies; qfamily; qfamily = qfamily->next ) {
+		for( qface = qfamily->faces; qface; qface = qface->next ) {
+			if( qface->f->uploadGlyphs ) {
+				qface->f->uploadGlyphs( qface );
+			}
+		}
+	}
+
+	fontFrameNum++;
+}
+
 /*
 * FTLIB_FreeFonts
 */
@@ -83,6 +83,9 @@ typedef struct qfontface_funcs_s {
 
 	// sets the fallback font family for the font
 	void ( *setFallback )( struct qfontface_s *qfont, struct qfontfamily_s *qfamily );
+
+	// uploads the glyphs that have been rendered since the last call
+	void ( *uploadGlyphs )( struct qfontface_s *qfont );
 } qfontface_funcs_t;
 
 typedef struct qfontface_s {
@@ -159,6 +162,7 @@ void FTLIB_PrecacheFonts( bool verbose );
 qfontface_t *FTLIB_RegisterFont( const char *family, const char *fallback, int style, unsigned int size );
 void FTLIB_TouchFont( qfontface_t *qfont );
 void FTLIB_TouchAllFonts( void );
+void FTLIB_EndFrame( void );
 void FTLIB_FreeFonts( bool verbose );
 void FTLIB_PrintFontList( void );
 qglyph_t *FTLIB_GetGlyph( qfontface_t *font, wchar_t num );
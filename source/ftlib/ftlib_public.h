@@ -23,7 +23,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // ftlib_public.h - font provider subsystem
 
-#define FTLIB_API_VERSION           11
+#define FTLIB_API_VERSION           12
 
 //===============================================================
 
@@ -126,6 +126,9 @@ typedef struct {
 	void ( *TouchAllFonts )( void );
 	void ( *FreeFonts )( bool verbose );
 
+	// uploads glyphs that have been rendered during the frame, must be called before the renderer ends the frame
+	void ( *EndFrame )( void );
+
 	// drawing functions
 	size_t ( *FontSize )( struct qfontface_s *font );
 	size_t ( *FontHeight )( struct qfontface_s *font );
@@ -200,7 +200,6 @@ void AI_InitLevel( void ) {
 	AiNavMeshManager::Init( level.mapname );
 	TacticalSpotsRegistry::Init( level.mapname );
 	AiGroundTraceCache::Init();
-	HazardsSelectorCache::Init();
 
 	AiManager::Init( g_gametype->string, level.mapname );
 
@@ -226,7 +225,6 @@ void AI_AfterLevelScriptShutdown() {
 	}
 
 	NavEntitiesRegistry::Shutdown();
-	HazardsSelectorCache::Shutdown();
 	AiGroundTraceCache::Shutdown();
 	TacticalSpotsRegistry::Shutdown();
 	AiNavMeshManager::Shutdown();
@@ -1,7 +1,6 @@
 #include "HazardsSelector.h"
 #include "AwarenessModule.h"
 #include "../bot.h"
-#include "../../../qalgo/Links.h"
 
 void HazardsSelector::BeginUpdate() {
 	if( primaryHazard ) {
@@ -98,9 +97,7 @@ class SameDirBeamsList {
 	unsigned plasmaBeamsCount { 0 };
 	bool isAlreadySkipped { false };
 public:
-	SameDirBeamsList( const edict_t *firstEntity, const edict_t *bot );
-
-	~SameDirBeamsList();
+	SameDirBeamsList( const edict_t *firstEntity, const edict_t *bot, unsigned maxProjectiles );
 
 	bool TryAddProjectile( const edict_t *projectile );
 
@@ -126,98 +123,17 @@ class PlasmaBeamsBuilder {
 
 	const edict_t *const bot;
 	HazardsSelector *const hazardSelector;
+	// Any list may get all projectiles
+	const unsigned maxProjectiles;
 public:
-	PlasmaBeamsBuilder( const edict_t *bot_, HazardsSelector *hazardSelector_ )
-		: bot( bot_ ), hazardSelector( hazardSelector_ ) {}
+	PlasmaBeamsBuilder( const edict_t *bot_, HazardsSelector *hazardSelector_, unsigned maxProjectiles_ )
+		: bot( bot_ ), hazardSelector( hazardSelector_ ), maxProjectiles( maxProjectiles_ ) {}
 
 	void AddProjectile( const edict_t *projectile );
 	void FindMostHazardousBeams();
 };
 
-class CachingAllocator {
-	struct alignas( 8 )Chunk {
-		Chunk *prev;
-		Chunk *next;
-		uint8_t *data;
-	};
-
-	/**
-	 * We have to ensure that the returned data is at least 8-byte aligned (that's the malloc contract)
-	 */
-	enum { DATA_PADDING = sizeof( Chunk ) % 8 ? 8 - sizeof( Chunk ) % 8 : 0 };
-
-	const size_t chunkDataSize;
-	unsigned numUsedChunks { 0 };
-	Chunk *freeChunksHead { nullptr };
-
-public:
-	explicit CachingAllocator( size_t chunkDataSize_ ): chunkDataSize( chunkDataSize_ ) {}
-
-	~CachingAllocator() {
-		// Everything must be released properly by a user at the moment of this call
-		assert( !numUsedChunks );
-
-		Chunk *nextChunk;
-		for( Chunk *chunk = freeChunksHead; chunk; chunk = nextChunk ) {
-			nextChunk = chunk->next;
-			G_Free( chunk );
-		}
-	}
-
-	uint8_t *Alloc() {
-		if( freeChunksHead ) {
-			auto *const chunk = ::Unlink( freeChunksHead, &freeChunksHead );
-			numUsedChunks++;
-			return chunk->data;
-		}
-
-		const size_t size = sizeof( Chunk ) + DATA_PADDING + chunkDataSize;
-		auto *const mem = (uint8_t *)G_Malloc( size );
-		auto *const chunk = (Chunk *)mem;
-		chunk->data = mem + sizeof( Chunk ) + DATA_PADDING;
-		numUsedChunks++;
-		return chunk->data;
-	}
-
-	void Free( void *p ) {
-		if( !p ) {
-			return;
-		}
-		auto *chunk = (Chunk *)( ( (uint8_t *)p ) - sizeof( Chunk ) - DATA_PADDING );
-		::Link( chunk, &freeChunksHead );
-		numUsedChunks--;
-	}
-};
-
-static StaticVector<HazardsSelectorCache, 1> instanceHolder;
-HazardsSelectorCache *HazardsSelectorCache::instance = nullptr;
-
-HazardsSelectorCache::HazardsSelectorCache() {
-	auto *mem = storageMem = (uint8_t *)G_Malloc( 2 * sizeof( CachingAllocator ) );
-	sortedProjectilesAllocator = new( mem )CachingAllocator( sizeof( EntAndLineParam ) * MAX_EDICTS );
-	mem += sizeof( CachingAllocator );
-	plasmaBeamsAllocator = new( mem )CachingAllocator( sizeof( PlasmaBeam ) * MAX_EDICTS );
-}
-
-HazardsSelectorCache::~HazardsSelectorCache() {
-	sortedProjectilesAllocator->~CachingAllocator();
-	plasmaBeamsAllocator->~CachingAllocator();
-	G_Free( storageMem );
-}
-
-void HazardsSelectorCache::Init() {
-	assert( !instance );
-	instance = new( instanceHolder.unsafe_grow_back() )HazardsSelectorCache;
-}
-
-void HazardsSelectorCache::Shutdown() {
-	if( instance ) {
-		instance = nullptr;
-		instanceHolder.clear();
-	}
-}
-
-SameDirBeamsList::SameDirBeamsList( const edict_t *firstEntity, const edict_t *bot )
+SameDirBeamsList::SameDirBeamsList( const edict_t *firstEntity, const edict_t *bot, unsigned maxProjectiles )
 	: avgDirection( firstEntity->velocity ), lineEqnPoint( firstEntity->s.origin ) {
 	avgDirection.NormalizeFast();
 
@@ -230,24 +146,13 @@ SameDirBeamsList::SameDirBeamsList( const edict_t *firstEntity, const edict_t *b
 		return;
 	}
 
-	auto *const cache = HazardsSelectorCache::Instance();
-	sortedProjectiles = (EntAndLineParam *)cache->sortedProjectilesAllocator->Alloc();
-	plasmaBeams = (PlasmaBeam *)cache->plasmaBeamsAllocator->Alloc();
+	// These lists are only needed during the current think frame
+	sortedProjectiles = (EntAndLineParam *)G_FrameMalloc( sizeof( EntAndLineParam ) * maxProjectiles );
+	plasmaBeams = (PlasmaBeam *)G_FrameMalloc( sizeof( PlasmaBeam ) * maxProjectiles );
 
 	sortedProjectiles[projectilesCount++] = EntAndLineParam( ENTNUM( firstEntity ), ComputeLineEqnParam( firstEntity ) );
 }
 
-SameDirBeamsList::~SameDirBeamsList() {
-	if( isAlreadySkipped ) {
-		return;
-	}
-	auto *const cache = HazardsSelectorCache::Instance();
-	cache->sortedProjectilesAllocator->Free( sortedProjectiles );
-	cache->plasmaBeamsAllocator->Free( plasmaBeams );
-	sortedProjectiles = nullptr;
-	plasmaBeams = nullptr;
-}
-
 bool SameDirBeamsList::TryAddProjectile( const edict_t *projectile ) {
 	Vec3 direction( projectile->velocity );
 
@@ -311,7 +216,7 @@ void PlasmaBeamsBuilder::AddProjectile( const edict_t *projectile ) {
 			return;
 		}
 	}
-	new ( sameDirLists.unsafe_grow_back() )SameDirBeamsList( projectile, bot );
+	new ( sameDirLists.unsafe_grow_back() )SameDirBeamsList( projectile, bot, maxProjectiles );
 }
 
 void PlasmaBeamsBuilder::FindMostHazardousBeams() {
@@ -466,7 +371,7 @@ void HazardsSelector::FindWaveHazards( const EntNumsVector &entNums ) {
 
 void HazardsSelector::FindPlasmaHazards( const EntNumsVector &entNums ) {
 	const edict_t *gameEdicts = game.edicts;
-	PlasmaBeamsBuilder plasmaBeamsBuilder( gameEdicts + bot->EntNum(), this );
+	PlasmaBeamsBuilder plasmaBeamsBuilder( gameEdicts + bot->EntNum(), this, entNums.size() );
 
 	for( unsigned i = 0; i < entNums.size(); ++i ) {
 		plasmaBeamsBuilder.AddProjectile( gameEdicts + entNums[i] );
@@ -57,6 +57,7 @@ void GT_asShutdownScript( void ) {
 	}
 
 	GT_ResetScriptData();
+	G_asResetCallContexts();
 
 	GAME_AS_ENGINE()->DiscardModule( GAMETYPE_SCRIPTS_MODULE_NAME );
 }
@@ -70,14 +71,12 @@ void GT_asCallSpawn( void ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.spawnFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.spawnFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -92,14 +91,12 @@ void GT_asCallMatchStateStarted( void ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.matchStateStartedFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.matchStateStartedFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -115,17 +112,15 @@ bool GT_asCallMatchStateFinished( int incomingMatchState ) {
 		return true;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.matchStateFinishedFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.matchStateFinishedFunc ) );
+	if( !ctx ) {
 		return true;
 	}
 
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgDWord( 0, incomingMatchState );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -145,14 +140,12 @@ void GT_asCallThinkRules( void ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.thinkRulesFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.thinkRulesFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -167,10 +160,8 @@ void GT_asCallPlayerRespawn( edict_t *ent, int old_team, int new_team ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.playerRespawnFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.playerRespawnFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -179,7 +170,7 @@ void GT_asCallPlayerRespawn( edict_t *ent, int old_team, int new_team ) {
 	ctx->SetArgDWord( 1, old_team );
 	ctx->SetArgDWord( 2, new_team );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -203,10 +194,8 @@ void GT_asCallScoreEvent( gclient_t *client, const char *score_event, const char
 		args = "";
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.scoreEventFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.scoreEventFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -218,7 +207,7 @@ void GT_asCallScoreEvent( gclient_t *client, const char *score_event, const char
 	ctx->SetArgObject( 1, s1 );
 	ctx->SetArgObject( 2, s2 );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -240,17 +229,15 @@ void GT_asCallScoreboardMessage( unsigned int maxlen ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.scoreboardMessageFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.scoreboardMessageFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgDWord( 0, maxlen );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -260,7 +247,7 @@ void GT_asCallScoreboardMessage( unsigned int maxlen ) {
 		return;
 	}
 
-	Q_strncpyz( scoreboardString, string->buffer, sizeof( scoreboardString ) );
+	Q_strncpyz( scoreboardString, string->buffer, SCOREBOARD_STRING_SIZE );
 }
 
 //"Entity @GT_SelectSpawnPoint( Entity @ent )"
@@ -273,17 +260,15 @@ edict_t *GT_asCallSelectSpawnPoint( edict_t *ent ) {
 		return SelectDeathmatchSpawnPoint( ent ); // should have a hardcoded backup
 
 	}
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.selectSpawnPointFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.selectSpawnPointFunc ) );
+	if( !ctx ) {
 		return SelectDeathmatchSpawnPoint( ent );
 	}
 
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -312,10 +297,8 @@ bool GT_asCallGameCommand( gclient_t *client, const char *cmd, const char *args,
 		return false;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.clientCommandFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.clientCommandFunc ) );
+	if( !ctx ) {
 		return false;
 	}
 
@@ -328,7 +311,7 @@ bool GT_asCallGameCommand( gclient_t *client, const char *cmd, const char *args,
 	ctx->SetArgObject( 2, s2 );
 	ctx->SetArgDWord( 3, argc );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -349,14 +332,12 @@ void GT_asCallShutdown( void ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.shutdownFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.shutdownFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -489,14 +470,12 @@ static bool G_asInitializeGametypeScript( asIScriptModule *asModule ) {
 	// execute the GT_InitGametype function
 	//
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.initFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.gametype.initFunc ) );
+	if( !ctx ) {
 		return false;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		return false;
 	}
@@ -40,6 +40,10 @@ extern angelwrap_api_t *angelExport;
 asIScriptModule *G_LoadGameScript( const char *moduleName, const char *dir, const char *filename, const char *ext );
 bool G_ExecutionErrorReport( int error );
 
+asIScriptContext *G_asPrepareCallContext( asIScriptFunction *func );
+int G_asExecuteCallContext( asIScriptContext *ctx );
+void G_asResetCallContexts( void );
+
 typedef struct asEnumVal_s {
 	const char * name;
 	int value;
@@ -88,14 +88,12 @@ static void G_asCallMapFunction( void *func ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( func ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( func ) );
+	if( !ctx ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		G_asShutdownMapScript();
 	}
@@ -143,10 +141,8 @@ const char *G_asCallMapGametype( void ) {
 		return "";
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.mapscript.gametypeFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( level.mapscript.gametypeFunc ) );
+	if( !ctx ) {
 		return "";
 	}
 
@@ -154,7 +150,7 @@ const char *G_asCallMapGametype( void ) {
 
 	ctx->SetArgObject( 0, s );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -216,6 +212,7 @@ void G_asShutdownMapScript( void ) {
 	}
 
 	G_ResetMapScriptData();
+	G_asResetCallContexts();
 
 	GAME_AS_ENGINE()->DiscardModule( MAP_SCRIPTS_MODULE_NAME );
 }
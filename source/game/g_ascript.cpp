@@ -3214,6 +3214,181 @@ static void G_asRegisterGlobalProperties( asIScriptEngine *asEngine, const asglo
 
 // ==========================================================================================
 
+// Every script function gets its own context from a small direct mapped table, so calling
+// the same function again reuses its prepared state instead of preparing a shared context
+// for a different function each time. Calls of functions that are being executed fall back
+// to the shared contexts pool.
+#define G_AS_CALL_CONTEXTS      64
+#define G_AS_PROFILE_SIZE       512
+
+typedef struct {
+	const void *func;
+	char *decl;
+	unsigned calls;
+	uint64_t micros;        // including nested calls
+	uint64_t maxMicros;
+} g_asprofile_t;
+
+static asIScriptContext *asCallContexts[G_AS_CALL_CONTEXTS];
+static g_asprofile_t asProfile[G_AS_PROFILE_SIZE];
+static unsigned asProfileNumFuncs;
+
+static inline unsigned G_asFunctionHash( const void *func ) {
+	return (unsigned)( ( (uintptr_t)func >> 4 ) * 2654435761u );
+}
+
+/*
+* G_asPrepareCallContext
+*/
+asIScriptContext *G_asPrepareCallContext( asIScriptFunction *func ) {
+	asIScriptEngine *asEngine = GAME_AS_ENGINE();
+	asIScriptContext **slot = &asCallContexts[G_asFunctionHash( func ) % G_AS_CALL_CONTEXTS];
+	asIScriptContext *ctx = *slot;
+
+	if( !ctx ) {
+		ctx = *slot = angelExport->asCreateContext( asEngine );
+	}
+
+	if( !ctx || ctx->GetState() == asEXECUTION_ACTIVE || ctx->GetState() == asEXECUTION_SUSPENDED ) {
+		ctx = angelExport->asAcquireContext( asEngine );
+	}
+
+	if( ctx->Prepare( func ) < 0 ) {
+		return NULL;
+	}
+	return ctx;
+}
+
+/*
+* G_asProfileCall
+*/
+static void G_asProfileCall( asIScriptFunction *func, uint64_t micros ) {
+	unsigned i, hash = G_asFunctionHash( func );
+	g_asprofile_t *profile;
+
+	for( i = 0; i < G_AS_PROFILE_SIZE; i++ ) {
+		profile = &asProfile[( hash + i ) % G_AS_PROFILE_SIZE];
+		if( profile->func == func ) {
+			break;
+		}
+		if( !profile->func ) {
+			if( asProfileNumFuncs >= G_AS_PROFILE_SIZE / 2 ) {
+				return;
+			}
+			profile->func = func;
+			profile->decl = G_CopyString( func->GetDeclaration( true, true ) );
+			asProfileNumFuncs++;
+			break;
+		}
+	}
+
+	if( i == G_AS_PROFILE_SIZE ) {
+		return;
+	}
+
+	profile->calls++;
+	profile->micros += micros;
+	if( micros > profile->maxMicros ) {
+		profile->maxMicros = micros;
+	}
+}
+
+/*
+* G_asExecuteCallContext
+*/
+int G_asExecuteCallContext( asIScriptContext *ctx ) {
+	asIScriptFunction *func = ctx->GetFunction();
+	uint64_t start = trap_Microseconds();
+
+	int error = ctx->Execute();
+
+	G_asProfileCall( func, trap_Microseconds() - start );
+	return error;
+}
+
+/*
+* G_asResetCallContexts
+*
+* Drops references to functions and objects of modules that are about to be discarded
+*/
+void G_asResetCallContexts( void ) {
+	int i;
+
+	for( i = 0; i < G_AS_CALL_CONTEXTS; i++ ) {
+		asIScriptContext *ctx = asCallContexts[i];
+		if( ctx && ctx->GetState() != asEXECUTION_ACTIVE && ctx->GetState() != asEXECUTION_SUSPENDED ) {
+			ctx->Unprepare();
+		}
+	}
+
+	for( i = 0; i < G_AS_PROFILE_SIZE; i++ ) {
+		if( asProfile[i].decl ) {
+			G_Free( asProfile[i].decl );
+		}
+	}
+	memset( asProfile, 0, sizeof( asProfile ) );
+	asProfileNumFuncs = 0;
+}
+
+/*
+* G_asReleaseCallContexts
+*/
+static void G_asReleaseCallContexts( void ) {
+	int i;
+
+	G_asResetCallContexts();
+
+	for( i = 0; i < G_AS_CALL_CONTEXTS; i++ ) {
+		if( asCallContexts[i] ) {
+			angelExport->asReleaseContext( asCallContexts[i] );
+			asCallContexts[i] = NULL;
+		}
+	}
+}
+
+/*
+* G_asProfile_f
+*
+* Prints time spent in script functions called by the game since the scripts were loaded
+*/
+void G_asProfile_f( void ) {
+	const g_asprofile_t *sorted[G_AS_PROFILE_SIZE];
+	unsigned i, j, numSorted = 0;
+	uint64_t totalMicros = 0;
+
+	if( !Q_stricmp( trap_Cmd_Argv( 1 ), "reset" ) ) {
+		for( i = 0; i < G_AS_PROFILE_SIZE; i++ ) {
+			asProfile[i].calls = 0;
+			asProfile[i].micros = asProfile[i].maxMicros = 0;
+		}
+		return;
+	}
+
+	// sort by total time, descending
+	for( i = 0; i < G_AS_PROFILE_SIZE; i++ ) {
+		const g_asprofile_t *profile = &asProfile[i];
+		if( !profile->calls ) {
+			continue;
+		}
+		for( j = numSorted; j > 0 && sorted[j - 1]->micros < profile->micros; j-- ) {
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = profile;
+		numSorted++;
+		totalMicros += profile->micros;
+	}
+
+	G_Printf( "%8s %10s %8s %8s  %s\n", "calls", "total ms", "avg us", "max us", "function" );
+	for( i = 0; i < numSorted; i++ ) {
+		const g_asprofile_t *profile = sorted[i];
+		G_Printf( "%8u %10.2f %8.1f %8" PRIu64 "  %s\n", profile->calls, profile->micros * 0.001,
+				  (double)profile->micros / profile->calls, profile->maxMicros, profile->decl );
+	}
+	G_Printf( "%u functions, %.2f ms total\n", numSorted, totalMicros * 0.001 );
+}
+
+// ==========================================================================================
+
 // map entity spawning
 bool G_asCallMapEntitySpawnScript( const char *classname, edict_t *ent ) {
 	char fdeclstr[MAX_STRING_CHARS];
@@ -3249,16 +3424,15 @@ bool G_asCallMapEntitySpawnScript( const char *classname, edict_t *ent ) {
 	G_asClearEntityBehaviors( ent );
 
 	// call the spawn function
-	asContext = angelExport->asAcquireContext( asEngine );
-	error = asContext->Prepare( asSpawnFunc );
-	if( error < 0 ) {
+	asContext = G_asPrepareCallContext( asSpawnFunc );
+	if( !asContext ) {
 		return false;
 	}
 
 	// Now we need to pass the parameters to the script function.
 	asContext->SetArgObject( 0, ent );
 
-	error = asContext->Execute();
+	error = G_asExecuteCallContext( asContext );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 		ent->asScriptModule = NULL;
@@ -3335,17 +3509,15 @@ void G_asCallMapEntityThink( edict_t *ent ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asThinkFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( ent->asThinkFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3361,10 +3533,8 @@ void G_asCallMapEntityTouch( edict_t *ent, edict_t *other, cplane_t *plane, int
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asTouchFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( ent->asTouchFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -3380,7 +3550,7 @@ void G_asCallMapEntityTouch( edict_t *ent, edict_t *other, cplane_t *plane, int
 	ctx->SetArgObject( 2, &normal );
 	ctx->SetArgDWord( 3, surfFlags );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3395,10 +3565,8 @@ void G_asCallMapEntityUse( edict_t *ent, edict_t *other, edict_t *activator ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asUseFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( ent->asUseFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -3407,7 +3575,7 @@ void G_asCallMapEntityUse( edict_t *ent, edict_t *other, edict_t *activator ) {
 	ctx->SetArgObject( 1, other );
 	ctx->SetArgObject( 2, activator );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3422,10 +3590,8 @@ void G_asCallMapEntityPain( edict_t *ent, edict_t *other, float kick, float dama
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asPainFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( ent->asPainFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -3435,7 +3601,7 @@ void G_asCallMapEntityPain( edict_t *ent, edict_t *other, float kick, float dama
 	ctx->SetArgFloat( 2, kick );
 	ctx->SetArgFloat( 3, damage );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3450,10 +3616,8 @@ void G_asCallMapEntityDie( edict_t *ent, edict_t *inflicter, edict_t *attacker,
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asDieFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( ent->asDieFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -3462,7 +3626,7 @@ void G_asCallMapEntityDie( edict_t *ent, edict_t *inflicter, edict_t *attacker,
 	ctx->SetArgObject( 1, inflicter );
 	ctx->SetArgObject( 2, attacker );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3477,17 +3641,15 @@ void G_asCallMapEntityStop( edict_t *ent ) {
 		return;
 	}
 
-	ctx = angelExport->asAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asStopFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallContext( static_cast<asIScriptFunction *>( ent->asStopFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecuteCallContext( ctx );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3598,6 +3760,7 @@ void G_asInitGameModuleEngine( void ) {
 void G_asShutdownGameModuleEngine( void ) {
 	if( game.asEngine != NULL ) {
 		if( angelExport ) {
+			G_asReleaseCallContexts();
 			angelExport->asReleaseEngine( static_cast<asIScriptEngine *>( game.asEngine ) );
 		}
 		G_ResetGameModuleScriptData();
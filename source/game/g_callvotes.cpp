@@ -273,17 +273,16 @@ static bool G_VoteMapValidate( callvotedata_t *data, bool first ) {
 				return true;
 			}
 
-			s = G_CopyString( g_map_pool->string );
+			s = ( char * )G_FrameMalloc( strlen( g_map_pool->string ) + 1 );
+			strcpy( s, g_map_pool->string );
 			tok = strtok( s, MAPLIST_SEPS );
 			while( tok != NULL ) {
 				if( !Q_stricmp( tok, mapname ) ) {
-					G_Free( s );
 					goto valid_map;
 				} else {
 					tok = strtok( NULL, MAPLIST_SEPS );
 				}
 			}
-			G_Free( s );
 			G_PrintMsg( data->caller, "%sMap is not in map pool.\n", S_COLOR_RED );
 			return false;
 		}
@@ -333,7 +332,8 @@ static http_response_code_t G_VoteMapWebRequest( http_query_method_t method, con
 	if( g_enforce_map_pool->integer && strlen( g_map_pool->string ) > 2 ) {
 		char *s, *tok;
 
-		s = G_CopyString( g_map_pool->string );
+		s = ( char * )G_FrameMalloc( strlen( g_map_pool->string ) + 1 );
+		strcpy( s, g_map_pool->string );
 		tok = strtok( s, MAPLIST_SEPS );
 		while( tok != NULL ) {
 			const char *fullname = trap_ML_GetFullname( tok );
@@ -349,8 +349,6 @@ static http_response_code_t G_VoteMapWebRequest( http_query_method_t method, con
 
 			tok = strtok( NULL, MAPLIST_SEPS );
 		}
-
-		G_Free( s );
 	} else {
 		for( i = 0; trap_ML_GetMapByNum( i, buffer, sizeof( buffer ) ); i++ ) {
 			G_AppendString( &msg, va(
@@ -203,7 +203,7 @@ static void G_UpdateServerInfo( void ) {
 			}
 
 			len++;
-			votable = ( char * )G_Malloc( len );
+			votable = ( char * )G_FrameMalloc( len );
 			votable[0] = 0;
 
 			for( count = 0; ( name = COM_ListNameForPosition( g_gametypes_list->string, count, CHAR_GAMETYPE_SEPARATOR ) ) != NULL; count++ ) {
@@ -215,7 +215,6 @@ static void G_UpdateServerInfo( void ) {
 
 			//votable[ strlen( votable )-2 ] = 0; // remove the last space
 			trap_Cvar_ForceSet( "g_gametypes_available", votable );
-			G_Free( votable );
 		}
 
 		g_votable_gametypes->modified = false;
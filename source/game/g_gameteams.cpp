@@ -611,7 +611,7 @@ void G_Teams_Join_Cmd( edict_t *ent ) {
 */
 void G_Teams_UpdateTeamInfoMessages( void ) {
 	static int nexttime = 0;
-	static char teammessage[MAX_STRING_CHARS];
+	char *teammessage;
 	edict_t *ent, *e;
 	size_t len;
 	int i, j, team;
@@ -627,10 +627,11 @@ void G_Teams_UpdateTeamInfoMessages( void ) {
 		nexttime += 2000;
 
 	// time for a new update
+	teammessage = ( char * )G_FrameMalloc( MAX_STRING_CHARS );
 
 	for( team = TEAM_ALPHA; team < GS_MAX_TEAMS; team++ ) {
 		*teammessage = 0;
-		Q_snprintfz( teammessage, sizeof( teammessage ), "ti \"" );
+		Q_snprintfz( teammessage, MAX_STRING_CHARS, "ti \"" );
 		len = strlen( teammessage );
 
 		// add our team info to the string
@@ -656,7 +657,7 @@ void G_Teams_UpdateTeamInfoMessages( void ) {
 			Q_snprintfz( entry, sizeof( entry ), "%i %i %i %i ", PLAYERNUM( ent ), locationTag, HEALTH_TO_INT( ent->health ), ARMOR_TO_INT( ent->r.client->resp.armor ) );
 
 			if( MAX_STRING_CHARS - len > strlen( entry ) ) {
-				Q_strncatz( teammessage, entry, sizeof( teammessage ) );
+				Q_strncatz( teammessage, entry, MAX_STRING_CHARS );
 				len = strlen( teammessage );
 			}
 		}
@@ -665,7 +666,7 @@ void G_Teams_UpdateTeamInfoMessages( void ) {
 		*entry = 0;
 		Q_snprintfz( entry, sizeof( entry ), "\"" );
 		if( MAX_STRING_CHARS - len > strlen( entry ) ) {
-			Q_strncatz( teammessage, entry, sizeof( teammessage ) );
+			Q_strncatz( teammessage, entry, MAX_STRING_CHARS );
 			len = strlen( teammessage );
 		}
 
@@ -527,6 +527,7 @@ void G_asInitGameModuleEngine( void );
 void G_asShutdownGameModuleEngine( void );
 void G_asGarbageCollect( bool force );
 void G_asDumpAPI_f( void );
+void G_asProfile_f( void );
 
 #define world   ( (edict_t *)game.edicts )
 
@@ -937,8 +938,9 @@ void G_ClientDamageFeedback( edict_t *ent );
 // p_hud.c
 //
 
-//scoreboards string
-extern char scoreboardString[MAX_STRING_CHARS];
+//scoreboards string, allocated from the frame arena by G_UpdateScoreBoardMessages
+#define SCOREBOARD_STRING_SIZE MAX_STRING_CHARS
+extern char *scoreboardString;
 extern const unsigned int scoreboardInterval;
 #define SCOREBOARD_MSG_MAXSIZE ( MAX_STRING_CHARS - 8 ) //I know, I know, doesn't make sense having a bigger string than the maxsize value
 
@@ -964,6 +966,9 @@ int G_BoxSlideMove( edict_t *ent, int contentmask, float slideBounce, float fric
 #define G_Malloc( size ) trap_MemAlloc( size, __FILE__, __LINE__ )
 #define G_Free( mem ) trap_MemFree( mem, __FILE__, __LINE__ )
 
+// valid till the end of the server frame, must not be freed
+#define G_FrameMalloc( size ) trap_MemFrameAlloc( size, __FILE__, __LINE__ )
+
 #define G_LevelMalloc( size ) _G_LevelMalloc( ( size ), __FILE__, __LINE__ )
 #define G_LevelFree( data ) _G_LevelFree( ( data ), __FILE__, __LINE__ )
 #define G_LevelCopyString( in ) _G_LevelCopyString( ( in ), __FILE__, __LINE__ )
@@ -20,7 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // g_public.h -- game dll information visible to server
 
-#define GAME_API_VERSION    56
+#define GAME_API_VERSION    59
 
 //===============================================================
 
@@ -99,6 +99,7 @@ typedef struct {
 	int ( *SkinIndex )( const char *name );
 
 	int64_t ( *Milliseconds )( void );
+	uint64_t ( *Microseconds )( void );
 
 	bool ( *inPVS )( const vec3_t p1, const vec3_t p2 );
 
@@ -122,6 +123,18 @@ typedef struct {
 	void *( *Mem_Alloc )( size_t size, const char *filename, int fileline );
 	void ( *Mem_Free )( void *data, const char *filename, int fileline );
 
+	// zeroed memory that is released at once at the end of the server frame
+	void *( *Mem_FrameAlloc )( size_t size, const char *filename, int fileline );
+
+	// engine-wide worker threads
+	unsigned ( *Tasks_NumWorkers )( void );
+	struct qtaskgroup_s *( *TaskGroup_Create )( void );
+	void ( *TaskGroup_Destroy )( struct qtaskgroup_s **pgroup );
+	void ( *TaskGroup_Wait )( struct qtaskgroup_s *group );
+	void ( *Task_Spawn )( struct qtaskgroup_s *group, qtaskfunc_t func, const void *arg, size_t argSize );
+	void ( *Task_ParallelFor )( struct qtaskgroup_s *group, qtaskrangefunc_t func, const void *arg, size_t argSize,
+								unsigned items, unsigned grain );
+
 	// console variable interaction
 	cvar_t *( *Cvar_Get )( const char *name, const char *value, int flags );
 	cvar_t *( *Cvar_Set )( const char *name, const char *value );
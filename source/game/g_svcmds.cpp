@@ -1287,6 +1287,7 @@ void G_AddServerCommands( void ) {
 #endif
 
 	trap_Cmd_AddCommand( "dumpASapi", G_asDumpAPI_f );
+	trap_Cmd_AddCommand( "ASprofile", G_asProfile_f );
 
 	trap_Cmd_AddCommand( "listlocations", Cmd_ListLocations_f );
 }
@@ -1313,6 +1314,7 @@ void G_RemoveCommands( void ) {
 #endif
 
 	trap_Cmd_RemoveCommand( "dumpASapi" );
+	trap_Cmd_RemoveCommand( "ASprofile" );
 
 	trap_Cmd_RemoveCommand( "listlocations" );
 }
@@ -78,6 +78,10 @@ static inline int64_t trap_Milliseconds( void ) {
 	return GAME_IMPORT.Milliseconds();
 }
 
+static inline uint64_t trap_Microseconds( void ) {
+	return GAME_IMPORT.Microseconds();
+}
+
 inline bool trap_inPVS( const vec3_t p1, const vec3_t p2 ) {
 	return GAME_IMPORT.inPVS( p1, p2 ) == true;
 }
@@ -154,6 +158,35 @@ static inline void trap_MemFree( void *data, const char *filename, int fileline
 	GAME_IMPORT.Mem_Free( data, filename, fileline );
 }
 
+static inline ATTRIBUTE_MALLOC void *trap_MemFrameAlloc( size_t size, const char *filename, int fileline ) {
+	return GAME_IMPORT.Mem_FrameAlloc( size, filename, fileline );
+}
+
+static inline unsigned trap_Tasks_NumWorkers( void ) {
+	return GAME_IMPORT.Tasks_NumWorkers();
+}
+
+static inline struct qtaskgroup_s *trap_TaskGroup_Create( void ) {
+	return GAME_IMPORT.TaskGroup_Create();
+}
+
+static inline void trap_TaskGroup_Destroy( struct qtaskgroup_s **pgroup ) {
+	GAME_IMPORT.TaskGroup_Destroy( pgroup );
+}
+
+static inline void trap_TaskGroup_Wait( struct qtaskgroup_s *group ) {
+	GAME_IMPORT.TaskGroup_Wait( group );
+}
+
+static inline void trap_Task_Spawn( struct qtaskgroup_s *group, qtaskfunc_t func, const void *arg, size_t argSize ) {
+	GAME_IMPORT.Task_Spawn( group, func, arg, argSize );
+}
+
+static inline void trap_Task_ParallelFor( struct qtaskgroup_s *group, qtaskrangefunc_t func, const void *arg, size_t argSize,
+										  unsigned items, unsigned grain ) {
+	GAME_IMPORT.Task_ParallelFor( group, func, arg, argSize, items, grain );
+}
+
 // cvars
 static inline cvar_t *trap_Cvar_Get( const char *name, const char *value, int flags ) {
 	return GAME_IMPORT.Cvar_Get( name, value, flags );
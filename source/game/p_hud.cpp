@@ -20,9 +20,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "g_local.h"
 
-char scoreboardString[MAX_STRING_CHARS];
+char *scoreboardString;
 const unsigned int scoreboardInterval = 1000;
-static const char *G_PlayerStatsMessage( edict_t *ent );
+static const char *G_PlayerStatsMessage( edict_t *ent, char *entry, size_t size );
 
 //======================================================================
 //
@@ -41,9 +41,14 @@ void G_UpdateScoreBoardMessages( void ) {
 	edict_t *ent;
 	gclient_t *client;
 	bool forcedUpdate = false;
-	char command[MAX_STRING_CHARS];
+	char *command, *stats;
 	size_t maxlen, staticlen;
 
+	// the strings are only needed till they are sent, so take them from the frame arena
+	scoreboardString = ( char * )G_FrameMalloc( SCOREBOARD_STRING_SIZE );
+	command = ( char * )G_FrameMalloc( MAX_STRING_CHARS );
+	stats = ( char * )G_FrameMalloc( MAX_TOKEN_CHARS );
+
 	// fixme : mess of copying
 	maxlen = MAX_STRING_CHARS - ( strlen( "scb \"\"" + 4 ) );
 
@@ -75,11 +80,11 @@ update:
 			} else {
 				G_ScoreboardMessage_AddChasers( ENTNUM( ent ), ENTNUM( ent ) );
 			}
-			Q_snprintfz( command, sizeof( command ), "scb \"%s\"", scoreboardString );
+			Q_snprintfz( command, MAX_STRING_CHARS, "scb \"%s\"", scoreboardString );
 
 			client->level.scoreboard_time = game.realtime + scoreboardInterval - ( game.realtime % scoreboardInterval );
 			trap_GameCmd( ent, command );
-			trap_GameCmd( ent, G_PlayerStatsMessage( ent ) );
+			trap_GameCmd( ent, G_PlayerStatsMessage( ent, stats, MAX_TOKEN_CHARS ) );
 		}
 	}
 
@@ -107,7 +112,7 @@ update:
     \
 	if( SCOREBOARD_MSG_MAXSIZE - len > strlen( entry ) ) \
 	{ \
-		Q_strncatz( scoreboardString, entry, sizeof( scoreboardString ) ); \
+		Q_strncatz( scoreboardString, entry, SCOREBOARD_STRING_SIZE ); \
 		len = strlen( scoreboardString ); \
 	} \
 	else \
@@ -217,14 +222,13 @@ void G_ScoreboardMessage_AddChasers( int entnum, int entnum_self ) {
 * G_PlayerStatsMessage
 * generic one to add the stats of the current player into the scoreboard message at cgame
 */
-static const char *G_PlayerStatsMessage( edict_t *ent ) {
+static const char *G_PlayerStatsMessage( edict_t *ent, char *entry, size_t size ) {
 	gsitem_t *it;
 	int i;
 	int weakhit, weakshot;
 	int hit, shot;
 	edict_t *target;
 	gclient_t *client;
-	static char entry[MAX_TOKEN_CHARS];
 
 	// when chasing generate from target
 	target = ent;
@@ -237,8 +241,8 @@ static const char *G_PlayerStatsMessage( edict_t *ent ) {
 
 	// message header
 	entry[0] = '\0';
-	Q_snprintfz( entry, sizeof( entry ), "plstats 0 \"" );
-	Q_strncatz( entry, va( " %d", PLAYERNUM( target ) ), sizeof( entry ) );
+	Q_snprintfz( entry, size, "plstats 0 \"" );
+	Q_strncatz( entry, va( " %d", PLAYERNUM( target ) ), size );
 
 	// weapon loop
 	for( i = WEAP_GUNBLADE; i < WEAP_TOTAL; i++ ) {
@@ -259,22 +263,22 @@ static const char *G_PlayerStatsMessage( edict_t *ent ) {
 		}
 
 		// both in one
-		Q_strncatz( entry, va( " %d", weakshot + shot ), sizeof( entry ) );
+		Q_strncatz( entry, va( " %d", weakshot + shot ), size );
 		if( weakshot + shot > 0 ) {
-			Q_strncatz( entry, va( " %d", weakhit + hit ), sizeof( entry ) );
+			Q_strncatz( entry, va( " %d", weakhit + hit ), size );
 
 			if( i == WEAP_LASERGUN || i == WEAP_ELECTROBOLT ) {
 				// strong
-				Q_strncatz( entry, va( " %d", shot ), sizeof( entry ) );
+				Q_strncatz( entry, va( " %d", shot ), size );
 				if( shot != ( weakshot + shot ) ) {
-					Q_strncatz( entry, va( " %d", hit ), sizeof( entry ) );
+					Q_strncatz( entry, va( " %d", hit ), size );
 				}
 			}
 		}
 	}
 
 	// add enclosing quote
-	Q_strncatz( entry, "\"", sizeof( entry ) );
+	Q_strncatz( entry, "\"", size );
 
 	return entry;
 }
@@ -122,6 +122,7 @@ typedef struct angelwrap_api_s {
 	void ( *asReleaseEngine )( asIScriptEngine *engine );
 
 	// context
+	asIScriptContext *( *asCreateContext )( asIScriptEngine * engine ); // not shared, released by asReleaseContext
 	asIScriptContext *( *asAcquireContext )( asIScriptEngine * engine );
 	void ( *asReleaseContext )( asIScriptContext *context );
 	asIScriptContext *( *asGetActiveContext )( void );
@@ -412,6 +412,12 @@ typedef int socket_handle_t;
 
 #endif  // x86 or x86_64
 
+// NEON is mandatory on AArch64 and is advertised by the compiler on ARMv7 targets that enable it
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( __aarch64__ ) || defined( _M_ARM64 )
+#include <arm_neon.h>
+#define QF_NEON
+#endif
+
 //==============================================
 
 #if !defined( __cplusplus )
@@ -387,6 +387,16 @@ int Q_bitcount( int v ) {
 	return c;
 }
 
+// the index of the lowest set bit, v must not be zero
+int Q_bsf( unsigned v ) {
+	static const int debruijn[32] = {
+		0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+		31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+	};
+
+	return debruijn[( ( v & ( ~v + 1 ) ) * 0x077CB531u ) >> 27];
+}
+
 /*
 * LerpAngle
 *
@@ -194,6 +194,8 @@ int Q_log2( int val );
 
 int Q_bitcount( int v );
 
+int Q_bsf( unsigned v );
+
 #define ISPOWOF2( x ) ( !( ( x ) & ( ( x ) - 1 ) ) )
 
 #define SQRTFAST( x ) ( Q_Sqrt( x ) )
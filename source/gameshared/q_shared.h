@@ -370,6 +370,9 @@ __declspec( noreturn ) void Com_Error( com_error_code_t code, _Printf_format_str
 #define FS_SEEK_SET         1
 #define FS_SEEK_END         2
 
+// called for every file of FS_LoadFilesBatch, the buffer is null-terminated and is freed after the callback returns
+typedef void ( *fs_batch_cb )( int index, const char *path, void *buffer, int length, void *user );
+
 typedef enum {
 	FS_MEDIA_IMAGES,
 
@@ -385,6 +388,15 @@ typedef enum {
 // equals to INFINITE on Windows and SDL_MUTEX_MAXWAIT
 #define Q_THREADS_WAIT_INFINITE 0xFFFFFFFF
 
+// command pipe flags
+#define QBUFPIPE_BLOCKWRITE     1   // writers wait for room instead of dropping commands
+#define QBUFPIPE_MULTIWRITER    2   // commands are written by more than one thread
+
+// tasks executed by the engine worker threads, arg points to a copy of the argument
+struct qtaskgroup_s;
+typedef void ( *qtaskfunc_t )( void *arg );
+typedef void ( *qtaskrangefunc_t )( unsigned first, unsigned items, void *arg );
+
 //==============================================================
 
 // connection state of the client in the server
@@ -30,7 +30,8 @@ void ReliablePipe::BackgroundRunner::RunMessageLoop() {
 ReliablePipe::ReliablePipe()
 	: reliableStorage( MakeLocalStoragePath() ) {
 	// Never actually fails?
-	this->reportsPipe = QBufPipe_Create( 128, 1 );
+	this->reportsPipe = QBufPipe_Create( 128, QBUFPIPE_BLOCKWRITE );
+	QBufPipe_SetName( this->reportsPipe, "mm reports" );
 
 	// Never actually fails?
 	this->backgroundWriter = new( ::malloc( sizeof( BackgroundWriter ) ) )BackgroundWriter( &reliableStorage, reportsPipe );
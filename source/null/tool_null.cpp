@@ -0,0 +1,278 @@
+// tool_null.cpp -- minimal replacements of common and system facilities
+// that are required by the qcommon subset headless tools are linked with.
+
+#include "../qcommon/qcommon.h"
+#include "../qcommon/wswcurl.h"
+#include "../qalgo/glob.h"
+
+#include "tool_null.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+cvar_t *developer;
+cvar_t *dedicated;
+cvar_t *versioncvar;
+cvar_t *con_printText;
+
+#define MAX_NUM_ARGVS   50
+
+static int com_argc;
+static char *com_argv[MAX_NUM_ARGVS + 1];
+
+static bool ( *tool_dropHandler )( const char *msg );
+
+void Tool_SetDropHandler( bool ( *handler )( const char *msg ) ) {
+	tool_dropHandler = handler;
+}
+
+void Com_Printf( const char *format, ... ) {
+	va_list argptr;
+	char msg[MAX_PRINTMSG];
+
+	va_start( argptr, format );
+	Q_vsnprintfz( msg, sizeof( msg ), format, argptr );
+	va_end( argptr );
+
+	fputs( msg, stdout );
+	fflush( stdout );
+}
+
+void Com_DPrintf( const char *format, ... ) {
+	va_list argptr;
+	char msg[MAX_PRINTMSG];
+
+	if( !developer || !developer->integer ) {
+		return;
+	}
+
+	va_start( argptr, format );
+	Q_vsnprintfz( msg, sizeof( msg ), format, argptr );
+	va_end( argptr );
+
+	Com_Printf( "%s", msg );
+}
+
+void Com_Error( com_error_code_t code, const char *format, ... ) {
+	va_list argptr;
+	char msg[MAX_PRINTMSG];
+
+	va_start( argptr, format );
+	Q_vsnprintfz( msg, sizeof( msg ), format, argptr );
+	va_end( argptr );
+
+	// There is no frame loop to return to, only the tool may know how to recover
+	if( code != ERR_FATAL && tool_dropHandler ) {
+		tool_dropHandler( msg );
+	}
+
+	Sys_Error( "%s", msg );
+}
+
+void Sys_Error( const char *format, ... ) {
+	va_list argptr;
+
+	fputs( "Error: ", stderr );
+	va_start( argptr, format );
+	vfprintf( stderr, format, argptr );
+	va_end( argptr );
+	fputs( "\n", stderr );
+
+	exit( 1 );
+}
+
+void Sys_Quit( void ) {
+	exit( 0 );
+}
+
+void Sys_ConsoleOutput( char *string ) {
+	fputs( string, stdout );
+}
+
+int Sys_GetCurrentProcessId( void ) {
+#ifdef _WIN32
+	return (int)GetCurrentProcessId();
+#else
+	return (int)getpid();
+#endif
+}
+
+bool Sys_GetNumberOfProcessors( unsigned *physical, unsigned *logical ) {
+	// Headless tools only size their worker pools by this, so report what the OS
+	// tells directly and count every logical processor as a physical one,
+	// just like the engine does when it can't query the topology.
+#ifdef _WIN32
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo( &systemInfo );
+	long onlineProcessors = (long)systemInfo.dwNumberOfProcessors;
+#else
+	long onlineProcessors = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+	if( onlineProcessors <= 0 ) {
+		*physical = 1;
+		*logical = 1;
+		return false;
+	}
+
+	*physical = (unsigned)onlineProcessors;
+	*logical = (unsigned)onlineProcessors;
+	return true;
+}
+
+unsigned Sys_GetProcessorFeatures() {
+	unsigned features = 0;
+	// Let the collision code use the same optimized paths as the engine does.
+	// Unlike the engine we do not bother about MSVC (the generic path is used in this case).
+#if ( defined ( __i386__ ) || defined ( __x86_64__ ) ) && !defined( _MSC_VER )
+#ifndef __clang__
+	__builtin_cpu_init();
+#endif
+	if( __builtin_cpu_supports( "avx" ) ) {
+		features |= Q_CPU_FEATURE_AVX;
+	} else if( __builtin_cpu_supports( "sse4.2" ) ) {
+		features |= Q_CPU_FEATURE_SSE42;
+	} else if( __builtin_cpu_supports( "sse4.1" ) ) {
+		features |= Q_CPU_FEATURE_SSE41;
+	} else if( __builtin_cpu_supports( "sse2" ) ) {
+		features |= Q_CPU_FEATURE_SSE2;
+	}
+#endif
+	// Set all least significant bits as the engine does
+	if( features ) {
+		features |= ( features - 1 );
+	}
+	return features;
+}
+
+void Sys_Sleep( unsigned int millis ) {
+#ifdef _WIN32
+	Sleep( millis );
+#else
+	usleep( millis * 1000 );
+#endif
+}
+
+int Com_ClientState( void ) {
+	return CA_UNINITIALIZED;
+}
+
+int Com_ServerState( void ) {
+	return 0; // ss_dead
+}
+
+bool Com_DemoPlaying( void ) {
+	return false;
+}
+
+int COM_Argc( void ) {
+	return com_argc;
+}
+
+const char *COM_Argv( int arg ) {
+	if( arg < 0 || arg >= com_argc || !com_argv[arg] ) {
+		return "";
+	}
+	return com_argv[arg];
+}
+
+void COM_ClearArgv( int arg ) {
+	if( arg < 0 || arg >= com_argc || !com_argv[arg] ) {
+		return;
+	}
+	com_argv[arg][0] = '\0';
+}
+
+void COM_InitArgv( int argc, char **argv ) {
+	if( argc > MAX_NUM_ARGVS ) {
+		Com_Error( ERR_FATAL, "argc > MAX_NUM_ARGVS" );
+	}
+	com_argc = argc;
+	for( int i = 0; i < argc; i++ ) {
+		com_argv[i] = ( argv[i] && strlen( argv[i] ) < MAX_TOKEN_CHARS ) ? argv[i] : (char *)"";
+	}
+}
+
+unsigned Com_CountPureListFiles( purelist_t *purelist ) {
+	// Demos are never recorded by the tools
+	return 0;
+}
+
+int Com_GlobMatch( const char *pattern, const char *text, const bool casecmp ) {
+	return glob_match( pattern, text, casecmp );
+}
+
+char *_ZoneCopyString( const char *str, const char *filename, int fileline ) {
+	return _Mem_CopyString( zoneMemPool, str, filename, fileline );
+}
+
+void *Q_malloc( size_t size ) {
+	void *buf = malloc( size );
+
+	if( !buf ) {
+		Sys_Error( "Q_malloc: failed on allocation of %" PRIuPTR " bytes.\n", (uintptr_t)size );
+	}
+
+	return buf;
+}
+
+void *Q_realloc( void *buf, size_t newsize ) {
+	void *newbuf = realloc( buf, newsize );
+
+	if( !newbuf && newsize ) {
+		Sys_Error( "Q_realloc: failed on allocation of %" PRIuPTR " bytes.\n", (uintptr_t)newsize );
+	}
+
+	return newbuf;
+}
+
+void Q_free( void *buf ) {
+	free( buf );
+}
+
+// Files are never read from URLs by the tools
+
+wswcurl_req *wswcurl_create( const char *iface, const char *furl, ... ) {
+	return NULL;
+}
+
+void wswcurl_start( wswcurl_req *req ) {
+}
+
+size_t wswcurl_getsize( wswcurl_req *req, size_t *rxreceived ) {
+	if( rxreceived ) {
+		*rxreceived = 0;
+	}
+	return 0;
+}
+
+void wswcurl_stream_callbacks( wswcurl_req *req, wswcurl_read_cb read_cb, wswcurl_done_cb done_cb,
+							   wswcurl_header_cb header_cb, void *customp ) {
+}
+
+void wswcurl_set_resume_from( wswcurl_req *req, long resume ) {
+}
+
+void wswcurl_ignore_bytes( wswcurl_req *req, size_t nbytes ) {
+}
+
+const char *wswcurl_get_url( const wswcurl_req *req ) {
+	return "";
+}
+
+size_t wswcurl_read( wswcurl_req *req, void *buffer, size_t size ) {
+	return 0;
+}
+
+void wswcurl_delete( wswcurl_req *req ) {
+}
+
+int wswcurl_tell( wswcurl_req *req ) {
+	return 0;
+}
+
+int wswcurl_eof( wswcurl_req *req ) {
+	return 1;
+}
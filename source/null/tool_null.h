@@ -0,0 +1,14 @@
+// tool_null.h -- hooks into the common facilities of tool_null.cpp
+
+#ifndef QFUSION_TOOL_NULL_H
+#define QFUSION_TOOL_NULL_H
+
+/*
+* Tool_SetDropHandler
+*
+* The handler is called by Com_Error() for non-fatal errors and may leave the current job, e.g. by longjmp().
+* Errors remain fatal if there is no handler or if it returns false.
+*/
+void Tool_SetDropHandler( bool ( *handler )( const char *msg ) );
+
+#endif
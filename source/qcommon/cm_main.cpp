@@ -227,7 +227,8 @@ cmodel_t *CM_LoadMap( cmodel_state_t *cms, const char *name, bool clientload, un
 	//
 	// load the file
 	//
-	length = FS_LoadFile( name, ( void ** )&buf, NULL, 0 );
+	// the map is only read by the loader, so don't copy it if it is stored in a mapped pak
+	length = FS_LoadFileView( name, ( const void ** )&buf );
 	if( !buf ) {
 		Com_Error( ERR_DROP, "Couldn't load %s", name );
 	}
@@ -989,7 +989,7 @@ void CM_LoadQ3BrushModel( cmodel_state_t *cms, void *parent, void *buf, bspForma
 	CMod_LoadVisibility( cms, &header.lumps[LUMP_VISIBILITY] );
 	CMod_LoadEntityString( cms, &header.lumps[LUMP_ENTITIES] );
 
-	FS_FreeFile( buf );
+	FS_FreeFileView( buf );
 
 	// Free no longer needed data
 	if( cms->map_verts ) {
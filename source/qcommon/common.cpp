@@ -833,6 +833,7 @@ void Qcommon_Init( int argc, char **argv ) {
 	// init commands and vars
 	//
 	Memory_InitCommands();
+	QThreads_InitCommands();
 
 	Qcommon_InitCommands();
 
@@ -857,6 +858,8 @@ void Qcommon_Init( int argc, char **argv ) {
 
 	Sys_Init();
 
+	QTasks_Init();
+
 	NET_Init();
 	Netchan_Init();
 
@@ -1008,6 +1011,7 @@ void Qcommon_Shutdown( void ) {
 
 	Com_ScriptModule_Shutdown();
 	CM_Shutdown();
+	QTasks_Shutdown();
 	Netchan_Shutdown();
 	NET_Shutdown();
 	Key_Shutdown();
@@ -1018,6 +1022,7 @@ void Qcommon_Shutdown( void ) {
 
 	Qcommon_ShutdownCommands();
 	Memory_ShutdownCommands();
+	QThreads_ShutdownCommands();
 
 	Com_CloseConsoleLog( true, true );
 
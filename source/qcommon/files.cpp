@@ -27,6 +27,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "wswcurl.h"
 #include "../qalgo/md5.h"
 #include "../qalgo/q_trie.h"
+#include "../qalgo/hash.h"
+
+#include <atomic>
 
 /*
 =============================================================================
@@ -89,9 +92,13 @@ typedef struct {
 
 #define FS_PACKFILE_NUM_THREADS     4     // including the main thread
 
+#define FS_BATCH_NUM_THREADS        4     // including the calling thread
+#define FS_BATCH_MAX_AHEAD          32    // limits the memory held by loaded files the callback hasn't got yet
+
 typedef struct packfile_s {
 	char *name;
 	char *pakname;
+	struct pack_s *pack;
 	void *vfsHandle;            // handle to the pack in VFS
 	unsigned flags;
 	unsigned compressedSize;    // compressed size
@@ -112,6 +119,10 @@ typedef struct pack_s {
 	struct pack_s *deferred_pack;
 	void *sysHandle;
 	void *vfsHandle;
+	void *mapping;
+	uint8_t *mappingData;       // the whole archive mapped into memory, shared by all readers
+	size_t mappingSize;
+	size_t mappingOffset;
 	int numFiles;
 	packfile_t *files;
 	char *fileNames;
@@ -121,6 +132,7 @@ typedef struct pack_s {
 typedef struct filehandle_s {
 	FILE *fstream;
 	packfile_t *pakFile;
+	const uint8_t *pakData;         // points to the entry in the pak mapping, fstream is not used for reading then
 	void *vfsHandle;
 	unsigned pakOffset;
 	unsigned uncompressedSize;      // uncompressed size
@@ -170,6 +182,35 @@ static searchpath_t *fs_basepaths = NULL;       // directories without gamedirs
 static searchpath_t *fs_searchpaths = NULL;     // game search directories, plus paks
 static qmutex_t *fs_searchpaths_mutex;
 
+// a pak file entry in the search index
+typedef struct fs_indexhit_s {
+	const char *name;
+	searchpath_t *search;
+	packfile_t *pakFile;
+	int order;                          // position of the search path in fs_searchpaths
+	struct fs_indexhit_s *nextName;     // next file name in the same hash bin
+	struct fs_indexhit_s *nextHit;      // the same file name in a pak that goes further in search order
+} fs_indexhit_t;
+
+typedef struct {
+	searchpath_t *search;
+	int order;
+} fs_indexdir_t;
+
+// an immutable snapshot of fs_searchpaths that merges contents of all paks into a single hash table
+typedef struct {
+	int numBins;
+	fs_indexhit_t **bins;
+	int numHits;
+	fs_indexhit_t *hits;
+	int numDirs;
+	fs_indexdir_t *dirs;                // directories in search order, these are always checked on disk
+} fs_searchindex_t;
+
+// the index is replaced as a whole when fs_searchpaths change, lookups do not lock fs_searchpaths_mutex
+static std::atomic<fs_searchindex_t *> fs_searchindex { nullptr };
+static std::atomic_int fs_searchindex_readers { 0 };
+
 static searchpath_t *fs_base_searchpaths;       // same as above, but without extra gamedirs
 static searchpath_t *fs_root_searchpath;        // base path directory
 static searchpath_t *fs_write_searchpath;       // write directory
@@ -210,21 +251,13 @@ static inline unsigned short LittleShortRaw( const uint8_t *raw ) {
 }
 
 /*
-* FS_ZipCheckFileCoherency
+* FS_ZipCheckLocalHeader
 *
-* Read the local header of the current zipfile
 * Check the coherency of the local header and info in the end of central directory about this file
 */
-static unsigned FS_ZipCheckFileCoherency( FILE *f, packfile_t *file ) {
+static unsigned FS_ZipCheckLocalHeader( const unsigned char *localHeader, packfile_t *file ) {
 	unsigned flags;
-	unsigned char localHeader[31], compressed;
-
-	if( fseek( f, Sys_VFS_FileOffset( file->vfsHandle ) + file->offset, SEEK_SET ) != 0 ) {
-		return 0;
-	}
-	if( fread( localHeader, 1, sizeof( localHeader ), f ) != sizeof( localHeader ) ) {
-		return 0;
-	}
+	unsigned char compressed;
 
 	// check the magic
 	if( LittleLongRaw( &localHeader[0] ) != FS_ZIP_LOCALHEADERMAGIC ) {
@@ -248,6 +281,37 @@ static unsigned FS_ZipCheckFileCoherency( FILE *f, packfile_t *file ) {
 	return FS_ZIP_SIZELOCALHEADER + LittleShortRaw( &localHeader[26] ) + ( unsigned )LittleShortRaw( &localHeader[28] );
 }
 
+/*
+* FS_ZipCheckFileCoherency
+*
+* Read the local header of the current zipfile and check it
+*/
+static unsigned FS_ZipCheckFileCoherency( FILE *f, packfile_t *file ) {
+	unsigned char localHeader[FS_ZIP_SIZELOCALHEADER];
+
+	if( fseek( f, Sys_VFS_FileOffset( file->vfsHandle ) + file->offset, SEEK_SET ) != 0 ) {
+		return 0;
+	}
+	if( fread( localHeader, 1, sizeof( localHeader ), f ) != sizeof( localHeader ) ) {
+		return 0;
+	}
+
+	return FS_ZipCheckLocalHeader( localHeader, file );
+}
+
+/*
+* FS_ZipCheckMappedFileCoherency
+*
+* Same as FS_ZipCheckFileCoherency for paks that are mapped into memory
+*/
+static unsigned FS_ZipCheckMappedFileCoherency( const pack_t *pack, packfile_t *file ) {
+	if( (size_t)file->offset + FS_ZIP_SIZELOCALHEADER > pack->mappingSize ) {
+		return 0;
+	}
+
+	return FS_ZipCheckLocalHeader( pack->mappingData + file->offset, file );
+}
+
 static int FS_SortStrings( const char **first, const char **second ) {
 	return Q_stricmp( *first, *second );
 }
@@ -417,6 +481,212 @@ static int FS_FileLength( FILE *f, bool close ) {
 	return end;
 }
 
+/*
+* FS_BuildSearchIndex
+*
+* Must be called with fs_searchpaths_mutex locked
+*/
+static fs_searchindex_t *FS_BuildSearchIndex( void ) {
+	int i, order, numHits, numDirs;
+	searchpath_t *search;
+	fs_searchindex_t *index;
+	fs_indexhit_t *hit, *name;
+
+	numHits = 0;
+	numDirs = 0;
+	for( search = fs_searchpaths; search; search = search->next ) {
+		if( !search->pack ) {
+			numDirs++;
+		} else if( search->pack->trie ) {
+			numHits += search->pack->numFiles;
+		}
+	}
+
+	index = ( fs_searchindex_t * )FS_Malloc( sizeof( fs_searchindex_t ) + numDirs * sizeof( fs_indexdir_t ) +
+											 numHits * sizeof( fs_indexhit_t ) + ( numHits + 1 ) * sizeof( fs_indexhit_t * ) );
+	index->dirs = ( fs_indexdir_t * )( ( uint8_t * )index + sizeof( fs_searchindex_t ) );
+	index->hits = ( fs_indexhit_t * )( ( uint8_t * )index->dirs + numDirs * sizeof( fs_indexdir_t ) );
+	index->bins = ( fs_indexhit_t ** )( ( uint8_t * )index->hits + numHits * sizeof( fs_indexhit_t ) );
+	index->numBins = numHits + 1;
+
+	for( search = fs_searchpaths, order = 0; search; search = search->next, order++ ) {
+		if( !search->pack ) {
+			index->dirs[index->numDirs].search = search;
+			index->dirs[index->numDirs].order = order;
+			index->numDirs++;
+			continue;
+		}
+
+		// deferred paks have not been loaded yet
+		if( !search->pack->trie ) {
+			continue;
+		}
+
+		for( i = 0; i < search->pack->numFiles; i++ ) {
+			packfile_t *pakFile = &search->pack->files[i];
+			const unsigned bin = COM_HashKey( pakFile->name, index->numBins );
+
+			for( name = index->bins[bin]; name; name = name->nextName ) {
+				if( !Q_stricmp( name->name, pakFile->name ) ) {
+					break;
+				}
+			}
+
+			if( name ) {
+				while( name->nextHit )
+					name = name->nextHit;
+				// duplicate entries of the same pak, the last one is in the trie
+				if( name->search == search ) {
+					name->pakFile = pakFile;
+					continue;
+				}
+			}
+
+			hit = &index->hits[index->numHits++];
+			hit->name = pakFile->name;
+			hit->search = search;
+			hit->pakFile = pakFile;
+			hit->order = order;
+
+			if( name ) {
+				name->nextHit = hit;
+			} else {
+				hit->nextName = index->bins[bin];
+				index->bins[bin] = hit;
+			}
+		}
+	}
+
+	return index;
+}
+
+/*
+* FS_InvalidateSearchIndex
+*
+* Must be called with fs_searchpaths_mutex locked before fs_searchpaths are modified.
+* Lookups fall back to walking fs_searchpaths under the lock until the index is rebuilt.
+*/
+static void FS_InvalidateSearchIndex( void ) {
+	fs_searchindex_t *index = fs_searchindex.exchange( nullptr );
+
+	if( !index ) {
+		return;
+	}
+
+	// wait for lookups that might still use the old index
+	while( fs_searchindex_readers.load() )
+		Sys_Sleep( 0 );
+
+	FS_Free( index );
+}
+
+/*
+* FS_RebuildSearchIndex
+*
+* Must be called with fs_searchpaths_mutex locked
+*/
+static void FS_RebuildSearchIndex( void ) {
+	FS_InvalidateSearchIndex();
+
+	fs_searchindex.store( FS_BuildSearchIndex() );
+}
+
+/*
+* FS_AcquireSearchIndex
+*
+* Returns NULL if the index is not available, FS_ReleaseSearchIndex must be called otherwise
+*/
+static const fs_searchindex_t *FS_AcquireSearchIndex( void ) {
+	fs_searchindex_t *index;
+
+	fs_searchindex_readers++;
+	index = fs_searchindex.load();
+	if( !index ) {
+		fs_searchindex_readers--;
+	}
+
+	return index;
+}
+
+/*
+* FS_ReleaseSearchIndex
+*/
+static void FS_ReleaseSearchIndex( void ) {
+	fs_searchindex_readers--;
+}
+
+/*
+* FS_SearchIndexForName
+*
+* Returns the first pak in search order that contains the file
+*/
+static const fs_indexhit_t *FS_SearchIndexForName( const fs_searchindex_t *index, const char *filename ) {
+	const fs_indexhit_t *name;
+
+	for( name = index->bins[COM_HashKey( filename, index->numBins )]; name; name = name->nextName ) {
+		if( !Q_stricmp( name->name, filename ) ) {
+			return name;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+* FS_FirstIndexHit
+*/
+static const fs_indexhit_t *FS_FirstIndexHit( const fs_indexhit_t *hit, fs_pure_t pure ) {
+	// purity is not a part of the index since it's changed on connection to servers
+	for( ; hit; hit = hit->nextHit ) {
+		if( hit->search->pack->pure == pure ) {
+			return hit;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+* FS_SearchIndexForFile
+*
+* Same as walking the search path in FS_SearchPathForFile.
+* Explicitly pure paks go first, then implicitly pure ones, then everything else in search order.
+*/
+static searchpath_t *FS_SearchIndexForFile( const fs_searchindex_t *index, const char *filename,
+											packfile_t **pout, char *path, size_t path_size, void **vfsHandle, int mode ) {
+	int i;
+	const fs_indexhit_t *hits, *hit;
+
+	hits = ( mode & FS_SEARCH_PAKS ) ? FS_SearchIndexForName( index, filename ) : NULL;
+
+	hit = FS_FirstIndexHit( hits, FS_PURE_EXPLICIT );
+	if( !hit ) {
+		hit = FS_FirstIndexHit( hits, FS_PURE_IMPLICIT );
+	}
+	if( !hit ) {
+		hit = FS_FirstIndexHit( hits, FS_PURE_NONE );
+
+		// loose files might be added at any time so directories are checked on disk,
+		// but only those that precede the pak in search order
+		if( mode & FS_SEARCH_DIRS ) {
+			for( i = 0; i < index->numDirs && ( !hit || index->dirs[i].order < hit->order ); i++ ) {
+				if( FS_SearchDirectoryForFile( index->dirs[i].search, filename, path, path_size, vfsHandle ) ) {
+					return index->dirs[i].search;
+				}
+			}
+		}
+	}
+
+	if( !hit ) {
+		return NULL;
+	}
+
+	if( pout ) {
+		*pout = hit->pakFile;
+	}
+	return hit->search;
+}
+
 /*
 * FS_SearchPathForFile
 *
@@ -429,6 +699,7 @@ static searchpath_t *FS_SearchPathForFile( const char *filename, packfile_t **po
 	packfile_t *implicitpure_pak;
 	bool purepass;
 	searchpath_t *result;
+	const fs_searchindex_t *index;
 
 	if( !COM_ValidateRelativeFilename( filename ) ) {
 		return NULL;
@@ -441,6 +712,13 @@ static searchpath_t *FS_SearchPathForFile( const char *filename, packfile_t **po
 		path[0] = '\0';
 	}
 
+	index = FS_AcquireSearchIndex();
+	if( index ) {
+		result = FS_SearchIndexForFile( index, filename, pout, path, path_size, vfsHandle, mode );
+		FS_ReleaseSearchIndex();
+		return result;
+	}
+
 	result = NULL;
 	purepass = true;
 	implicitpure = NULL;
@@ -753,6 +1031,47 @@ static void FS_CloseFileHandle( filehandle_t *fh ) {
 	QMutex_Unlock( fs_fh_mutex );
 }
 
+/*
+* FS_FirstExtensionInIndex
+*/
+static const char *FS_FirstExtensionInIndex( const fs_searchindex_t *index, char **filenames,
+											 const char *extensions[], int num_extensions ) {
+	int i, j, pass;
+	const fs_indexhit_t **hits, *hit, *best;
+	const char *result;
+	static const fs_pure_t passes[] = { FS_PURE_EXPLICIT, FS_PURE_IMPLICIT, FS_PURE_NONE };
+
+	hits = ( const fs_indexhit_t ** )alloca( sizeof( *hits ) * num_extensions );
+	for( i = 0; i < num_extensions; i++ )
+		hits[i] = FS_SearchIndexForName( index, filenames[i] );
+
+	best = NULL;
+	result = NULL;
+	for( pass = 0; pass < 3 && !best; pass++ ) {
+		for( i = 0; i < num_extensions; i++ ) {
+			hit = FS_FirstIndexHit( hits[i], passes[pass] );
+			if( hit && ( !best || hit->order < best->order ) ) {
+				best = hit;
+				result = extensions[i];
+			}
+		}
+		if( best && passes[pass] != FS_PURE_NONE ) {
+			return result;
+		}
+	}
+
+	for( i = 0; i < index->numDirs && ( !best || index->dirs[i].order < best->order ); i++ ) {
+		for( j = 0; j < num_extensions; j++ ) {
+			void *vfsHandle = NULL; // search in VFS as well
+			if( FS_SearchDirectoryForFile( index->dirs[i].search, filenames[j], NULL, 0, &vfsHandle ) ) {
+				return extensions[j];
+			}
+		}
+	}
+
+	return result;
+}
+
 /*
 * FS_FirstExtension
 * Searches the paths for file matching with one of the extensions
@@ -768,6 +1087,7 @@ const char *FS_FirstExtension( const char *filename, const char *extensions[], i
 	bool purepass;
 	const char *implicitpure;
 	const char *result;
+	const fs_searchindex_t *index;
 
 	assert( filename && extensions );
 
@@ -805,6 +1125,13 @@ const char *FS_FirstExtension( const char *filename, const char *extensions[], i
 		COM_ReplaceExtension( filenames[i], extensions[i], filename_size );
 	}
 
+	index = FS_AcquireSearchIndex();
+	if( index ) {
+		result = FS_FirstExtensionInIndex( index, filenames, extensions, num_extensions );
+		FS_ReleaseSearchIndex();
+		return result;
+	}
+
 	result = NULL;
 	purepass = true;
 	implicitpure = NULL;
@@ -1044,6 +1371,7 @@ static void FS_StreamDoneSimpleCb( wswcurl_req *req, int status, void *customp )
 */
 static int _FS_FOpenPakFile( packfile_t *pakFile, int *filenum ) {
 	filehandle_t *file;
+	const pack_t *pack;
 
 	*filenum = 0;
 
@@ -1054,18 +1382,27 @@ static int _FS_FOpenPakFile( packfile_t *pakFile, int *filenum ) {
 		return -1;
 	}
 
+	pack = pakFile->pack;
+
 	*filenum = FS_OpenFileHandle();
 	file = &fs_filehandles[*filenum - 1];
-	file->fstream = fopen( pakFile->vfsHandle ? Sys_VFS_VFSName( pakFile->vfsHandle ) : pakFile->pakname, "rb" );
-	if( !file->fstream ) {
-		Com_Error( ERR_FATAL, "Error opening pak file: %s", pakFile->pakname );
+	if( !pack->mappingData ) {
+		file->fstream = fopen( pakFile->vfsHandle ? Sys_VFS_VFSName( pakFile->vfsHandle ) : pakFile->pakname, "rb" );
+		if( !file->fstream ) {
+			Com_Error( ERR_FATAL, "Error opening pak file: %s", pakFile->pakname );
+		}
 	}
 	file->uncompressedSize = pakFile->uncompressedSize;
 	file->zipEntry = NULL;
 	file->pakFile = pakFile;
 
 	if( !( pakFile->flags & FS_PACKFILE_COHERENT ) ) {
-		unsigned offset = FS_ZipCheckFileCoherency( file->fstream, pakFile );
+		unsigned offset;
+		if( pack->mappingData ) {
+			offset = FS_ZipCheckMappedFileCoherency( pack, pakFile );
+		} else {
+			offset = FS_ZipCheckFileCoherency( file->fstream, pakFile );
+		}
 		if( !offset ) {
 			Com_DPrintf( "_FS_FOpenPakFile: can't get proper offset for %s\n", pakFile->name );
 			return -1;
@@ -1075,11 +1412,26 @@ static int _FS_FOpenPakFile( packfile_t *pakFile, int *filenum ) {
 	}
 	file->pakOffset = Sys_VFS_FileOffset( pakFile->vfsHandle ) + pakFile->offset;
 
+	if( pack->mappingData ) {
+		if( (size_t)file->pakOffset + pakFile->compressedSize > pack->mappingSize ) {
+			Com_DPrintf( "_FS_FOpenPakFile: %s is out of pak bounds\n", pakFile->name );
+			return -1;
+		}
+		file->pakData = pack->mappingData + file->pakOffset;
+	}
+
 	if( pakFile->flags & FS_PACKFILE_DEFLATED ) {
 		file->zipEntry = ( zipEntry_t* )Mem_Alloc( fs_mempool, sizeof( zipEntry_t ) );
 		file->zipEntry->compressedSize = pakFile->compressedSize;
 		file->zipEntry->restReadCompressed = pakFile->compressedSize;
 
+		// inflate straight from the mapping
+		if( file->pakData ) {
+			file->zipEntry->zstream.next_in = (Bytef *)file->pakData;
+			file->zipEntry->zstream.avail_in = (uInt)pakFile->compressedSize;
+			file->zipEntry->restReadCompressed = 0;
+		}
+
 		// windowBits is passed < 0 to tell that there is no zlib header.
 		// Note that in this case inflate *requires* an extra "dummy" byte
 		// after the compressed stream in order to complete decompression and
@@ -1091,7 +1443,7 @@ static int _FS_FOpenPakFile( packfile_t *pakFile, int *filenum ) {
 		}
 	}
 
-	if( fseek( file->fstream, file->pakOffset, SEEK_SET ) != 0 ) {
+	if( file->fstream && fseek( file->fstream, file->pakOffset, SEEK_SET ) != 0 ) {
 		Com_DPrintf( "_FS_FOpenPakFile: can't inflate %s\n", pakFile->name );
 		return -1;
 	}
@@ -1367,6 +1719,7 @@ void FS_FCloseFile( int file ) {
 		fclose( fh->fstream );
 		fh->fstream = NULL;
 	}
+	fh->pakData = NULL;
 	if( fh->streamHandle ) {
 		if( fh->done_cb && !fh->streamDone ) {
 			// premature closing of file, call done-callback
@@ -1420,7 +1773,8 @@ static int FS_ReadZipFile( uint8_t *buf, size_t len, filehandle_t *fh ) {
 
 	totalOutBefore = zipEntry->zstream.total_out;
 	flush = ( ( len == fh->uncompressedSize )
-			  && ( zipEntry->restReadCompressed <= FS_ZIP_BUFSIZE ) && !zipEntry->zstream.avail_in ? Z_FINISH : Z_SYNC_FLUSH );
+			  && ( fh->pakData || ( zipEntry->restReadCompressed <= FS_ZIP_BUFSIZE && !zipEntry->zstream.avail_in ) )
+			  ? Z_FINISH : Z_SYNC_FLUSH );
 
 	do {
 		// read in chunks but attempt to read the whole file first
@@ -1451,6 +1805,17 @@ static int FS_ReadZipFile( uint8_t *buf, size_t len, filehandle_t *fh ) {
 	return (int)( zipEntry->zstream.total_out - totalOutBefore );
 }
 
+/*
+* FS_ReadMappedFile
+*
+* Properly handles partial reads
+*/
+static int FS_ReadMappedFile( uint8_t *buf, size_t len, filehandle_t *fh ) {
+	len = min( len, (size_t)( fh->uncompressedSize - fh->offset ) );
+	memcpy( buf, fh->pakData + fh->offset, len );
+	return (int)len;
+}
+
 /*
 * FS_ReadFile
 *
@@ -1476,7 +1841,7 @@ int FS_Read( void *buffer, size_t len, int file ) {
 
 	fh = FS_FileHandleForNum( file );
 
-	if( fh->fstream && ( fh->pakFile || fh->vfsHandle ) && len + fh->offset > fh->uncompressedSize ) {
+	if( ( fh->fstream || fh->pakData ) && ( fh->pakFile || fh->vfsHandle ) && len + fh->offset > fh->uncompressedSize ) {
 		len = fh->uncompressedSize - fh->offset;
 		if( !len ) {
 			return 0;
@@ -1489,6 +1854,8 @@ int FS_Read( void *buffer, size_t len, int file ) {
 		total = FS_ReadStream( (uint8_t *)buffer, len, fh );
 	} else if( fh->gzstream ) {
 		total = qgzread( fh->gzstream, buffer, len );
+	} else if( fh->pakData ) {
+		total = FS_ReadMappedFile( ( uint8_t * )buffer, len, fh );
 	} else if( fh->fstream ) {
 		total = FS_ReadFile( ( uint8_t * )buffer, len, fh );
 	} else {
@@ -1667,7 +2034,7 @@ int FS_Seek( int file, int offset, int whence ) {
 		return 0;
 	}
 
-	if( !fh->fstream ) {
+	if( !fh->fstream && !fh->pakData ) {
 		return -1;
 	}
 	if( offset > (int)fh->uncompressedSize ) {
@@ -1676,6 +2043,9 @@ int FS_Seek( int file, int offset, int whence ) {
 
 	if( !fh->zipEntry ) {
 		fh->offset = offset;
+		if( fh->pakData ) {
+			return 0;
+		}
 		return fseek( fh->fstream, fh->pakOffset + offset, SEEK_SET );
 	}
 
@@ -1685,19 +2055,25 @@ int FS_Seek( int file, int offset, int whence ) {
 	if( offset > currentOffset ) {
 		offset -= currentOffset;
 	} else {
-		if( fseek( fh->fstream, fh->pakOffset, SEEK_SET ) != 0 ) {
-			return -1;
+		if( fh->pakData ) {
+			zipEntry->zstream.next_in = (Bytef *)fh->pakData;
+			zipEntry->zstream.avail_in = (uInt)zipEntry->compressedSize;
+		} else {
+			if( fseek( fh->fstream, fh->pakOffset, SEEK_SET ) != 0 ) {
+				return -1;
+			}
+
+			zipEntry->zstream.next_in = zipEntry->readBuffer;
+			zipEntry->zstream.avail_in = 0;
 		}
 
-		zipEntry->zstream.next_in = zipEntry->readBuffer;
-		zipEntry->zstream.avail_in = 0;
 		error = qzinflateReset( &zipEntry->zstream );
 		if( error != Z_OK ) {
 			Sys_Error( "FS_Seek: can't inflateReset file" );
 		}
 
 		fh->offset = 0;
-		zipEntry->restReadCompressed = zipEntry->compressedSize;
+		zipEntry->restReadCompressed = fh->pakData ? 0 : zipEntry->compressedSize;
 	}
 
 	remaining = offset;
@@ -1723,6 +2099,9 @@ int FS_Eof( int file ) {
 	if( fh->streamHandle ) {
 		return wswcurl_eof( fh->streamHandle );
 	}
+	if( fh->pakData ) {
+		return fh->offset >= fh->uncompressedSize;
+	}
 	if( fh->zipEntry ) {
 		return fh->zipEntry->restReadCompressed == 0;
 	}
@@ -1766,6 +2145,12 @@ int FS_FileNo( int file, size_t *offset ) {
 	}
 
 	fh = FS_FileHandleForNum( file );
+
+	// stored entries of mapped paks are read without the stream
+	if( fh->pakData && !fh->zipEntry && !fh->fstream ) {
+		fh->fstream = fopen( fh->pakFile->pakname, "rb" );
+	}
+
 	if( fh->fstream && !fh->zipEntry && !fh->gzstream ) {
 		if( offset ) {
 			*offset = fh->pakOffset;
@@ -1859,6 +2244,194 @@ int FS_LoadBaseFileExt( const char *path, int flags, void **buffer, void *stack,
 	return _FS_LoadFile( fhandle, len, buffer, stack, stackSize, filename, fileline );
 }
 
+/*
+* FS_LoadFileViewExt
+*
+* Files that are stored uncompressed in mapped paks are not copied, the view points to the pak mapping
+*/
+int FS_LoadFileViewExt( const char *path, int flags, const void **view, const char *filename, int fileline ) {
+	unsigned int len;
+	int fhandle;
+	filehandle_t *fh;
+	void *buffer;
+
+	*view = NULL;
+
+	len = FS_FOpenFile( path, &fhandle, FS_READ | flags );
+	if( !fhandle ) {
+		return -1;
+	}
+
+	fh = FS_FileHandleForNum( fhandle );
+	if( fh->pakData && !fh->zipEntry && !( (uintptr_t)fh->pakData & ( sizeof( int ) - 1 ) ) ) {
+		*view = fh->pakData;
+		FS_FCloseFile( fhandle );
+		return len;
+	}
+
+	len = _FS_LoadFile( fhandle, len, &buffer, NULL, 0, filename, fileline );
+	*view = buffer;
+	return len;
+}
+
+/*
+* FS_FreeFileView
+*/
+void FS_FreeFileView( const void *view ) {
+	searchpath_t *search;
+	const uint8_t *data = ( const uint8_t * )view;
+
+	if( !data ) {
+		return;
+	}
+
+	// borrowed views are released along with the pak
+	QMutex_Lock( fs_searchpaths_mutex );
+	for( search = fs_searchpaths; search; search = search->next ) {
+		if( search->pack && search->pack->mappingData ) {
+			if( data >= search->pack->mappingData && data < search->pack->mappingData + search->pack->mappingSize ) {
+				break;
+			}
+		}
+	}
+	QMutex_Unlock( fs_searchpaths_mutex );
+
+	if( !search ) {
+		FS_FreeFile( ( void * )view );
+	}
+}
+
+typedef struct {
+	const char *path;
+	void *buffer;
+	int length;
+	bool done;
+} fs_batchfile_t;
+
+typedef struct {
+	fs_batchfile_t *files;
+	int numFiles;
+	int flags;
+	int next;                   // the next file to be loaded
+	int delivered;              // the number of files that have been passed to the callback
+	qmutex_t *mutex;
+	qcondvar_t *loaded;
+	qcondvar_t *consumed;
+} fs_batch_t;
+
+/*
+* FS_LoadNextBatchFile
+*
+* Must be called with the batch mutex locked. Returns false if there's no file that can be loaded now.
+*/
+static bool FS_LoadNextBatchFile( fs_batch_t *batch ) {
+	fs_batchfile_t *file;
+
+	if( batch->next >= batch->numFiles || batch->next >= batch->delivered + FS_BATCH_MAX_AHEAD ) {
+		return false;
+	}
+
+	file = &batch->files[batch->next++];
+
+	QMutex_Unlock( batch->mutex );
+	file->length = FS_LoadFileExt( file->path, batch->flags, &file->buffer, NULL, 0, __FILE__, __LINE__ );
+	QMutex_Lock( batch->mutex );
+
+	file->done = true;
+	QCondVar_Wake( batch->loaded );
+	return true;
+}
+
+/*
+* FS_LoadFilesBatch_Job
+*/
+static void *FS_LoadFilesBatch_Job( void *parg ) {
+	fs_batch_t *batch = ( fs_batch_t * )parg;
+
+	QMutex_Lock( batch->mutex );
+	while( batch->next < batch->numFiles ) {
+		if( !FS_LoadNextBatchFile( batch ) ) {
+			QCondVar_Wait( batch->consumed, batch->mutex, Q_THREADS_WAIT_INFINITE );
+		}
+	}
+	QMutex_Unlock( batch->mutex );
+
+	return NULL;
+}
+
+/*
+* FS_LoadFilesBatch
+*/
+int FS_LoadFilesBatch( const char **paths, int numPaths, int flags, fs_batch_cb callback, void *user ) {
+	int i, numFound;
+	fs_batch_t batch;
+	fs_batchfile_t *file;
+	qthread_t *threads[FS_BATCH_NUM_THREADS - 1] = { NULL };
+	const int num_threads = min( numPaths, FS_BATCH_NUM_THREADS ) - 1;
+
+	if( numPaths <= 0 ) {
+		return 0;
+	}
+
+	batch.files = ( fs_batchfile_t * )Mem_TempMalloc( sizeof( fs_batchfile_t ) * numPaths );
+	batch.numFiles = numPaths;
+	batch.flags = flags;
+	batch.next = 0;
+	batch.delivered = 0;
+	batch.mutex = QMutex_Create();
+	batch.loaded = QCondVar_Create();
+	batch.consumed = QCondVar_Create();
+
+	for( i = 0; i < numPaths; i++ ) {
+		batch.files[i].path = paths[i];
+	}
+
+	for( i = 0; i < num_threads; i++ )
+		threads[i] = QThread_Create( FS_LoadFilesBatch_Job, &batch );
+
+	numFound = 0;
+	for( i = 0; i < numPaths; i++ ) {
+		file = &batch.files[i];
+
+		// help loading files while waiting for the next one
+		QMutex_Lock( batch.mutex );
+		while( !file->done ) {
+			if( !FS_LoadNextBatchFile( &batch ) ) {
+				QCondVar_Wait( batch.loaded, batch.mutex, Q_THREADS_WAIT_INFINITE );
+			}
+		}
+		QMutex_Unlock( batch.mutex );
+
+		if( file->buffer ) {
+			callback( i, file->path, file->buffer, file->length, user );
+			FS_FreeFile( file->buffer );
+			file->buffer = NULL;
+			numFound++;
+		}
+
+		QMutex_Lock( batch.mutex );
+		batch.delivered++;
+		QCondVar_Wake( batch.consumed );
+		QMutex_Unlock( batch.mutex );
+	}
+
+	// wake up threads that are still waiting so they can see there's nothing left
+	QMutex_Lock( batch.mutex );
+	for( i = 0; i < num_threads; i++ )
+		QCondVar_Wake( batch.consumed );
+	QMutex_Unlock( batch.mutex );
+
+	for( i = 0; i < num_threads; i++ )
+		QThread_Join( threads[i] );
+
+	QCondVar_Destroy( &batch.consumed );
+	QCondVar_Destroy( &batch.loaded );
+	QMutex_Destroy( &batch.mutex );
+	Mem_TempFree( batch.files );
+
+	return numFound;
+}
+
 /*
 * FS_MMapBaseFile
 */
@@ -2110,7 +2683,9 @@ static bool _FS_RemoveFile( const char *filename, bool base ) {
 		return false;
 	}
 
-	if( strncmp( fullname, FS_WriteDirectory(), strlen( FS_WriteDirectory() ) ) ) {
+	// Cached files may be stored outside of the write directory
+	if( strncmp( fullname, FS_WriteDirectory(), strlen( FS_WriteDirectory() ) ) &&
+		strncmp( fullname, FS_CacheDirectory(), strlen( FS_CacheDirectory() ) ) ) {
 		return false;
 	}
 
@@ -2651,6 +3226,7 @@ static pack_t *FS_LoadZipFile( const char *packfilename, bool silent ) {
 
 		file->name = names;
 		file->pakname = pack->filename;
+		file->pack = pack;
 		file->vfsHandle = vfsHandle;
 
 		offset = FS_ZipGetFileInfo( fin, vfsHandle, centralPos, byteBeforeTheZipFile, file, &len, &checksums[i] );
@@ -2693,6 +3269,16 @@ static pack_t *FS_LoadZipFile( const char *packfilename, bool silent ) {
 		}
 	}
 
+	// map the whole archive so entries are read from the page cache shared by all threads
+	// instead of opening the pak for every file. Don't exhaust the address space of 32-bit builds though.
+	if( !vfsHandle && sizeof( void * ) > 4 ) {
+		int size = FS_FileLength( fin, false );
+		if( size > 0 ) {
+			pack->mappingData = ( uint8_t * )Sys_FS_MMapFile( Sys_FS_FileNo( fin ), size, 0, &pack->mapping, &pack->mappingOffset );
+			pack->mappingSize = pack->mappingData ? (size_t)size : 0;
+		}
+	}
+
 	fclose( fin );
 	fin = NULL;
 
@@ -2724,6 +3310,9 @@ error:
 		fclose( fin );
 	}
 	if( pack ) {
+		if( pack->mappingData ) {
+			Sys_FS_UnMMapFile( pack->mapping, pack->mappingData, pack->mappingSize, pack->mappingOffset );
+		}
 		if( pack->trie ) {
 			Trie_Destroy( pack->trie );
 		}
@@ -2859,6 +3448,9 @@ static void FS_FreePakFile( pack_t *pack ) {
 	if( pack->sysHandle ) {
 		Sys_FS_UnlockFile( pack->sysHandle );
 	}
+	if( pack->mappingData ) {
+		Sys_FS_UnMMapFile( pack->mapping, pack->mappingData, pack->mappingSize, pack->mappingOffset );
+	}
 	Trie_Destroy( pack->trie );
 	FS_Free( pack->filename );
 	FS_Free( pack );
@@ -3404,7 +3996,7 @@ void FS_CreateAbsolutePath( const char *path ) {
 * NULL if not found, or file is in pak
 */
 const char *FS_AbsoluteNameForFile( const char *filename ) {
-	static char absolutename[FS_MAX_PATH];
+	static thread_local char absolutename[FS_MAX_PATH];
 	searchpath_t *search = FS_SearchPathForFile( filename, NULL, NULL, 0, NULL, FS_SEARCH_DIRS );
 
 	if( !search || search->pack ) {
@@ -3422,7 +4014,7 @@ const char *FS_AbsoluteNameForFile( const char *filename ) {
 * NULL if not found
 */
 const char *FS_AbsoluteNameForBaseFile( const char *filename ) {
-	static char absolutename[FS_MAX_PATH];
+	static thread_local char absolutename[FS_MAX_PATH];
 	searchpath_t *search = FS_SearchPathForBaseFile( filename, NULL, 0, NULL );
 
 	if( !search ) {
@@ -3615,6 +4207,8 @@ static int FS_TouchGamePath( searchpath_t *basepath, const char *gamedir, bool i
 
 	QMutex_Lock( fs_searchpaths_mutex );
 
+	FS_InvalidateSearchIndex();
+
 	// add directory to the list of search paths so pak files can stack properly
 	if( initial ) {
 		search = ( searchpath_t* )FS_Malloc( sizeof( searchpath_t ) );
@@ -3705,6 +4299,8 @@ static void FS_ReplaceDeferredPaks( void ) {
 
 	QMutex_Lock( fs_searchpaths_mutex );
 
+	FS_InvalidateSearchIndex();
+
 	// scan for deferred paks with matching shard id
 	prev = NULL;
 	for( search = fs_searchpaths; search != NULL; ) {
@@ -3829,6 +4425,8 @@ static void FS_RemoveExtraPaks( searchpath_t *old ) {
 
 	QMutex_Lock( fs_searchpaths_mutex );
 
+	FS_InvalidateSearchIndex();
+
 	// scan for many paks with same name, but different base directory, and remove extra ones
 	compare = fs_searchpaths;
 	while( compare && compare != old ) {
@@ -3865,6 +4463,8 @@ static int FS_TouchGameDirectory( const char *gamedir, bool initial ) {
 	// add for every basepath, in reverse order
 	QMutex_Lock( fs_searchpaths_mutex );
 
+	FS_InvalidateSearchIndex();
+
 	old = fs_searchpaths;
 	prev = NULL;
 	newpaks = 0;
@@ -3891,6 +4491,8 @@ static int FS_TouchGameDirectory( const char *gamedir, bool initial ) {
 		FS_RemoveExtraPaks( old );
 	}
 
+	FS_RebuildSearchIndex();
+
 	QMutex_Unlock( fs_searchpaths_mutex );
 
 	return newpaks;
@@ -3949,6 +4551,7 @@ bool FS_SetGameDirectory( const char *dir, bool force ) {
 
 	// free up any current game dir info
 	QMutex_Lock( fs_searchpaths_mutex );
+	FS_InvalidateSearchIndex();
 	while( fs_searchpaths != fs_base_searchpaths ) {
 		if( fs_searchpaths->pack ) {
 			FS_FreePakFile( fs_searchpaths->pack );
@@ -3958,6 +4561,7 @@ bool FS_SetGameDirectory( const char *dir, bool force ) {
 		FS_Free( fs_searchpaths );
 		fs_searchpaths = next;
 	}
+	FS_RebuildSearchIndex();
 	QMutex_Unlock( fs_searchpaths_mutex );
 
 	if( !strcmp( dir, fs_basegame->string ) || ( *dir == 0 ) ) {
@@ -4357,6 +4961,8 @@ void FS_Shutdown( void ) {
 
 	QMutex_Lock( fs_searchpaths_mutex );
 
+	FS_InvalidateSearchIndex();
+
 	while( fs_searchpaths ) {
 		search = fs_searchpaths;
 		fs_searchpaths = search->next;
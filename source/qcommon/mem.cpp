@@ -20,21 +20,40 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 // Z_zone.c
 
 #include "qcommon.h"
+#include "sys_threads.h"
 
 //#define MEMTRASH
 
+// use malloc for every allocation so memory checkers can see individual blocks
+//#define MEMNOSLABS
+
 #define POOLNAMESIZE 128
 
 #define MEMHEADER_SENTINEL1         0xDEADF00D
 #define MEMHEADER_SENTINEL2         0xDF
+#define MEMHEADER_SENTINEL_FREED    0xDEADBEEF
 
 #define MEMALIGNMENT_DEFAULT        16
 
+// allocations are linked into one of the pool's chains depending on the allocating thread,
+// each chain has its own lock so threads rarely wait for each other
+#define MEMPOOL_STRIPES             8
+
+// small allocations are served from size classes of blocks carved from big slabs,
+// every thread keeps a cache of free blocks of each class
+#define MEMSLAB_SIZE                ( 64 * 1024 )
+#define MEMSLAB_HEADER_SIZE         MEMALIGNMENT_DEFAULT
+#define MEMSLAB_MAX_BLOCK_SIZE      4096
+#define MEMSLAB_NUM_CLASSES         23
+#define MEMSLAB_LARGE               0xFF    // the size class of blocks allocated by malloc
+
 typedef struct memheader_s {
 	// address returned by malloc (may be significantly before this header to satisify alignment)
+	// or the beginning of the slab block
 	void *baseaddress;
 
 	// next and previous memheaders in chain belonging to pool
+	// (next is also used to link free blocks of slabs)
 	struct memheader_s *next;
 	struct memheader_s *prev;
 
@@ -51,26 +70,51 @@ typedef struct memheader_s {
 	const char *filename;
 	int fileline;
 
-	// should always be MEMHEADER_SENTINEL1
+	// pool chain the memheader is linked into
+	uint8_t stripe;
+
+	// slab size class or MEMSLAB_LARGE
+	uint8_t sizeclass;
+
+	// should always be MEMHEADER_SENTINEL1 (MEMHEADER_SENTINEL_FREED for free slab blocks)
 	unsigned int sentinel1;
 	// immediately followed by data, which is followed by a MEMHEADER_SENTINEL2 byte
 } memheader_t;
 
+// offset of data from the beginning of a slab block
+#define MEMHEADER_OFFSET            ( ( sizeof( memheader_t ) + MEMALIGNMENT_DEFAULT - 1 ) & ~( MEMALIGNMENT_DEFAULT - 1 ) )
+
+#define MEMSTRIPE_PADDING           ( 64 - 4 * sizeof( int ) - sizeof( void * ) )
+
+typedef struct {
+	volatile int lock;
+
+	// total memory allocated in this chain (inside memheaders)
+	int totalsize;
+
+	// total memory allocated in this chain (actual malloc total)
+	int realsize;
+
+	int numblocks;
+
+	// chain of individual memory allocations
+	struct memheader_s *chain;
+
+	// keep chains used by different threads on different cache lines
+	uint8_t padding[MEMSTRIPE_PADDING];
+} mempoolstripe_t;
+
 struct mempool_s {
 	// should always be MEMHEADER_SENTINEL1
 	unsigned int sentinel1;
 
-	// chain of individual memory allocations
-	struct memheader_s *chain;
+	mempoolstripe_t stripes[MEMPOOL_STRIPES];
 
 	// temporary, etc
 	int flags;
 
-	// total memory allocated in this pool (inside memheaders)
-	int totalsize;
-
-	// total memory allocated in this pool (actual malloc total)
-	int realsize;
+	// memory used by the pool itself
+	int selfsize;
 
 	// updated each time the pool is displayed by memlist, shows change from previous time (unless pool was freed)
 	int lastchecksize;
@@ -93,6 +137,81 @@ struct mempool_s {
 	unsigned int sentinel2;
 };
 
+typedef struct {
+	volatile int lock;
+	int numblocks;
+
+	// free blocks returned by threads
+	memheader_t *blocks;
+
+	// the slab blocks are being carved from and the list of all slabs of the class
+	uint8_t *slab;
+	size_t slabused;
+	int numslabs;
+} memslabdepot_t;
+
+// updated only by the owning thread, summed up when stats are requested
+typedef struct {
+	uint64_t allocs;
+	uint64_t frees;
+	uint64_t largeallocs;
+	uint64_t refills;           // blocks requested from depots
+	uint64_t contended;         // lock acquisitions that had to wait
+} memcounters_t;
+
+typedef struct memthreadcache_s {
+	memheader_t *blocks[MEMSLAB_NUM_CLASSES];
+	int numblocks[MEMSLAB_NUM_CLASSES];
+	memcounters_t counters;
+	int stripe;
+	bool registered;
+	struct memthreadcache_s *prev, *next;
+
+	~memthreadcache_s();
+} memthreadcache_t;
+
+// a chunk of memory arena allocations are bumped from, data follows the header
+typedef struct memarenablock_s {
+	struct memarenablock_s *next;
+	size_t size;
+	size_t used;
+	uint8_t padding[MEMALIGNMENT_DEFAULT - ( 2 * sizeof( size_t ) + sizeof( void * ) ) % MEMALIGNMENT_DEFAULT];
+} memarenablock_t;
+
+struct memarena_s {
+	mempool_t *pool;
+
+	// the current block goes first, older blocks are only kept till the next reset
+	memarenablock_t *blocks;
+
+	// size of a single block that is enough for the whole frame
+	size_t blocksize;
+
+	// bytes handed out since the last reset and the maximum of that over all frames
+	size_t used;
+	size_t highwater;
+
+	// resets that had to free more than one block
+	int numoverflows;
+	int numresets;
+
+	// heap allocations made by the thread that resets the arena between the last two resets,
+	// and the number of consecutive frames that made none
+	uint64_t lastallocs;
+	uint64_t frameallocs;
+	int numquietframes;
+
+	char name[POOLNAMESIZE];
+
+	// linked into the global arena list
+	struct memarena_s *prev, *next;
+};
+
+static const int memSlabClassSizes[MEMSLAB_NUM_CLASSES] = {
+	96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640,
+	768, 896, 1024, 1280, 1536, 1792, 2048, 2560, 3072, 3584, 4096
+};
+
 // ============================================================================
 
 //#define SHOW_NONFREED
@@ -109,7 +228,23 @@ mempool_t *tempMemPool;
 // only for zone
 mempool_t *zoneMemPool;
 
-static qmutex_t *memMutex;
+static uint8_t memSlabClassForSize[MEMSLAB_MAX_BLOCK_SIZE / MEMALIGNMENT_DEFAULT + 1];
+static int memSlabClassBatch[MEMSLAB_NUM_CLASSES];
+static memslabdepot_t memSlabDepots[MEMSLAB_NUM_CLASSES];
+
+static thread_local memthreadcache_t memThreadCache;
+
+// registered thread caches, for stats
+static qmutex_t *memCachesMutex;
+static memthreadcache_t *memThreadCaches;
+static memcounters_t memRetiredCounters;
+static volatile int memNextStripe;
+
+// registered arenas, for stats
+static memarena_t *memArenas;
+
+static memcounters_t memLastCounters;
+static int64_t memLastCountersTime;
 
 static bool memory_initialized = false;
 static bool commands_initialized = false;
@@ -125,10 +260,233 @@ static void _Mem_Error( const char *format, ... ) {
 	Sys_Error( "%s", msg );
 }
 
+/*
+* Mem_Lock
+*/
+static inline void Mem_Lock( volatile int *lock, memthreadcache_t *cache ) {
+	int i;
+
+	if( Sys_Atomic_CAS( lock, 0, 1, NULL ) ) {
+		return;
+	}
+
+	cache->counters.contended++;
+
+	// locks are held for a few instructions so spin for a bit before giving up the time slice
+	for( i = 0; !Sys_Atomic_CAS( lock, 0, 1, NULL ); i++ ) {
+		if( i >= 64 ) {
+			Sys_Thread_Yield();
+		}
+	}
+}
+
+/*
+* Mem_Unlock
+*/
+static inline void Mem_Unlock( volatile int *lock ) {
+	Sys_Atomic_CAS( lock, 1, 0, NULL );
+}
+
+/*
+* Mem_AddCounters
+*/
+static void Mem_AddCounters( memcounters_t *to, const memcounters_t *from ) {
+	to->allocs += from->allocs;
+	to->frees += from->frees;
+	to->largeallocs += from->largeallocs;
+	to->refills += from->refills;
+	to->contended += from->contended;
+}
+
+/*
+* Mem_ThreadCache
+*/
+static memthreadcache_t *Mem_ThreadCache( void ) {
+	memthreadcache_t *cache = &memThreadCache;
+
+	if( !cache->registered ) {
+		cache->stripe = Sys_Atomic_Add( &memNextStripe, 1, NULL ) % MEMPOOL_STRIPES;
+		cache->registered = true;
+
+		QMutex_Lock( memCachesMutex );
+		cache->prev = NULL;
+		cache->next = memThreadCaches;
+		if( cache->next ) {
+			cache->next->prev = cache;
+		}
+		memThreadCaches = cache;
+		QMutex_Unlock( memCachesMutex );
+	}
+
+	return cache;
+}
+
+/*
+* Mem_SlabClassForSize
+*/
+static inline int Mem_SlabClassForSize( size_t size, size_t alignment ) {
+#ifdef MEMNOSLABS
+	return MEMSLAB_LARGE;
+#else
+	if( alignment > MEMALIGNMENT_DEFAULT || size > MEMSLAB_MAX_BLOCK_SIZE - MEMHEADER_OFFSET - 1 ) {
+		return MEMSLAB_LARGE;
+	}
+	return memSlabClassForSize[( MEMHEADER_OFFSET + size + 1 + MEMALIGNMENT_DEFAULT - 1 ) / MEMALIGNMENT_DEFAULT];
+#endif
+}
+
+/*
+* Mem_RefillThreadCache
+*
+* Moves a batch of free blocks from the depot to the thread cache, carving new blocks from slabs if needed.
+*/
+static void Mem_RefillThreadCache( memthreadcache_t *cache, int sizeclass ) {
+	memslabdepot_t *depot = &memSlabDepots[sizeclass];
+	const size_t blocksize = memSlabClassSizes[sizeclass];
+	const int batch = memSlabClassBatch[sizeclass];
+	int count = 0;
+
+	cache->counters.refills++;
+
+	Mem_Lock( &depot->lock, cache );
+
+	while( depot->blocks && count < batch ) {
+		memheader_t *mem = depot->blocks;
+		depot->blocks = mem->next;
+		depot->numblocks--;
+
+		mem->next = cache->blocks[sizeclass];
+		cache->blocks[sizeclass] = mem;
+		count++;
+	}
+
+	while( count < batch ) {
+		uint8_t *block;
+		memheader_t *mem;
+
+		if( !depot->slab || depot->slabused + blocksize > MEMSLAB_SIZE ) {
+			uint8_t *slab = ( uint8_t * )malloc( MEMSLAB_SIZE );
+			if( slab == NULL ) {
+				_Mem_Error( "Mem_Alloc: out of memory (slab of %i byte blocks)", (int)blocksize );
+			}
+
+			// slabs of a class are linked by their first bytes
+			*( uint8_t ** )slab = depot->slab;
+			depot->slab = slab;
+			depot->slabused = MEMSLAB_HEADER_SIZE;
+			depot->numslabs++;
+		}
+
+		block = depot->slab + depot->slabused;
+		depot->slabused += blocksize;
+
+		mem = ( memheader_t * )( block + MEMHEADER_OFFSET - sizeof( memheader_t ) );
+		mem->baseaddress = block;
+		mem->sizeclass = sizeclass;
+		mem->sentinel1 = MEMHEADER_SENTINEL_FREED;
+
+		mem->next = cache->blocks[sizeclass];
+		cache->blocks[sizeclass] = mem;
+		count++;
+	}
+
+	Mem_Unlock( &depot->lock );
+
+	cache->numblocks[sizeclass] += count;
+}
+
+/*
+* Mem_FlushThreadCache
+*
+* Returns free blocks of the thread cache to the depot.
+*/
+static void Mem_FlushThreadCache( memthreadcache_t *cache, int sizeclass, int count ) {
+	memslabdepot_t *depot = &memSlabDepots[sizeclass];
+	memheader_t *first, *last;
+	int i;
+
+	count = min( count, cache->numblocks[sizeclass] );
+	if( count <= 0 ) {
+		return;
+	}
+
+	first = last = cache->blocks[sizeclass];
+	for( i = 1; i < count; i++ ) {
+		last = last->next;
+	}
+
+	cache->blocks[sizeclass] = last->next;
+	cache->numblocks[sizeclass] -= count;
+
+	Mem_Lock( &depot->lock, cache );
+	last->next = depot->blocks;
+	depot->blocks = first;
+	depot->numblocks += count;
+	Mem_Unlock( &depot->lock );
+}
+
+/*
+* memthreadcache_s::~memthreadcache_s
+*
+* Gives cached blocks back when the thread exits.
+*/
+memthreadcache_s::~memthreadcache_s() {
+	int i;
+
+	if( !registered || !memory_initialized ) {
+		return;
+	}
+
+	for( i = 0; i < MEMSLAB_NUM_CLASSES; i++ ) {
+		Mem_FlushThreadCache( this, i, numblocks[i] );
+	}
+
+	QMutex_Lock( memCachesMutex );
+	Mem_AddCounters( &memRetiredCounters, &counters );
+	if( prev ) {
+		prev->next = next;
+	} else {
+		memThreadCaches = next;
+	}
+	if( next ) {
+		next->prev = prev;
+	}
+	QMutex_Unlock( memCachesMutex );
+
+	registered = false;
+}
+
+/*
+* Mem_LinkBlock
+*/
+static void Mem_LinkBlock( mempool_t *pool, memheader_t *mem, memthreadcache_t *cache ) {
+	mempoolstripe_t *stripe = &pool->stripes[cache->stripe];
+
+	mem->stripe = cache->stripe;
+	mem->prev = NULL;
+
+	Mem_Lock( &stripe->lock, cache );
+
+	stripe->totalsize += mem->size;
+	stripe->realsize += mem->realsize;
+	stripe->numblocks++;
+
+	// append to head of list
+	mem->next = stripe->chain;
+	stripe->chain = mem;
+	if( mem->next ) {
+		mem->next->prev = mem;
+	}
+
+	Mem_Unlock( &stripe->lock );
+}
+
 ATTRIBUTE_MALLOC void *_Mem_AllocExt( mempool_t *pool, size_t size, size_t alignment, int z, int musthave, int canthave, const char *filename, int fileline ) {
 	void *base;
 	size_t realsize;
 	memheader_t *mem;
+	memthreadcache_t *cache;
+	int sizeclass;
 
 	if( size <= 0 ) {
 		return NULL;
@@ -156,21 +514,36 @@ ATTRIBUTE_MALLOC void *_Mem_AllocExt( mempool_t *pool, size_t size, size_t align
 		Com_DPrintf( format, pool->name, filename, fileline, (uint64_t)size );
 	}
 
-	QMutex_Lock( memMutex );
+	cache = Mem_ThreadCache();
+	cache->counters.allocs++;
+
+	sizeclass = Mem_SlabClassForSize( size, alignment );
+	if( sizeclass != MEMSLAB_LARGE ) {
+		if( !cache->blocks[sizeclass] ) {
+			Mem_RefillThreadCache( cache, sizeclass );
+		}
+
+		mem = cache->blocks[sizeclass];
+		cache->blocks[sizeclass] = mem->next;
+		cache->numblocks[sizeclass]--;
+
+		realsize = memSlabClassSizes[sizeclass];
+	} else {
+		realsize = sizeof( memheader_t ) + size + alignment + sizeof( int );
 
-	pool->totalsize += size;
-	realsize = sizeof( memheader_t ) + size + alignment + sizeof( int );
+		base = malloc( realsize );
+		if( base == NULL ) {
+			_Mem_Error( "Mem_Alloc: out of memory (alloc at %s:%i)", filename, fileline );
+		}
 
-	pool->realsize += realsize;
+		// calculate address that aligns the end of the memheader_t to the specified alignment
+		mem = ( memheader_t * )( ( ( (size_t)base + sizeof( memheader_t ) + ( alignment - 1 ) ) & ~( alignment - 1 ) ) - sizeof( memheader_t ) );
+		mem->baseaddress = base;
+		mem->sizeclass = MEMSLAB_LARGE;
 
-	base = malloc( realsize );
-	if( base == NULL ) {
-		_Mem_Error( "Mem_Alloc: out of memory (alloc at %s:%i)", filename, fileline );
+		cache->counters.largeallocs++;
 	}
 
-	// calculate address that aligns the end of the memheader_t to the specified alignment
-	mem = ( memheader_t * )( ( ( (size_t)base + sizeof( memheader_t ) + ( alignment - 1 ) ) & ~( alignment - 1 ) ) - sizeof( memheader_t ) );
-	mem->baseaddress = base;
 	mem->filename = filename;
 	mem->fileline = fileline;
 	mem->size = size;
@@ -181,15 +554,7 @@ ATTRIBUTE_MALLOC void *_Mem_AllocExt( mempool_t *pool, size_t size, size_t align
 	// we have to use only a single byte for this sentinel, because it may not be aligned, and some platforms can't use unaligned accesses
 	*( (uint8_t *) mem + sizeof( memheader_t ) + mem->size ) = MEMHEADER_SENTINEL2;
 
-	// append to head of list
-	mem->next = pool->chain;
-	mem->prev = NULL;
-	pool->chain = mem;
-	if( mem->next ) {
-		mem->next->prev = mem;
-	}
-
-	QMutex_Unlock( memMutex );
+	Mem_LinkBlock( pool, mem, cache );
 
 	if( z ) {
 		memset( (void *)( (uint8_t *) mem + sizeof( memheader_t ) ), 0, mem->size );
@@ -220,6 +585,20 @@ void *_Mem_Realloc( void *data, size_t size, const char *filename, int fileline
 		return data;
 	}
 
+	// grow in place if the slab block has enough room
+	if( mem->sizeclass != MEMSLAB_LARGE && MEMHEADER_OFFSET + size + 1 <= mem->realsize ) {
+		mempoolstripe_t *stripe = &mem->pool->stripes[mem->stripe];
+
+		Mem_Lock( &stripe->lock, Mem_ThreadCache() );
+		stripe->totalsize += size - mem->size;
+		Mem_Unlock( &stripe->lock );
+
+		memset( (uint8_t *)data + mem->size, 0, size - mem->size );
+		mem->size = size;
+		*( (uint8_t *) mem + sizeof( memheader_t ) + mem->size ) = MEMHEADER_SENTINEL2;
+		return data;
+	}
+
 	newdata = Mem_AllocExt( mem->pool, size, 0 );
 	memcpy( newdata, data, mem->size );
 	memset( (uint8_t *)newdata + mem->size, 0, size - mem->size );
@@ -243,6 +622,9 @@ void _Mem_Free( void *data, int musthave, int canthave, const char *filename, in
 	void *base;
 	memheader_t *mem;
 	mempool_t *pool;
+	mempoolstripe_t *stripe;
+	memthreadcache_t *cache;
+	int sizeclass;
 
 	if( data == NULL ) {
 		//_Mem_Error( "Mem_Free: data == NULL (called at %s:%i)", filename, fileline );
@@ -251,6 +633,10 @@ void _Mem_Free( void *data, int musthave, int canthave, const char *filename, in
 
 	mem = ( memheader_t * )( (uint8_t *) data - sizeof( memheader_t ) );
 
+	if( mem->sentinel1 == MEMHEADER_SENTINEL_FREED ) {
+		_Mem_Error( "Mem_Free: double freed (alloc at %s:%i, free at %s:%i)", mem->filename, mem->fileline, filename, fileline );
+	}
+
 	assert( mem->sentinel1 == MEMHEADER_SENTINEL1 );
 	assert( *( (uint8_t *) mem + sizeof( memheader_t ) + mem->size ) == MEMHEADER_SENTINEL2 );
 
@@ -274,35 +660,57 @@ void _Mem_Free( void *data, int musthave, int canthave, const char *filename, in
 		Com_DPrintf( format, pool->name, mem->filename, mem->fileline, filename, fileline, (size_t)mem->size );
 	}
 
-	QMutex_Lock( memMutex );
+	cache = Mem_ThreadCache();
+	cache->counters.frees++;
+
+	stripe = &pool->stripes[mem->stripe];
+
+	Mem_Lock( &stripe->lock, cache );
 
 	// unlink memheader from doubly linked list
-	if( ( mem->prev ? mem->prev->next != mem : pool->chain != mem ) || ( mem->next && mem->next->prev != mem ) ) {
+	if( ( mem->prev ? mem->prev->next != mem : stripe->chain != mem ) || ( mem->next && mem->next->prev != mem ) ) {
+		Mem_Unlock( &stripe->lock );
 		_Mem_Error( "Mem_Free: not allocated or double freed (free at %s:%i)", filename, fileline );
 	}
 
 	if( mem->prev ) {
 		mem->prev->next = mem->next;
 	} else {
-		pool->chain = mem->next;
+		stripe->chain = mem->next;
 	}
 	if( mem->next ) {
 		mem->next->prev = mem->prev;
 	}
 
 	// memheader has been unlinked, do the actual free now
-	pool->totalsize -= mem->size;
+	stripe->totalsize -= mem->size;
+	stripe->realsize -= mem->realsize;
+	stripe->numblocks--;
 
-	base = mem->baseaddress;
-	pool->realsize -= mem->realsize;
+	Mem_Unlock( &stripe->lock );
 
-	QMutex_Unlock( memMutex );
+	base = mem->baseaddress;
+	sizeclass = mem->sizeclass;
 
 #ifdef MEMTRASH
 	memset( mem, 0xBF, sizeof( memheader_t ) + mem->size + sizeof( int ) );
 #endif
 
-	free( base );
+	if( sizeclass == MEMSLAB_LARGE ) {
+		free( base );
+		return;
+	}
+
+	// the header has to stay valid so the block can be recognized later
+	mem->baseaddress = base;
+	mem->sizeclass = sizeclass;
+	mem->sentinel1 = MEMHEADER_SENTINEL_FREED;
+
+	mem->next = cache->blocks[sizeclass];
+	cache->blocks[sizeclass] = mem;
+	if( ++cache->numblocks[sizeclass] > memSlabClassBatch[sizeclass] * 2 ) {
+		Mem_FlushThreadCache( cache, sizeclass, memSlabClassBatch[sizeclass] );
+	}
 }
 
 mempool_t *_Mem_AllocPool( mempool_t *parent, const char *name, int flags, const char *filename, int fileline ) {
@@ -326,11 +734,9 @@ mempool_t *_Mem_AllocPool( mempool_t *parent, const char *name, int flags, const
 	pool->filename = filename;
 	pool->fileline = fileline;
 	pool->flags = flags;
-	pool->chain = NULL;
 	pool->parent = parent;
 	pool->child = NULL;
-	pool->totalsize = 0;
-	pool->realsize = sizeof( mempool_t );
+	pool->selfsize = sizeof( mempool_t );
 	Q_strncpyz( pool->name, name, sizeof( pool->name ) );
 
 	if( parent ) {
@@ -353,10 +759,60 @@ mempool_t *_Mem_AllocTempPool( const char *name, const char *filename, int filel
 	return pool;
 }
 
+/*
+* Mem_PoolSizes
+*
+* Sums up counters of all chains of the pool, not including children.
+*/
+static void Mem_PoolSizes( mempool_t *pool, int *totalsize, int *realsize, int *numblocks ) {
+	int i;
+
+	for( i = 0; i < MEMPOOL_STRIPES; i++ ) {
+		const mempoolstripe_t *stripe = &pool->stripes[i];
+
+		if( totalsize ) {
+			( *totalsize ) += stripe->totalsize;
+		}
+		if( realsize ) {
+			( *realsize ) += stripe->realsize;
+		}
+		if( numblocks ) {
+			( *numblocks ) += stripe->numblocks;
+		}
+	}
+}
+
+/*
+* Mem_PrintPoolAllocations
+*/
+static void Mem_PrintPoolAllocations( mempool_t *pool ) {
+	int i;
+	memheader_t *mem;
+
+	for( i = 0; i < MEMPOOL_STRIPES; i++ ) {
+		for( mem = pool->stripes[i].chain; mem; mem = mem->next )
+			Com_Printf( "%10" PRIu64 " bytes allocated at %s:%i\n", (uint64_t)mem->size, mem->filename, mem->fileline );
+	}
+}
+
+/*
+* Mem_FreePoolAllocations
+*/
+static void Mem_FreePoolAllocations( mempool_t *pool ) {
+	int i;
+
+	for( i = 0; i < MEMPOOL_STRIPES; i++ ) {
+		mempoolstripe_t *stripe = &pool->stripes[i];
+
+		while( stripe->chain )  // free memory owned by the pool
+			Mem_Free( (void *)( (uint8_t *)stripe->chain + sizeof( memheader_t ) ) );
+	}
+}
+
 void _Mem_FreePool( mempool_t **pool, int musthave, int canthave, const char *filename, int fileline ) {
 	mempool_t **chainAddress;
 #ifdef SHOW_NONFREED
-	memheader_t *mem;
+	int numblocks = 0;
 #endif
 
 	if( !( *pool ) ) {
@@ -388,11 +844,10 @@ void _Mem_FreePool( mempool_t **pool, int musthave, int canthave, const char *fi
 	}
 
 #ifdef SHOW_NONFREED
-	if( ( *pool )->chain ) {
+	Mem_PoolSizes( *pool, NULL, NULL, &numblocks );
+	if( numblocks ) {
 		Com_Printf( "Warning: Memory pool %s has resources that weren't freed:\n", ( *pool )->name );
-	}
-	for( mem = ( *pool )->chain; mem; mem = mem->next ) {
-		Com_Printf( "%10i bytes allocated at %s:%i\n", mem->size, mem->filename, mem->fileline );
+		Mem_PrintPoolAllocations( *pool );
 	}
 #endif
 
@@ -407,8 +862,7 @@ void _Mem_FreePool( mempool_t **pool, int musthave, int canthave, const char *fi
 		_Mem_Error( "Mem_FreePool: pool already free (freepool at %s:%i)", filename, fileline );
 	}
 
-	while( ( *pool )->chain )  // free memory owned by the pool
-		Mem_Free( (void *)( (uint8_t *)( *pool )->chain + sizeof( memheader_t ) ) );
+	Mem_FreePoolAllocations( *pool );
 
 	*chainAddress = ( *pool )->next;
 
@@ -423,7 +877,7 @@ void _Mem_FreePool( mempool_t **pool, int musthave, int canthave, const char *fi
 void _Mem_EmptyPool( mempool_t *pool, int musthave, int canthave, const char *filename, int fileline ) {
 	mempool_t *child, *next;
 #ifdef SHOW_NONFREED
-	memheader_t *mem;
+	int numblocks = 0;
 #endif
 
 	if( pool == NULL ) {
@@ -455,21 +909,188 @@ void _Mem_EmptyPool( mempool_t *pool, int musthave, int canthave, const char *fi
 	}
 
 #ifdef SHOW_NONFREED
-	if( pool->chain ) {
+	Mem_PoolSizes( pool, NULL, NULL, &numblocks );
+	if( numblocks ) {
 		Com_Printf( "Warning: Memory pool %s has resources that weren't freed:\n", pool->name );
-	}
-	for( mem = pool->chain; mem; mem = mem->next ) {
-		Com_Printf( "%10i bytes allocated at %s:%i\n", mem->size, mem->filename, mem->fileline );
+		Mem_PrintPoolAllocations( pool );
 	}
 #endif
-	while( pool->chain )        // free memory owned by the pool
-		Mem_Free( (void *)( (uint8_t *) pool->chain + sizeof( memheader_t ) ) );
+	Mem_FreePoolAllocations( pool );
 }
 
 size_t Mem_PoolTotalSize( mempool_t *pool ) {
+	int totalsize = 0;
+
 	assert( pool != NULL );
 
-	return pool->totalsize;
+	Mem_PoolSizes( pool, &totalsize, NULL, NULL );
+	return totalsize;
+}
+
+/*
+* Mem_ArenaAllocBlock
+*/
+static memarenablock_t *Mem_ArenaAllocBlock( memarena_t *arena, size_t size, const char *filename, int fileline ) {
+	memarenablock_t *block;
+
+	block = ( memarenablock_t * )_Mem_AllocExt( arena->pool, sizeof( memarenablock_t ) + size, 0, 0, 0, 0, filename, fileline );
+	block->next = NULL;
+	block->size = size;
+	block->used = 0;
+	return block;
+}
+
+/*
+* _Mem_ArenaBegin
+*/
+memarena_t *_Mem_ArenaBegin( mempool_t *pool, const char *name, size_t blocksize, const char *filename, int fileline ) {
+	memarena_t *arena;
+
+	if( pool == NULL ) {
+		_Mem_Error( "Mem_ArenaBegin: pool == NULL (arena at %s:%i)", filename, fileline );
+	}
+
+	arena = ( memarena_t * )_Mem_Alloc( pool, sizeof( memarena_t ), 0, 0, filename, fileline );
+	arena->pool = pool;
+	arena->blocksize = ( max( blocksize, (size_t)MEMALIGNMENT_DEFAULT ) + MEMALIGNMENT_DEFAULT - 1 ) & ~( MEMALIGNMENT_DEFAULT - 1 );
+	arena->blocks = Mem_ArenaAllocBlock( arena, arena->blocksize, filename, fileline );
+	arena->lastallocs = Mem_ThreadCache()->counters.allocs;
+	Q_strncpyz( arena->name, name, sizeof( arena->name ) );
+
+	QMutex_Lock( memCachesMutex );
+	arena->next = memArenas;
+	if( memArenas ) {
+		memArenas->prev = arena;
+	}
+	memArenas = arena;
+	QMutex_Unlock( memCachesMutex );
+
+	return arena;
+}
+
+/*
+* _Mem_ArenaAlloc
+*
+* Bumps zeroed memory from the current block. The memory is valid till the next reset,
+* an arena must only be used by a single thread at a time.
+*/
+void *_Mem_ArenaAlloc( memarena_t *arena, size_t size, const char *filename, int fileline ) {
+	void *data;
+	memarenablock_t *block;
+
+	if( arena == NULL ) {
+		_Mem_Error( "Mem_ArenaAlloc: arena == NULL (called at %s:%i)", filename, fileline );
+	}
+
+	size = ( max( size, (size_t)1 ) + MEMALIGNMENT_DEFAULT - 1 ) & ~( MEMALIGNMENT_DEFAULT - 1 );
+
+	block = arena->blocks;
+	if( block->used + size > block->size ) {
+		// the frame needs more than the block has, chain a new one for the rest of the frame
+		block = Mem_ArenaAllocBlock( arena, max( size, arena->blocksize ), filename, fileline );
+		block->next = arena->blocks;
+		arena->blocks = block;
+	}
+
+	data = ( uint8_t * )block + sizeof( memarenablock_t ) + block->used;
+	block->used += size;
+
+	arena->used += size;
+	if( arena->used > arena->highwater ) {
+		arena->highwater = arena->used;
+	}
+
+	memset( data, 0, size );
+	return data;
+}
+
+/*
+* Mem_ArenaCountFrameAllocs
+*
+* Counts the heap allocations the frame that ends with this reset made on the calling thread,
+* a steady-state frame that gets all of its transient memory from arenas makes none.
+*/
+static void Mem_ArenaCountFrameAllocs( memarena_t *arena ) {
+	const uint64_t allocs = Mem_ThreadCache()->counters.allocs;
+
+	arena->frameallocs = allocs - arena->lastallocs;
+	arena->lastallocs = allocs;
+
+	if( arena->frameallocs ) {
+		arena->numquietframes = 0;
+	} else {
+		arena->numquietframes++;
+	}
+}
+
+/*
+* Mem_ArenaReset
+*
+* Releases all allocations of the arena at once. If the frame did not fit into a single block,
+* the blocks are replaced by one that fits the high-water mark so steady-state frames never reach the heap.
+*/
+void Mem_ArenaReset( memarena_t *arena ) {
+	memarenablock_t *block, *next;
+
+	assert( arena != NULL );
+
+	arena->numresets++;
+	arena->used = 0;
+
+	if( !arena->blocks->next ) {
+		arena->blocks->used = 0;
+		Mem_ArenaCountFrameAllocs( arena );
+		return;
+	}
+
+	for( block = arena->blocks; block; block = next ) {
+		next = block->next;
+		Mem_Free( block );
+	}
+
+	arena->numoverflows++;
+	arena->blocksize = arena->highwater;
+	arena->blocks = Mem_ArenaAllocBlock( arena, arena->blocksize, __FILE__, __LINE__ );
+	Mem_ArenaCountFrameAllocs( arena );
+
+	if( developer_memory && developer_memory->integer ) {
+		Com_DPrintf( "Mem_ArenaReset: arena %s grown to %" PRIu64 " bytes\n", arena->name, (uint64_t)arena->blocksize );
+	}
+}
+
+/*
+* Mem_ArenaEnd
+*
+* Must be called before the pool of the arena is freed or emptied.
+*/
+void Mem_ArenaEnd( memarena_t **parena ) {
+	memarena_t *arena;
+	memarenablock_t *block, *next;
+
+	if( !parena || !*parena ) {
+		return;
+	}
+
+	arena = *parena;
+
+	QMutex_Lock( memCachesMutex );
+	if( arena->prev ) {
+		arena->prev->next = arena->next;
+	} else {
+		memArenas = arena->next;
+	}
+	if( arena->next ) {
+		arena->next->prev = arena->prev;
+	}
+	QMutex_Unlock( memCachesMutex );
+
+	for( block = arena->blocks; block; block = next ) {
+		next = block->next;
+		Mem_Free( block );
+	}
+	Mem_Free( arena );
+
+	*parena = NULL;
 }
 
 void _Mem_CheckSentinels( void *data, const char *filename, int fileline ) {
@@ -493,8 +1114,10 @@ void _Mem_CheckSentinels( void *data, const char *filename, int fileline ) {
 }
 
 static void _Mem_CheckSentinelsPool( mempool_t *pool, const char *filename, int fileline ) {
+	int i;
 	memheader_t *mem;
 	mempool_t *child;
+	memthreadcache_t *cache = Mem_ThreadCache();
 
 	// recurse into children
 	if( pool->child ) {
@@ -512,8 +1135,14 @@ static void _Mem_CheckSentinelsPool( mempool_t *pool, const char *filename, int
 		_Mem_Error( "_Mem_CheckSentinelsPool: trashed pool sentinel 2 (allocpool at %s:%i, sentinel check at %s:%i)", pool->filename, pool->fileline, filename, fileline );
 	}
 
-	for( mem = pool->chain; mem; mem = mem->next )
-		_Mem_CheckSentinels( (void *)( (uint8_t *) mem + sizeof( memheader_t ) ), filename, fileline );
+	for( i = 0; i < MEMPOOL_STRIPES; i++ ) {
+		mempoolstripe_t *stripe = &pool->stripes[i];
+
+		Mem_Lock( &stripe->lock, cache );
+		for( mem = stripe->chain; mem; mem = mem->next )
+			_Mem_CheckSentinels( (void *)( (uint8_t *) mem + sizeof( memheader_t ) ), filename, fileline );
+		Mem_Unlock( &stripe->lock );
+	}
 }
 
 void _Mem_CheckSentinelsGlobal( const char *filename, int fileline ) {
@@ -535,19 +1164,16 @@ static void Mem_CountPoolStats( mempool_t *pool, int *count, int *size, int *rea
 	if( count ) {
 		( *count )++;
 	}
-	if( size ) {
-		( *size ) += pool->totalsize;
-	}
 	if( realsize ) {
-		( *realsize ) += pool->realsize;
+		( *realsize ) += pool->selfsize;
 	}
+	Mem_PoolSizes( pool, size, realsize, NULL );
 }
 
 static void Mem_PrintStats( void ) {
 	int count, size, real;
 	int total, totalsize, realsize;
 	mempool_t *pool;
-	memheader_t *mem;
 
 	Mem_CheckSentinelsGlobal();
 
@@ -562,20 +1188,24 @@ static void Mem_PrintStats( void ) {
 
 	// temporary pools are not nested
 	for( pool = poolChain; pool; pool = pool->next ) {
-		if( ( pool->flags & MEMPOOL_TEMPORARY ) && pool->chain ) {
-			Com_Printf( "%i bytes (%.3fMB) (%i bytes (%.3fMB actual)) of temporary memory still allocated (Leak!)\n", pool->totalsize, pool->totalsize / 1048576.0,
-						pool->realsize, pool->realsize / 1048576.0 );
+		if( !( pool->flags & MEMPOOL_TEMPORARY ) ) {
+			continue;
+		}
+
+		size = real = count = 0;
+		Mem_PoolSizes( pool, &size, &real, &count );
+		if( count ) {
+			Com_Printf( "%i bytes (%.3fMB) (%i bytes (%.3fMB actual)) of temporary memory still allocated (Leak!)\n", size, size / 1048576.0,
+						real, real / 1048576.0 );
 			Com_Printf( "listing temporary memory allocations for %s:\n", pool->name );
 
-			for( mem = tempMemPool->chain; mem; mem = mem->next )
-				Com_Printf( "%10" PRIu64 " bytes allocated at %s:%i\n", (uint64_t)mem->size, mem->filename, mem->fileline );
+			Mem_PrintPoolAllocations( pool );
 		}
 	}
 }
 
 static void Mem_PrintPoolStats( mempool_t *pool, int listchildren, int listallocations ) {
 	mempool_t *child;
-	memheader_t *mem;
 	int totalsize = 0, realsize = 0;
 
 	Mem_CountPoolStats( pool, NULL, &totalsize, &realsize );
@@ -597,8 +1227,7 @@ static void Mem_PrintPoolStats( mempool_t *pool, int listchildren, int listalloc
 	pool->lastchecksize = totalsize;
 
 	if( listallocations ) {
-		for( mem = pool->chain; mem; mem = mem->next )
-			Com_Printf( "%10" PRIu64 " bytes allocated at %s:%i\n", (uint64_t)mem->size, mem->filename, mem->fileline );
+		Mem_PrintPoolAllocations( pool );
 	}
 
 	if( listchildren ) {
@@ -653,9 +1282,73 @@ static void MemList_f( void ) {
 	Com_Printf( "MemList_f: unknown pool name '%s'. Usage: [all|pool]\n", name );
 }
 
+/*
+* Mem_PrintAllocatorStats
+*
+* Prints the state of slabs and thread caches and allocation rates since the previous call.
+*/
+static void Mem_PrintAllocatorStats( void ) {
+	int i;
+	int numslabs = 0, numthreads = 0;
+	size_t depotsize = 0, cachedsize = 0;
+	memcounters_t counters;
+	memthreadcache_t *cache;
+	const int64_t now = Sys_Milliseconds();
+
+	for( i = 0; i < MEMSLAB_NUM_CLASSES; i++ ) {
+		numslabs += memSlabDepots[i].numslabs;
+		depotsize += (size_t)memSlabDepots[i].numblocks * memSlabClassSizes[i];
+	}
+
+	QMutex_Lock( memCachesMutex );
+	counters = memRetiredCounters;
+	for( cache = memThreadCaches; cache; cache = cache->next ) {
+		Mem_AddCounters( &counters, &cache->counters );
+		for( i = 0; i < MEMSLAB_NUM_CLASSES; i++ ) {
+			cachedsize += (size_t)cache->numblocks[i] * memSlabClassSizes[i];
+		}
+		numthreads++;
+	}
+	QMutex_Unlock( memCachesMutex );
+
+	Com_Printf( "%i slabs (%.3fMB), %.3fMB free in depots, %.3fMB free in caches of %i threads\n",
+				numslabs, numslabs * ( MEMSLAB_SIZE / 1048576.0 ), depotsize / 1048576.0, cachedsize / 1048576.0, numthreads );
+	Com_Printf( "%" PRIu64 " allocations (%" PRIu64 " large), %" PRIu64 " frees, %" PRIu64 " cache refills, %" PRIu64 " contended locks\n",
+				counters.allocs, counters.largeallocs, counters.frees, counters.refills, counters.contended );
+
+	if( memLastCountersTime && now > memLastCountersTime ) {
+		const double seconds = ( now - memLastCountersTime ) * 0.001;
+		Com_Printf( "since last memstats: %.1f allocations/s, %.1f frees/s, %.1f contended locks/s\n",
+					( counters.allocs - memLastCounters.allocs ) / seconds, ( counters.frees - memLastCounters.frees ) / seconds,
+					( counters.contended - memLastCounters.contended ) / seconds );
+	}
+
+	memLastCounters = counters;
+	memLastCountersTime = now;
+}
+
+/*
+* Mem_PrintArenaStats
+*/
+static void Mem_PrintArenaStats( void ) {
+	memarena_t *arena;
+
+	QMutex_Lock( memCachesMutex );
+	for( arena = memArenas; arena; arena = arena->next ) {
+		Com_Printf( "arena %s: %" PRIu64 " bytes used, %" PRIu64 " high-water, %" PRIu64 " block, %i of %i resets overflowed\n",
+					arena->name, (uint64_t)arena->used, (uint64_t)arena->highwater, (uint64_t)arena->blocksize,
+					arena->numoverflows, arena->numresets );
+		Com_Printf( "  %" PRIu64 " heap allocations in the last frame, %i frames in a row without any%s\n",
+					arena->frameallocs, arena->numquietframes, arena->numquietframes ? " (steady state)" : "" );
+	}
+	QMutex_Unlock( memCachesMutex );
+}
+
 static void MemStats_f( void ) {
 	Mem_CheckSentinelsGlobal();
 	Mem_PrintStats();
+	Mem_PrintAllocatorStats();
+	Mem_PrintArenaStats();
 }
 
 
@@ -663,14 +1356,29 @@ static void MemStats_f( void ) {
 * Memory_Init
 */
 void Memory_Init( void ) {
+	int i, size;
+
 	assert( !memory_initialized );
 
-	memMutex = QMutex_Create();
+	memCachesMutex = QMutex_Create();
 
-	zoneMemPool = Mem_AllocPool( NULL, "Zone" );
-	tempMemPool = Mem_AllocTempPool( "Temporary Memory" );
+	// map block sizes rounded up to the alignment to the smallest fitting class
+	for( i = 0, size = 0; size <= MEMSLAB_MAX_BLOCK_SIZE; size += MEMALIGNMENT_DEFAULT ) {
+		while( memSlabClassSizes[i] < size ) {
+			i++;
+		}
+		memSlabClassForSize[size / MEMALIGNMENT_DEFAULT] = i;
+	}
+
+	// move about 8KB at once between thread caches and depots
+	for( i = 0; i < MEMSLAB_NUM_CLASSES; i++ ) {
+		memSlabClassBatch[i] = bound( 4, 8192 / memSlabClassSizes[i], 32 );
+	}
 
 	memory_initialized = true;
+
+	zoneMemPool = Mem_AllocPool( NULL, "Zone" );
+	tempMemPool = Mem_AllocTempPool( "Temporary Memory" );
 }
 
 /*
@@ -693,7 +1401,9 @@ void Memory_InitCommands( void ) {
 * NOTE: Should be the last called function before shutdown!
 */
 void Memory_Shutdown( void ) {
+	int i;
 	mempool_t *pool, *next;
+	memthreadcache_t *cache;
 
 	if( !memory_initialized ) {
 		return;
@@ -717,7 +1427,34 @@ void Memory_Shutdown( void ) {
 		Mem_FreePool( &pool );
 	}
 
-	QMutex_Destroy( &memMutex );
+	// threads are not supposed to allocate anymore, forget about their caches
+	QMutex_Lock( memCachesMutex );
+	for( cache = memThreadCaches; cache; cache = cache->next ) {
+		for( i = 0; i < MEMSLAB_NUM_CLASSES; i++ ) {
+			cache->blocks[i] = NULL;
+			cache->numblocks[i] = 0;
+		}
+		cache->registered = false;
+	}
+	memThreadCaches = NULL;
+	memArenas = NULL;
+	QMutex_Unlock( memCachesMutex );
+
+	for( i = 0; i < MEMSLAB_NUM_CLASSES; i++ ) {
+		memslabdepot_t *depot = &memSlabDepots[i];
+
+		while( depot->slab ) {
+			uint8_t *slab = depot->slab;
+			depot->slab = *( uint8_t ** )slab;
+			free( slab );
+		}
+		memset( depot, 0, sizeof( *depot ) );
+	}
+
+	memset( &memRetiredCounters, 0, sizeof( memRetiredCounters ) );
+	memLastCountersTime = 0;
+
+	QMutex_Destroy( &memCachesMutex );
 
 	memory_initialized = false;
 }
@@ -302,7 +302,8 @@ int MSG_SkipData( msg_t *msg, size_t length ) {
 
 static char *MSG_ReadString2( msg_t *msg, bool linebreak ) {
 	int l, c;
-	static char string[MAX_MSG_STRING_CHARS];
+	// messages might be parsed by different threads at the same time (see the demo analysis tool)
+	static thread_local char string[MAX_MSG_STRING_CHARS];
 
 	l = 0;
 	do {
@@ -62,7 +62,7 @@ typedef struct {
 } loopback_t;
 
 static loopback_t loopbacks[2];
-static char errorstring[MAX_PRINTMSG];
+static thread_local char errorstring[MAX_PRINTMSG];   // sockets are used by the server browser thread too
 static bool net_initialized = false;
 
 #define MAX_IPS 16
@@ -630,6 +630,16 @@ void    FS_FreeBaseFile( void *buffer );
 #define FS_LoadBaseFile( path,buffer,stack,stacksize ) FS_LoadBaseFileExt( path,0,buffer,stack,stacksize,__FILE__,__LINE__ )
 #define FS_LoadCacheFile( path,buffer,stack,stacksize ) FS_LoadFileExt( path,FS_CACHE,buffer,stack,stacksize,__FILE__,__LINE__ )
 
+// a read-only view of the file contents aligned to the size of int, that must be released with FS_FreeFileView.
+// unlike FS_LoadFile, the contents are not null-terminated and must not be used after the game directory changes.
+int     FS_LoadFileViewExt( const char *path, int flags, const void **view, const char *filename, int fileline );
+void    FS_FreeFileView( const void *view );
+#define FS_LoadFileView( path,view ) FS_LoadFileViewExt( path,0,view,__FILE__,__LINE__ )
+
+// loads and decompresses files on several threads, the callback is called on the calling thread
+// in the order of paths as soon as the file is loaded. Returns the number of files that have been found.
+int     FS_LoadFilesBatch( const char **paths, int numPaths, int flags, fs_batch_cb callback, void *user );
+
 /**
 * Maps an existing file on disk for reading.
 * Does *not* work for compressed virtual files.
@@ -774,6 +784,15 @@ void _Mem_CheckSentinelsGlobal( const char *filename, int fileline );
 
 size_t Mem_PoolTotalSize( mempool_t *pool );
 
+// bump allocators for memory that only lives till the end of a frame
+struct memarena_s;
+typedef struct memarena_s memarena_t;
+
+memarena_t *_Mem_ArenaBegin( mempool_t *pool, const char *name, size_t blocksize, const char *filename, int fileline );
+ATTRIBUTE_MALLOC void *_Mem_ArenaAlloc( memarena_t *arena, size_t size, const char *filename, int fileline );
+void Mem_ArenaReset( memarena_t *arena );
+void Mem_ArenaEnd( memarena_t **arena );
+
 #define Mem_AllocExt( pool, size, z ) _Mem_AllocExt( pool, size, 0, z, 0, 0, __FILE__, __LINE__ )
 #define Mem_Alloc( pool, size ) _Mem_Alloc( pool, size, 0, 0, __FILE__, __LINE__ )
 #define Mem_Realloc( data, size ) _Mem_Realloc( data, size, __FILE__, __LINE__ )
@@ -783,6 +802,8 @@ size_t Mem_PoolTotalSize( mempool_t *pool );
 #define Mem_FreePool( pool ) _Mem_FreePool( pool, 0, 0, __FILE__, __LINE__ )
 #define Mem_EmptyPool( pool ) _Mem_EmptyPool( pool, 0, 0, __FILE__, __LINE__ )
 #define Mem_CopyString( pool, str ) _Mem_CopyString( pool, str, __FILE__, __LINE__ )
+#define Mem_ArenaBegin( pool, name, blocksize ) _Mem_ArenaBegin( pool, name, blocksize, __FILE__, __LINE__ )
+#define Mem_ArenaAlloc( arena, size ) _Mem_ArenaAlloc( arena, size, __FILE__, __LINE__ )
 
 #define Mem_CheckSentinels( data ) _Mem_CheckSentinels( data, __FILE__, __LINE__ )
 #define Mem_CheckSentinelsGlobal() _Mem_CheckSentinelsGlobal( __FILE__, __LINE__ )
@@ -35,6 +35,8 @@ typedef struct qcondvar_s qcondvar_t;
 struct qbufPipe_s;
 typedef struct qbufPipe_s qbufPipe_t;
 
+typedef struct qtaskgroup_s qtaskgroup_t;
+
 qmutex_t *QMutex_Create( void );
 void QMutex_Destroy( qmutex_t **pmutex );
 void QMutex_Lock( qmutex_t *mutex );
@@ -52,13 +54,27 @@ void QThread_Yield( void );
 
 void QThreads_Init( void );
 void QThreads_Shutdown( void );
+void QThreads_InitCommands( void );
+void QThreads_ShutdownCommands( void );
 
 qbufPipe_t *QBufPipe_Create( size_t bufSize, int flags );
+void QBufPipe_SetName( qbufPipe_t *queue, const char *name );
 void QBufPipe_Destroy( qbufPipe_t **pqueue );
 void QBufPipe_Finish( qbufPipe_t *queue );
 void QBufPipe_WriteCmd( qbufPipe_t *queue, const void *cmd, unsigned cmd_size );
+bool QBufPipe_TryWriteCmd( qbufPipe_t *queue, const void *cmd, unsigned cmd_size );
 int QBufPipe_ReadCmds( qbufPipe_t *queue, unsigned( **cmdHandlers )( const void * ) );
 void QBufPipe_Wait( qbufPipe_t *queue, int ( *read )( qbufPipe_t *, unsigned( ** )( const void * ), bool ),
 					unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec );
 
+void QTasks_Init( void );
+void QTasks_Shutdown( void );
+unsigned QTasks_NumWorkers( void );
+qtaskgroup_t *QTaskGroup_Create( void );
+void QTaskGroup_Destroy( qtaskgroup_t **pgroup );
+void QTaskGroup_Wait( qtaskgroup_t *group );
+void QTask_Spawn( qtaskgroup_t *group, void ( *func )( void * ), const void *arg, size_t argSize );
+void QTask_ParallelFor( qtaskgroup_t *group, void ( *func )( unsigned, unsigned, void * ), const void *arg, size_t argSize,
+						unsigned items, unsigned grain );
+
 #endif // Q_THREADS_H
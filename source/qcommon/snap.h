@@ -10,6 +10,44 @@ extern "C" {
 // define this 0 to disable compression of demo files
 #define SNAP_DEMO_GZ                    FS_GZ
 
+// demos periodically store non-delta frames (keyframes) prefixed by a full configstrings set
+// and an index of keyframes in the meta data, so a playback can start from any keyframe
+#define SNAP_DEMO_KEYFRAME_INTERVAL     10000
+#define SNAP_MAX_DEMO_KEYFRAMES         256
+#define SNAP_DEMO_META_KEYFRAMES_KEY    "keyframes"
+
+// svc_extension id of a configstring that is stored along with a keyframe
+#define SNAP_DEMO_EXT_CONFIGSTRING      1
+
+typedef struct {
+	int64_t serverTime;
+	int offset;                         // uncompressed demo file offset of the keyframe configstrings message
+} snapDemoKeyframe_t;
+
+typedef struct {
+	int64_t interval;
+	unsigned numKeyframes;
+	snapDemoKeyframe_t keyframes[SNAP_MAX_DEMO_KEYFRAMES];
+} snapDemoIndex_t;
+
+// writes demo messages to a file in a separate thread
+struct snapDemoWriter_s;
+typedef struct snapDemoWriter_s snapDemoWriter_t;
+
+typedef struct {
+	unsigned numQueued;
+	unsigned numDropped;
+	unsigned numWritten;
+	unsigned numBatches;
+	int queueSize;
+	int pendingBytes;
+	int maxPendingBytes;
+	uint64_t bytesWritten;
+	uint64_t avgLatencyMicros;          // from queueing a message to returning from the file write
+	uint64_t maxLatencyMicros;
+	uint64_t writeMicros;               // total time spent in file writes
+} snapDemoWriterStats_t;
+
 void SNAP_ParseBaseline( struct msg_s *msg, entity_state_t *baselines );
 void SNAP_SkipFrame( struct msg_s *msg, struct snapshot_s *header );
 struct snapshot_s *SNAP_ParseFrame( struct msg_s *msg, struct snapshot_s *lastFrame, int *suppressCount,
@@ -60,6 +98,22 @@ size_t SNAP_ClearDemoMeta( char *meta_data, size_t meta_data_max_size );
 size_t SNAP_SetDemoMetaKeyValue( char *meta_data, size_t meta_data_max_size, size_t meta_data_realsize,
 								 const char *key, const char *value );
 size_t SNAP_ReadDemoMetaData( int demofile, char *meta_data, size_t meta_data_size );
+void SNAP_ClearDemoIndex( snapDemoIndex_t *index );
+bool SNAP_DemoKeyframeDue( const snapDemoIndex_t *index, int64_t serverTime );
+void SNAP_RecordDemoKeyframe( int demofile, snapDemoWriter_t *writer, snapDemoIndex_t *index,
+							  int64_t serverTime, const char *configstrings );
+size_t SNAP_SetDemoMetaIndex( char *meta_data, size_t meta_data_max_size, size_t meta_data_realsize,
+							  const snapDemoIndex_t *index );
+unsigned SNAP_ReadDemoMetaIndex( const char *meta_data, size_t meta_data_realsize,
+								 snapDemoKeyframe_t *keyframes, unsigned max_keyframes );
+const snapDemoKeyframe_t *SNAP_FindDemoKeyframe( const snapDemoKeyframe_t *keyframes, unsigned num_keyframes,
+												 int64_t serverTime );
+
+snapDemoWriter_t *SNAP_CreateDemoWriter( int demofile, int queueSize, bool dropOnOverflow );
+void SNAP_DestroyDemoWriter( snapDemoWriter_t **pwriter );
+bool SNAP_QueueDemoMessage( snapDemoWriter_t *writer, struct msg_s *msg, bool droppable );
+int SNAP_DemoWriterOffset( const snapDemoWriter_t *writer );
+void SNAP_GetDemoWriterStats( snapDemoWriter_t *writer, snapDemoWriterStats_t *stats );
 
 #ifdef __cplusplus
 }
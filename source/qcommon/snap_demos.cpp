@@ -19,6 +19,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 
 #include "qcommon.h"
+#include "sys_threads.h"
 
 #define DEMO_SAFEWRITE( demofile,msg,force ) \
 	if( force || ( msg )->cursize > ( msg )->maxsize / 2 ) \
@@ -410,3 +411,497 @@ size_t SNAP_ReadDemoMetaData( int demofile, char *meta_data, size_t meta_data_si
 
 	return meta_data_realsize;
 }
+
+/*
+* SNAP_ClearDemoIndex
+*/
+void SNAP_ClearDemoIndex( snapDemoIndex_t *index ) {
+	index->interval = SNAP_DEMO_KEYFRAME_INTERVAL;
+	index->numKeyframes = 0;
+}
+
+/*
+* SNAP_DemoKeyframeDue
+*/
+bool SNAP_DemoKeyframeDue( const snapDemoIndex_t *index, int64_t serverTime ) {
+	if( !index->numKeyframes ) {
+		return true;
+	}
+	return serverTime >= index->keyframes[index->numKeyframes - 1].serverTime + index->interval;
+}
+
+/*
+* SNAP_RecordDemoKeyframe
+*
+* Must be called right before the message that contains a non-delta frame
+* for the given server time is written to the demo file.
+* If the writer is specified, messages are queued to it instead of writing to the file directly.
+*/
+void SNAP_RecordDemoKeyframe( int demofile, snapDemoWriter_t *writer, snapDemoIndex_t *index,
+							  int64_t serverTime, const char *configstrings ) {
+	unsigned i;
+	int offset;
+	msg_t msg;
+	uint8_t msg_buffer[MAX_MSGLEN];
+	snapDemoKeyframe_t *keyframe;
+
+	if( !demofile ) {
+		return;
+	}
+
+	offset = writer ? SNAP_DemoWriterOffset( writer ) : FS_Tell( demofile );
+	if( offset < 0 ) {
+		return;
+	}
+
+	// the index is full, drop every other keyframe and make following ones sparser
+	if( index->numKeyframes == SNAP_MAX_DEMO_KEYFRAMES ) {
+		for( i = 0; i < SNAP_MAX_DEMO_KEYFRAMES / 2; i++ ) {
+			index->keyframes[i] = index->keyframes[i * 2];
+		}
+		index->numKeyframes = SNAP_MAX_DEMO_KEYFRAMES / 2;
+		index->interval *= 2;
+	}
+
+	keyframe = &index->keyframes[index->numKeyframes++];
+	keyframe->serverTime = serverTime;
+	keyframe->offset = offset;
+
+	// configstrings are wrapped in extension commands, so a regular playback skips them
+	MSG_Init( &msg, msg_buffer, sizeof( msg_buffer ) );
+
+	for( i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
+		const char *configstring = configstrings + i * MAX_CONFIGSTRING_CHARS;
+		const size_t len = strlen( configstring );
+		if( !len ) {
+			continue;
+		}
+
+		MSG_WriteUint8( &msg, svc_extension );
+		MSG_WriteUint8( &msg, SNAP_DEMO_EXT_CONFIGSTRING );
+		MSG_WriteUint8( &msg, 1 ); // version
+		MSG_WriteInt16( &msg, (int)( sizeof( short ) + len + 1 ) );
+		MSG_WriteInt16( &msg, i );
+		MSG_WriteData( &msg, configstring, len + 1 );
+
+		if( msg.cursize > msg.maxsize / 2 ) {
+			if( writer ) {
+				SNAP_QueueDemoMessage( writer, &msg, false );
+			} else {
+				SNAP_RecordDemoMessage( demofile, &msg, 0 );
+			}
+			MSG_Clear( &msg );
+		}
+	}
+
+	if( writer ) {
+		SNAP_QueueDemoMessage( writer, &msg, false );
+	} else {
+		SNAP_RecordDemoMessage( demofile, &msg, 0 );
+	}
+}
+
+/*
+* SNAP_SetDemoMetaIndex
+*
+* Stores the keyframes index as a meta data value of "time:offset" pairs separated by spaces.
+*/
+size_t SNAP_SetDemoMetaIndex( char *meta_data, size_t meta_data_max_size, size_t meta_data_realsize,
+							  const snapDemoIndex_t *index ) {
+	unsigned i;
+	size_t len, value_size;
+	char *value;
+
+	if( !index->numKeyframes ) {
+		return meta_data_realsize;
+	}
+
+	value_size = index->numKeyframes * 32;
+	value = (char *)Mem_TempMalloc( value_size );
+
+	for( i = 0, len = 0; i < index->numKeyframes; i++ ) {
+		const snapDemoKeyframe_t *keyframe = &index->keyframes[i];
+		Q_snprintfz( value + len, value_size - len, "%s%" PRIi64 ":%i", i ? " " : "", keyframe->serverTime, keyframe->offset );
+		len += strlen( value + len );
+	}
+
+	meta_data_realsize = SNAP_SetDemoMetaKeyValue( meta_data, meta_data_max_size, meta_data_realsize,
+												   SNAP_DEMO_META_KEYFRAMES_KEY, value );
+
+	Mem_TempFree( value );
+
+	return meta_data_realsize;
+}
+
+/*
+* SNAP_ReadDemoMetaIndex
+*
+* Returns the number of keyframes, zero for demos that do not have an index.
+*/
+unsigned SNAP_ReadDemoMetaIndex( const char *meta_data, size_t meta_data_realsize,
+								 snapDemoKeyframe_t *keyframes, unsigned max_keyframes ) {
+	const char *s, *val;
+	const char *end = meta_data + meta_data_realsize;
+	unsigned num_keyframes = 0;
+
+	for( s = meta_data; s < end && *s; ) {
+		val = s + strlen( s ) + 1;
+		if( val >= end ) {
+			break;
+		}
+
+		if( Q_stricmp( s, SNAP_DEMO_META_KEYFRAMES_KEY ) ) {
+			s = val + strlen( val ) + 1;
+			continue;
+		}
+
+		while( val < end && *val && num_keyframes < max_keyframes ) {
+			char *sep, *next;
+			snapDemoKeyframe_t *keyframe = &keyframes[num_keyframes];
+
+			keyframe->serverTime = strtoll( val, &sep, 10 );
+			if( *sep != ':' ) {
+				break;
+			}
+			keyframe->offset = (int)strtol( sep + 1, &next, 10 );
+			if( next == sep + 1 || keyframe->offset < 0 ) {
+				break;
+			}
+			// keyframes must be sorted by time for the binary search
+			if( num_keyframes && keyframe->serverTime <= keyframes[num_keyframes - 1].serverTime ) {
+				break;
+			}
+
+			num_keyframes++;
+			for( val = next; *val == ' '; val++ ) ;
+		}
+		break;
+	}
+
+	return num_keyframes;
+}
+
+/*
+* SNAP_FindDemoKeyframe
+*
+* Returns the latest keyframe that is not past the given server time.
+*/
+const snapDemoKeyframe_t *SNAP_FindDemoKeyframe( const snapDemoKeyframe_t *keyframes, unsigned num_keyframes,
+												 int64_t serverTime ) {
+	unsigned lo = 0, hi = num_keyframes;
+
+	while( lo < hi ) {
+		const unsigned mid = lo + ( hi - lo ) / 2;
+		if( keyframes[mid].serverTime <= serverTime ) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo ? &keyframes[lo - 1] : NULL;
+}
+
+/*
+=============================================================================
+
+ASYNCHRONOUS DEMO WRITER
+
+Messages are copied to a command pipe and written to the file by a separate thread,
+so compression and disk stalls do not affect the thread that produces messages.
+
+=============================================================================
+*/
+
+#define DEMO_WRITER_BATCH_SIZE  ( MAX_MSGLEN * 4 )
+
+enum {
+	DEMO_WRITER_CMD_WRITE,
+	DEMO_WRITER_CMD_QUIT,
+
+	NUM_DEMO_WRITER_CMDS
+};
+
+typedef struct {
+	int id;
+	int len;
+	snapDemoWriter_t *writer;
+	uint64_t queuedAt;
+} demoWriterWriteCmd_t;
+
+typedef struct {
+	int id;
+	snapDemoWriter_t *writer;
+} demoWriterQuitCmd_t;
+
+struct snapDemoWriter_s {
+	int demofile;
+	bool dropOnOverflow;
+	int queueSize;
+	qbufPipe_t *pipe;
+	qthread_t *thread;
+	qmutex_t *mutex;
+
+	volatile int pendingBytes;
+
+	// accessed by the producer thread only
+	int offset;
+	unsigned numQueued;
+	unsigned numDropped;
+	int maxPendingBytes;
+	uint8_t *cmdbuf;
+
+	// accessed by the writer thread only
+	uint8_t *batch;
+	size_t batchSize;
+	unsigned batchMessages;
+	uint64_t batchQueuedAtSum;
+	uint64_t batchFirstQueuedAt;
+
+	// written by the writer thread under the mutex
+	unsigned numWritten;
+	unsigned numBatches;
+	uint64_t bytesWritten;
+	uint64_t latencySum;
+	uint64_t latencyMax;
+	uint64_t writeMicros;
+};
+
+/*
+* SNAP_DemoWriterCmdSize
+*/
+static int SNAP_DemoWriterCmdSize( int len ) {
+	// keep commands aligned in the pipe
+	return (int)( ( sizeof( demoWriterWriteCmd_t ) + len + 7 ) & ~7 );
+}
+
+/*
+* SNAP_FlushDemoWriterBatch
+*/
+static void SNAP_FlushDemoWriterBatch( snapDemoWriter_t *writer ) {
+	uint64_t startedAt, now;
+
+	if( !writer->batchSize ) {
+		return;
+	}
+
+	startedAt = Sys_Microseconds();
+	FS_Write( writer->batch, writer->batchSize, writer->demofile );
+	now = Sys_Microseconds();
+
+	QMutex_Lock( writer->mutex );
+	writer->numWritten += writer->batchMessages;
+	writer->numBatches++;
+	writer->bytesWritten += writer->batchSize;
+	writer->latencySum += now * writer->batchMessages - writer->batchQueuedAtSum;
+	writer->latencyMax = max( writer->latencyMax, now - writer->batchFirstQueuedAt );
+	writer->writeMicros += now - startedAt;
+	QMutex_Unlock( writer->mutex );
+
+	writer->batchSize = 0;
+	writer->batchMessages = 0;
+	writer->batchQueuedAtSum = 0;
+}
+
+/*
+* SNAP_DemoWriterHandleWriteCmd
+*/
+static unsigned SNAP_DemoWriterHandleWriteCmd( const void *pcmd ) {
+	const demoWriterWriteCmd_t *cmd = (const demoWriterWriteCmd_t *)pcmd;
+	snapDemoWriter_t *writer = cmd->writer;
+	const int cmdSize = SNAP_DemoWriterCmdSize( cmd->len );
+	int len;
+
+	if( writer->batchSize + sizeof( int ) + cmd->len > DEMO_WRITER_BATCH_SIZE ) {
+		SNAP_FlushDemoWriterBatch( writer );
+	}
+
+	if( !writer->batchMessages ) {
+		writer->batchFirstQueuedAt = cmd->queuedAt;
+	}
+
+	// the same layout as SNAP_RecordDemoMessage() produces
+	len = LittleLong( cmd->len );
+	memcpy( writer->batch + writer->batchSize, &len, sizeof( int ) );
+	memcpy( writer->batch + writer->batchSize + sizeof( int ), cmd + 1, cmd->len );
+	writer->batchSize += sizeof( int ) + cmd->len;
+	writer->batchMessages++;
+	writer->batchQueuedAtSum += cmd->queuedAt;
+
+	Sys_Atomic_Add( &writer->pendingBytes, -cmdSize, writer->mutex );
+
+	return cmdSize;
+}
+
+/*
+* SNAP_DemoWriterHandleQuitCmd
+*/
+static unsigned SNAP_DemoWriterHandleQuitCmd( const void *pcmd ) {
+	return 0;
+}
+
+typedef struct {
+	unsigned( *cmdHandlers[NUM_DEMO_WRITER_CMDS] )( const void * );
+	snapDemoWriter_t *writer;
+} demoWriterThreadContext_t;
+
+/*
+* SNAP_DemoWriterCmdsWaiter
+*/
+static int SNAP_DemoWriterCmdsWaiter( qbufPipe_t *queue, unsigned( **cmdHandlers )( const void * ), bool timeout ) {
+	// handlers are the first member of the thread context
+	const demoWriterThreadContext_t *context = (const demoWriterThreadContext_t *)cmdHandlers;
+	int read = QBufPipe_ReadCmds( queue, cmdHandlers );
+
+	// the pipe is drained (or the writer is quitting), write everything that has been collected so far
+	SNAP_FlushDemoWriterBatch( context->writer );
+
+	return read;
+}
+
+/*
+* SNAP_DemoWriterThreadProc
+*/
+static void *SNAP_DemoWriterThreadProc( void *param ) {
+	demoWriterThreadContext_t context =
+	{
+		{
+			SNAP_DemoWriterHandleWriteCmd,
+			SNAP_DemoWriterHandleQuitCmd,
+		},
+		(snapDemoWriter_t *)param
+	};
+
+	QBufPipe_Wait( context.writer->pipe, SNAP_DemoWriterCmdsWaiter, context.cmdHandlers, Q_THREADS_WAIT_INFINITE );
+
+	return NULL;
+}
+
+/*
+* SNAP_CreateDemoWriter
+*
+* The demo file must not be accessed until the writer is destroyed.
+* The queue size is specified in bytes.
+*/
+snapDemoWriter_t *SNAP_CreateDemoWriter( int demofile, int queueSize, bool dropOnOverflow ) {
+	snapDemoWriter_t *writer;
+
+	// a queue must be able to hold at least a pair of largest messages
+	queueSize = max( queueSize, SNAP_DemoWriterCmdSize( MAX_MSGLEN ) * 4 );
+
+	writer = (snapDemoWriter_t *)Mem_ZoneMalloc( sizeof( *writer ) );
+	writer->demofile = demofile;
+	writer->dropOnOverflow = dropOnOverflow;
+	writer->queueSize = queueSize;
+	writer->offset = FS_Tell( demofile );
+	writer->batch = (uint8_t *)Mem_ZoneMalloc( DEMO_WRITER_BATCH_SIZE );
+	writer->cmdbuf = (uint8_t *)Mem_ZoneMalloc( SNAP_DemoWriterCmdSize( MAX_MSGLEN ) );
+	writer->mutex = QMutex_Create();
+	// writes never block on the pipe level unless the queue is really full, overflows are handled by the writer
+	writer->pipe = QBufPipe_Create( queueSize, QBUFPIPE_BLOCKWRITE );
+	QBufPipe_SetName( writer->pipe, "demo writer" );
+	writer->thread = QThread_Create( SNAP_DemoWriterThreadProc, writer );
+
+	return writer;
+}
+
+/*
+* SNAP_DestroyDemoWriter
+*
+* Writes all queued messages and stops the writer thread.
+*/
+void SNAP_DestroyDemoWriter( snapDemoWriter_t **pwriter ) {
+	snapDemoWriter_t *writer = *pwriter;
+	demoWriterQuitCmd_t cmd;
+
+	if( !writer ) {
+		return;
+	}
+
+	*pwriter = NULL;
+
+	cmd.id = DEMO_WRITER_CMD_QUIT;
+	cmd.writer = writer;
+	QBufPipe_WriteCmd( writer->pipe, &cmd, sizeof( cmd ) );
+	QThread_Join( writer->thread );
+
+	QBufPipe_Destroy( &writer->pipe );
+	QMutex_Destroy( &writer->mutex );
+
+	Mem_ZoneFree( writer->cmdbuf );
+	Mem_ZoneFree( writer->batch );
+	Mem_ZoneFree( writer );
+}
+
+/*
+* SNAP_QueueDemoMessage
+*
+* Only droppable messages may be dropped if the writer has been created with dropOnOverflow,
+* others always wait for the queue space.
+* Returns false if the message has been dropped due to the queue overflow.
+*/
+bool SNAP_QueueDemoMessage( snapDemoWriter_t *writer, msg_t *msg, bool droppable ) {
+	demoWriterWriteCmd_t *cmd;
+	int cmdSize, pendingBytes;
+
+	if( !msg->cursize ) {
+		return true;
+	}
+
+	cmdSize = SNAP_DemoWriterCmdSize( msg->cursize );
+
+	// rewinding the pipe might waste up to a size of a command
+	pendingBytes = Sys_Atomic_Add( &writer->pendingBytes, 0, writer->mutex );
+	if( pendingBytes + cmdSize * 2 + (int)sizeof( int ) > writer->queueSize ) {
+		if( writer->dropOnOverflow && droppable ) {
+			writer->numDropped++;
+			return false;
+		}
+	}
+
+	cmd = (demoWriterWriteCmd_t *)writer->cmdbuf;
+	cmd->id = DEMO_WRITER_CMD_WRITE;
+	cmd->len = msg->cursize;
+	cmd->writer = writer;
+	cmd->queuedAt = Sys_Microseconds();
+	memcpy( cmd + 1, msg->data, msg->cursize );
+
+	pendingBytes = Sys_Atomic_Add( &writer->pendingBytes, cmdSize, writer->mutex );
+	writer->maxPendingBytes = max( writer->maxPendingBytes, pendingBytes + cmdSize );
+
+	// blocks if the queue is full
+	QBufPipe_WriteCmd( writer->pipe, cmd, cmdSize );
+
+	writer->offset += sizeof( int ) + msg->cursize;
+	writer->numQueued++;
+	return true;
+}
+
+/*
+* SNAP_DemoWriterOffset
+*
+* Returns an offset in the uncompressed demo file the next queued message is going to be written at.
+*/
+int SNAP_DemoWriterOffset( const snapDemoWriter_t *writer ) {
+	return writer->offset;
+}
+
+/*
+* SNAP_GetDemoWriterStats
+*/
+void SNAP_GetDemoWriterStats( snapDemoWriter_t *writer, snapDemoWriterStats_t *stats ) {
+	stats->numQueued = writer->numQueued;
+	stats->numDropped = writer->numDropped;
+	stats->queueSize = writer->queueSize;
+	stats->pendingBytes = Sys_Atomic_Add( &writer->pendingBytes, 0, writer->mutex );
+	stats->maxPendingBytes = writer->maxPendingBytes;
+
+	QMutex_Lock( writer->mutex );
+	stats->numWritten = writer->numWritten;
+	stats->numBatches = writer->numBatches;
+	stats->bytesWritten = writer->bytesWritten;
+	stats->avgLatencyMicros = writer->numWritten ? writer->latencySum / writer->numWritten : 0;
+	stats->maxLatencyMicros = writer->latencyMax;
+	stats->writeMicros = writer->writeMicros;
+	QMutex_Unlock( writer->mutex );
+}
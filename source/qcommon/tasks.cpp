@@ -0,0 +1,624 @@
+// tasks.cpp -- engine-wide worker threads shared by all modules
+//
+// Every worker owns a deque of tasks: it pushes and pops tasks at the bottom,
+// idle workers steal from the top of deques of others. Threads that are not workers
+// (the main thread, the sound thread, etc) push tasks to a shared deque. A thread that
+// waits for a group helps executing tasks of that group only and parks till the group
+// completes when none of them are left in deques. Deques are guarded by tiny spinlocks
+// that are contended only when a steal hits the deque the owner is working with.
+
+#include "qcommon.h"
+#include "sys_threads.h"
+
+#include <atomic>
+#include <new>
+
+#define QTASKS_MAX_WORKERS          32
+#define QTASK_DEQUE_SIZE            1024    // must be a power of two
+#define QTASK_ARG_SIZE              64
+
+// yields before an idle worker parks
+#define QTASK_IDLE_SPINS            64
+// yields before a thread waiting for a group without runnable tasks parks
+#define QTASK_WAIT_SPINS            8
+#define QTASK_PARK_MSEC             100
+
+typedef struct {
+	qtaskgroup_t *group;
+	qtaskfunc_t func;
+	qtaskrangefunc_t rangefunc;
+	unsigned first;
+	unsigned items;
+	union {
+		uint8_t bytes[QTASK_ARG_SIZE];
+		void *p;
+		double d;
+		int64_t i;
+	} arg;
+} qtask_t;
+
+typedef struct {
+	volatile int lock;
+
+	// tasks are popped from the bottom by the owner and stolen from the top,
+	// both are only changed under the lock but are peeked at without it
+	std::atomic<unsigned> top;
+	std::atomic<unsigned> bottom;
+
+	qtask_t tasks[QTASK_DEQUE_SIZE];
+
+	// keep locks of different deques on different cache lines
+	uint8_t padding[64];
+} qtaskdeque_t;
+
+struct qtaskgroup_s {
+	std::atomic<int> pending;
+};
+
+// a thread parked in QTaskGroup_Wait till the group completes
+typedef struct qtaskwaiter_s {
+	const qtaskgroup_t *group;
+	qcondvar_t *condvar;
+	struct qtaskwaiter_s *next;
+} qtaskwaiter_t;
+
+// the condition variable a thread parks on, created on the first wait
+typedef struct qtaskthreadcondvar_s {
+	qcondvar_t *condvar;
+
+	~qtaskthreadcondvar_s() {
+		QCondVar_Destroy( &condvar );
+	}
+} qtaskthreadcondvar_t;
+
+static bool qtasksInitialized;
+static unsigned qtaskNumThreads;
+static qthread_t *qtaskThreads[QTASKS_MAX_WORKERS];
+
+// one deque per worker, followed by the deque shared by threads that are not workers
+static qtaskdeque_t *qtaskDeques;
+static unsigned qtaskNumDeques;
+
+// tasks that are in deques, idle workers park when there are none
+static std::atomic<int> qtaskQueued;
+static std::atomic<int> qtaskSleepers;
+static std::atomic<int> qtaskQuit;
+static qmutex_t *qtaskSleepMutex;
+static qcondvar_t *qtaskSleepCondvar;
+
+static thread_local int qtaskWorkerNum = -1;
+
+// threads parked till their groups complete, the number of submitted tasks tells them
+// whether a task was queued after they had looked for one
+static std::atomic<int> qtaskNumWaiters;
+static std::atomic<unsigned> qtaskNumSubmits;
+static qtaskwaiter_t *qtaskWaiters;
+static qmutex_t *qtaskWaitMutex;
+
+static thread_local qtaskthreadcondvar_t qtaskThreadCondvar;
+
+static cvar_t *com_workerthreads;
+
+/*
+* QTask_LockDeque
+*/
+static inline void QTask_LockDeque( qtaskdeque_t *deque ) {
+	while( !Sys_Atomic_CAS( &deque->lock, 0, 1, NULL ) ) {
+		QThread_Yield();
+	}
+}
+
+/*
+* QTask_UnlockDeque
+*/
+static inline void QTask_UnlockDeque( qtaskdeque_t *deque ) {
+	Sys_Atomic_CAS( &deque->lock, 1, 0, NULL );
+}
+
+/*
+* QTask_DequeEmpty
+*/
+static inline bool QTask_DequeEmpty( const qtaskdeque_t *deque ) {
+	return deque->bottom.load( std::memory_order_relaxed ) == deque->top.load( std::memory_order_relaxed );
+}
+
+/*
+* QTask_Push
+*
+* Returns false if the deque is full.
+*/
+static bool QTask_Push( qtaskdeque_t *deque, const qtask_t *task ) {
+	unsigned bottom;
+
+	QTask_LockDeque( deque );
+	bottom = deque->bottom.load( std::memory_order_relaxed );
+	if( bottom - deque->top.load( std::memory_order_relaxed ) == QTASK_DEQUE_SIZE ) {
+		QTask_UnlockDeque( deque );
+		return false;
+	}
+	deque->tasks[bottom & ( QTASK_DEQUE_SIZE - 1 )] = *task;
+	deque->bottom.store( bottom + 1, std::memory_order_relaxed );
+	QTask_UnlockDeque( deque );
+	return true;
+}
+
+/*
+* QTask_Pop
+*/
+static bool QTask_Pop( qtaskdeque_t *deque, qtask_t *task ) {
+	unsigned bottom;
+
+	if( QTask_DequeEmpty( deque ) ) {
+		return false;
+	}
+
+	QTask_LockDeque( deque );
+	if( QTask_DequeEmpty( deque ) ) {
+		QTask_UnlockDeque( deque );
+		return false;
+	}
+	bottom = deque->bottom.load( std::memory_order_relaxed ) - 1;
+	*task = deque->tasks[bottom & ( QTASK_DEQUE_SIZE - 1 )];
+	deque->bottom.store( bottom, std::memory_order_relaxed );
+	QTask_UnlockDeque( deque );
+	return true;
+}
+
+/*
+* QTask_Steal
+*
+* Gives up instead of waiting if someone else is using the deque.
+*/
+static bool QTask_Steal( qtaskdeque_t *deque, qtask_t *task ) {
+	unsigned top;
+
+	if( QTask_DequeEmpty( deque ) ) {
+		return false;
+	}
+
+	if( !Sys_Atomic_CAS( &deque->lock, 0, 1, NULL ) ) {
+		return false;
+	}
+	if( QTask_DequeEmpty( deque ) ) {
+		QTask_UnlockDeque( deque );
+		return false;
+	}
+	top = deque->top.load( std::memory_order_relaxed );
+	*task = deque->tasks[top & ( QTASK_DEQUE_SIZE - 1 )];
+	deque->top.store( top + 1, std::memory_order_relaxed );
+	QTask_UnlockDeque( deque );
+	return true;
+}
+
+/*
+* QTask_TakeGroupTask
+*
+* Takes the newest task of the group from the deque, the hole is filled with the newest task.
+* Waits for the lock, as giving up could leave the waiting thread parked while its tasks are queued.
+*/
+static bool QTask_TakeGroupTask( qtaskdeque_t *deque, const qtaskgroup_t *group, qtask_t *task ) {
+	unsigned i, top, bottom;
+	qtask_t *slot;
+
+	if( QTask_DequeEmpty( deque ) ) {
+		return false;
+	}
+
+	QTask_LockDeque( deque );
+
+	top = deque->top.load( std::memory_order_relaxed );
+	bottom = deque->bottom.load( std::memory_order_relaxed );
+	for( i = bottom; i != top; i-- ) {
+		slot = &deque->tasks[( i - 1 ) & ( QTASK_DEQUE_SIZE - 1 )];
+		if( slot->group != group ) {
+			continue;
+		}
+
+		*task = *slot;
+		*slot = deque->tasks[( bottom - 1 ) & ( QTASK_DEQUE_SIZE - 1 )];
+		deque->bottom.store( bottom - 1, std::memory_order_relaxed );
+		QTask_UnlockDeque( deque );
+		return true;
+	}
+
+	QTask_UnlockDeque( deque );
+	return false;
+}
+
+/*
+* QTask_TakeFromGroup
+*
+* Takes a task of the given group from any deque, starting with the one of the calling thread.
+*/
+static bool QTask_TakeFromGroup( const qtaskgroup_t *group, qtask_t *task ) {
+	unsigned i, start;
+	const int worker = qtaskWorkerNum;
+
+	if( !qtaskQueued.load( std::memory_order_relaxed ) ) {
+		return false;
+	}
+
+	start = worker >= 0 ? worker : qtaskNumDeques - 1;
+	for( i = 0; i < qtaskNumDeques; i++ ) {
+		qtaskdeque_t *deque = &qtaskDeques[( start + i ) % qtaskNumDeques];
+		if( QTask_TakeGroupTask( deque, group, task ) ) {
+			qtaskQueued.fetch_sub( 1 );
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+* QTask_Take
+*
+* Takes a task from the deque of the calling worker or steals one from others.
+*/
+static bool QTask_Take( qtask_t *task ) {
+	unsigned i, start;
+	const int worker = qtaskWorkerNum;
+
+	if( !qtaskQueued.load( std::memory_order_relaxed ) ) {
+		return false;
+	}
+
+	if( worker >= 0 && QTask_Pop( &qtaskDeques[worker], task ) ) {
+		qtaskQueued.fetch_sub( 1 );
+		return true;
+	}
+
+	// start with the shared deque for non-workers, with the next one for workers
+	start = worker >= 0 ? worker + 1 : qtaskNumDeques - 1;
+	for( i = 0; i < qtaskNumDeques; i++ ) {
+		qtaskdeque_t *deque = &qtaskDeques[( start + i ) % qtaskNumDeques];
+		if( QTask_Steal( deque, task ) ) {
+			qtaskQueued.fetch_sub( 1 );
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+* QTask_WakeWaiters
+*/
+static void QTask_WakeWaiters( const qtaskgroup_t *group ) {
+	qtaskwaiter_t *waiter;
+
+	QMutex_Lock( qtaskWaitMutex );
+	for( waiter = qtaskWaiters; waiter; waiter = waiter->next ) {
+		if( waiter->group == group ) {
+			QCondVar_Wake( waiter->condvar );
+		}
+	}
+	QMutex_Unlock( qtaskWaitMutex );
+}
+
+/*
+* QTask_ParkTillDone
+*
+* Sleeps till the group completes or gets a new task. Returns right away if any task
+* was submitted since numSubmits had been read, as it might belong to the group.
+*/
+static void QTask_ParkTillDone( const qtaskgroup_t *group, unsigned numSubmits ) {
+	qtaskwaiter_t waiter, **prev;
+
+	if( !qtaskThreadCondvar.condvar ) {
+		qtaskThreadCondvar.condvar = QCondVar_Create();
+	}
+
+	waiter.group = group;
+	waiter.condvar = qtaskThreadCondvar.condvar;
+
+	QMutex_Lock( qtaskWaitMutex );
+	waiter.next = qtaskWaiters;
+	qtaskWaiters = &waiter;
+	qtaskNumWaiters.fetch_add( 1 );
+
+	if( group->pending.load() > 0 && qtaskNumSubmits.load() == numSubmits ) {
+		QCondVar_Wait( waiter.condvar, qtaskWaitMutex, QTASK_PARK_MSEC );
+	}
+
+	for( prev = &qtaskWaiters; *prev != &waiter; prev = &( *prev )->next );
+	*prev = waiter.next;
+	qtaskNumWaiters.fetch_sub( 1 );
+	QMutex_Unlock( qtaskWaitMutex );
+}
+
+/*
+* QTask_Execute
+*/
+static void QTask_Execute( qtask_t *task ) {
+	qtaskgroup_t *group = task->group;
+
+	if( task->func ) {
+		task->func( task->arg.bytes );
+	} else {
+		task->rangefunc( task->first, task->items, task->arg.bytes );
+	}
+
+	// sequentially consistent so a parking waiter either sees the group completed or gets woken up,
+	// the group may be destroyed as soon as it completes so it is only compared with afterwards
+	if( group->pending.fetch_sub( 1 ) == 1 && qtaskNumWaiters.load() ) {
+		QTask_WakeWaiters( group );
+	}
+}
+
+/*
+* QTask_Submit
+*/
+static void QTask_Submit( qtask_t *task ) {
+	qtaskdeque_t *deque;
+
+	task->group->pending.fetch_add( 1, std::memory_order_relaxed );
+
+	if( !qtaskNumThreads ) {
+		QTask_Execute( task );
+		return;
+	}
+
+	deque = &qtaskDeques[qtaskWorkerNum >= 0 ? qtaskWorkerNum : qtaskNumDeques - 1];
+	if( !QTask_Push( deque, task ) ) {
+		// too many tasks in flight, do it right away
+		QTask_Execute( task );
+		return;
+	}
+
+	// sequentially consistent so a parking worker either sees the task or gets signalled
+	qtaskQueued.fetch_add( 1 );
+	if( qtaskSleepers.load() ) {
+		QMutex_Lock( qtaskSleepMutex );
+		QCondVar_Wake( qtaskSleepCondvar );
+		QMutex_Unlock( qtaskSleepMutex );
+	}
+
+	// let a thread waiting for the group help with the new task
+	qtaskNumSubmits.fetch_add( 1 );
+	if( qtaskNumWaiters.load() ) {
+		QTask_WakeWaiters( task->group );
+	}
+}
+
+/*
+* QTask_InitTask
+*/
+static void QTask_InitTask( qtask_t *task, qtaskgroup_t *group, const void *arg, size_t argSize ) {
+	if( argSize > QTASK_ARG_SIZE ) {
+		Com_Error( ERR_FATAL, "QTask_InitTask: argument size %u exceeds %i bytes", (unsigned)argSize, QTASK_ARG_SIZE );
+	}
+
+	task->group = group;
+	task->func = NULL;
+	task->rangefunc = NULL;
+	task->first = 0;
+	task->items = 0;
+	if( argSize ) {
+		memcpy( task->arg.bytes, arg, argSize );
+	}
+}
+
+/*
+* QTask_Spawn
+*
+* Up to QTASK_ARG_SIZE bytes of the argument are copied, the function receives a pointer to the copy.
+*/
+void QTask_Spawn( qtaskgroup_t *group, qtaskfunc_t func, const void *arg, size_t argSize ) {
+	qtask_t task;
+
+	QTask_InitTask( &task, group, arg, argSize );
+	task.func = func;
+	QTask_Submit( &task );
+}
+
+/*
+* QTask_ParallelFor
+*
+* Splits the range into tasks of at least grain items, a few tasks per worker so
+* idle workers are able to steal some of the work from busy ones.
+*/
+void QTask_ParallelFor( qtaskgroup_t *group, qtaskrangefunc_t func, const void *arg, size_t argSize, unsigned items, unsigned grain ) {
+	qtask_t task;
+	unsigned first, chunk;
+	const unsigned maxTasks = QTasks_NumWorkers() * 4;
+
+	if( !items ) {
+		return;
+	}
+
+	chunk = ( items + maxTasks - 1 ) / maxTasks;
+	if( chunk < grain ) {
+		chunk = grain;
+	}
+
+	QTask_InitTask( &task, group, arg, argSize );
+	task.rangefunc = func;
+
+	for( first = 0; first < items; first += chunk ) {
+		task.first = first;
+		task.items = min( chunk, items - first );
+		QTask_Submit( &task );
+	}
+}
+
+/*
+* QTaskGroup_Create
+*/
+qtaskgroup_t *QTaskGroup_Create( void ) {
+	qtaskgroup_t *group = (qtaskgroup_t *)Q_malloc( sizeof( *group ) );
+	new( &group->pending ) std::atomic<int>( 0 );
+	return group;
+}
+
+/*
+* QTaskGroup_Destroy
+*/
+void QTaskGroup_Destroy( qtaskgroup_t **pgroup ) {
+	assert( pgroup != NULL );
+	if( !pgroup || !*pgroup ) {
+		return;
+	}
+
+	QTaskGroup_Wait( *pgroup );
+	Q_free( *pgroup );
+	*pgroup = NULL;
+}
+
+/*
+* QTaskGroup_Wait
+*
+* Executes tasks of the given group while they are pending, so the caller is never
+* held up by unrelated long tasks. Parks once the rest of the group is being executed
+* by other threads.
+*/
+void QTaskGroup_Wait( qtaskgroup_t *group ) {
+	qtask_t task;
+	unsigned spins = 0, numSubmits;
+
+	while( group->pending.load( std::memory_order_acquire ) > 0 ) {
+		numSubmits = qtaskNumSubmits.load();
+		if( QTask_TakeFromGroup( group, &task ) ) {
+			QTask_Execute( &task );
+			spins = 0;
+			continue;
+		}
+
+		// the remaining tasks are being executed by other threads
+		if( ++spins < QTASK_WAIT_SPINS ) {
+			QThread_Yield();
+			continue;
+		}
+
+		QTask_ParkTillDone( group, numSubmits );
+		spins = 0;
+	}
+}
+
+/*
+* QTasks_NumWorkers
+*
+* Returns the number of threads that execute tasks, including the calling one.
+*/
+unsigned QTasks_NumWorkers( void ) {
+	return qtaskNumThreads + 1;
+}
+
+/*
+* QTask_WorkerThreadProc
+*/
+static void *QTask_WorkerThreadProc( void *param ) {
+	qtask_t task;
+	unsigned spins = 0;
+
+	qtaskWorkerNum = (int)(intptr_t)param;
+
+	while( !qtaskQuit.load( std::memory_order_relaxed ) ) {
+		if( QTask_Take( &task ) ) {
+			QTask_Execute( &task );
+			spins = 0;
+			continue;
+		}
+
+		if( ++spins < QTASK_IDLE_SPINS ) {
+			QThread_Yield();
+			continue;
+		}
+
+		// park till something is submitted
+		QMutex_Lock( qtaskSleepMutex );
+		qtaskSleepers.fetch_add( 1 );
+		if( !qtaskQueued.load() && !qtaskQuit.load() ) {
+			QCondVar_Wait( qtaskSleepCondvar, qtaskSleepMutex, QTASK_PARK_MSEC );
+		}
+		qtaskSleepers.fetch_sub( 1 );
+		QMutex_Unlock( qtaskSleepMutex );
+		spins = 0;
+	}
+
+	return NULL;
+}
+
+/*
+* QTasks_Init
+*
+* Starts a worker for every logical processor except the one of the calling thread.
+*/
+void QTasks_Init( void ) {
+	unsigned i, numThreads;
+	unsigned physical, logical;
+
+	assert( !qtasksInitialized );
+
+	com_workerthreads = Cvar_Get( "com_workerthreads", "0", CVAR_ARCHIVE | CVAR_LATCH );
+
+	if( com_workerthreads->integer > 0 ) {
+		numThreads = com_workerthreads->integer;
+	} else if( Sys_GetNumberOfProcessors( &physical, &logical ) && logical > 1 ) {
+		numThreads = logical - 1;
+	} else {
+		numThreads = 1;
+	}
+	numThreads = min( numThreads, (unsigned)QTASKS_MAX_WORKERS );
+
+	qtaskNumDeques = numThreads + 1;
+	qtaskDeques = (qtaskdeque_t *)Q_malloc( qtaskNumDeques * sizeof( qtaskdeque_t ) );
+	for( i = 0; i < qtaskNumDeques; i++ ) {
+		new( &qtaskDeques[i] ) qtaskdeque_t();
+	}
+
+	qtaskQueued = 0;
+	qtaskSleepers = 0;
+	qtaskQuit = 0;
+	qtaskSleepMutex = QMutex_Create();
+	qtaskSleepCondvar = QCondVar_Create();
+
+	qtaskNumWaiters = 0;
+	qtaskNumSubmits = 0;
+	qtaskWaiters = NULL;
+	qtaskWaitMutex = QMutex_Create();
+
+	for( i = 0; i < numThreads; i++ ) {
+		qtaskThreads[i] = QThread_Create( QTask_WorkerThreadProc, (void *)(intptr_t)i );
+	}
+	qtaskNumThreads = numThreads;
+
+	qtasksInitialized = true;
+
+	Com_DPrintf( "Started %u worker threads\n", numThreads );
+}
+
+/*
+* QTasks_Shutdown
+*
+* All task groups must have been waited for.
+*/
+void QTasks_Shutdown( void ) {
+	unsigned i;
+
+	if( !qtasksInitialized ) {
+		return;
+	}
+
+	qtaskQuit = 1;
+	for( i = 0; i < qtaskNumThreads; i++ ) {
+		QMutex_Lock( qtaskSleepMutex );
+		QCondVar_Wake( qtaskSleepCondvar );
+		QMutex_Unlock( qtaskSleepMutex );
+	}
+	for( i = 0; i < qtaskNumThreads; i++ ) {
+		QThread_Join( qtaskThreads[i] );
+		qtaskThreads[i] = NULL;
+	}
+	qtaskNumThreads = 0;
+
+	QCondVar_Destroy( &qtaskSleepCondvar );
+	QMutex_Destroy( &qtaskSleepMutex );
+	QMutex_Destroy( &qtaskWaitMutex );
+
+	Q_free( qtaskDeques );
+	qtaskDeques = NULL;
+	qtaskNumDeques = 0;
+
+	qtasksInitialized = false;
+}
@@ -21,6 +21,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "qcommon.h"
 #include "sys_threads.h"
 
+#include <atomic>
+#include <new>
+
 /*
 * QMutex_Create
 */
@@ -129,48 +132,131 @@ void QThread_Yield( void ) {
 	Sys_Thread_Yield();
 }
 
+static qmutex_t *qbufPipesMutex;
+static qbufPipe_t *qbufPipes;
+
 /*
 * QThreads_Init
 */
 void QThreads_Init( void ) {
+	qbufPipesMutex = QMutex_Create();
 }
 
 /*
 * QThreads_Shutdown
 */
 void QThreads_Shutdown( void ) {
+	QMutex_Destroy( &qbufPipesMutex );
+	qbufPipes = NULL;
 }
 
 // ============================================================================
 
+/*
+* The pipe is a ring buffer that is read by a single thread without any locks.
+* Commands are written by a single thread as well, unless the pipe has been created
+* with QBUFPIPE_MULTIWRITER, in which case writers are serialized by a spinlock
+* that the reader never touches. The reader parks on a condition variable only when
+* the pipe is empty, writers signal it only if it has announced that it is parked.
+*/
+
+#define QBUFPIPE_NAMESIZE           64
+
+typedef struct {
+	// updated by the writer
+	uint64_t numwrites;
+	uint64_t numbyteswritten;
+	uint64_t numdropped;            // commands that did not fit into a non-blocking pipe
+	uint64_t numstalls;             // writes that had to wait for the reader
+	uint64_t numsignals;            // wakeups of the parked reader
+
+	// updated by the reader
+	uint64_t numreads;
+	uint64_t numparks;
+	uint64_t numlatencysamples;
+	uint64_t latencysum;            // microseconds
+	uint64_t latencymax;
+} qbufPipeStats_t;
+
 struct qbufPipe_s {
 	int blockWrite;
+	int multiWriter;
 	volatile int terminated;
+	size_t bufSize;
+	char *buf;
+
+	// owned by the writer
 	unsigned write_pos;
+	uint64_t written;
+
+	// owned by the reader
 	unsigned read_pos;
-	volatile int cmdbuf_len;
-	qmutex_t *cmdbuf_mutex;
-	size_t bufSize;
+	uint64_t consumed;
+
+	// bytes that have been written but not read yet
+	std::atomic<int> cmdbuf_len;
+
+	// set by the reader while it is parked on the condition variable
+	std::atomic<int> waiting;
 	qcondvar_t *nonempty_condvar;
 	qmutex_t *nonempty_mutex;
-	char *buf;
+
+	// serializes writers of QBUFPIPE_MULTIWRITER pipes
+	volatile int write_lock;
+
+	// a write that is being timed, only one at once
+	std::atomic<uint64_t> sample_time;
+	uint64_t sample_end;
+
+	qbufPipeStats_t stats;
+
+	char name[QBUFPIPE_NAMESIZE];
+
+	// linked into the list of all pipes, for stats
+	struct qbufPipe_s *prev, *next;
 };
 
 /*
 * QBufPipe_Create
 */
 qbufPipe_t *QBufPipe_Create( size_t bufSize, int flags ) {
-	qbufPipe_t *pipe = (qbufPipe_t *)malloc( sizeof( *pipe ) + bufSize );
-	memset( pipe, 0, sizeof( *pipe ) );
-	pipe->blockWrite = flags & 1;
+	qbufPipe_t *pipe = new( malloc( sizeof( qbufPipe_t ) + bufSize ) )qbufPipe_t();
+	pipe->blockWrite = flags & QBUFPIPE_BLOCKWRITE;
+	pipe->multiWriter = flags & QBUFPIPE_MULTIWRITER;
 	pipe->buf = (char *)( pipe + 1 );
 	pipe->bufSize = bufSize;
-	pipe->cmdbuf_mutex = QMutex_Create();
 	pipe->nonempty_condvar = QCondVar_Create();
 	pipe->nonempty_mutex = QMutex_Create();
+	Q_strncpyz( pipe->name, "unnamed", sizeof( pipe->name ) );
+
+	if( qbufPipesMutex ) {
+		QMutex_Lock( qbufPipesMutex );
+		pipe->next = qbufPipes;
+		if( qbufPipes ) {
+			qbufPipes->prev = pipe;
+		}
+		qbufPipes = pipe;
+		QMutex_Unlock( qbufPipesMutex );
+	}
+
 	return pipe;
 }
 
+/*
+* QBufPipe_SetName
+*
+* The name is only used for stats.
+*/
+void QBufPipe_SetName( qbufPipe_t *pipe, const char *name ) {
+	if( qbufPipesMutex ) {
+		QMutex_Lock( qbufPipesMutex );
+	}
+	Q_strncpyz( pipe->name, name, sizeof( pipe->name ) );
+	if( qbufPipesMutex ) {
+		QMutex_Unlock( qbufPipesMutex );
+	}
+}
+
 /*
 * QBufPipe_Destroy
 */
@@ -178,26 +264,65 @@ void QBufPipe_Destroy( qbufPipe_t **ppipe ) {
 	qbufPipe_t *pipe;
 
 	assert( ppipe != NULL );
-	if( !ppipe ) {
+	if( !ppipe || !*ppipe ) {
 		return;
 	}
 
 	pipe = *ppipe;
 	*ppipe = NULL;
 
-	QMutex_Destroy( &pipe->cmdbuf_mutex );
+	if( qbufPipesMutex ) {
+		QMutex_Lock( qbufPipesMutex );
+		if( pipe->prev ) {
+			pipe->prev->next = pipe->next;
+		} else if( qbufPipes == pipe ) {
+			qbufPipes = pipe->next;
+		}
+		if( pipe->next ) {
+			pipe->next->prev = pipe->prev;
+		}
+		QMutex_Unlock( qbufPipesMutex );
+	}
+
 	QMutex_Destroy( &pipe->nonempty_mutex );
 	QCondVar_Destroy( &pipe->nonempty_condvar );
+	pipe->~qbufPipe_t();
 	free( pipe );
 }
 
 /*
 * QBufPipe_Wake
 *
-* Signals the waiting thread to wake up.
+* Signals the parked reader thread to wake up. Does nothing if the reader is busy,
+* it is going to see new commands before parking again. Must be called by the writer.
 */
 static void QBufPipe_Wake( qbufPipe_t *pipe ) {
+	// only the first writer after the reader has parked needs to signal
+	if( !pipe->waiting.exchange( 0 ) ) {
+		return;
+	}
+
+	QMutex_Lock( pipe->nonempty_mutex );
 	QCondVar_Wake( pipe->nonempty_condvar );
+	QMutex_Unlock( pipe->nonempty_mutex );
+
+	pipe->stats.numsignals++;
+}
+
+/*
+* QBufPipe_LockWriters
+*/
+static void QBufPipe_LockWriters( qbufPipe_t *pipe ) {
+	while( !Sys_Atomic_CAS( &pipe->write_lock, 0, 1, NULL ) ) {
+		QThread_Yield();
+	}
+}
+
+/*
+* QBufPipe_UnlockWriters
+*/
+static void QBufPipe_UnlockWriters( qbufPipe_t *pipe ) {
+	Sys_Atomic_CAS( &pipe->write_lock, 1, 0, NULL );
 }
 
 /*
@@ -207,10 +332,14 @@ static void QBufPipe_Wake( qbufPipe_t *pipe ) {
 * or terminates with an error.
 */
 void QBufPipe_Finish( qbufPipe_t *pipe ) {
-	while( Sys_Atomic_CAS( &pipe->cmdbuf_len, 0, 0, pipe->cmdbuf_mutex ) == false && !pipe->terminated ) {
-		QMutex_Lock( pipe->nonempty_mutex );
-		QBufPipe_Wake( pipe );
-		QMutex_Unlock( pipe->nonempty_mutex );
+	while( pipe->cmdbuf_len.load( std::memory_order_acquire ) != 0 && !pipe->terminated ) {
+		if( pipe->multiWriter ) {
+			QBufPipe_LockWriters( pipe );
+			QBufPipe_Wake( pipe );
+			QBufPipe_UnlockWriters( pipe );
+		} else {
+			QBufPipe_Wake( pipe );
+		}
 		QThread_Yield();
 	}
 }
@@ -226,31 +355,46 @@ static void *QBufPipe_AllocCmd( qbufPipe_t *pipe, unsigned cmd_size ) {
 
 /*
 * QBufPipe_BufLenAdd
+*
+* Publishes written commands to the reader or returns space to the writer.
 */
 static void QBufPipe_BufLenAdd( qbufPipe_t *pipe, int val ) {
-	Sys_Atomic_Add( &pipe->cmdbuf_len, val, pipe->cmdbuf_mutex );
+	// sequentially consistent so the writer can't miss the reader parking
+	pipe->cmdbuf_len.fetch_add( val );
 }
 
 /*
-* QBufPipe_WriteCmd
+* QBufPipe_WaitForRoom
 *
-* Add new command to buffer. Never allow the distance between the reader
-* and the writer to grow beyond the size of the buffer.
-*
-* Note that there are race conditions here but in the worst case we're going
-* to erroneously drop cmd's instead of stepping on the reader's toes.
+* Returns false if the command has to be dropped.
 */
-void QBufPipe_WriteCmd( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size ) {
+static bool QBufPipe_WaitForRoom( qbufPipe_t *pipe, size_t size, bool block ) {
+	bool stalled = false;
+
+	// acquire so the reader is done with the memory that is going to be overwritten
+	while( pipe->cmdbuf_len.load( std::memory_order_acquire ) + size > pipe->bufSize ) {
+		if( !block || pipe->terminated ) {
+			pipe->stats.numdropped++;
+			return false;
+		}
+		if( !stalled ) {
+			pipe->stats.numstalls++;
+			stalled = true;
+		}
+		QBufPipe_Wake( pipe );
+		QThread_Yield();
+	}
+
+	return true;
+}
+
+/*
+* QBufPipe_WriteCmdLocked
+*/
+static bool QBufPipe_WriteCmdLocked( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size, bool block ) {
 	void *buf;
 	unsigned write_remains;
 
-	if( !pipe ) {
-		return;
-	}
-	if( pipe->terminated ) {
-		return;
-	}
-
 	assert( pipe->bufSize >= pipe->write_pos );
 	if( pipe->bufSize < pipe->write_pos ) {
 		pipe->write_pos = 0;
@@ -259,12 +403,8 @@ void QBufPipe_WriteCmd( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size )
 	write_remains = pipe->bufSize - pipe->write_pos;
 
 	if( sizeof( int ) > write_remains ) {
-		while( pipe->cmdbuf_len + cmd_size + write_remains > pipe->bufSize ) {
-			if( pipe->blockWrite ) {
-				QThread_Yield();
-				continue;
-			}
-			return;
+		if( !QBufPipe_WaitForRoom( pipe, cmd_size + write_remains, block ) ) {
+			return false;
 		}
 
 		// not enough space to enpipe even the reset cmd, rewind
@@ -273,12 +413,8 @@ void QBufPipe_WriteCmd( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size )
 	} else if( cmd_size > write_remains ) {
 		int *cmd;
 
-		while( pipe->cmdbuf_len + sizeof( int ) + cmd_size + write_remains > pipe->bufSize ) {
-			if( pipe->blockWrite ) {
-				QThread_Yield();
-				continue;
-			}
-			return;
+		if( !QBufPipe_WaitForRoom( pipe, sizeof( int ) + cmd_size + write_remains, block ) ) {
+			return false;
 		}
 
 		// explicit pointer reset cmd
@@ -287,24 +423,103 @@ void QBufPipe_WriteCmd( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size )
 
 		QBufPipe_BufLenAdd( pipe, sizeof( *cmd ) + write_remains ); // atomic
 		pipe->write_pos = 0;
-	} else {
-		while( pipe->cmdbuf_len + cmd_size > pipe->bufSize ) {
-			if( pipe->blockWrite ) {
-				QThread_Yield();
-				continue;
-			}
-			return;
-		}
+	} else if( !QBufPipe_WaitForRoom( pipe, cmd_size, block ) ) {
+		return false;
 	}
 
 	buf = QBufPipe_AllocCmd( pipe, cmd_size );
 	memcpy( buf, pcmd, cmd_size );
 	QBufPipe_BufLenAdd( pipe, cmd_size ); // atomic
 
-	// wake the other thread waiting for signal
-	QMutex_Lock( pipe->nonempty_mutex );
-	QBufPipe_Wake( pipe );
-	QMutex_Unlock( pipe->nonempty_mutex );
+	pipe->written += cmd_size;
+	pipe->stats.numwrites++;
+	pipe->stats.numbyteswritten += cmd_size;
+
+	// time the command if no other one is being timed
+	if( !pipe->sample_time.load( std::memory_order_acquire ) ) {
+		pipe->sample_end = pipe->written;
+		pipe->sample_time.store( Sys_Microseconds(), std::memory_order_release );
+	}
+
+	return true;
+}
+
+/*
+* QBufPipe_DoWriteCmd
+*/
+static bool QBufPipe_DoWriteCmd( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size, bool block ) {
+	bool written;
+
+	if( pipe->terminated ) {
+		return false;
+	}
+
+	if( pipe->multiWriter ) {
+		QBufPipe_LockWriters( pipe );
+	}
+
+	// wake the other thread if it's waiting for signal
+	written = QBufPipe_WriteCmdLocked( pipe, pcmd, cmd_size, block );
+	if( written ) {
+		QBufPipe_Wake( pipe );
+	}
+
+	if( pipe->multiWriter ) {
+		QBufPipe_UnlockWriters( pipe );
+	}
+
+	return written;
+}
+
+/*
+* QBufPipe_WriteCmd
+*
+* Add new command to buffer. Never allow the distance between the reader
+* and the writer to grow beyond the size of the buffer.
+*
+* Commands that don't fit are dropped unless the pipe has been created with QBUFPIPE_BLOCKWRITE.
+*/
+void QBufPipe_WriteCmd( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size ) {
+	if( !pipe ) {
+		return;
+	}
+	QBufPipe_DoWriteCmd( pipe, pcmd, cmd_size, pipe->blockWrite );
+}
+
+/*
+* QBufPipe_TryWriteCmd
+*
+* Never waits for the reader, even if the pipe has been created with QBUFPIPE_BLOCKWRITE.
+* Returns false if the command didn't fit, so the caller can keep it and retry later.
+*/
+bool QBufPipe_TryWriteCmd( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size ) {
+	if( !pipe ) {
+		return false;
+	}
+	return QBufPipe_DoWriteCmd( pipe, pcmd, cmd_size, false );
+}
+
+/*
+* QBufPipe_SampleLatency
+*
+* Completes timing of the sampled command once the reader has got past it.
+*/
+static void QBufPipe_SampleLatency( qbufPipe_t *pipe ) {
+	uint64_t latency;
+	const uint64_t sample_time = pipe->sample_time.load( std::memory_order_acquire );
+
+	if( !sample_time || pipe->consumed < pipe->sample_end ) {
+		return;
+	}
+
+	latency = Sys_Microseconds() - sample_time;
+	pipe->stats.numlatencysamples++;
+	pipe->stats.latencysum += latency;
+	if( latency > pipe->stats.latencymax ) {
+		pipe->stats.latencymax = latency;
+	}
+
+	pipe->sample_time.store( 0, std::memory_order_release );
 }
 
 /*
@@ -312,12 +527,14 @@ void QBufPipe_WriteCmd( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size )
 */
 int QBufPipe_ReadCmds( qbufPipe_t *pipe, unsigned( **cmdHandlers )( const void * ) ) {
 	int read = 0;
+	int available;
 
 	if( !pipe ) {
 		return -1;
 	}
 
-	while( Sys_Atomic_CAS( &pipe->cmdbuf_len, 0, 0, pipe->cmdbuf_mutex ) == false && !pipe->terminated ) {
+	// acquire so contents of the commands are visible
+	while( ( available = pipe->cmdbuf_len.load( std::memory_order_acquire ) ) != 0 && !pipe->terminated ) {
 		int cmd;
 		int cmd_size;
 		int read_remains;
@@ -333,6 +550,7 @@ int QBufPipe_ReadCmds( qbufPipe_t *pipe, unsigned( **cmdHandlers )( const void *
 			// implicit reset
 			pipe->read_pos = 0;
 			QBufPipe_BufLenAdd( pipe, -read_remains );
+			continue;
 		}
 
 		cmd = *( (int *)( pipe->buf + pipe->read_pos ) );
@@ -351,16 +569,22 @@ int QBufPipe_ReadCmds( qbufPipe_t *pipe, unsigned( **cmdHandlers )( const void *
 			return -1;
 		}
 
-		if( cmd_size > pipe->cmdbuf_len ) {
+		if( cmd_size > available ) {
 			assert( 0 );
 			pipe->terminated = 1;
 			return -1;
 		}
 
 		pipe->read_pos += cmd_size;
+		pipe->consumed += cmd_size;
 		QBufPipe_BufLenAdd( pipe, -cmd_size ); // atomic
 	}
 
+	if( read ) {
+		pipe->stats.numreads += read;
+		QBufPipe_SampleLatency( pipe );
+	}
+
 	return read;
 }
 
@@ -373,14 +597,19 @@ void QBufPipe_Wait( qbufPipe_t *pipe, int ( *read )( qbufPipe_t *, unsigned( **
 		int res;
 		bool timeout = false;
 
-		while( Sys_Atomic_CAS( &pipe->cmdbuf_len, 0, 0, pipe->cmdbuf_mutex ) == true ) {
+		if( pipe->cmdbuf_len.load( std::memory_order_acquire ) == 0 ) {
 			QMutex_Lock( pipe->nonempty_mutex );
 
-			timeout = QCondVar_Wait( pipe->nonempty_condvar, pipe->nonempty_mutex, timeout_msec ) == false;
+			// announce parking before checking for commands the last time,
+			// a writer either sees the flag or its command is seen here
+			pipe->waiting.store( 1 );
+			if( pipe->cmdbuf_len.load() == 0 && !pipe->terminated ) {
+				pipe->stats.numparks++;
+				timeout = QCondVar_Wait( pipe->nonempty_condvar, pipe->nonempty_mutex, timeout_msec ) == false;
+			}
+			pipe->waiting.store( 0 );
 
-			// don't hold the mutex, changes to cmdbuf_len are atomic anyway
 			QMutex_Unlock( pipe->nonempty_mutex );
-			break;
 		}
 
 		// we're guaranteed at this point that either cmdbuf_len is > 0
@@ -392,3 +621,166 @@ void QBufPipe_Wait( qbufPipe_t *pipe, int ( *read )( qbufPipe_t *, unsigned( **
 		}
 	}
 }
+
+/*
+* QBufPipe_PrintStats
+*/
+static void QBufPipe_PrintStats( const qbufPipe_t *pipe ) {
+	const qbufPipeStats_t *stats = &pipe->stats;
+	const double latencyavg = stats->numlatencysamples ? (double)stats->latencysum / stats->numlatencysamples : 0.0;
+
+	Com_Printf( "%s: %" PRIuPTR " bytes%s%s, %i bytes queued\n", pipe->name, (uintptr_t)pipe->bufSize,
+				pipe->blockWrite ? ", blocking" : "", pipe->multiWriter ? ", multiple writers" : "", pipe->cmdbuf_len.load() );
+	Com_Printf( "  %" PRIu64 " writes (%.3fMB), %" PRIu64 " reads, %" PRIu64 " dropped, %" PRIu64 " stalls, %" PRIu64 " parks, %" PRIu64 " signals\n",
+				stats->numwrites, stats->numbyteswritten / 1048576.0, stats->numreads, stats->numdropped,
+				stats->numstalls, stats->numparks, stats->numsignals );
+	Com_Printf( "  latency: %.1f us average, %" PRIu64 " us max (%" PRIu64 " samples)\n",
+				latencyavg, stats->latencymax, stats->numlatencysamples );
+}
+
+/*
+* QBufPipe_Stats_f
+*/
+static void QBufPipe_Stats_f( void ) {
+	QMutex_Lock( qbufPipesMutex );
+	for( const qbufPipe_t *pipe = qbufPipes; pipe; pipe = pipe->next ) {
+		QBufPipe_PrintStats( pipe );
+	}
+	QMutex_Unlock( qbufPipesMutex );
+}
+
+// ============================================================================
+
+#define QBUFPIPE_BENCH_MAX_WRITERS  16
+
+enum {
+	QBUFPIPE_BENCH_CMD_DATA,
+	QBUFPIPE_BENCH_CMD_QUIT
+};
+
+typedef struct {
+	int id;
+	unsigned size;
+} qbufPipeBenchCmd_t;
+
+typedef struct {
+	qbufPipe_t *pipe;
+	unsigned numcmds;
+	unsigned cmdsize;
+} qbufPipeBenchWriter_t;
+
+static unsigned QBufPipe_BenchDataCmd( const void *pcmd ) {
+	return ( (const qbufPipeBenchCmd_t *)pcmd )->size;
+}
+
+static unsigned QBufPipe_BenchQuitCmd( const void *pcmd ) {
+	return 0;
+}
+
+static int QBufPipe_BenchRead( qbufPipe_t *pipe, unsigned( **cmdHandlers )( const void * ), bool timeout ) {
+	return QBufPipe_ReadCmds( pipe, cmdHandlers );
+}
+
+static void *QBufPipe_BenchReaderProc( void *param ) {
+	static unsigned( *cmdHandlers[] )( const void * ) = { QBufPipe_BenchDataCmd, QBufPipe_BenchQuitCmd };
+
+	QBufPipe_Wait( (qbufPipe_t *)param, QBufPipe_BenchRead, cmdHandlers, Q_THREADS_WAIT_INFINITE );
+	return NULL;
+}
+
+static void *QBufPipe_BenchWriterProc( void *param ) {
+	const qbufPipeBenchWriter_t *writer = (const qbufPipeBenchWriter_t *)param;
+	qbufPipeBenchCmd_t *cmd = (qbufPipeBenchCmd_t *)alloca( writer->cmdsize );
+
+	memset( cmd, 0, writer->cmdsize );
+	cmd->id = QBUFPIPE_BENCH_CMD_DATA;
+	cmd->size = writer->cmdsize;
+
+	for( unsigned i = 0; i < writer->numcmds; i++ ) {
+		QBufPipe_WriteCmd( writer->pipe, cmd, writer->cmdsize );
+	}
+	return NULL;
+}
+
+/*
+* QBufPipe_Bench_f
+*
+* Pushes commands through a pipe from one or more threads to a reader thread.
+*/
+static void QBufPipe_Bench_f( void ) {
+	unsigned numcmds, cmdsize, numwriters;
+	qbufPipe_t *pipe;
+	qthread_t *reader, *writers[QBUFPIPE_BENCH_MAX_WRITERS];
+	qbufPipeBenchWriter_t writer;
+	qbufPipeBenchCmd_t quit;
+	uint64_t startedAt, micros;
+
+	if( Cmd_Argc() < 2 ) {
+		Com_Printf( "Usage: %s <commands> [command size] [writer threads]\n", Cmd_Argv( 0 ) );
+		return;
+	}
+
+	numcmds = (unsigned)atoi( Cmd_Argv( 1 ) );
+	cmdsize = Cmd_Argc() > 2 ? (unsigned)atoi( Cmd_Argv( 2 ) ) : 64;
+	cmdsize = bound( (unsigned)sizeof( qbufPipeBenchCmd_t ), cmdsize & ~3u, 0x1000u );
+	numwriters = Cmd_Argc() > 3 ? (unsigned)atoi( Cmd_Argv( 3 ) ) : 1;
+	numwriters = bound( 1u, numwriters, (unsigned)QBUFPIPE_BENCH_MAX_WRITERS );
+
+	pipe = QBufPipe_Create( 0x40000, QBUFPIPE_BLOCKWRITE | ( numwriters > 1 ? QBUFPIPE_MULTIWRITER : 0 ) );
+	QBufPipe_SetName( pipe, "bench" );
+
+	writer.pipe = pipe;
+	writer.numcmds = numcmds / numwriters;
+	writer.cmdsize = cmdsize;
+
+	reader = QThread_Create( QBufPipe_BenchReaderProc, pipe );
+
+	startedAt = Sys_Microseconds();
+
+	if( numwriters > 1 ) {
+		for( unsigned i = 0; i < numwriters; i++ ) {
+			writers[i] = QThread_Create( QBufPipe_BenchWriterProc, &writer );
+		}
+		for( unsigned i = 0; i < numwriters; i++ ) {
+			QThread_Join( writers[i] );
+		}
+	} else {
+		QBufPipe_BenchWriterProc( &writer );
+	}
+
+	QBufPipe_Finish( pipe );
+	micros = Sys_Microseconds() - startedAt;
+
+	quit.id = QBUFPIPE_BENCH_CMD_QUIT;
+	quit.size = sizeof( quit );
+	QBufPipe_WriteCmd( pipe, &quit, sizeof( quit ) );
+	QThread_Join( reader );
+
+	numcmds = writer.numcmds * numwriters;
+	Com_Printf( "%u commands of %u bytes from %u threads in %" PRIu64 " us: %.3f Mcmds/s, %.1f MB/s\n",
+				numcmds, cmdsize, numwriters, micros, micros ? (double)numcmds / micros : 0.0,
+				micros ? (double)numcmds * cmdsize / micros : 0.0 );
+	QBufPipe_PrintStats( pipe );
+
+	QBufPipe_Destroy( &pipe );
+}
+
+/*
+* QThreads_InitCommands
+*/
+void QThreads_InitCommands( void ) {
+	Cmd_AddCommand( "pipestats", QBufPipe_Stats_f );
+#ifndef PUBLIC_BUILD
+	Cmd_AddCommand( "pipebench", QBufPipe_Bench_f );
+#endif
+}
+
+/*
+* QThreads_ShutdownCommands
+*/
+void QThreads_ShutdownCommands( void ) {
+	Cmd_RemoveCommand( "pipestats" );
+#ifndef PUBLIC_BUILD
+	Cmd_RemoveCommand( "pipebench" );
+#endif
+}
@@ -1082,6 +1082,7 @@ ref_cmdpipe_t *RF_CreateCmdPipe( bool sync ) {
 		cmdpipe->sync = sync;
 	} else {
 		cmdpipe->pipe = ri.BufPipe_Create( REF_PIPE_CMD_BUF_SIZE, 1 );
+		ri.BufPipe_SetName( cmdpipe->pipe, "render frontend" );
 	}
 
 	cmdpipe->Init = &RF_IssueInitReliableCmd;
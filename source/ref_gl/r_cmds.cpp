@@ -297,6 +297,35 @@ void R_ImageList_f( void ) {
 	R_PrintImageList( ri.Cmd_Argv( 1 ), R_GlobFilter );
 }
 
+/*
+* R_ImageBench_f
+*/
+void R_ImageBench_f( void ) {
+	if( ri.Cmd_Argc() != 2 ) {
+		Com_Printf( "Usage: %s <directory>\n", ri.Cmd_Argv( 0 ) );
+		return;
+	}
+
+	R_BenchmarkImagePipeline( ri.Cmd_Argv( 1 ) );
+}
+
+/*
+* R_SkmBench_f
+*/
+void R_SkmBench_f( void ) {
+	int iterations = 100;
+
+	if( ri.Cmd_Argc() > 1 ) {
+		iterations = atoi( ri.Cmd_Argv( 1 ) );
+		if( iterations <= 0 ) {
+			Com_Printf( "Usage: %s [iterations]\n", ri.Cmd_Argv( 0 ) );
+			return;
+		}
+	}
+
+	R_BenchmarkSkeletalTransforms( iterations );
+}
+
 /*
 * R_ShaderList_f
 */
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "../qalgo/hash.h"
 
 #include <algorithm>
+#include <atomic>
 
 #define MAX_GLIMAGES        8192
 #define IMAGES_HASH_SIZE    64
@@ -319,8 +320,12 @@ enum {
 static uint8_t *r_screenShotBuffer;
 static size_t r_screenShotBufferSize;
 
-static uint8_t *r_imageBuffers[NUM_QGL_CONTEXTS][NUM_IMAGE_BUFFERS];
-static size_t r_imageBufSize[NUM_QGL_CONTEXTS][NUM_IMAGE_BUFFERS];
+// An additional set of buffers that is not bound to any GL context and is used by the image pipeline benchmark
+#define IMAGE_BUFFERS_BENCHMARK     NUM_QGL_CONTEXTS
+#define NUM_IMAGE_BUFFER_SETS       ( NUM_QGL_CONTEXTS + 1 )
+
+static uint8_t *r_imageBuffers[NUM_IMAGE_BUFFER_SETS][NUM_IMAGE_BUFFERS];
+static size_t r_imageBufSize[NUM_IMAGE_BUFFER_SETS][NUM_IMAGE_BUFFERS];
 
 #define R_PrepareImageBuffer( ctx,buffer,size ) _R_PrepareImageBuffer( ctx,buffer,size,__FILE__,__LINE__ )
 
@@ -348,7 +353,7 @@ static uint8_t *_R_PrepareImageBuffer( int ctx, int buffer, size_t size,
 void R_FreeImageBuffers( void ) {
 	int i, j;
 
-	for( i = 0; i < NUM_QGL_CONTEXTS; i++ )
+	for( i = 0; i < NUM_IMAGE_BUFFER_SETS; i++ )
 		for( j = 0; j < NUM_IMAGE_BUFFERS; j++ ) {
 			if( r_imageBuffers[i][j] ) {
 				R_Free( r_imageBuffers[i][j] );
@@ -581,6 +586,45 @@ static void R_CutImage( const uint8_t *in, int inwidth, int height, uint8_t *out
 	}
 }
 
+/*
+* R_ResampleRow4
+*
+* Resamples a row of a texture that has 4 samples per pixel.
+* Produces exactly the same results as the generic code path does.
+*/
+static void R_ResampleRow4( const uint8_t *inrow, const uint8_t *inrow2,
+							const unsigned *p1, const unsigned *p2, uint8_t *out, int outwidth ) {
+#ifdef QF_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for( int j = 0; j < outwidth; j++ ) {
+		int32_t pix1, pix2, pix3, pix4;
+		// Rows are not guaranteed to be aligned
+		memcpy( &pix1, inrow + p1[j], 4 );
+		memcpy( &pix2, inrow + p2[j], 4 );
+		memcpy( &pix3, inrow2 + p1[j], 4 );
+		memcpy( &pix4, inrow2 + p2[j], 4 );
+		// Expand bytes to 16-bit words, so the sum of 4 pixels does not overflow
+		__m128i top = _mm_unpacklo_epi8( _mm_unpacklo_epi32( _mm_cvtsi32_si128( pix1 ), _mm_cvtsi32_si128( pix2 ) ), zero );
+		__m128i bottom = _mm_unpacklo_epi8( _mm_unpacklo_epi32( _mm_cvtsi32_si128( pix3 ), _mm_cvtsi32_si128( pix4 ) ), zero );
+		__m128i sum = _mm_add_epi16( top, bottom );
+		sum = _mm_add_epi16( sum, _mm_srli_si128( sum, 8 ) );
+		sum = _mm_srli_epi16( sum, 2 );
+		int32_t result = _mm_cvtsi128_si32( _mm_packus_epi16( sum, sum ) );
+		memcpy( out + j * 4, &result, 4 );
+	}
+#else
+	for( int j = 0; j < outwidth; j++ ) {
+		const uint8_t *pix1 = inrow + p1[j];
+		const uint8_t *pix2 = inrow + p2[j];
+		const uint8_t *pix3 = inrow2 + p1[j];
+		const uint8_t *pix4 = inrow2 + p2[j];
+		uint8_t *opix = out + j * 4;
+		for( int k = 0; k < 4; k++ )
+			opix[k] = ( pix1[k] + pix2[k] + pix3[k] + pix4[k] ) >> 2;
+	}
+#endif
+}
+
 /*
 * R_ResampleTexture
 */
@@ -620,6 +664,10 @@ static void R_ResampleTexture( int ctx, const uint8_t *in, int inwidth, int inhe
 	for( i = 0; i < outheight; i++, out += outwidthS ) {
 		inrow = in + inwidthS * (int)( ( i + 0.25 ) * inheight / outheight );
 		inrow2 = in + inwidthS * (int)( ( i + 0.75 ) * inheight / outheight );
+		if( samples == 4 ) {
+			R_ResampleRow4( inrow, inrow2, p1, p2, out, outwidth );
+			continue;
+		}
 		for( j = 0; j < outwidth; j++ ) {
 			pix1 = inrow + p1[j];
 			pix2 = inrow + p2[j];
@@ -689,6 +737,53 @@ static void R_ResampleTexture16( int ctx, const unsigned short *in, int inwidth,
 	}
 }
 
+/*
+* R_MipMapRow4
+*
+* Processes a row of a texture that has 4 samples per pixel
+* as long as there are pairs of input pixels for every output pixel.
+* Produces exactly the same results as the generic code path does.
+* Returns the number of output pixels written.
+*/
+static int R_MipMapRow4( const uint8_t *in, const uint8_t *next, uint8_t *out, int width ) {
+	// The number of output pixels that have a pair of input pixels in a row
+	const int limit = width >> 1;
+	int j = 0;
+
+#ifdef QF_AVX2
+	const __m256i shuffle = _mm256_setr_epi32( 0, 4, 1, 5, 0, 4, 1, 5 );
+	for( ; j + 4 <= limit; j += 4 ) {
+		// Each half of a register contains 4 pixels with samples expanded to 16-bit words
+		__m256i row0 = _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i *)( in + j * 8 ) ) );
+		__m256i row1 = _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i *)( in + j * 8 + 16 ) ) );
+		row0 = _mm256_add_epi16( row0, _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i *)( next + j * 8 ) ) ) );
+		row1 = _mm256_add_epi16( row1, _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i *)( next + j * 8 + 16 ) ) ) );
+		// Add even and odd pixels. Lanes contain output pixels 0, 2 and 1, 3 respectively.
+		__m256i sum = _mm256_add_epi16( _mm256_unpacklo_epi64( row0, row1 ), _mm256_unpackhi_epi64( row0, row1 ) );
+		sum = _mm256_srli_epi16( sum, 2 );
+		__m256i packed = _mm256_permutevar8x32_epi32( _mm256_packus_epi16( sum, sum ), shuffle );
+		// Writing is safe as the output is always behind the input
+		_mm_storeu_si128( (__m128i *)( out + j * 4 ), _mm256_castsi256_si128( packed ) );
+	}
+#endif
+
+#ifdef QF_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for( ; j + 2 <= limit; j += 2 ) {
+		__m128i top = _mm_loadu_si128( (const __m128i *)( in + j * 8 ) );
+		__m128i bottom = _mm_loadu_si128( (const __m128i *)( next + j * 8 ) );
+		__m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( top, zero ), _mm_unpacklo_epi8( bottom, zero ) );
+		__m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( top, zero ), _mm_unpackhi_epi8( bottom, zero ) );
+		// Add even and odd pixels
+		__m128i sum = _mm_add_epi16( _mm_unpacklo_epi64( lo, hi ), _mm_unpackhi_epi64( lo, hi ) );
+		sum = _mm_srli_epi16( sum, 2 );
+		_mm_storel_epi64( (__m128i *)( out + j * 4 ), _mm_packus_epi16( sum, sum ) );
+	}
+#endif
+
+	return j;
+}
+
 /*
 * R_MipMap
 *
@@ -714,7 +809,12 @@ static void R_MipMap( uint8_t *in, int width, int height, int samples, int align
 
 	for( i = 0; i < outheight; i++, in += instride * 2, out += outpadding ) {
 		next = ( ( ( i << 1 ) + 1 ) < height ) ? ( in + instride ) : in;
-		for( j = 0, inofs = 0; j < outwidth; j++, inofs += samples ) {
+		j = 0;
+		if( samples == 4 ) {
+			j = R_MipMapRow4( in, next, out, width );
+			out += j * 4;
+		}
+		for( inofs = j * 2 * samples; j < outwidth; j++, inofs += samples ) {
 			if( ( ( j << 1 ) + 1 ) < width ) {
 				for( k = 0; k < samples; ++k, ++inofs )
 					*( out++ ) = ( in[inofs] + in[inofs + samples] + next[inofs] + next[inofs + samples] ) >> 2;
@@ -1363,28 +1463,20 @@ typedef struct ktx_header_s {
 } ktx_header_t;
 
 /*
-* R_LoadKTX
+* R_UploadKTX
+*
+* The buffer contents may be modified.
 */
-static bool R_LoadKTX( int ctx, image_t *image, const char *pathname ) {
+static bool R_UploadKTX( int ctx, image_t *image, const char *pathname, uint8_t *buffer ) {
 	int i, j;
-	uint8_t *buffer;
 	ktx_header_t *header;
 	bool swapEndian;
 	uint8_t *data;
 	int numFaces = ( ( image->flags & IT_CUBEMAP ) ? 6 : 1 ), numMips;
 
-	if( image->flags & ( IT_FLIPX | IT_FLIPY | IT_FLIPDIAGONAL ) ) {
-		return false;
-	}
-
-	R_LoadFile( pathname, ( void ** )&buffer );
-	if( !buffer ) {
-		return false;
-	}
-
 	header = ( ktx_header_t * )buffer;
 	if( memcmp( header->identifier, "\xABKTX 11\xBB\r\n\x1A\n", 12 ) ) {
-		ri.Com_DPrintf( S_COLOR_YELLOW "R_LoadKTX: Bad file identifier: %s\n", pathname );
+		ri.Com_DPrintf( S_COLOR_YELLOW "R_UploadKTX: Bad file identifier: %s\n", pathname );
 		goto error;
 	}
 
@@ -1395,15 +1487,15 @@ static bool R_LoadKTX( int ctx, image_t *image, const char *pathname ) {
 	}
 
 	if( header->format && ( header->format != header->baseInternalFormat ) ) {
-		ri.Com_DPrintf( S_COLOR_YELLOW "R_LoadKTX: Pixel format doesn't match internal format: %s\n", pathname );
+		ri.Com_DPrintf( S_COLOR_YELLOW "R_UploadKTX: Pixel format doesn't match internal format: %s\n", pathname );
 		goto error;
 	}
 	if( !R_IsKTXFormatValid( header->format ? header->baseInternalFormat : header->internalFormat, header->type ) ) {
-		ri.Com_DPrintf( S_COLOR_YELLOW "R_LoadKTX: Unsupported pixel format: %s\n", pathname );
+		ri.Com_DPrintf( S_COLOR_YELLOW "R_UploadKTX: Unsupported pixel format: %s\n", pathname );
 		goto error;
 	}
 	if( ( header->pixelWidth < 1 ) || ( header->pixelHeight < 0 ) ) {
-		ri.Com_DPrintf( S_COLOR_YELLOW "R_LoadKTX: Zero texture size: %s\n", pathname );
+		ri.Com_DPrintf( S_COLOR_YELLOW "R_UploadKTX: Zero texture size: %s\n", pathname );
 		goto error;
 	}
 	if( !header->pixelHeight ) {
@@ -1411,19 +1503,19 @@ static bool R_LoadKTX( int ctx, image_t *image, const char *pathname ) {
 	}
 	if( !header->type && ( ( header->pixelWidth & ( header->pixelWidth - 1 ) ) || ( header->pixelHeight & ( header->pixelHeight - 1 ) ) ) ) {
 		// NPOT compressed textures may crash on certain drivers/GPUs
-		ri.Com_DPrintf( S_COLOR_YELLOW "R_LoadKTX: Compressed image must be power-of-two: %s\n", pathname );
+		ri.Com_DPrintf( S_COLOR_YELLOW "R_UploadKTX: Compressed image must be power-of-two: %s\n", pathname );
 		goto error;
 	}
 	if( ( image->flags & IT_CUBEMAP ) && ( header->pixelWidth != header->pixelHeight ) ) {
-		ri.Com_DPrintf( S_COLOR_YELLOW "R_LoadKTX: Not square cubemap image: %s\n", pathname );
+		ri.Com_DPrintf( S_COLOR_YELLOW "R_UploadKTX: Not square cubemap image: %s\n", pathname );
 		goto error;
 	}
 	if( ( header->pixelDepth > 1 ) || ( header->numberOfArrayElements > 1 ) ) {
-		ri.Com_DPrintf( S_COLOR_YELLOW "R_LoadKTX: 3D textures and texture arrays are not supported: %s\n", pathname );
+		ri.Com_DPrintf( S_COLOR_YELLOW "R_UploadKTX: 3D textures and texture arrays are not supported: %s\n", pathname );
 		goto error;
 	}
 	if( header->numberOfFaces != numFaces ) {
-		ri.Com_DPrintf( S_COLOR_YELLOW "R_LoadKTX: Bad number of cubemap faces: %s\n", pathname );
+		ri.Com_DPrintf( S_COLOR_YELLOW "R_UploadKTX: Bad number of cubemap faces: %s\n", pathname );
 		goto error;
 	}
 	if( header->numberOfMipmapLevels < 1 ) {
@@ -1444,7 +1536,7 @@ static bool R_LoadKTX( int ctx, image_t *image, const char *pathname ) {
 		if( ( header->numberOfMipmapLevels == 1 ) && ( image->flags & IT_NOMIPMAP ) ) {
 			mips = 1;
 		} else if( header->numberOfMipmapLevels < mips ) {
-			ri.Com_DPrintf( S_COLOR_YELLOW "R_LoadKTX: Compressed image has too few mip levels: %s\n", pathname );
+			ri.Com_DPrintf( S_COLOR_YELLOW "R_UploadKTX: Compressed image has too few mip levels: %s\n", pathname );
 			goto error;
 		}
 
@@ -1602,15 +1694,287 @@ static bool R_LoadKTX( int ctx, image_t *image, const char *pathname ) {
 	image->width = header->pixelWidth;
 	image->height = header->pixelHeight;
 
-	R_FreeFile( buffer );
 	R_DeferDataSync();
 	return true;
 
 error: // must not be reached after actually starting uploading the texture
-	R_FreeFile( buffer );
 	return false;
 }
 
+/*
+* R_LoadKTX
+*/
+static bool R_LoadKTX( int ctx, image_t *image, const char *pathname ) {
+	uint8_t *buffer;
+	bool loaded;
+
+	if( image->flags & ( IT_FLIPX | IT_FLIPY | IT_FLIPDIAGONAL ) ) {
+		return false;
+	}
+
+	R_LoadFile( pathname, ( void ** )&buffer );
+	if( !buffer ) {
+		return false;
+	}
+
+	loaded = R_UploadKTX( ctx, image, pathname, buffer );
+
+	R_FreeFile( buffer );
+	return loaded;
+}
+
+/*
+=================================================================
+
+TRANSCODED IMAGES CACHE
+
+Decoded images with complete mipmap chains are stored in the cache directory
+in KTX format, so they can be uploaded straight away on subsequent loads.
+There is a single cached file for a source image and a set of image flags.
+The length and the modification time of the source file are kept in the KTX key/value data,
+so a cached file is replaced as soon as the source image is modified, without reading the source.
+=================================================================
+*/
+
+#define IMAGE_CACHE_DIRECTORY   "cache/images"
+#define IMAGE_CACHE_SOURCE_KEY  "qfSourceStamp"
+#define IMAGE_CACHE_KEYVALUE_SIZE   ( sizeof( int ) + 32 )  // key, NUL, 16 hex digits, NUL, padding
+
+/*
+* R_IsImageCacheable
+*
+* Only plain 2D images that are uploaded without resampling are cached.
+* Cubemaps, flipped and cut images and images that require resizing to meet hardware limits are not.
+*/
+static bool R_IsImageCacheable( int flags, int width, int height, int samples ) {
+	int scaledWidth, scaledHeight;
+
+	if( !r_texturecache->integer ) {
+		return false;
+	}
+	if( flags & ( IT_CUBEMAP | IT_FLIPX | IT_FLIPY | IT_FLIPDIAGONAL | IT_LEFTHALF | IT_RIGHTHALF |
+				  IT_DEPTH | IT_FRAMEBUFFER | IT_ARRAY | IT_3D | IT_FLOAT | IT_WAL ) ) {
+		return false;
+	}
+	if( samples != 3 && samples != 4 ) {
+		return false;
+	}
+	if( width > 0 && height > 0 ) {
+		// Picmip is applied on loading the cached image, the stored chain must start from the source size
+		if( R_ScaledImageSize( width, height, &scaledWidth, &scaledHeight, flags | IT_NOPICMIP, 1, 1, false ) != 0 ) {
+			return false;
+		}
+		if( scaledWidth != width || scaledHeight != height ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+* R_CachedImageKeyValue
+*
+* Makes the KTX key/value data that identifies the source of a cached image.
+*/
+static void R_CachedImageKeyValue( unsigned length, unsigned mtime, uint8_t *keyValue ) {
+	char *pair = (char *)( keyValue + sizeof( int ) );
+
+	memset( keyValue, 0, IMAGE_CACHE_KEYVALUE_SIZE );
+	strcpy( pair, IMAGE_CACHE_SOURCE_KEY );
+	pair += sizeof( IMAGE_CACHE_SOURCE_KEY );
+	Q_snprintfz( pair, 17, "%08x%08x", length, mtime );
+	*( (int *)keyValue ) = (int)( sizeof( IMAGE_CACHE_SOURCE_KEY ) + 17 );
+}
+
+/*
+* R_CachedImageName
+*
+* Finds the source image for the pathname, makes the name of its cached version
+* and the key/value data the cached version must have.
+*/
+static bool R_CachedImageName( const image_t *image, char *pathname, size_t pathname_size,
+							   char *cachename, size_t cachename_size, uint8_t *keyValue ) {
+	const char *extension;
+	int length;
+	time_t mtime;
+
+	extension = ri.FS_FirstExtension( pathname, IMAGE_EXTENSIONS, NUM_IMAGE_EXTENSIONS - 1 ); // last is KTX
+	if( !extension ) {
+		return false;
+	}
+
+	// Only look the source up, reading it would make hits as slow as misses
+	COM_ReplaceExtension( pathname, extension, pathname_size );
+	length = ri.FS_FOpenFile( pathname, NULL, FS_READ );
+	if( length < 0 ) {
+		return false;
+	}
+	mtime = ri.FS_FileMTime( pathname );
+	if( mtime <= 0 ) {
+		return false;
+	}
+
+	// The loading mode does not affect the data
+	Q_snprintfz( cachename, cachename_size, IMAGE_CACHE_DIRECTORY "/%s_%s_%08x.ktx",
+				 image->name, extension + 1, (unsigned)( image->flags & ~IT_SYNC ) );
+	R_CachedImageKeyValue( (unsigned)length, (unsigned)mtime, keyValue );
+	return true;
+}
+
+/*
+* R_CachedImageSize
+*/
+static size_t R_CachedImageSize( int width, int height, int samples, int numMips ) {
+	size_t size = sizeof( ktx_header_t ) + IMAGE_CACHE_KEYVALUE_SIZE;
+	int i;
+
+	for( i = 0; i < numMips; i++ ) {
+		size += sizeof( int ) + ALIGN( width * samples, 4 ) * height;
+		width = std::max( width >> 1, 1 );
+		height = std::max( height >> 1, 1 );
+	}
+
+	return size;
+}
+
+/*
+* R_LoadCachedImage
+*/
+static bool R_LoadCachedImage( int ctx, image_t *image, const char *cachename, const uint8_t *keyValue ) {
+	uint8_t *buffer;
+	ktx_header_t *header;
+	int length;
+	int samples;
+	bool loaded = false;
+
+	length = R_LoadCacheFile( cachename, ( void ** )&buffer );
+	if( !buffer ) {
+		return false;
+	}
+
+	// Reject files of modified sources, partially written files
+	// and files that have been written on a machine of different endianness.
+	// Rejected files are overwritten by R_StoreCachedImage.
+	header = ( ktx_header_t * )buffer;
+	if( length >= (int)( sizeof( ktx_header_t ) + IMAGE_CACHE_KEYVALUE_SIZE ) && header->endianness == 0x04030201 &&
+		header->type == GL_UNSIGNED_BYTE && header->bytesOfKeyValueData == (int)IMAGE_CACHE_KEYVALUE_SIZE &&
+		!memcmp( buffer + sizeof( ktx_header_t ), keyValue, IMAGE_CACHE_KEYVALUE_SIZE ) &&
+		header->numberOfMipmapLevels > 0 && header->numberOfMipmapLevels <= 32 ) {
+		samples = ( header->format == GL_RGBA || header->format == GL_BGRA_EXT ) ? 4 : 3;
+		if( R_IsImageCacheable( image->flags, header->pixelWidth, header->pixelHeight, samples ) &&
+			(size_t)length == R_CachedImageSize( header->pixelWidth, header->pixelHeight, samples, header->numberOfMipmapLevels ) ) {
+			loaded = R_UploadKTX( ctx, image, cachename, buffer );
+		}
+	}
+
+	R_FreeFile( buffer );
+	return loaded;
+}
+
+/*
+* R_RemoveStaleCachedImages
+*
+* Removes cached versions of the image that have been made from source files of other formats.
+*/
+static void R_RemoveStaleCachedImages( const char *cachename ) {
+	char stalename[1024];
+	const char *flagsSuffix, *extension;
+	size_t i, prefixLength;
+
+	// The extension and the flags are the last parts of the name, image names may contain underscores as well
+	flagsSuffix = strrchr( cachename, '_' );
+	if( !flagsSuffix || flagsSuffix == cachename ) {
+		return;
+	}
+	for( extension = flagsSuffix - 1; extension > cachename && *extension != '_'; extension-- ) ;
+	if( extension == cachename ) {
+		return;
+	}
+
+	prefixLength = extension - cachename + 1;
+	for( i = 0; i < NUM_IMAGE_EXTENSIONS - 1; i++ ) { // last is KTX
+		Q_snprintfz( stalename, sizeof( stalename ), "%.*s%s%s", (int)prefixLength, cachename, IMAGE_EXTENSIONS[i] + 1, flagsSuffix );
+		if( strcmp( stalename, cachename ) ) {
+			ri.FS_RemoveFile( stalename );
+		}
+	}
+}
+
+/*
+* R_StoreCachedImage
+*
+* Builds a KTX image with a complete mipmap chain, saves it to the cache and uploads it.
+*/
+static bool R_StoreCachedImage( int ctx, image_t *image, const char *cachename, const uint8_t *keyValue,
+								const uint8_t *pic, int width, int height, int samples, int flags ) {
+	ktx_header_t *header;
+	uint8_t *buffer, *data, *mip;
+	size_t size;
+	int i, row, numMips;
+	int mipWidth = width, mipHeight = height;
+	int rowSize, alignedRowSize;
+	int file;
+	bool loaded;
+
+	numMips = R_MipCount( width, height, 1 );
+	size = R_CachedImageSize( width, height, samples, numMips );
+	buffer = (uint8_t *)R_MallocExt( r_imagesPool, size, 16, 1 );
+
+	header = ( ktx_header_t * )buffer;
+	memcpy( header->identifier, "\xABKTX 11\xBB\r\n\x1A\n", 12 );
+	header->endianness = 0x04030201;
+	header->type = GL_UNSIGNED_BYTE;
+	header->typeSize = 1;
+	if( samples == 4 ) {
+		header->format = ( flags & IT_BGRA ) ? GL_BGRA_EXT : GL_RGBA;
+	} else {
+		header->format = ( flags & IT_BGRA ) ? GL_BGR_EXT : GL_RGB;
+	}
+	header->internalFormat = header->format;
+	header->baseInternalFormat = header->format;
+	header->pixelWidth = width;
+	header->pixelHeight = height;
+	header->numberOfFaces = 1;
+	header->numberOfMipmapLevels = numMips;
+	header->bytesOfKeyValueData = IMAGE_CACHE_KEYVALUE_SIZE;
+	memcpy( buffer + sizeof( ktx_header_t ), keyValue, IMAGE_CACHE_KEYVALUE_SIZE );
+
+	// Mipmaps are generated in a temporary buffer without padding, KTX rows must be aligned to 4 bytes
+	mip = R_PrepareImageBuffer( ctx, TEXTURE_RESAMPLING_BUF0, width * height * samples );
+	memcpy( mip, pic, width * height * samples );
+
+	data = buffer + sizeof( ktx_header_t ) + IMAGE_CACHE_KEYVALUE_SIZE;
+	for( i = 0; i < numMips; i++ ) {
+		if( i ) {
+			R_MipMap( mip, mipWidth, mipHeight, samples, 1 );
+			mipWidth = std::max( mipWidth >> 1, 1 );
+			mipHeight = std::max( mipHeight >> 1, 1 );
+		}
+
+		rowSize = mipWidth * samples;
+		alignedRowSize = ALIGN( rowSize, 4 );
+		*( (int *)data ) = alignedRowSize * mipHeight;
+		data += sizeof( int );
+		for( row = 0; row < mipHeight; row++, data += alignedRowSize ) {
+			memcpy( data, mip + row * rowSize, rowSize );
+		}
+	}
+
+	if( ri.FS_FOpenFile( cachename, &file, FS_WRITE | FS_CACHE ) != -1 ) {
+		if( ri.FS_Write( buffer, size, file ) != (int)size ) {
+			ri.Com_DPrintf( S_COLOR_YELLOW "R_StoreCachedImage: Failed to write %s\n", cachename );
+		}
+		ri.FS_FCloseFile( file );
+	}
+
+	R_RemoveStaleCachedImages( cachename );
+
+	loaded = R_UploadKTX( ctx, image, cachename, buffer );
+
+	R_Free( buffer );
+	return loaded;
+}
+
 /*
 * R_LoadImageFromDisk
 */
@@ -1709,10 +2073,30 @@ static bool R_LoadImageFromDisk( int ctx, image_t *image ) {
 		}
 	} else {
 		uint8_t *pic = NULL;
+		char cachename[1024];
+		uint8_t cacheKeyValue[IMAGE_CACHE_KEYVALUE_SIZE];
+		bool useCache = false;
 
 		Q_strncatz( pathname, ".tga", pathsize );
+
+		if( R_IsImageCacheable( flags, 0, 0, 3 ) ) {
+			useCache = R_CachedImageName( image, pathname, pathsize, cachename, sizeof( cachename ), cacheKeyValue );
+			if( useCache && R_LoadCachedImage( ctx, image, cachename, cacheKeyValue ) ) {
+				Q_strncpyz( image->extension, &pathname[len], sizeof( image->extension ) );
+				return true;
+			}
+		}
+
 		samples = R_ReadImageFromDisk( ctx, pathname, pathsize, &pic, &width, &height, &flags, 0 );
 
+		if( pic && useCache && R_IsImageCacheable( flags, width, height, samples ) ) {
+			image->flags = flags;
+			if( R_StoreCachedImage( ctx, image, cachename, cacheKeyValue, pic, width, height, samples, flags ) ) {
+				Q_strncpyz( image->extension, &pathname[len], sizeof( image->extension ) );
+				return true;
+			}
+		}
+
 		if( pic ) {
 			image->width = width;
 			image->height = height;
@@ -2086,6 +2470,78 @@ image_t *R_FindImage( const char *name, const char *suffix, int flags, int minmi
 	return image;
 }
 
+/*
+* R_BenchmarkImagePipeline
+*
+* Decodes, resamples to power-of-two dimensions and mipmaps images from the directory
+* the same way as R_Upload32() does but without uploading, so neither GL calls nor loader threads are involved.
+*/
+void R_BenchmarkImagePipeline( const char *dir ) {
+	static const char *extensions[] = { ".jpg", ".tga", ".png" };
+	const int ctx = IMAGE_BUFFERS_BENCHMARK;
+	char buffer[4096];
+	char pathname[1024];
+	int i, j, numImages = 0;
+	double numPixels = 0;
+	uint64_t decodeMicros = 0, resampleMicros = 0, mipmapMicros = 0;
+
+	for( i = 0; i < (int)( sizeof( extensions ) / sizeof( extensions[0] ) ); i++ ) {
+		int start = 0;
+		for(;; ) {
+			const char *name;
+			int numFiles = ri.FS_GetFileList( dir, extensions[i], buffer, sizeof( buffer ), start, 0 );
+			if( !numFiles ) {
+				break;
+			}
+
+			for( j = 0, name = buffer; j < numFiles; j++, name += strlen( name ) + 1 ) {
+				uint8_t *pic, *mip;
+				int width, height, samples;
+				int scaledWidth, scaledHeight;
+				uint64_t startedAt;
+
+				Q_snprintfz( pathname, sizeof( pathname ), "%s/%s", dir, name );
+
+				startedAt = ri.Sys_Microseconds();
+				samples = R_ReadImageFromDisk( ctx, pathname, sizeof( pathname ), &pic, &width, &height, NULL, 0 );
+				decodeMicros += ri.Sys_Microseconds() - startedAt;
+				if( !pic ) {
+					continue;
+				}
+
+				numImages++;
+				numPixels += width * height;
+
+				for( scaledWidth = 1; ( scaledWidth << 1 ) <= width; scaledWidth <<= 1 ) ;
+				for( scaledHeight = 1; ( scaledHeight << 1 ) <= height; scaledHeight <<= 1 ) ;
+
+				mip = pic;
+				if( scaledWidth != width || scaledHeight != height ) {
+					mip = R_PrepareImageBuffer( ctx, TEXTURE_RESAMPLING_BUF0, scaledWidth * scaledHeight * samples );
+					startedAt = ri.Sys_Microseconds();
+					R_ResampleTexture( ctx, pic, width, height, mip, scaledWidth, scaledHeight, samples, 1 );
+					resampleMicros += ri.Sys_Microseconds() - startedAt;
+				}
+
+				startedAt = ri.Sys_Microseconds();
+				while( scaledWidth > 1 || scaledHeight > 1 ) {
+					R_MipMap( mip, scaledWidth, scaledHeight, samples, 1 );
+					scaledWidth = std::max( 1, scaledWidth >> 1 );
+					scaledHeight = std::max( 1, scaledHeight >> 1 );
+				}
+				mipmapMicros += ri.Sys_Microseconds() - startedAt;
+			}
+
+			start += numFiles;
+		}
+	}
+
+	Com_Printf( "%i images, %.1f megapixels\n", numImages, numPixels / ( 1024.0 * 1024.0 ) );
+	Com_Printf( "Decoding: %.1f ms\n", decodeMicros / 1000.0 );
+	Com_Printf( "Resampling: %.1f ms\n", resampleMicros / 1000.0 );
+	Com_Printf( "Mipmapping: %.1f ms\n", mipmapMicros / 1000.0 );
+}
+
 /*
 ==============================================================================
 
@@ -2950,6 +3406,9 @@ static qthread_t *loader_thread[NUM_LOADER_THREADS] = { NULL };
 static void *loader_gl_context[NUM_LOADER_THREADS] = { NULL };
 static void *loader_gl_surface[NUM_LOADER_THREADS] = { NULL };
 
+// Numbers of pictures that have been issued to loaders but have not been loaded yet
+static std::atomic_int loader_pending_pics[NUM_LOADER_THREADS];
+
 static void *R_ImageLoaderThreadProc( void *param );
 
 /*
@@ -2995,6 +3454,8 @@ static void R_IssueDataSyncLoaderCmd( int id ) {
 * R_InitImageLoader
 */
 static void R_InitImageLoader( int id ) {
+	char name[32];
+
 	if( !glConfig.multithreading ) {
 		loader_gl_context[id] = NULL;
 		loader_gl_surface[id] = NULL;
@@ -3005,7 +3466,9 @@ static void R_InitImageLoader( int id ) {
 		return;
 	}
 
+	loader_pending_pics[id] = 0;
 	loader_queue[id] = ri.BufPipe_Create( 0x40000, 1 );
+	ri.BufPipe_SetName( loader_queue[id], va_r( name, sizeof( name ), "image loader %i", id ) );
 	loader_thread[id] = ri.Thread_Create( R_ImageLoaderThreadProc, loader_queue[id] );
 
 	R_IssueInitLoaderCmd( id );
@@ -3037,18 +3500,28 @@ void R_FinishLoadingImages( void ) {
 * R_LoadAsyncImageFromDisk
 */
 static bool R_LoadAsyncImageFromDisk( image_t *image ) {
-	int pic;
-	int id;
+	int i, pic;
+	int id, minPendingPics;
 
 	if( loader_gl_context[0] == NULL ) {
 		return false;
 	}
 
 	pic = image - r_images;
+
+	// Pick the least busy loader, so a slow decode does not block pictures that could be loaded by another loader.
+	// Prefer the loader that was chosen by a picture number previously if there are several equally busy ones.
 	id = pic % NUM_LOADER_THREADS;
 	if( loader_gl_context[id] == NULL ) {
 		id = 0;
 	}
+	minPendingPics = loader_pending_pics[id];
+	for( i = 0; i < NUM_LOADER_THREADS && minPendingPics; i++ ) {
+		if( loader_gl_context[i] && loader_pending_pics[i] < minPendingPics ) {
+			minPendingPics = loader_pending_pics[i];
+			id = i;
+		}
+	}
 
 	image->loaded = false;
 	image->missing = false;
@@ -3060,6 +3533,7 @@ static bool R_LoadAsyncImageFromDisk( image_t *image ) {
 	R_UnbindImage( image );
 	qglFinish();
 
+	loader_pending_pics[id]++;
 	R_IssueLoadPicLoaderCmd( id, pic );
 	return true;
 }
@@ -3136,6 +3610,8 @@ static unsigned R_HandleLoadPicLoaderCmd( void *pcmd ) {
 		image->loaded = true;
 	}
 
+	loader_pending_pics[cmd->self]--;
+
 	return sizeof( *cmd );
 }
 
@@ -20,161 +20,59 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "r_local.h"
 
-typedef void (*queueCmdHandler_t)( const void * );
-
-enum {
-	CMD_JOB_TAKE,
-	CMD_JOB_QUIT,
-
-	NUM_JOB_CMDS
-};
+// jobs are executed by the engine worker threads and by the thread that waits for them
 
 typedef struct {
-	int id;
-	unsigned first;
-	unsigned items;
 	jobfunc_t job;
 	jobarg_t job_arg;
-} jobTakeCmd_t;
-
-static qbufPipe_t *job_queue[NUM_JOB_THREADS] = { NULL };
-static qthread_t *job_thread[NUM_JOB_THREADS] = { NULL };
-static unsigned job_count;
+} jobTask_t;
 
-static void RJ_IssueJobTakeCmd( unsigned thread, jobfunc_t job, jobarg_t *arg, unsigned first, unsigned stride );
-static void RJ_IssueJobQuitCmd( unsigned thread );
-static void *R_JobThreadProc( void *param );
+static struct qtaskgroup_s *job_group;
 
 /*
 * RJ_Init
 */
 void RJ_Init( void ) {
-	int i;
-
-	job_count = 0;
-
-	for( i = 0; i < NUM_JOB_THREADS; i++ ) {
-		job_queue[i] = ri.BufPipe_Create( 0x4000, 1 );
-		job_thread[i] = ri.Thread_Create( R_JobThreadProc, job_queue[i] );
-	}
-}
-
-/*
-* RJ_ScheduleJob
-*/
-void RJ_ScheduleJob( jobfunc_t job, jobarg_t *arg, unsigned items ) {
-	unsigned first;
-	const unsigned block = ( items + NUM_JOB_THREADS - 1 ) / NUM_JOB_THREADS;
-
-	for( first = 0; first < items; ) {
-		unsigned last = first + block;
-		if( last > items ) {
-			last = items;
-		}
-
-		RJ_IssueJobTakeCmd( job_count % NUM_JOB_THREADS, job, arg, first, last - first );
-		job_count++;
-
-		first += last - first;
-	}
+	job_group = ri.TaskGroup_Create();
 }
 
 /*
-* RJ_FinishJobs
-*/
-void RJ_FinishJobs( void ) {
-	int i;
-
-	for( i = 0; i < NUM_JOB_THREADS; i++ )
-		ri.BufPipe_Finish( job_queue[i] );
-}
-
-/*
-* RJ_Shutdown
+* RJ_NumThreads
 */
-void RJ_Shutdown( void ) {
-	int i;
-
-	for( i = 0; i < NUM_JOB_THREADS; i++ ) {
-		RJ_IssueJobQuitCmd( i );
-	}
-
-	RJ_FinishJobs();
-
-	for( i = 0; i < NUM_JOB_THREADS; i++ ) {
-		ri.Thread_Join( job_thread[i] );
-		job_thread[i] = NULL;
-	}
-
-	for( i = 0; i < NUM_JOB_THREADS; i++ ) {
-		ri.BufPipe_Destroy( &job_queue[i] );
-	}
-
-	job_count = 0;
+unsigned RJ_NumThreads( void ) {
+	return ri.Tasks_NumWorkers();
 }
 
 /*
-* RJ_IssueJobTakeCmd
+* R_JobTask
 */
-static void RJ_IssueJobTakeCmd( unsigned thread, jobfunc_t job, jobarg_t *arg, unsigned first, unsigned items ) {
-	jobTakeCmd_t cmd;
-	cmd.id = CMD_JOB_TAKE;
-	cmd.job = job;
-	cmd.job_arg = *arg;
-	cmd.first = first;
-	cmd.items = items;
-	ri.BufPipe_WriteCmd( job_queue[thread], &cmd, sizeof( cmd ) );
-}
+static void R_JobTask( unsigned first, unsigned items, void *parg ) {
+	jobTask_t *task = (jobTask_t *)parg;
 
-/*
- * RJ_IssueJobQuitCmd
- */
-static void RJ_IssueJobQuitCmd( unsigned thread ) {
-	int cmd = CMD_JOB_QUIT;
-	ri.BufPipe_WriteCmd( job_queue[thread], &cmd, sizeof( cmd ) );
+	task->job( first, items, &task->job_arg );
 }
 
 /*
-* R_HandleJobTakeCmd
+* RJ_ScheduleJob
 */
-static unsigned R_HandleJobTakeCmd( void *pcmd ) {
-	auto *cmd = (jobTakeCmd_t *)pcmd;
-
-	cmd->job( cmd->first, cmd->items, &cmd->job_arg );
-
-	return sizeof( *cmd );
-}
+void RJ_ScheduleJob( jobfunc_t job, jobarg_t *arg, unsigned items ) {
+	jobTask_t task;
 
-/*
-* R_HandleJobQuitCmd
-*/
-static unsigned R_HandleJobQuitCmd( void *pcmd ) {
-	return 0;
+	task.job = job;
+	task.job_arg = *arg;
+	ri.Task_ParallelFor( job_group, R_JobTask, &task, sizeof( task ), items, 1 );
 }
 
 /*
-* R_JobCmdsWaiter
+* RJ_FinishJobs
 */
-static int R_JobCmdsWaiter( qbufPipe_t *queue, queueCmdHandler_t *cmdHandlers, bool timeout ) {
-	typedef unsigned( **Handlers )( const void * );
-	return ri.BufPipe_ReadCmds( queue, (Handlers)cmdHandlers );
+void RJ_FinishJobs( void ) {
+	ri.TaskGroup_Wait( job_group );
 }
 
 /*
-* R_JobThreadProc
+* RJ_Shutdown
 */
-static void *R_JobThreadProc( void *param ) {
-	qbufPipe_t *cmdQueue = (qbufPipe_t *)param;
-	queueCmdHandler_t cmdHandlers[NUM_JOB_CMDS] =
-	{
-		(queueCmdHandler_t)R_HandleJobTakeCmd,
-		(queueCmdHandler_t)R_HandleJobQuitCmd,
-
-	};
-
-	typedef unsigned( **Handlers )( const void * );
-	typedef int ( *WaitFunc )( struct qbufPipe_s *, unsigned( ** )( const void * ), bool );
-	ri.BufPipe_Wait( cmdQueue, (WaitFunc)&R_JobCmdsWaiter, (Handlers)cmdHandlers, Q_THREADS_WAIT_INFINITE );
-
-	return NULL;
+void RJ_Shutdown( void ) {
+	ri.TaskGroup_Destroy( &job_group );
 }
@@ -21,8 +21,6 @@
 #ifndef R_JOBS_H
 #define R_JOBS_H
 
-#define NUM_JOB_THREADS 2
-
 typedef struct {
 	int iarg;
 	unsigned uarg;
@@ -32,6 +30,7 @@ typedef struct {
 typedef void (*jobfunc_t)( unsigned first, unsigned items, jobarg_t * );
 
 void RJ_Init( void );
+unsigned RJ_NumThreads( void );
 void RJ_ScheduleJob( jobfunc_t job, jobarg_t *arg, unsigned items );
 void RJ_FinishJobs( void );
 void RJ_Shutdown( void );
@@ -551,6 +551,7 @@ extern cvar_t *r_gamma;
 extern cvar_t *r_texturemode;
 extern cvar_t *r_texturefilter;
 extern cvar_t *r_texturecompression;
+extern cvar_t *r_texturecache;
 extern cvar_t *r_mode;
 extern cvar_t *r_nobind;
 extern cvar_t *r_picmip;
@@ -630,6 +631,8 @@ void        R_ScreenShot_f( void );
 void        R_TakeEnvShot( const char *path, const char *name, unsigned maxPixels );
 void        R_EnvShot_f( void );
 void        R_ImageList_f( void );
+void        R_ImageBench_f( void );
+void        R_SkmBench_f( void );
 void        R_ShaderList_f( void );
 void        R_ShaderDump_f( void );
 
@@ -899,6 +902,7 @@ bool        R_SkeletalModelLerpTag( orientation_t *orient, const mskmodel_t *skm
 void        R_InitSkeletalCache( void );
 void        R_ClearSkeletalCache( void );
 void        R_ShutdownSkeletalCache( void );
+void        R_BenchmarkSkeletalTransforms( int iterations );
 
 //
 // r_vbo.c
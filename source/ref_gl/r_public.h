@@ -22,7 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "../cgame/ref.h"
 
-#define REF_API_VERSION 25
+#define REF_API_VERSION 29
 
 //
 // these are the functions exported by the refresh module
@@ -87,6 +87,7 @@ typedef struct {
 	const char * ( *FS_WriteDirectory )( void );
 	const char * ( *FS_MediaDirectory )( fs_mediatype_t type );
 	void ( *FS_AddFileToMedia )( const char *filename );
+	int ( *FS_LoadFilesBatch )( const char **paths, int numPaths, int flags, fs_batch_cb callback, void *user );
 
 	struct cinematics_s *( *CIN_Open )( const char *name, int64_t start_time, bool *yuv, float *framerate );
 	bool ( *CIN_NeedNextFrame )( struct cinematics_s *cin, int64_t curtime );
@@ -115,12 +116,24 @@ typedef struct {
 	void ( *Mutex_Unlock )( struct qmutex_s *mutex );
 
 	struct qbufPipe_s *( *BufPipe_Create )( size_t bufSize, int flags );
+	void ( *BufPipe_SetName )( struct qbufPipe_s *queue, const char *name );
 	void ( *BufPipe_Destroy )( struct qbufPipe_s **pqueue );
 	void ( *BufPipe_Finish )( struct qbufPipe_s *queue );
 	void ( *BufPipe_WriteCmd )( struct qbufPipe_s *queue, const void *cmd, unsigned cmd_size );
 	int ( *BufPipe_ReadCmds )( struct qbufPipe_s *queue, unsigned( **cmdHandlers )( const void * ) );
 	void ( *BufPipe_Wait )( struct qbufPipe_s *queue, int ( *read )( struct qbufPipe_s *, unsigned( ** )( const void * ), bool ),
 							unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec );
+
+	bool ( *GetNumberOfProcessors )( unsigned *physical, unsigned *logical );
+
+	// engine-wide worker threads
+	unsigned ( *Tasks_NumWorkers )( void );
+	struct qtaskgroup_s *( *TaskGroup_Create )( void );
+	void ( *TaskGroup_Destroy )( struct qtaskgroup_s **pgroup );
+	void ( *TaskGroup_Wait )( struct qtaskgroup_s *group );
+	void ( *Task_Spawn )( struct qtaskgroup_s *group, qtaskfunc_t func, const void *arg, size_t argSize );
+	void ( *Task_ParallelFor )( struct qtaskgroup_s *group, qtaskrangefunc_t func, const void *arg, size_t argSize,
+								unsigned items, unsigned grain );
 } ref_import_t;
 
 typedef struct {
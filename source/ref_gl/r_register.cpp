@@ -106,6 +106,7 @@ cvar_t *r_gamma;
 cvar_t *r_texturemode;
 cvar_t *r_texturefilter;
 cvar_t *r_texturecompression;
+cvar_t *r_texturecache;
 cvar_t *r_picmip;
 cvar_t *r_skymip;
 cvar_t *r_nobind;
@@ -1146,6 +1147,7 @@ static void R_Register( const char *screenshotsPrefix ) {
 	r_texturemode = ri.Cvar_Get( "r_texturemode", "GL_LINEAR_MIPMAP_LINEAR", CVAR_ARCHIVE );
 	r_texturefilter = ri.Cvar_Get( "r_texturefilter", "4", CVAR_ARCHIVE );
 	r_texturecompression = ri.Cvar_Get( "r_texturecompression", "0", CVAR_ARCHIVE | CVAR_LATCH_VIDEO );
+	r_texturecache = ri.Cvar_Get( "r_texturecache", "1", CVAR_ARCHIVE );
 	r_stencilbits = ri.Cvar_Get( "r_stencilbits", "0", CVAR_ARCHIVE | CVAR_LATCH_VIDEO );
 
 	r_screenshot_jpeg = ri.Cvar_Get( "r_screenshot_jpeg", "1", CVAR_ARCHIVE );
@@ -1188,6 +1190,8 @@ static void R_Register( const char *screenshotsPrefix ) {
 	}
 
 	ri.Cmd_AddCommand( "imagelist", R_ImageList_f );
+	ri.Cmd_AddCommand( "imagebench", R_ImageBench_f );
+	ri.Cmd_AddCommand( "skmbench", R_SkmBench_f );
 	ri.Cmd_AddCommand( "shaderlist", R_ShaderList_f );
 	ri.Cmd_AddCommand( "shaderdump", R_ShaderDump_f );
 	ri.Cmd_AddCommand( "screenshot", R_ScreenShot_f );
@@ -1573,6 +1577,8 @@ void R_Shutdown( bool verbose ) {
 	ri.Cmd_RemoveCommand( "screenshot" );
 	ri.Cmd_RemoveCommand( "envshot" );
 	ri.Cmd_RemoveCommand( "imagelist" );
+	ri.Cmd_RemoveCommand( "imagebench" );
+	ri.Cmd_RemoveCommand( "skmbench" );
 	ri.Cmd_RemoveCommand( "gfxinfo" );
 	ri.Cmd_RemoveCommand( "shaderdump" );
 	ri.Cmd_RemoveCommand( "shaderlist" );
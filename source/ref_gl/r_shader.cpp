@@ -71,7 +71,7 @@ static char *r_shortShaderName;
 static size_t r_shortShaderNameSize;
 
 static bool Shader_Parsetok( shader_t *shader, shaderpass_t *pass, const shaderkey_t *keys, const char *token, const char **ptr );
-static void Shader_MakeCache( const char *filename );
+static void Shader_MakeCache( const char *filename, char *temp, int size );
 static unsigned int Shader_GetCache( const char *name, shadercache_t **cache );
 #define R_FreePassCinematics( pass ) if( ( pass )->cin ) { R_FreeCinematic( ( pass )->cin ); ( pass )->cin = 0; }
 
@@ -1703,39 +1703,30 @@ void R_PrintShaderCache( const char *name ) {
 	cache->buffer[ptr - cache->buffer] = backup;
 }
 
-static void Shader_MakeCache( const char *filename ) {
-	int size;
+/*
+* Shader_MakeCache
+*
+* Parses the contents of a shader script, the contents are modified
+*/
+static void Shader_MakeCache( const char *filename, char *temp, int size ) {
 	unsigned int key;
-	char *pathName = NULL;
-	size_t pathNameSize;
-	char *token, *buf, *temp = NULL;
+	char *token, *buf;
 	const char *ptr;
 	shadercache_t *cache;
 	uint8_t *cacheMemBuf;
 	size_t cacheMemSize;
 
-	pathNameSize = strlen( "scripts/" ) + strlen( filename ) + 1;
-	pathName = (char *)R_Malloc( pathNameSize );
-	assert( pathName );
-	Q_snprintfz( pathName, pathNameSize, "scripts/%s", filename );
-
-	if ( r_showShaderCache && r_showShaderCache->integer )
-		Com_Printf( "...loading '%s'\n", pathName );
-
-	size = R_LoadFile( pathName, ( void ** )&temp );
 	if( !temp || size <= 0 ) {
-		goto done;
+		return;
 	}
 
 	size = COM_Compress( temp );
 	if( !size ) {
-		goto done;
+		return;
 	}
 
 	buf = (char *)R_Malloc( size + 1 );
 	strcpy( buf, temp );
-	R_FreeFile( temp );
-	temp = NULL;
 
 	// calculate buffer size to allocate our cache objects all at once (we may leak
 	// insignificantly here because of duplicate entries)
@@ -1751,7 +1742,7 @@ static void Shader_MakeCache( const char *filename ) {
 
 	if( !cacheMemSize ) {
 		R_Free( buf );
-		goto done;
+		return;
 	}
 
 	cacheMemBuf = (uint8_t *)R_Malloc( cacheMemSize );
@@ -1785,12 +1776,19 @@ set_path_and_offset:
 
 		Shader_SkipBlock( &ptr );
 	}
+}
 
-done:
-	if( temp ) {
-		R_FreeFile( temp );
+/*
+* Shader_MakeCacheFromBatch
+*/
+static void Shader_MakeCacheFromBatch( int index, const char *path, void *buffer, int length, void *user ) {
+	const char **filenames = ( const char ** )user;
+
+	if( r_showShaderCache && r_showShaderCache->integer ) {
+		Com_Printf( "...loading '%s'\n", path );
 	}
-	R_Free( pathName );
+
+	Shader_MakeCache( filenames[index], ( char * )buffer, length );
 }
 
 /*
@@ -1825,6 +1823,8 @@ static void R_InitShadersCache( void ) {
 	const char *fileptr;
 	char shaderPaths[1024];
 	const char *dirs[3] = { "<scripts", ">scripts", "scripts" };
+	char **filenames, **pathNames;
+	int numloaded;
 
 	r_shaderTemplateBuf = NULL;
 
@@ -1846,8 +1846,14 @@ static void R_InitShadersCache( void ) {
 		// enumerate shaders
 		numfiles = ri.FS_GetFileList( dirs[d], ".shader", NULL, 0, 0, 0 );
 		numfiles_total += numfiles;
+		if( !numfiles ) {
+			continue;
+		}
+
+		filenames = ( char ** )R_Malloc( sizeof( char * ) * numfiles * 2 );
+		pathNames = filenames + numfiles;
 
-		// now load them all
+		numloaded = 0;
 		for( i = 0; i < numfiles; i += k ) {
 			if( ( k = ri.FS_GetFileList( dirs[d], ".shader", shaderPaths, sizeof( shaderPaths ), i, numfiles ) ) == 0 ) {
 				k = 1; // advance by one file
@@ -1855,8 +1861,12 @@ static void R_InitShadersCache( void ) {
 			}
 
 			fileptr = shaderPaths;
-			for( j = 0; j < k; j++ ) {
-				Shader_MakeCache( fileptr );
+			for( j = 0; j < k && numloaded < numfiles; j++ ) {
+				filenames[numloaded] = R_CopyString( fileptr );
+				pathNames[numloaded] = ( char * )R_Malloc( strlen( "scripts/" ) + strlen( fileptr ) + 1 );
+				strcpy( pathNames[numloaded], "scripts/" );
+				strcat( pathNames[numloaded], fileptr );
+				numloaded++;
 
 				fileptr += strlen( fileptr ) + 1;
 				if( !*fileptr ) {
@@ -1864,6 +1874,15 @@ static void R_InitShadersCache( void ) {
 				}
 			}
 		}
+
+		// now load them all, scripts are inflated in parallel but parsed in order
+		ri.FS_LoadFilesBatch( ( const char ** )pathNames, numloaded, 0, Shader_MakeCacheFromBatch, filenames );
+
+		for( i = 0; i < numloaded; i++ ) {
+			R_Free( filenames[i] );
+			R_Free( pathNames[i] );
+		}
+		R_Free( filenames );
 	}
 
 	if( !numfiles_total ) {
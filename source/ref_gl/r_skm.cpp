@@ -1099,9 +1099,9 @@ void R_ShutdownSkeletalCache( void ) {
 #endif
 
 /*
-* R_SkeletalBlendPoses
+* R_SkeletalBlendPosesGeneric
 */
-static void R_SkeletalBlendPoses( unsigned int numblends, mskblend_t *blends, unsigned int numbones, mat4_t *relbonepose ) {
+static void R_SkeletalBlendPosesGeneric( unsigned int numblends, mskblend_t *blends, unsigned int numbones, mat4_t *relbonepose ) {
 	unsigned int i, j, k;
 	float *pose;
 	mskblend_t *blend;
@@ -1132,9 +1132,9 @@ static void R_SkeletalBlendPoses( unsigned int numblends, mskblend_t *blends, un
 }
 
 /*
-* R_SkeletalTransformVerts
+* R_SkeletalTransformVertsGeneric
 */
-static void R_SkeletalTransformVerts( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov ) {
+static void R_SkeletalTransformVertsGeneric( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov ) {
 	const float *pose;
 
 	for( ; numverts; numverts--, v += 4, ov += 4, blends++ ) {
@@ -1148,9 +1148,9 @@ static void R_SkeletalTransformVerts( int numverts, const unsigned int *blends,
 }
 
 /*
-* R_SkeletalTransformNormals
+* R_SkeletalTransformNormalsGeneric
 */
-static void R_SkeletalTransformNormals( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov ) {
+static void R_SkeletalTransformNormalsGeneric( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov ) {
 	const float *pose;
 
 	for( ; numverts; numverts--, v += 4, ov += 4, blends++ ) {
@@ -1164,9 +1164,9 @@ static void R_SkeletalTransformNormals( int numverts, const unsigned int *blends
 }
 
 /*
-* R_SkeletalTransformNormalsAndSVecs
+* R_SkeletalTransformNormalsAndSVecsGeneric
 */
-static void R_SkeletalTransformNormalsAndSVecs( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov, const vec_t *sv, vec_t *osv ) {
+static void R_SkeletalTransformNormalsAndSVecsGeneric( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov, const vec_t *sv, vec_t *osv ) {
 	const float *pose;
 
 	for( ; numverts; numverts--, v += 4, ov += 4, sv += 4, osv += 4, blends++ ) {
@@ -1184,6 +1184,157 @@ static void R_SkeletalTransformNormalsAndSVecs( int numverts, const unsigned int
 	}
 }
 
+#ifdef QF_SSE2
+
+// Vectorized versions operate on whole matrix rows and vec4_t vertex attributes.
+// The order of operations is the same as in the generic code, so results match the generic ones
+// as long as the compiler does not contract multiplications and additions of the generic code.
+// Bone matrices and vertex streams are not guaranteed to be aligned.
+
+/*
+* R_SkeletalBlendPoses
+*/
+static void R_SkeletalBlendPoses( unsigned int numblends, mskblend_t *blends, unsigned int numbones, mat4_t *relbonepose ) {
+	unsigned int i, j, k;
+	mskblend_t *blend;
+
+	for( i = 0, j = numbones, blend = blends; i < numblends; i++, j++, blend++ ) {
+		const float *b = relbonepose[blend->indices[0]];
+		const float f0 = blend->weights[0] * ( 1.0 / 255.0 );
+		__m128 f = _mm_set1_ps( f0 );
+		__m128 row0 = _mm_mul_ps( f, _mm_loadu_ps( b + 0 ) );
+		__m128 row1 = _mm_mul_ps( f, _mm_loadu_ps( b + 4 ) );
+		__m128 row2 = _mm_mul_ps( f, _mm_loadu_ps( b + 8 ) );
+		__m128 row3 = _mm_mul_ps( f, _mm_loadu_ps( b + 12 ) );
+
+		for( k = 1; k < SKM_MAX_WEIGHTS && blend->weights[k]; k++ ) {
+			const float fk = blend->weights[k] * ( 1.0 / 255.0 );
+			b = relbonepose[blend->indices[k]];
+			f = _mm_set1_ps( fk );
+			row0 = _mm_add_ps( row0, _mm_mul_ps( f, _mm_loadu_ps( b + 0 ) ) );
+			row1 = _mm_add_ps( row1, _mm_mul_ps( f, _mm_loadu_ps( b + 4 ) ) );
+			row2 = _mm_add_ps( row2, _mm_mul_ps( f, _mm_loadu_ps( b + 8 ) ) );
+			row3 = _mm_add_ps( row3, _mm_mul_ps( f, _mm_loadu_ps( b + 12 ) ) );
+		}
+
+		// the last column is never used by transforms, so it is safe to overwrite it
+		float *pose = relbonepose[j];
+		_mm_storeu_ps( pose + 0, row0 );
+		_mm_storeu_ps( pose + 4, row1 );
+		_mm_storeu_ps( pose + 8, row2 );
+		_mm_storeu_ps( pose + 12, row3 );
+	}
+}
+
+/*
+* R_SkeletalRotate4
+*
+* Rotates a vector by the upper 3x3 part of the matrix. The w component of the result is undefined.
+*/
+static inline __m128 R_SkeletalRotate4( const float *pose, __m128 v ) {
+	__m128 x = _mm_mul_ps( _mm_shuffle_ps( v, v, _MM_SHUFFLE( 0, 0, 0, 0 ) ), _mm_loadu_ps( pose + 0 ) );
+	__m128 y = _mm_mul_ps( _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 1, 1, 1 ) ), _mm_loadu_ps( pose + 4 ) );
+	__m128 z = _mm_mul_ps( _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 2, 2, 2 ) ), _mm_loadu_ps( pose + 8 ) );
+	return _mm_add_ps( _mm_add_ps( x, y ), z );
+}
+
+#ifdef QF_AVX
+/*
+* R_SkeletalLoadRows8
+*
+* Puts the same row of two matrices into lower and upper lanes of the result.
+*/
+static inline __m256 R_SkeletalLoadRows8( const float *pose1, const float *pose2, int row ) {
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( pose1 + row * 4 ) ), _mm_loadu_ps( pose2 + row * 4 ), 1 );
+}
+
+/*
+* R_SkeletalRotate8
+*
+* Rotates two adjacent vectors by two different matrices. The w components of the result are undefined.
+*/
+static inline __m256 R_SkeletalRotate8( const float *pose1, const float *pose2, __m256 v ) {
+	__m256 x = _mm256_mul_ps( _mm256_permute_ps( v, _MM_SHUFFLE( 0, 0, 0, 0 ) ), R_SkeletalLoadRows8( pose1, pose2, 0 ) );
+	__m256 y = _mm256_mul_ps( _mm256_permute_ps( v, _MM_SHUFFLE( 1, 1, 1, 1 ) ), R_SkeletalLoadRows8( pose1, pose2, 1 ) );
+	__m256 z = _mm256_mul_ps( _mm256_permute_ps( v, _MM_SHUFFLE( 2, 2, 2, 2 ) ), R_SkeletalLoadRows8( pose1, pose2, 2 ) );
+	return _mm256_add_ps( _mm256_add_ps( x, y ), z );
+}
+#endif
+
+/*
+* R_SkeletalTransformVerts
+*/
+static void R_SkeletalTransformVerts( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov ) {
+#ifdef QF_AVX
+	for( ; numverts > 1; numverts -= 2, v += 8, ov += 8, blends += 2 ) {
+		const float *pose1 = relbonepose[blends[0]], *pose2 = relbonepose[blends[1]];
+		__m256 r = R_SkeletalRotate8( pose1, pose2, _mm256_loadu_ps( v ) );
+		_mm256_storeu_ps( ov, _mm256_add_ps( r, R_SkeletalLoadRows8( pose1, pose2, 3 ) ) );
+		ov[3] = 1;
+		ov[7] = 1;
+	}
+#endif
+	for( ; numverts > 0; numverts--, v += 4, ov += 4, blends++ ) {
+		const float *pose = relbonepose[*blends];
+		__m128 r = R_SkeletalRotate4( pose, _mm_loadu_ps( v ) );
+		_mm_storeu_ps( ov, _mm_add_ps( r, _mm_loadu_ps( pose + 12 ) ) );
+		ov[3] = 1;
+	}
+}
+
+/*
+* R_SkeletalTransformNormals
+*/
+static void R_SkeletalTransformNormals( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov ) {
+#ifdef QF_AVX
+	for( ; numverts > 1; numverts -= 2, v += 8, ov += 8, blends += 2 ) {
+		const float *pose1 = relbonepose[blends[0]], *pose2 = relbonepose[blends[1]];
+		_mm256_storeu_ps( ov, R_SkeletalRotate8( pose1, pose2, _mm256_loadu_ps( v ) ) );
+		ov[3] = 0;
+		ov[7] = 0;
+	}
+#endif
+	for( ; numverts > 0; numverts--, v += 4, ov += 4, blends++ ) {
+		_mm_storeu_ps( ov, R_SkeletalRotate4( relbonepose[*blends], _mm_loadu_ps( v ) ) );
+		ov[3] = 0;
+	}
+}
+
+/*
+* R_SkeletalTransformNormalsAndSVecs
+*/
+static void R_SkeletalTransformNormalsAndSVecs( int numverts, const unsigned int *blends, mat4_t *relbonepose, const vec_t *v, vec_t *ov, const vec_t *sv, vec_t *osv ) {
+#ifdef QF_AVX
+	for( ; numverts > 1; numverts -= 2, v += 8, ov += 8, sv += 8, osv += 8, blends += 2 ) {
+		const float *pose1 = relbonepose[blends[0]], *pose2 = relbonepose[blends[1]];
+		_mm256_storeu_ps( ov, R_SkeletalRotate8( pose1, pose2, _mm256_loadu_ps( v ) ) );
+		ov[3] = 0;
+		ov[7] = 0;
+
+		// keep the sign of the binormal direction that is stored in w
+		const __m256 svecs = _mm256_loadu_ps( sv );
+		_mm256_storeu_ps( osv, _mm256_blend_ps( R_SkeletalRotate8( pose1, pose2, svecs ), svecs, 0x88 ) );
+	}
+#endif
+	for( ; numverts > 0; numverts--, v += 4, ov += 4, sv += 4, osv += 4, blends++ ) {
+		const float *pose = relbonepose[*blends];
+		_mm_storeu_ps( ov, R_SkeletalRotate4( pose, _mm_loadu_ps( v ) ) );
+		ov[3] = 0;
+
+		_mm_storeu_ps( osv, R_SkeletalRotate4( pose, _mm_loadu_ps( sv ) ) );
+		osv[3] = sv[3];
+	}
+}
+
+#else
+
+#define R_SkeletalBlendPoses R_SkeletalBlendPosesGeneric
+#define R_SkeletalTransformVerts R_SkeletalTransformVertsGeneric
+#define R_SkeletalTransformNormals R_SkeletalTransformNormalsGeneric
+#define R_SkeletalTransformNormalsAndSVecs R_SkeletalTransformNormalsAndSVecsGeneric
+
+#endif
+
 // set the FP precision back to whatever value it was
 #if defined ( _WIN32 ) && ( _MSC_VER >= 1400 ) && defined( NDEBUG )
 # pragma float_control(pop)
@@ -1615,3 +1766,156 @@ bool R_AddSkeletalModelToDrawList( const entity_t *e ) {
 
 	return true;
 }
+
+/*
+* R_SkeletalBenchRandom
+*/
+static float R_SkeletalBenchRandom( unsigned *seed, float scale ) {
+	*seed = *seed * 1664525 + 1013904223;
+	return ( ( *seed >> 8 ) * ( 1.0f / 16777216.0f ) * 2.0f - 1.0f ) * scale;
+}
+
+/*
+* R_SkeletalBenchRandomIndex
+*/
+static unsigned R_SkeletalBenchRandomIndex( unsigned *seed, unsigned count ) {
+	*seed = *seed * 1664525 + 1013904223;
+	return ( *seed >> 16 ) % count;
+}
+
+/*
+* R_SkeletalBenchMaxError
+*/
+static float R_SkeletalBenchMaxError( const vec_t *v1, const vec_t *v2, int numverts ) {
+	float error = 0;
+	for( int i = 0; i < numverts * 4; i++ ) {
+		error = std::max( error, fabsf( v1[i] - v2[i] ) );
+	}
+	return error;
+}
+
+/*
+* R_BenchmarkSkeletalTransforms
+*
+* Runs the CPU skinning path on a synthetic model using both the generic
+* and the vectorized code and prints timings and the largest difference of results.
+*/
+void R_BenchmarkSkeletalTransforms( int iterations ) {
+	const unsigned numbones = 128, numblends = 512;
+	const int numverts = 16384;
+	unsigned seed = 1;
+	unsigned i, k;
+	int iter;
+	uint64_t startedAt, micros[2][4];
+	float error[4];
+
+	mat4_t *poses = ( mat4_t * )R_Malloc( sizeof( mat4_t ) * ( numbones + numblends ) * 2 );
+	mskblend_t *blends = ( mskblend_t * )R_Malloc( sizeof( mskblend_t ) * numblends );
+	unsigned *vertexBlends = ( unsigned * )R_Malloc( sizeof( unsigned ) * numverts );
+	vec_t *in = ( vec_t * )R_Malloc( sizeof( vec4_t ) * numverts * 3 );
+	vec_t *out = ( vec_t * )R_Malloc( sizeof( vec4_t ) * numverts * 4 * 2 );
+
+	for( i = 0; i < numbones; i++ ) {
+		for( k = 0; k < 16; k++ ) {
+			poses[i][k] = R_SkeletalBenchRandom( &seed, k < 12 ? 1.0f : 64.0f );
+		}
+		poses[i][3] = poses[i][7] = poses[i][11] = 0;
+		poses[i][15] = 1;
+	}
+
+	for( i = 0; i < numblends; i++ ) {
+		int left = 255;
+		for( k = 0; k < SKM_MAX_WEIGHTS; k++ ) {
+			int weight = k + 1 < SKM_MAX_WEIGHTS ? ( int )( ( R_SkeletalBenchRandom( &seed, 0.5f ) + 0.5f ) * left ) : left;
+			blends[i].indices[k] = ( uint8_t )R_SkeletalBenchRandomIndex( &seed, numbones );
+			blends[i].weights[k] = ( uint8_t )weight;
+			left -= weight;
+		}
+	}
+
+	for( iter = 0; iter < numverts; iter++ ) {
+		vertexBlends[iter] = R_SkeletalBenchRandomIndex( &seed, numbones + numblends );
+		for( k = 0; k < 12; k++ ) {
+			in[iter * 12 + k] = R_SkeletalBenchRandom( &seed, 32.0f );
+		}
+	}
+
+	memcpy( poses + numbones + numblends, poses, sizeof( mat4_t ) * numbones );
+
+	for( k = 0; k < 2; k++ ) {
+		mat4_t *relbonepose = poses + k * ( numbones + numblends );
+		vec_t *ov = out + k * numverts * 16;
+
+		startedAt = ri.Sys_Microseconds();
+		for( iter = 0; iter < iterations; iter++ ) {
+			if( k ) {
+				R_SkeletalBlendPoses( numblends, blends, numbones, relbonepose );
+			} else {
+				R_SkeletalBlendPosesGeneric( numblends, blends, numbones, relbonepose );
+			}
+		}
+		micros[k][0] = ri.Sys_Microseconds() - startedAt;
+
+		startedAt = ri.Sys_Microseconds();
+		for( iter = 0; iter < iterations; iter++ ) {
+			if( k ) {
+				R_SkeletalTransformVerts( numverts, vertexBlends, relbonepose, in, ov );
+			} else {
+				R_SkeletalTransformVertsGeneric( numverts, vertexBlends, relbonepose, in, ov );
+			}
+		}
+		micros[k][1] = ri.Sys_Microseconds() - startedAt;
+
+		startedAt = ri.Sys_Microseconds();
+		for( iter = 0; iter < iterations; iter++ ) {
+			if( k ) {
+				R_SkeletalTransformNormalsAndSVecs( numverts, vertexBlends, relbonepose,
+					in + numverts * 4, ov + numverts * 4, in + numverts * 8, ov + numverts * 8 );
+			} else {
+				R_SkeletalTransformNormalsAndSVecsGeneric( numverts, vertexBlends, relbonepose,
+					in + numverts * 4, ov + numverts * 4, in + numverts * 8, ov + numverts * 8 );
+			}
+		}
+		micros[k][2] = ri.Sys_Microseconds() - startedAt;
+
+		startedAt = ri.Sys_Microseconds();
+		for( iter = 0; iter < iterations; iter++ ) {
+			if( k ) {
+				R_SkeletalTransformNormals( numverts, vertexBlends, relbonepose, in + numverts * 4, ov + numverts * 12 );
+			} else {
+				R_SkeletalTransformNormalsGeneric( numverts, vertexBlends, relbonepose, in + numverts * 4, ov + numverts * 12 );
+			}
+		}
+		micros[k][3] = ri.Sys_Microseconds() - startedAt;
+	}
+
+	// the last column of blended matrices is not computed by the generic code
+	error[0] = 0;
+	for( i = numbones; i < numbones + numblends; i++ ) {
+		for( k = 0; k < 15; k++ ) {
+			if( ( k & 3 ) != 3 ) {
+				error[0] = std::max( error[0], fabsf( poses[i][k] - poses[i + numbones + numblends][k] ) );
+			}
+		}
+	}
+	error[1] = R_SkeletalBenchMaxError( out, out + numverts * 16, numverts );
+	error[2] = R_SkeletalBenchMaxError( out + numverts * 4, out + numverts * 20, numverts * 2 );
+	error[3] = R_SkeletalBenchMaxError( out + numverts * 12, out + numverts * 28, numverts );
+
+	Com_Printf( "%u bones, %u blends, %i verts, %i iterations, %u job threads\n",
+		numbones, numblends, numverts, iterations, RJ_NumThreads() );
+	Com_Printf( "Blending poses: %.1f ms generic, %.1f ms vectorized, max error %g\n",
+		micros[0][0] / 1000.0, micros[1][0] / 1000.0, error[0] );
+	Com_Printf( "Transforming verts: %.1f ms generic, %.1f ms vectorized, max error %g\n",
+		micros[0][1] / 1000.0, micros[1][1] / 1000.0, error[1] );
+	Com_Printf( "Transforming normals and svecs: %.1f ms generic, %.1f ms vectorized, max error %g\n",
+		micros[0][2] / 1000.0, micros[1][2] / 1000.0, error[2] );
+	Com_Printf( "Transforming normals: %.1f ms generic, %.1f ms vectorized, max error %g\n",
+		micros[0][3] / 1000.0, micros[1][3] / 1000.0, error[3] );
+
+	R_Free( out );
+	R_Free( in );
+	R_Free( vertexBlends );
+	R_Free( blends );
+	R_Free( poses );
+}
@@ -228,6 +228,8 @@ typedef struct {
 	client_t client;                // special client for writing the messages
 	char meta_data[SNAP_MAX_DEMO_META_DATA_SIZE];
 	size_t meta_data_realsize;
+	snapDemoIndex_t index;
+	snapDemoWriter_t *writer;       // not NULL if the demo is written asynchronously
 } server_static_demo_t;
 
 typedef server_static_demo_t demorec_t;
@@ -292,6 +294,8 @@ typedef struct {
 	char *motd;
 
 	void *wakelock;
+
+	memarena_t *frameArena;             // transient allocations, released at the end of every frame
 } server_static_t;
 
 typedef struct {
@@ -371,6 +375,9 @@ extern cvar_t *sv_lastAutoUpdate;
 extern cvar_t *sv_defaultmap;
 
 extern cvar_t *sv_demodir;
+extern cvar_t *sv_demoasync;
+extern cvar_t *sv_demoqueuesize;
+extern cvar_t *sv_demoqueuedrop;
 
 extern cvar_t *sv_snap_aggressive_sound_culling;
 extern cvar_t *sv_snap_raycast_players_culling;
@@ -511,6 +518,7 @@ extern game_export_t *ge;
 
 void SV_InitGameProgs( void );
 void SV_ShutdownGameProgs( void );
+void SV_ResetGameFrameArena( void );
 
 
 //============================================================
@@ -523,6 +531,7 @@ void SV_Demo_Start_f( void );
 void SV_Demo_Stop_f( void );
 void SV_Demo_Cancel_f( void );
 void SV_Demo_Purge_f( void );
+void SV_Demo_Stats_f( void );
 
 void SV_DemoList_f( client_t *client );
 void SV_DemoGet_f( client_t *client );
@@ -391,6 +391,7 @@ void SV_InitOperatorCommands( void ) {
 	Cmd_AddCommand( "serverrecordstop", SV_Demo_Stop_f );
 	Cmd_AddCommand( "serverrecordcancel", SV_Demo_Cancel_f );
 	Cmd_AddCommand( "serverrecordpurge", SV_Demo_Purge_f );
+	Cmd_AddCommand( "serverrecordstats", SV_Demo_Stats_f );
 
 	Cmd_AddCommand( "purelist", SV_PureList_f );
 
@@ -424,6 +425,7 @@ void SV_ShutdownOperatorCommands( void ) {
 	Cmd_RemoveCommand( "serverrecordstop" );
 	Cmd_RemoveCommand( "serverrecordcancel" );
 	Cmd_RemoveCommand( "serverrecordpurge" );
+	Cmd_RemoveCommand( "serverrecordstats" );
 
 	Cmd_RemoveCommand( "purelist" );
 
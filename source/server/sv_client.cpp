@@ -721,7 +721,7 @@ static void SV_BeginDownload_f( client_t *client ) {
 			goto local_download;
 		} else {
 			alloc_size = sizeof( char ) * ( strlen( sv_uploads_baseurl->string ) + 1 );
-			url = (char *)Mem_TempMalloc( alloc_size );
+			url = (char *)Mem_ArenaAlloc( svs.frameArena, alloc_size );
 			Q_snprintfz( url, alloc_size, "%s/", sv_uploads_baseurl->string );
 		}
 	} else if( SV_IsDemoDownloadRequest( requestname ) && ( local_http || sv_uploads_demos_baseurl->string[0] != 0 ) ) {
@@ -729,12 +729,12 @@ static void SV_BeginDownload_f( client_t *client ) {
 		if( local_http ) {
 local_download:
 			alloc_size = sizeof( char ) * ( 6 + strlen( uploadname ) * 3 + 1 );
-			url = (char *)Mem_TempMalloc( alloc_size );
+			url = (char *)Mem_ArenaAlloc( svs.frameArena, alloc_size );
 			Q_snprintfz( url, alloc_size, "files/" );
 			Q_urlencode_unsafechars( uploadname, url + 6, alloc_size - 6 );
 		} else {
 			alloc_size = sizeof( char ) * ( strlen( sv_uploads_demos_baseurl->string ) + 1 );
-			url = (char *)Mem_TempMalloc( alloc_size );
+			url = (char *)Mem_ArenaAlloc( svs.frameArena, alloc_size );
 			Q_snprintfz( url, alloc_size, "%s/", sv_uploads_demos_baseurl->string );
 		}
 	} else {
@@ -747,11 +747,6 @@ local_download:
 						  client->download.size, checksum, local_http ? 1 : 0, ( url ? url : "" ) );
 	SV_AddReliableCommandsToMessage( client, &tmpMessage );
 	SV_SendMessageToClient( client, &tmpMessage );
-
-	if( url ) {
-		Mem_TempFree( url );
-		url = NULL;
-	}
 }
 
 //============================================================================
@@ -26,15 +26,28 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 /*
 * SV_Demo_WriteMessage
 *
-* Writes given message to the demofile
+* Writes given message to the demofile.
+* Only messages that contain nothing but a frame may be dropped, returns false if the message has been dropped.
 */
-static void SV_Demo_WriteMessage( msg_t *msg ) {
+static bool SV_Demo_WriteMessage( msg_t *msg, bool frame ) {
 	assert( svs.demo.file );
 	if( !svs.demo.file ) {
-		return;
+		return false;
+	}
+
+	if( svs.demo.writer ) {
+		// following frames would refer to the dropped one, restart the delta chain.
+		// Keyframes are still written only when due, so a full queue doesn't get
+		// more non-droppable configstrings and index entries.
+		if( !SNAP_QueueDemoMessage( svs.demo.writer, msg, frame ) ) {
+			svs.demo.client.nodelta = true;
+			return false;
+		}
+		return true;
 	}
 
 	SNAP_RecordDemoMessage( svs.demo.file, msg, 0 );
+	return true;
 }
 
 /*
@@ -43,6 +56,7 @@ static void SV_Demo_WriteMessage( msg_t *msg ) {
 static void SV_Demo_WriteStartMessages( void ) {
 	// clear demo meta data, we'll write some keys later
 	svs.demo.meta_data_realsize = SNAP_ClearDemoMeta( svs.demo.meta_data, sizeof( svs.demo.meta_data ) );
+	SNAP_ClearDemoIndex( &svs.demo.index );
 
 	SNAP_BeginDemoRecording( svs.demo.file, svs.spawncount, svc.snapFrameTime, sv.mapname, SV_BITFLAGS_RELIABLE,
 							 svs.purelist, sv.configstrings[0], sv.baselines );
@@ -53,6 +67,7 @@ static void SV_Demo_WriteStartMessages( void ) {
 */
 void SV_Demo_WriteSnap( void ) {
 	int i;
+	bool keyframe, written;
 	msg_t msg;
 	uint8_t msg_buffer[MAX_MSGLEN];
 
@@ -74,16 +89,34 @@ void SV_Demo_WriteSnap( void ) {
 
 	MSG_Init( &msg, msg_buffer, sizeof( msg_buffer ) );
 
+	// periodically write a nodelta frame, so the playback can start from it
+	keyframe = SNAP_DemoKeyframeDue( &svs.demo.index, svs.gametime );
+	if( keyframe ) {
+		svs.demo.client.nodelta = true;
+		SNAP_RecordDemoKeyframe( svs.demo.file, svs.demo.writer, &svs.demo.index, svs.gametime, sv.configstrings[0] );
+	}
+
+	// reliable commands go first as they do for clients, and are never dropped
+	SV_AddReliableCommandsToMessage( &svs.demo.client, &msg );
+	SV_Demo_WriteMessage( &msg, false );
+	MSG_Clear( &msg );
+
 	SV_BuildClientFrameSnap( &svs.demo.client, 0 );
 
 	SV_WriteFrameSnapToClient( &svs.demo.client, &msg );
 
-	SV_AddReliableCommandsToMessage( &svs.demo.client, &msg );
-
-	SV_Demo_WriteMessage( &msg );
+	// a dropped frame leaves nodelta set for the next one
+	written = SV_Demo_WriteMessage( &msg, true );
+	if( written ) {
+		svs.demo.client.nodelta = false;
+	}
 
 	svs.demo.duration = svs.gametime - svs.demo.basetime;
-	svs.demo.client.lastframe = sv.framenum; // FIXME: is this needed?
+
+	// game commands of a dropped frame are written again with the next one
+	if( written ) {
+		svs.demo.client.lastframe = sv.framenum; // FIXME: is this needed?
+	}
 }
 
 /*
@@ -185,14 +218,34 @@ void SV_Demo_Start_f( void ) {
 	svs.demo.localtime = time( NULL );
 	SV_Demo_WriteStartMessages();
 
+	// the start messages are written synchronously, the rest goes through the writer
+	if( sv_demoasync->integer ) {
+		svs.demo.writer = SNAP_CreateDemoWriter( svs.demo.file, sv_demoqueuesize->integer * 1024, sv_demoqueuedrop->integer != 0 );
+	}
+
 	// Clearing tables won't harm...
 	SnapVisTable::Instance()->Clear();
 	SnapShadowTable::Instance()->Clear();
 
-	// write one nodelta frame
-	svs.demo.client.nodelta = true;
+	// the first frame is always a nodelta keyframe
 	SV_Demo_WriteSnap();
-	svs.demo.client.nodelta = false;
+}
+
+/*
+* SV_Demo_PrintStats
+*/
+static void SV_Demo_PrintStats( void ) {
+	snapDemoWriterStats_t stats;
+
+	SNAP_GetDemoWriterStats( svs.demo.writer, &stats );
+
+	Com_Printf( "Messages: %u queued, %u written in %u batches, %u dropped\n",
+				stats.numQueued, stats.numWritten, stats.numBatches, stats.numDropped );
+	Com_Printf( "Queue: %i/%i KiB used, %i KiB peak\n",
+				stats.pendingBytes / 1024, stats.queueSize / 1024, stats.maxPendingBytes / 1024 );
+	Com_Printf( "Latency: %.1f ms average, %.1f ms max\n",
+				stats.avgLatencyMicros / 1000.0, stats.maxLatencyMicros / 1000.0 );
+	Com_Printf( "Written: %" PRIu64 " KiB in %.1f ms\n", stats.bytesWritten / 1024, stats.writeMicros / 1000.0 );
 }
 
 /*
@@ -206,6 +259,14 @@ static void SV_Demo_Stop( bool cancel, bool silent ) {
 		return;
 	}
 
+	// write all queued messages before the file is finished
+	if( svs.demo.writer ) {
+		if( !silent ) {
+			SV_Demo_PrintStats();
+		}
+		SNAP_DestroyDemoWriter( &svs.demo.writer );
+	}
+
 	if( cancel ) {
 		Com_Printf( "Canceled server demo recording: %s\n", svs.demo.filename );
 	} else {
@@ -233,6 +294,8 @@ static void SV_Demo_Stop( bool cancel, bool silent ) {
 		SV_SetDemoMetaKeyValue( "matchname", sv.configstrings[CS_MATCHNAME] );
 		SV_SetDemoMetaKeyValue( "matchscore", sv.configstrings[CS_MATCHSCORE] );
 		SV_SetDemoMetaKeyValue( "matchuuid", sv.configstrings[CS_MATCHUUID] );
+		svs.demo.meta_data_realsize = SNAP_SetDemoMetaIndex( svs.demo.meta_data, sizeof( svs.demo.meta_data ),
+															 svs.demo.meta_data_realsize, &svs.demo.index );
 
 		SNAP_WriteDemoMetaData( svs.demo.tempname, svs.demo.meta_data, svs.demo.meta_data_realsize );
 
@@ -270,6 +333,25 @@ void SV_Demo_Cancel_f( void ) {
 	SV_Demo_Stop( true, atoi( Cmd_Argv( 1 ) ) != 0 );
 }
 
+/*
+* SV_Demo_Stats_f
+*
+* Prints statistics of the asynchronous server demo writer
+*/
+void SV_Demo_Stats_f( void ) {
+	if( !svs.demo.file ) {
+		Com_Printf( "No server demo recording in progress\n" );
+		return;
+	}
+
+	if( !svs.demo.writer ) {
+		Com_Printf( "The server demo is written synchronously\n" );
+		return;
+	}
+
+	SV_Demo_PrintStats();
+}
+
 /*
 * SV_Demo_Purge_f
 *
@@ -27,6 +27,7 @@ game_export_t *ge;
 EXTERN_API_FUNC void *GetGameAPI( void * );
 
 mempool_t *sv_gameprogspool;
+static memarena_t *sv_gameframearena;
 static void *module_handle;
 
 //======================================================================
@@ -423,6 +424,13 @@ static void PF_MemFree( void *data, const char *filename, int fileline ) {
 	_Mem_Free( data, MEMPOOL_GAMEPROGS, 0, filename, fileline );
 }
 
+/*
+* PF_MemFrameAlloc
+*/
+static void *PF_MemFrameAlloc( size_t size, const char *filename, int fileline ) {
+	return _Mem_ArenaAlloc( sv_gameframearena, size, filename, fileline );
+}
+
 //==============================================
 
 /*
@@ -441,10 +449,22 @@ void SV_ShutdownGameProgs( void ) {
 	// (for example if there are global object destructors calling G_Free()),
 	// that's why it's called before releasing the pool.
 	Com_UnloadGameLibrary( &module_handle );
+	Mem_ArenaEnd( &sv_gameframearena );
 	Mem_FreePool( &sv_gameprogspool );
 	ge = NULL;
 }
 
+/*
+* SV_ResetGameFrameArena
+*
+* Releases the memory the game module has allocated for the current frame.
+*/
+void SV_ResetGameFrameArena( void ) {
+	if( sv_gameframearena ) {
+		Mem_ArenaReset( sv_gameframearena );
+	}
+}
+
 /*
 * SV_LocateEntities
 */
@@ -482,6 +502,7 @@ void SV_InitGameProgs( void ) {
 	}
 
 	sv_gameprogspool = _Mem_AllocPool( NULL, "Game Progs", MEMPOOL_GAMEPROGS, __FILE__, __LINE__ );
+	sv_gameframearena = Mem_ArenaBegin( sv_gameprogspool, "Game Frame", 64 * 1024 );
 
 	// load a new game dll
 	import.Print = PF_dprint;
@@ -507,6 +528,7 @@ void SV_InitGameProgs( void ) {
 	import.CM_FindTopNodeForSphere = PF_CM_FindTopNodeForSphere;
 
 	import.Milliseconds = Sys_Milliseconds;
+	import.Microseconds = Sys_Microseconds;
 
 	import.ModelIndex = SV_ModelIndex;
 	import.SoundIndex = SV_SoundIndex;
@@ -537,6 +559,14 @@ void SV_InitGameProgs( void ) {
 
 	import.Mem_Alloc = PF_MemAlloc;
 	import.Mem_Free = PF_MemFree;
+	import.Mem_FrameAlloc = PF_MemFrameAlloc;
+
+	import.Tasks_NumWorkers = QTasks_NumWorkers;
+	import.TaskGroup_Create = QTaskGroup_Create;
+	import.TaskGroup_Destroy = QTaskGroup_Destroy;
+	import.TaskGroup_Wait = QTaskGroup_Wait;
+	import.Task_Spawn = QTask_Spawn;
+	import.Task_ParallelFor = QTask_ParallelFor;
 
 	import.Cvar_Get = Cvar_Get;
 	import.Cvar_Set = Cvar_Set;
@@ -590,6 +620,7 @@ void SV_InitGameProgs( void ) {
 	apiversion = ge->API();
 	if( apiversion != GAME_API_VERSION ) {
 		Com_UnloadGameLibrary( &module_handle );
+		Mem_ArenaEnd( &sv_gameframearena );
 		Mem_FreePool( &sv_gameprogspool );
 		ge = NULL;
 		Com_Error( ERR_DROP, "Game is version %i, not %i", apiversion, GAME_API_VERSION );
@@ -343,6 +343,7 @@ void SV_InitGame( void ) {
 	svs.clients = (client_t *)Mem_Alloc( sv_mempool, sizeof( client_t ) * sv_maxclients->integer );
 	svs.client_entities.num_entities = sv_maxclients->integer * UPDATE_BACKUP * MAX_SNAP_ENTITIES;
 	svs.client_entities.entities = (entity_state_t *)Mem_Alloc( sv_mempool, sizeof( entity_state_t ) * svs.client_entities.num_entities );
+	svs.frameArena = Mem_ArenaBegin( sv_mempool, "Server Frame", 16 * 1024 );
 
 	// init network stuff
 
@@ -542,6 +543,8 @@ void SV_ShutdownGame( const char *finalmsg, bool reconnect ) {
 		svs.motd = NULL;
 	}
 
+	Mem_ArenaEnd( &svs.frameArena );
+
 	if( sv_mempool ) {
 		Mem_EmptyPool( sv_mempool );
 	}
@@ -99,6 +99,9 @@ cvar_t *sv_autoUpdate;
 cvar_t *sv_lastAutoUpdate;
 
 cvar_t *sv_demodir;
+cvar_t *sv_demoasync;
+cvar_t *sv_demoqueuesize;
+cvar_t *sv_demoqueuedrop;
 
 cvar_t *sv_snap_aggressive_sound_culling;
 cvar_t *sv_snap_raycast_players_culling;
@@ -742,6 +745,9 @@ void SV_Frame( unsigned realmsec, unsigned gamemsec ) {
 
 		// clear teleport flags, etc for next frame
 		ge->ClearSnap();
+
+		// nothing the game has allocated for the frame is referenced anymore
+		SV_ResetGameFrameArena();
 	}
 
 	// handle HTTP connections
@@ -750,6 +756,10 @@ void SV_Frame( unsigned realmsec, unsigned gamemsec ) {
 	SV_CheckAutoUpdate();
 
 	SV_CheckPostUpdateRestart();
+
+	if( svs.frameArena ) {
+		Mem_ArenaReset( svs.frameArena );
+	}
 }
 
 //============================================================================
@@ -943,6 +953,12 @@ void SV_Init( void ) {
 		Cvar_ForceSet( "sv_demodir", "" );
 	}
 
+	// write server demos in a separate thread, the queue size is in kilobytes
+	sv_demoasync = Cvar_Get( "sv_demoasync", "1", CVAR_ARCHIVE );
+	sv_demoqueuesize = Cvar_Get( "sv_demoqueuesize", "2048", CVAR_ARCHIVE );
+	// drop demo messages instead of stalling the server frame if the queue is full
+	sv_demoqueuedrop = Cvar_Get( "sv_demoqueuedrop", "0", CVAR_ARCHIVE );
+
 	// wsw : jal : cap client's exceding server rules
 	sv_maxrate =            Cvar_Get( "sv_maxrate", "0", CVAR_DEVELOPER );
 	sv_compresspackets =        Cvar_Get( "sv_compresspackets", "1", CVAR_DEVELOPER );
@@ -25,7 +25,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifdef HTTP_SUPPORT
 
 #define MAX_INCOMING_HTTP_CONNECTIONS           48
-#define MAX_INCOMING_HTTP_CONNECTIONS_PER_ADDR  3
+#define MAX_INCOMING_HTTP_CONNECTIONS_PER_ADDR  4
 
 #define MAX_INCOMING_CONTENT_LENGTH             0x2800
 
@@ -47,6 +47,8 @@ typedef enum {
 	CONTENT_STATE_RECEIVED = 2,
 } sv_http_content_state_t;
 
+// begin is -1 for "bytes=-N" suffix ranges that have N as the end,
+// otherwise the end is inclusive or -1 for "bytes=N-" ranges
 typedef struct {
 	long begin;
 	long end;
@@ -81,6 +83,7 @@ typedef struct {
 
 	bool partial;
 	sv_http_content_range_t partial_content_range;
+	char *if_range;
 
 	bool got_start_line;
 	bool close_after_resp;
@@ -100,6 +103,7 @@ typedef struct {
 	size_t file_data_offset;
 	size_t file_send_pos;
 	char *filename;
+	unsigned checksum;              // of the served pak, used as the entity tag
 } sv_http_response_t;
 
 typedef struct sv_http_connection_s {
@@ -195,6 +199,10 @@ static void SV_Web_ResetRequest( sv_http_request_t *request ) {
 		Mem_Free( request->clientSession );
 		request->clientSession = NULL;
 	}
+	if( request->if_range ) {
+		Mem_Free( request->if_range );
+		request->if_range = NULL;
+	}
 
 	request->query_string = "";
 	SV_Web_ResetStream( &request->stream );
@@ -231,6 +239,7 @@ static void SV_Web_ResetResponse( sv_http_response_t *response ) {
 	response->fileno = -1;
 	response->file_data_offset = 0;
 	response->file_send_pos = 0;
+	response->checksum = 0;
 
 	response->content_state = CONTENT_STATE_DEFAULT;
 	if( response->content ) {
@@ -447,11 +456,10 @@ static unsigned SV_Web_ConnectionLimitReached( const netadr_t *addr ) {
 	for( con = hnode->prev; con != hnode; con = next ) {
 		next = con->prev;
 		if( NET_CompareAddress( addr, &con->address ) ) {
-			if( cnt >= MAX_INCOMING_HTTP_CONNECTIONS_PER_ADDR ) {
+			if( ++cnt >= MAX_INCOMING_HTTP_CONNECTIONS_PER_ADDR ) {
 				return true;
 			}
 		}
-		cnt++;
 	}
 	return false;
 }
@@ -645,8 +653,10 @@ static void SV_Web_ReadOutgoingQueueCmds( void ) {
 * SV_Web_InitQueues
 */
 static void SV_Web_InitQueues( void ) {
-	sv_http_incoming_queue = QBufPipe_Create( 0x10000, 1 );
-	sv_http_outgoing_queue = QBufPipe_Create( 0x10000, 1 );
+	sv_http_incoming_queue = QBufPipe_Create( 0x10000, QBUFPIPE_BLOCKWRITE );
+	sv_http_outgoing_queue = QBufPipe_Create( 0x10000, QBUFPIPE_BLOCKWRITE );
+	QBufPipe_SetName( sv_http_incoming_queue, "http incoming" );
+	QBufPipe_SetName( sv_http_outgoing_queue, "http outgoing" );
 }
 
 /*
@@ -725,6 +735,73 @@ static void SV_Web_ParseStartLine( sv_http_request_t *request, char *line ) {
 	}
 }
 
+/*
+* SV_Web_ParseRange
+*
+* Only single byte ranges are served partially. As RFC 7233 requires, malformed ranges,
+* other units and requests for multiple ranges are ignored and get the whole file.
+* Whether a well-formed range can be satisfied is checked once the file size is known.
+*/
+static void SV_Web_ParseRange( sv_http_request_t *request, const char *value ) {
+	sv_http_content_range_t range;
+	const char *p;
+	char *end;
+
+	if( Q_strnicmp( value, "bytes=", 6 ) ) {
+		return;
+	}
+
+	p = value + 6;
+	if( strchr( p, ',' ) ) {
+		return;
+	}
+
+	while( *p == ' ' ) {
+		p++;
+	}
+
+	if( *p == '-' ) {
+		// bytes=-100, last 100 bytes
+		p++;
+		if( *p < '0' || *p > '9' ) {
+			return;
+		}
+		range.begin = -1;
+		range.end = strtol( p, &end, 10 );
+	} else {
+		if( *p < '0' || *p > '9' ) {
+			return;
+		}
+		range.begin = strtol( p, &end, 10 );
+		if( *end != '-' ) {
+			return;
+		}
+
+		p = end + 1;
+		if( *p >= '0' && *p <= '9' ) {
+			// bytes=200-300
+			range.end = strtol( p, &end, 10 );
+			if( range.end < range.begin ) {
+				return;
+			}
+		} else {
+			// bytes=200-
+			range.end = -1;
+			end = (char *)p;
+		}
+	}
+
+	while( *end == ' ' ) {
+		end++;
+	}
+	if( *end || range.begin == LONG_MAX || range.end == LONG_MAX ) {
+		return;
+	}
+
+	request->partial_content_range = range;
+	request->partial = true;
+}
+
 /*
 * SV_Web_AnalyzeHeader
 */
@@ -749,55 +826,9 @@ static void SV_Web_AnalyzeHeader( sv_http_request_t *request, const char *key, c
 		}
 	} else if( !Q_stricmp( key, "Range" )
 			   && ( request->method == HTTP_METHOD_GET || request->method == HTTP_METHOD_HEAD ) ) {
-		const char *delim = strchr( value, '-' );
-
-		if( Q_strnicmp( value, "bytes=", 6 ) || !delim ) {
-			request->error = HTTP_RESP_BAD_REQUEST;
-		} else {
-			bool neg_end = false;
-			const char *p = value;
-
-			// first byte pos
-			while( *p && p < delim ) {
-				if( *p >= '0' && *p <= '9' ) {
-					stream->content_range.begin = stream->content_range.begin * 10 + *p - '0';
-				}
-				p++;
-			}
-			p++;
-
-			// last byte pos
-			if( *p == '-' ) {
-				if( value != delim ) {
-					request->error = HTTP_RESP_REQUESTED_RANGE_NOT_SATISFIABLE;
-					return;
-				}
-				neg_end = true;
-				p++;
-			}
-			while( *p ) {
-				if( *p >= '0' && *p <= '9' ) {
-					stream->content_range.end = stream->content_range.end * 10 + *p++ - '0';
-				}
-			}
-
-			// partial content request
-			if( neg_end && stream->content_range.end ) {
-				// bytes=-100
-				request->partial = true;
-				stream->content_range.end = -stream->content_range.end;
-			} else if( stream->content_range.end >= stream->content_range.begin ) {
-				// bytes=200-300
-				request->partial = true;
-			} else if( stream->content_range.begin >= 0 && *( delim + 1 ) == '\0' ) {
-				// bytes=200-
-				request->partial = true;
-			}
-
-			if( request->partial ) {
-				request->partial_content_range = stream->content_range;
-			}
-		}
+		SV_Web_ParseRange( request, value );
+	} else if( !Q_stricmp( key, "If-Range" ) ) {
+		request->if_range = ZoneCopyString( value );
 	} else if( !Q_stricmp( key, "X-Client" ) ) {
 		request->clientNum = atoi( value );
 	} else if( !Q_stricmp( key, "X-Session" ) ) {
@@ -1066,6 +1097,9 @@ static void SV_Web_RouteRequest( const sv_http_request_t *request, sv_http_respo
 				*content_length = 0;
 			} else {
 				response->code = HTTP_RESP_OK;
+				if( FS_CheckPakExtension( filename ) ) {
+					response->checksum = FS_ChecksumBaseFile( filename, false );
+				}
 			}
 		} else {
 			response->code = HTTP_RESP_BAD_REQUEST;
@@ -1075,6 +1109,26 @@ static void SV_Web_RouteRequest( const sv_http_request_t *request, sv_http_respo
 	}
 }
 
+/*
+* SV_Web_IfRangeMatches
+*
+* A range request with a stale If-Range validator gets the whole file.
+* Only entity tags are supported as validators since no modification dates are sent.
+*/
+static bool SV_Web_IfRangeMatches( const sv_http_request_t *request, const sv_http_response_t *response ) {
+	char etag[16];
+
+	if( !request->if_range ) {
+		return true;
+	}
+	if( !response->checksum ) {
+		return false;
+	}
+
+	Q_snprintfz( etag, sizeof( etag ), "\"%08x\"", response->checksum );
+	return !strcmp( request->if_range, etag );
+}
+
 /*
 * SV_Web_RespondToQuery
 */
@@ -1109,25 +1163,30 @@ static void SV_Web_RespondToQuery( sv_http_connection_t *con ) {
 		}
 
 		// serve range requests
-		if( request->partial && response->file ) {
-			// seek to first byte pos and clamp the last byte pos to content length
-			if( request->partial_content_range.begin > 0 ) {
-				FS_Seek( response->file, request->partial_content_range.begin, FS_SEEK_SET );
-				// range.end may be set to 0 for 'bytes=100-' style requests
-				response->stream.content_range.end = request->partial_content_range.end
-													 ? request->partial_content_range.end : content_length;
-
-			} else if( request->partial_content_range.end < 0 ) {
-				// seek to N last bytes in the file
-				FS_Seek( response->file, request->partial_content_range.end, FS_SEEK_END );
-				response->stream.content_range.end = -request->partial_content_range.end;
+		if( request->partial && response->file && SV_Web_IfRangeMatches( request, response ) ) {
+			const sv_http_content_range_t *range = &request->partial_content_range;
+			long first, last;
+
+			if( range->begin < 0 ) {
+				// an empty suffix is never satisfiable
+				first = (long)content_length - std::min( range->end, (long)content_length );
+				last = (long)content_length - 1;
+			} else {
+				first = range->begin;
+				last = ( range->end < 0 || range->end >= (long)content_length ) ? (long)content_length - 1 : range->end;
 			}
 
-			// Content-Range header values
-			response->file_send_pos = FS_Tell( response->file );
-			response->stream.content_range.begin = response->file_send_pos;
-			response->stream.content_range.end = std::min( (long)content_length, response->stream.content_range.end );
-			response->code = HTTP_RESP_PARTIAL_CONTENT;
+			if( first >= (long)content_length ) {
+				response->code = HTTP_RESP_REQUESTED_RANGE_NOT_SATISFIABLE;
+				FS_FCloseFile( response->file );
+				response->file = 0;
+			} else {
+				FS_Seek( response->file, first, FS_SEEK_SET );
+				response->file_send_pos = FS_Tell( response->file );
+				response->stream.content_range.begin = first;
+				response->stream.content_range.end = last;
+				response->code = HTTP_RESP_PARTIAL_CONTENT;
+			}
 		}
 
 		if( request->method == HTTP_METHOD_HEAD && response->file ) {
@@ -1146,23 +1205,24 @@ static void SV_Web_RespondToQuery( sv_http_connection_t *con ) {
 				sizeof( resp_stream->header_buf ) );
 
 	if( response->code == HTTP_RESP_REQUESTED_RANGE_NOT_SATISFIABLE ) {
-		int file_length = FS_FOpenBaseFile( request->resource, NULL, FS_READ );
-
-		// in accordance with RFC 2616, send the Content-Range entity header,
-		// specifying the length of the resource
-		if( file_length < 0 ) {
-			Q_strncatz( resp_stream->header_buf, "Content-Range: bytes */*\r\n",
-						sizeof( resp_stream->header_buf ) );
-		} else {
-			Q_snprintfz( vastr, sizeof( vastr ), "Content-Range: bytes */%" PRIi64 "\r\n", (int64_t)content_length );
-			Q_strncatz( resp_stream->header_buf, vastr, sizeof( resp_stream->header_buf ) );
-		}
+		// in accordance with RFC 7233, send the Content-Range header specifying the length of the resource
+		Q_snprintfz( vastr, sizeof( vastr ), "Content-Range: bytes */%" PRIi64 "\r\n", (int64_t)content_length );
+		Q_strncatz( resp_stream->header_buf, vastr, sizeof( resp_stream->header_buf ) );
 	} else if( response->code == HTTP_RESP_PARTIAL_CONTENT ) {
 		const char *format = "Content-Range: bytes %" PRIi64 "-%" PRIi64 "/%" PRIi64 "\r\n";
 		Q_snprintfz( vastr, sizeof( vastr ), format, (int64_t)response->stream.content_range.begin,
 			(int64_t)response->stream.content_range.end, (int64_t)content_length );
 		Q_strncatz( resp_stream->header_buf, vastr, sizeof( resp_stream->header_buf ) );
-		content_length = response->stream.content_range.end - response->stream.content_range.begin;
+		content_length = response->stream.content_range.end - response->stream.content_range.begin + 1;
+	}
+
+	if( response->checksum && response->code < HTTP_RESP_BAD_REQUEST ) {
+		Q_snprintfz( vastr, sizeof( vastr ), "ETag: \"%08x\"\r\n", response->checksum );
+		Q_strncatz( resp_stream->header_buf, vastr, sizeof( resp_stream->header_buf ) );
+	}
+
+	if( con->close_after_resp ) {
+		Q_strncatz( resp_stream->header_buf, "Connection: close\r\n", sizeof( resp_stream->header_buf ) );
 	}
 
 	if( response->code >= HTTP_RESP_BAD_REQUEST || !content_length ) {
@@ -27,7 +27,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 * S_CreateSoundCmdPipe
 */
 sndCmdPipe_t *S_CreateSoundCmdPipe( void ) {
-	return trap_BufPipe_Create( SND_COMMANDS_BUFSIZE, 0 );
+	sndCmdPipe_t *pipe = trap_BufPipe_Create( SND_COMMANDS_BUFSIZE, 0 );
+	trap_BufPipe_SetName( pipe, "sound backend" );
+	return pipe;
 }
 
 /*
@@ -4,8 +4,6 @@
 #include "../qalgo/Links.h"
 #include "../qalgo/SingletonHolder.h"
 
-#include <thread>
-
 static SingletonHolder<ParallelComputationHost> instanceHolder;
 
 ParallelComputationHost *ParallelComputationHost::Instance() {
@@ -20,52 +18,29 @@ void ParallelComputationHost::Shutdown() {
 	instanceHolder.Shutdown();
 }
 
-int ParallelComputationHost::SuggestNumberOfTasks() {
-	unsigned numPhysicalProcessors, numLogicalProcessors;
-	if( trap_GetNumberOfProcessors( &numPhysicalProcessors, &numLogicalProcessors ) ) {
-		// It's unlikely that the number of threads per physical core > 2 but let's use an inequality
-		assert( numLogicalProcessors >= numPhysicalProcessors * 2 );
-		// We think adding more tasks than number of physical processors is the right move
-		// as the propagation graph computations (unfortunately) are not cache-friendly
-		// and using hyper-threading can fill pipeline stalls time to some degree.
-		return numPhysicalProcessors + ( numLogicalProcessors - 1 );
-	}
-	return 2;
+ParallelComputationHost::ParallelComputationHost() {
+	taskGroup = trap_TaskGroup_Create();
 }
 
-void *TaskThreadFunc( void *param ) {
-	auto *const task = (ParallelComputationHost::PartialTask *)param;
-	// TODO: This is not that bad as it gets started almost immediately but still...
-	while( !task->hasStarted.load( std::memory_order_relaxed ) ) {
-		trap_Thread_Yield();
-	}
+ParallelComputationHost::~ParallelComputationHost() {
+	DestroyHeldTasks();
+	trap_TaskGroup_Destroy( &taskGroup );
+}
 
-	task->Exec();
+int ParallelComputationHost::SuggestNumberOfTasks() {
+	// Workers are started for every logical processor (including the caller thread one).
+	// The propagation graph computations (unfortunately) are not cache-friendly
+	// and using hyper-threading can fill pipeline stalls time to some degree.
+	return (int)trap_Tasks_NumWorkers();
+}
 
-	task->isCompleted.store( true, std::memory_order_relaxed );
-	return nullptr;
+void ParallelComputationHost::ExecTask( void *arg ) {
+	( *(PartialTask **)arg )->Exec();
 }
 
 bool ParallelComputationHost::TryAddTask( PartialTask *task ) {
 	assert( !isRunning );
 
-	// If there is no tasks, just link the task.
-	// It will be executed in a caller thread even if other tasks are added.
-	if( !tasksHead ) {
-		Link( task, &tasksHead, 0 );
-		return true;
-	}
-
-	assert( !task->hasStarted && !task->isCompleted );
-
-	auto *threadHandle = trap_Thread_Create( &TaskThreadFunc, task );
-	if( !threadHandle ) {
-		// Destroy the task immediately as we always acquire an ownership over the task lifetime.
-		DestroyTask( task );
-		return false;
-	}
-
-	task->threadHandle = threadHandle;
 	Link( task, &tasksHead, 0 );
 	return true;
 }
@@ -79,49 +54,20 @@ void ParallelComputationHost::Exec() {
 
 	isRunning = true;
 
-	PartialTask *thisThreadTask = nullptr;
-	// Launch all tasks if their own
-	for( auto *task = tasksHead; task; task = task->Next() ) {
-		if( task->threadHandle ) {
-			task->hasStarted.store( true, std::memory_order_relaxed );
-			continue;
-		}
-		assert( !thisThreadTask );
-		thisThreadTask = task;
+	// Submit all tasks but the first one which is executed in the caller thread
+	for( auto *task = tasksHead->Next(); task; task = task->Next() ) {
+		trap_Task_Spawn( taskGroup, &ParallelComputationHost::ExecTask, &task, sizeof( task ) );
 	}
 
-	assert( thisThreadTask );
-	// Execute the single task without its thread in the caller thread
-	thisThreadTask->Exec();
+	tasksHead->Exec();
 
-	// Wait for completion of other tasks.
-	// As a CPU workload of tasks is assumed to be +/- equal, this should not take long.
-	WaitForTasksCompletion( thisThreadTask );
+	// Wait for completion of other tasks (executing some of them if they have not been picked up yet).
+	trap_TaskGroup_Wait( taskGroup );
 	DestroyHeldTasks();
 	// We're ready for another batch of tasks
 	isRunning = false;
 }
 
-void ParallelComputationHost::WaitForTasksCompletion( const PartialTask *thisThreadTask ) {
-	for(;; ) {
-		if( AreAllTasksCompleted( thisThreadTask ) ) {
-			return;
-		}
-		// Should not really be bad as all tasks are going to be complete on the first iteration
-		trap_Thread_Yield();
-	}
-}
-
-bool ParallelComputationHost::AreAllTasksCompleted( const PartialTask *thisThreadTask ) {
-	for( auto *task = tasksHead; task; task = task->Next() ) {
-		if( task != thisThreadTask && !task->isCompleted.load( std::memory_order_relaxed ) ) {
-			return false;
-		}
-	}
-
-	return true;
-}
-
 inline void ParallelComputationHost::DestroyTask( PartialTask *task ) {
 	assert( task );
 	task->~PartialTask();
@@ -139,6 +139,8 @@ bool SF_Init( void *hwnd, int maxEntities, bool verbose ) {
 	s_effects_number_threshold = trap_Cvar_Get( "s_effects_number_threshold", "15", CVAR_ARCHIVE );
 	s_hrtf = trap_Cvar_Get( "s_hrtf", "1", CVAR_ARCHIVE | CVAR_LATCH_SOUND );
 	s_realistic_obstruction = trap_Cvar_Get( "s_realistic_obstruction", "1", CVAR_ARCHIVE );
+	// Gets checked by the PropagationTable computation code on its own
+	trap_Cvar_Get( "s_tiled_propagation", "1", CVAR_ARCHIVE );
 
 #ifdef ENABLE_PLAY
 	trap_Cmd_AddCommand( "play", SF_Play_f );
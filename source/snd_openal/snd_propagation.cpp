@@ -14,6 +14,7 @@
 #include "../qalgo/SingletonHolder.h"
 
 #include <algorithm>
+#include <atomic>
 #include <limits>
 #include <memory>
 #include <random>
@@ -974,6 +975,13 @@ DistanceType PathFinder<DistanceType>::FindPath( int fromLeaf,
 	return std::numeric_limits<DistanceType>::infinity();
 }
 
+/**
+ * Gets set by {@code PropagationTable::RequestComputationCancellation()} from an arbitrary thread.
+ * Gets cleared only by {@code PropagationTable::Init()}, so a request made
+ * while other caches are being computed is not lost.
+ */
+static std::atomic_bool isPropagationComputationCancelled { false };
+
 template <typename> class PropagationTableBuilder;
 
 template <typename DistanceType>
@@ -1103,6 +1111,7 @@ class PropagationTableBuilder {
 	int totalWorkload { -1 };
 
 	const bool fastAndCoarse;
+	const bool useTiledSolver;
 
 	/**
 	 * Adds a task progress to an overall progress.
@@ -1113,6 +1122,13 @@ class PropagationTableBuilder {
 	 */
 	void AddTaskProgress( int taskWorkloadDelta );
 
+	/**
+	 * Fills the table using a blocked all-pairs shortest paths solver instead of per-pair path finding.
+	 * Only a single (the best) path is known for every pair of leaves in this mode,
+	 * so results match the {@code fastAndCoarse} path-finding mode.
+	 */
+	bool BuildUsingTiledSolver();
+
 	void ValidateJointResults();
 
 #ifndef _MSC_VER
@@ -1122,11 +1138,18 @@ class PropagationTableBuilder {
 	__declspec( noreturn ) void ValidationError( _Printf_format_string_ const char *format, ... );
 #endif
 public:
-	PropagationTableBuilder( int actualNumLeafs, bool fastAndCoarse_ )
-		: euclideanDistanceTable( (float *)S_Malloc( actualNumLeafs * actualNumLeafs * sizeof( float ) ) )
+	/**
+	 * @param actualNumLeafs an actual number of leaves of the map.
+	 * @param fastAndCoarse_ should be true for computations on a consumer machine.
+	 * @param useTiledSolver_ whether all paths should be found at once by {@code TiledPathsSolver}.
+	 * An euclidean distance table that is required for path-finding is not allocated in this case.
+	 */
+	PropagationTableBuilder( int actualNumLeafs, bool fastAndCoarse_, bool useTiledSolver_ )
+		: euclideanDistanceTable( useTiledSolver_ ? nullptr : (float *)S_Malloc( actualNumLeafs * actualNumLeafs * sizeof( float ) ) )
 		, graphBuilder( actualNumLeafs, fastAndCoarse_ )
 		, pathFinder( euclideanDistanceTable, graphBuilder )
-		, fastAndCoarse( fastAndCoarse_ ) {
+		, fastAndCoarse( fastAndCoarse_ )
+		, useTiledSolver( useTiledSolver_ ) {
 		assert( executedWorkload.is_lock_free() );
 
 		if( euclideanDistanceTable ) {
@@ -1194,7 +1217,7 @@ void PropagationTableBuilder<DistanceType>::AddTaskProgress( int taskWorkloadDel
 template <typename DistanceType>
 bool PropagationTableBuilder<DistanceType>::Build() {
 	// If the euclidean distance table allocation has failed
-	if( !euclideanDistanceTable ) {
+	if( !euclideanDistanceTable && !useTiledSolver ) {
 		return false;
 	}
 
@@ -1217,6 +1240,16 @@ bool PropagationTableBuilder<DistanceType>::Build() {
 
 	memset( table, 0, tableSizeInBytes );
 
+	if( useTiledSolver ) {
+		if( !BuildUsingTiledSolver() ) {
+			return false;
+		}
+#ifndef PUBLIC_BUILD
+		ValidateJointResults();
+#endif
+		return true;
+	}
+
 	// Right now the computation host lifecycle should be limited only to scope where actual computations occur.
 	ComputationHostLifecycleHolder computationHostLifecycleHolder;
 
@@ -1316,6 +1349,11 @@ bool PropagationTableBuilder<DistanceType>::Build() {
 
 	computationHost->Exec();
 
+	if( isPropagationComputationCancelled.load( std::memory_order_relaxed ) ) {
+		Com_Printf( S_COLOR_YELLOW "The sound propagation table computation has been cancelled\n" );
+		return false;
+	}
+
 #ifndef PUBLIC_BUILD
 	ValidateJointResults();
 #endif
@@ -1458,6 +1496,9 @@ void PropagationBuilderTask<DistanceType>::Exec() {
 
 	// Process "rectangular" part of the workload
 	for( int i = 1; i < leafsRangeBegin; ++i ) {
+		if( isPropagationComputationCancelled.load( std::memory_order_relaxed ) ) {
+			return;
+		}
 		for ( int j = leafsRangeBegin; j < leafsRangeEnd; ++j ) {
 			ComputePropsForPair( i, j );
 		}
@@ -1465,6 +1506,9 @@ void PropagationBuilderTask<DistanceType>::Exec() {
 
 	// Process "triangular" part of the workload
 	for( int i = leafsRangeBegin; i < leafsRangeEnd; ++i ) {
+		if( isPropagationComputationCancelled.load( std::memory_order_relaxed ) ) {
+			return;
+		}
 		for( int j = i + 1; j < leafsRangeEnd; ++j ) {
 			ComputePropsForPair( i, j );
 		}
@@ -1684,10 +1728,19 @@ int *PropagationBuilderTask<DistanceType>::UnwindScalingWeights( IteratorType *i
 	return arrayBegin;
 }
 
+/**
+ * Builds an average dir of sound flowing into the first leaf of the chain.
+ * @param graph a graph that provides leaf-to-leaf dirs (edge distances might be temporarily scaled).
+ * @param allocatedDir a buffer for the result.
+ * @param leafsChain a chain of leaves that starts from the leaf the dir is built for.
+ * Only first {@code WeightedDirBuilder::MAX_DIRS} leaves of the chain are actually used.
+ * @param numLeafsInChain a number of leaves in the chain.
+ */
 template <typename DistanceType>
-void PropagationBuilderTask<DistanceType>::BuildInfluxDirForLeaf( float *allocatedDir,
-																  const int *leafsChain,
-																  int numLeafsInChain ) {
+static void BuildInfluxDirForLeaf( const PropagationGraphBuilder<DistanceType> *graph,
+								   float *allocatedDir,
+								   const int *leafsChain,
+								   int numLeafsInChain ) {
 	assert( numLeafsInChain > 1 );
 	const int maxTestedLeafs = std::min( numLeafsInChain, (int)WeightedDirBuilder::MAX_DIRS );
 
@@ -1695,7 +1748,7 @@ void PropagationBuilderTask<DistanceType>::BuildInfluxDirForLeaf( float *allocat
 	for( int i = 1; i < maxTestedLeafs; ++i ) {
 		// The graph edge distance might be (temporarily) scaled.
 		// However infinity values are preserved.
-		if( std::isinf( graphInstance->EdgeDistance( leafsChain[0], leafsChain[i] ) ) ) {
+		if( std::isinf( graph->EdgeDistance( leafsChain[0], leafsChain[i] ) ) ) {
 			// If there were added dirs, stop accumulating dirs
 			if( i > 1 ) {
 				break;
@@ -1722,7 +1775,7 @@ void PropagationBuilderTask<DistanceType>::BuildInfluxDirForLeaf( float *allocat
 
 		// Continue accumulating dirs coming from other leafs to the first one.
 		vec3_t dir;
-		if( !graphInstance->GetDirFromLeafToLeaf( leafsChain[i], leafsChain[0], dir ) ) {
+		if( !graph->GetDirFromLeafToLeaf( leafsChain[i], leafsChain[0], dir ) ) {
 			assert( 0 && "Should not be reached" );
 		}
 
@@ -1743,6 +1796,379 @@ void PropagationBuilderTask<DistanceType>::BuildInfluxDirForLeaf( float *allocat
 	builder.BuildDir( allocatedDir );
 }
 
+template <typename DistanceType>
+void PropagationBuilderTask<DistanceType>::BuildInfluxDirForLeaf( float *allocatedDir,
+																  const int *leafsChain,
+																  int numLeafsInChain ) {
+	::BuildInfluxDirForLeaf<DistanceType>( graphInstance, allocatedDir, leafsChain, numLeafsInChain );
+}
+
+/**
+ * A blocked ("tiled") Floyd-Warshall all-pairs shortest paths solver.
+ * The distance matrix is processed in square tiles that fit into a CPU cache
+ * so every round of the algorithm touches each tile only once.
+ * Besides distances, a "next leaf" matrix is maintained so a path between any pair of leaves can be unwound.
+ * @note A round consists of 3 phases that must be executed in order:
+ * <ul>
+ * <li>relaxing the diagonal tile {@code (k, k)}</li>
+ * <li>relaxing tiles of the {@code k}-th tiles row and column using the diagonal tile</li>
+ * <li>relaxing all remaining tiles using tiles of the {@code k}-th row and column</li>
+ * </ul>
+ * Tiles of the second and third phase are independent within a phase and can be processed in parallel.
+ */
+template <typename DistanceType>
+class TiledPathsSolver {
+	template <typename> friend class TiledPathsTask;
+	template <typename> friend class TiledPropsTask;
+public:
+	/**
+	 * 64x64 tiles of single-precision distances and next leaf numbers take 32 KiB together.
+	 */
+	enum : int { TILE_SIDE = 64 };
+private:
+	DistanceType *distances { nullptr };
+	int32_t *nextLeafs { nullptr };
+	const int numLeafs;
+	const int numTiles;
+
+	/**
+	 * Relaxes paths of the tile {@code (iTile, jTile)} via leaves of the {@code kTile}.
+	 * @note leaves of the {@code kTile} must be iterated in the outer loop
+	 * as the relaxed tile might be the same as a source one.
+	 */
+	void RelaxTile( int iTile, int jTile, int kTile );
+
+	/**
+	 * Relaxes both tiles {@code (kTile, tile)} and {@code (tile, kTile)}.
+	 */
+	void RelaxCrossTiles( int tile, int kTile ) {
+		assert( tile != kTile );
+		RelaxTile( kTile, tile, kTile );
+		RelaxTile( tile, kTile, kTile );
+	}
+
+	/**
+	 * Relaxes all tiles of the {@code iTile} row except these ones that belong to the {@code kTile} cross.
+	 */
+	void RelaxRemainingTilesOfRow( int iTile, int kTile ) {
+		assert( iTile != kTile );
+		for( int jTile = 0; jTile < numTiles; ++jTile ) {
+			if( jTile != kTile ) {
+				RelaxTile( iTile, jTile, kTile );
+			}
+		}
+	}
+public:
+	explicit TiledPathsSolver( int numLeafs_ )
+		: numLeafs( numLeafs_ ), numTiles( ( numLeafs_ + TILE_SIDE - 1 ) / TILE_SIDE ) {}
+
+	~TiledPathsSolver() {
+		if( distances ) {
+			S_Free( distances );
+		}
+		if( nextLeafs ) {
+			S_Free( nextLeafs );
+		}
+	}
+
+	int NumTiles() const { return numTiles; }
+
+	/**
+	 * Allocates the solver matrices and fills them by direct edges of the graph.
+	 * @return false if the solver matrices cannot be allocated.
+	 */
+	bool Prepare( const PropagationGraphBuilder<DistanceType> &graph );
+
+	/**
+	 * Executes the first phase of a round.
+	 */
+	void RelaxDiagonalTile( int kTile ) {
+		RelaxTile( kTile, kTile, kTile );
+	}
+
+	DistanceType PathDistance( int fromLeaf, int toLeaf ) const {
+		return distances[fromLeaf * numLeafs + toLeaf];
+	}
+
+	/**
+	 * Writes first leaves of a best path (starting from {@code fromLeaf}) to a buffer.
+	 * @param fromLeaf a first leaf of the path.
+	 * @param toLeaf a last leaf of the path. There must be a path between these leaves.
+	 * @param leafsChain a buffer for leaf numbers.
+	 * @param maxLeafsInChain a capacity of the buffer.
+	 * @return a number of leaves written (the path gets truncated if its longer than {@code maxLeafsInChain}).
+	 */
+	int UnwindPath( int fromLeaf, int toLeaf, int *leafsChain, int maxLeafsInChain ) const {
+		assert( fromLeaf != toLeaf );
+		assert( std::isfinite( PathDistance( fromLeaf, toLeaf ) ) );
+		int numLeafsInChain = 0;
+		leafsChain[numLeafsInChain++] = fromLeaf;
+		for( int leaf = fromLeaf; leaf != toLeaf && numLeafsInChain < maxLeafsInChain; ) {
+			leaf = nextLeafs[leaf * numLeafs + toLeaf];
+			assert( leaf > 0 && leaf < numLeafs );
+			leafsChain[numLeafsInChain++] = leaf;
+		}
+		return numLeafsInChain;
+	}
+};
+
+template <typename DistanceType>
+bool TiledPathsSolver<DistanceType>::Prepare( const PropagationGraphBuilder<DistanceType> &graph ) {
+	const size_t numCells = (size_t)numLeafs * (size_t)numLeafs;
+	if( !( distances = (DistanceType *)S_Malloc( numCells * sizeof( DistanceType ) ) ) ) {
+		return false;
+	}
+	if( !( nextLeafs = (int32_t *)S_Malloc( numCells * sizeof( int32_t ) ) ) ) {
+		return false;
+	}
+
+	const auto infinity = std::numeric_limits<DistanceType>::infinity();
+	// The zero leaf is kept in matrices to simplify addressing but it is never reachable
+	for( int i = 0; i < numLeafs; ++i ) {
+		distances[i] = distances[i * numLeafs] = infinity;
+		nextLeafs[i] = nextLeafs[i * numLeafs] = -1;
+	}
+
+	for( int i = 1; i < numLeafs; ++i ) {
+		DistanceType *const distancesRow = distances + i * numLeafs;
+		int32_t *const nextLeafsRow = nextLeafs + i * numLeafs;
+		for( int j = 1; j < numLeafs; ++j ) {
+			if( i == j ) {
+				distancesRow[j] = DistanceType( 0 );
+				nextLeafsRow[j] = j;
+				continue;
+			}
+			// Note that a diagonal of the graph table is not guaranteed to be set
+			const DistanceType distance = graph.EdgeDistance( i, j );
+			if( std::isfinite( distance ) ) {
+				distancesRow[j] = distance;
+				nextLeafsRow[j] = j;
+			} else {
+				distancesRow[j] = infinity;
+				nextLeafsRow[j] = -1;
+			}
+		}
+	}
+
+	return true;
+}
+
+template <typename DistanceType>
+void TiledPathsSolver<DistanceType>::RelaxTile( int iTile, int jTile, int kTile ) {
+	const int iBegin = iTile * TILE_SIDE, iEnd = std::min( iBegin + (int)TILE_SIDE, numLeafs );
+	const int jBegin = jTile * TILE_SIDE, jEnd = std::min( jBegin + (int)TILE_SIDE, numLeafs );
+	const int kBegin = kTile * TILE_SIDE, kEnd = std::min( kBegin + (int)TILE_SIDE, numLeafs );
+
+	for( int k = kBegin; k < kEnd; ++k ) {
+		// Rows might be the same for diagonal and cross tiles, so do not use __restrict
+		const DistanceType *const kDistancesRow = distances + k * numLeafs;
+		for( int i = iBegin; i < iEnd; ++i ) {
+			DistanceType *const iDistancesRow = distances + i * numLeafs;
+			const DistanceType ikDistance = iDistancesRow[k];
+			if( std::isinf( ikDistance ) ) {
+				continue;
+			}
+			int32_t *const iNextLeafsRow = nextLeafs + i * numLeafs;
+			const int32_t ikNextLeaf = iNextLeafsRow[k];
+			for( int j = jBegin; j < jEnd; ++j ) {
+				const DistanceType relaxedDistance = ikDistance + kDistancesRow[j];
+				if( relaxedDistance < iDistancesRow[j] ) {
+					iDistancesRow[j] = relaxedDistance;
+					iNextLeafsRow[j] = ikNextLeaf;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Executes a part of the second or the third phase of a {@code TiledPathsSolver} round.
+ * Tiles are distributed between tasks in an interleaved fashion
+ * as workloads of tiles are equal (except the last partial tile).
+ */
+template <typename DistanceType>
+class TiledPathsTask: public ParallelComputationHost::PartialTask {
+	template <typename> friend class PropagationTableBuilder;
+
+	TiledPathsSolver<DistanceType> *const solver;
+	const int kTile;
+	const int taskNum;
+	const int numTasks;
+	const bool isCrossPhase;
+
+	TiledPathsTask( TiledPathsSolver<DistanceType> *solver_, int kTile_, int taskNum_, int numTasks_, bool isCrossPhase_ )
+		: solver( solver_ ), kTile( kTile_ ), taskNum( taskNum_ ), numTasks( numTasks_ ), isCrossPhase( isCrossPhase_ ) {}
+
+	void Exec() override {
+		for( int tile = taskNum, numTiles = solver->NumTiles(); tile < numTiles; tile += numTasks ) {
+			if( tile == kTile ) {
+				continue;
+			}
+			if( isCrossPhase ) {
+				solver->RelaxCrossTiles( tile, kTile );
+			} else {
+				solver->RelaxRemainingTilesOfRow( tile, kTile );
+			}
+		}
+	}
+};
+
+/**
+ * Converts paths found by a {@code TiledPathsSolver} to {@code PropagationTable::PropagationProps}.
+ * Table rows are distributed between tasks in an interleaved fashion
+ * so the triangular workload is split (almost) evenly.
+ */
+template <typename DistanceType>
+class TiledPropsTask: public ParallelComputationHost::PartialTask {
+	template <typename> friend class PropagationTableBuilder;
+
+	using PropagationProps = PropagationTable::PropagationProps;
+
+	const TiledPathsSolver<DistanceType> *const solver;
+	const PropagationGraphBuilder<DistanceType> *const graph;
+	PropagationProps *const table;
+	const int taskNum;
+	const int numTasks;
+
+	TiledPropsTask( const TiledPathsSolver<DistanceType> *solver_,
+					const PropagationGraphBuilder<DistanceType> *graph_,
+					PropagationProps *table_, int taskNum_, int numTasks_ )
+		: solver( solver_ ), graph( graph_ ), table( table_ ), taskNum( taskNum_ ), numTasks( numTasks_ ) {}
+
+	void Exec() override;
+
+	void ComputePropsForPair( int leaf1, int leaf2 );
+};
+
+template <typename DistanceType>
+void TiledPropsTask<DistanceType>::Exec() {
+	const int numLeafs = graph->NumLeafs();
+	for( int i = 1 + taskNum; i < numLeafs; i += numTasks ) {
+		if( isPropagationComputationCancelled.load( std::memory_order_relaxed ) ) {
+			return;
+		}
+		for( int j = i + 1; j < numLeafs; ++j ) {
+			ComputePropsForPair( i, j );
+		}
+	}
+}
+
+template <typename DistanceType>
+void TiledPropsTask<DistanceType>::ComputePropsForPair( int leaf1, int leaf2 ) {
+	const int numLeafs = graph->NumLeafs();
+	PropagationProps *const firstProps = &table[leaf1 * numLeafs + leaf2];
+	PropagationProps *const secondProps = &table[leaf2 * numLeafs + leaf1];
+	if( std::isfinite( graph->EdgeDistance( leaf1, leaf2 ) ) ) {
+		firstProps->SetHasDirectPath();
+		secondProps->SetHasDirectPath();
+		return;
+	}
+
+	const DistanceType distance = solver->PathDistance( leaf1, leaf2 );
+	if( !std::isfinite( distance ) ) {
+		firstProps->MarkAsFailed();
+		secondProps->MarkAsFailed();
+		return;
+	}
+
+	// Only first leaves of a path contribute to an influx dir
+	int leafsChain[WeightedDirBuilder::MAX_DIRS];
+	vec3_t dir1, dir2;
+
+	// A chain that starts from the first leaf yields a 2->1 "propagation window"
+	int numLeafsInChain = solver->UnwindPath( leaf1, leaf2, leafsChain, WeightedDirBuilder::MAX_DIRS );
+	BuildInfluxDirForLeaf( graph, dir2, leafsChain, numLeafsInChain );
+	// A chain that starts from the second leaf yields a 1->2 "propagation window"
+	numLeafsInChain = solver->UnwindPath( leaf2, leaf1, leafsChain, WeightedDirBuilder::MAX_DIRS );
+	BuildInfluxDirForLeaf( graph, dir1, leafsChain, numLeafsInChain );
+
+	firstProps->SetIndirectPath( dir1, (float)distance );
+	secondProps->SetIndirectPath( dir2, (float)distance );
+}
+
+template <typename DistanceType>
+bool PropagationTableBuilder<DistanceType>::BuildUsingTiledSolver() {
+	const int numLeafs = graphBuilder.NumLeafs();
+
+	TiledPathsSolver<DistanceType> solver( numLeafs );
+	if( !solver.Prepare( graphBuilder ) ) {
+		return false;
+	}
+
+	using PathsTaskType = TiledPathsTask<DistanceType>;
+	using PropsTaskType = TiledPropsTask<DistanceType>;
+
+	// Right now the computation host lifecycle should be limited only to scope where actual computations occur.
+	ComputationHostLifecycleHolder computationHostLifecycleHolder;
+	auto *const computationHost = computationHostLifecycleHolder.Instance();
+	// Tasks are very lightweight as objects and share all the data, so there is no explicit limit.
+	const int numTasks = std::max( 1, computationHost->SuggestNumberOfTasks() );
+
+	// Tasks are destroyed by the host after every Exec() call, so we have to create them for every phase.
+	// This is fine as the amount of computations per phase is huge compared to a thread creation cost.
+	const auto execParallelPhase = [&]( int kTile, bool isCrossPhase ) -> bool {
+		for( int i = 0; i < numTasks; ++i ) {
+			void *const objectMem = S_Malloc( sizeof( PathsTaskType ) );
+			if( !objectMem ) {
+				computationHost->DestroyHeldTasks();
+				return false;
+			}
+			auto *const task = new( objectMem )PathsTaskType( &solver, kTile, i, numTasks, isCrossPhase );
+			if( !computationHost->TryAddTask( task ) ) {
+				computationHost->DestroyHeldTasks();
+				return false;
+			}
+		}
+		computationHost->Exec();
+		return true;
+	};
+
+	const int numTiles = solver.NumTiles();
+	int lastShownProgress = -1;
+	for( int kTile = 0; kTile < numTiles; ++kTile ) {
+		if( isPropagationComputationCancelled.load( std::memory_order_relaxed ) ) {
+			Com_Printf( S_COLOR_YELLOW "The sound propagation table computation has been cancelled\n" );
+			return false;
+		}
+
+		const auto progress = (int)( ( 100.0f / (float)numTiles ) * kTile );
+		if( progress != lastShownProgress ) {
+			Com_Printf( "Computing sound propagation paths... %2d%%\n", progress );
+			lastShownProgress = progress;
+		}
+
+		solver.RelaxDiagonalTile( kTile );
+		if( !execParallelPhase( kTile, true ) ) {
+			return false;
+		}
+		if( !execParallelPhase( kTile, false ) ) {
+			return false;
+		}
+	}
+
+	for( int i = 0; i < numTasks; ++i ) {
+		void *const objectMem = S_Malloc( sizeof( PropsTaskType ) );
+		if( !objectMem ) {
+			computationHost->DestroyHeldTasks();
+			return false;
+		}
+		auto *const task = new( objectMem )PropsTaskType( &solver, &graphBuilder, table, i, numTasks );
+		if( !computationHost->TryAddTask( task ) ) {
+			computationHost->DestroyHeldTasks();
+			return false;
+		}
+	}
+
+	computationHost->Exec();
+
+	if( isPropagationComputationCancelled.load( std::memory_order_relaxed ) ) {
+		Com_Printf( S_COLOR_YELLOW "The sound propagation table computation has been cancelled\n" );
+		return false;
+	}
+
+	return true;
+}
+
 class PropagationIOHelper {
 protected:
 	using PropagationProps = PropagationTable::PropagationProps;
@@ -1777,6 +2203,7 @@ PropagationTable *PropagationTable::Instance() {
 }
 
 void PropagationTable::Init() {
+	isPropagationComputationCancelled.store( false, std::memory_order_relaxed );
 	propagationTableHolder.Init();
 }
 
@@ -1800,9 +2227,19 @@ bool PropagationTable::TryReadFromFile( int fsFlags ) {
 	return ( this->table = reader.ReadPropsTable( NumLeafs() ) ) != nullptr;
 }
 
+void PropagationTable::RequestComputationCancellation() {
+	isPropagationComputationCancelled.store( true, std::memory_order_relaxed );
+}
+
+bool PropagationTable::IsComputationCancelled() {
+	return isPropagationComputationCancelled.load( std::memory_order_relaxed );
+}
+
 bool PropagationTable::ComputeNewState( bool fastAndCoarse ) {
 	if( fastAndCoarse ) {
-		PropagationTableBuilder<float> builder( NumLeafs(), fastAndCoarse );
+		// Finding alternative paths is not supported by the tiled solver, so it is used only in this mode
+		const bool useTiledSolver = trap_Cvar_Value( "s_tiled_propagation" ) != 0;
+		PropagationTableBuilder<float> builder( NumLeafs(), fastAndCoarse, useTiledSolver );
 		if( builder.Build()) {
 			table = builder.ReleaseOwnership();
 			return true;
@@ -1810,7 +2247,7 @@ bool PropagationTable::ComputeNewState( bool fastAndCoarse ) {
 		return false;
 	}
 
-	PropagationTableBuilder<double> builder( NumLeafs(), fastAndCoarse );
+	PropagationTableBuilder<double> builder( NumLeafs(), fastAndCoarse, false );
 	if( builder.Build()) {
 		table = builder.ReleaseOwnership();
 		return true;
@@ -113,6 +113,7 @@ class PropagationTable: public CachedComputation {
 	friend class PropagationTableWriter;
 	template <typename> friend class PropagationTableBuilder;
 	template <typename> friend class PropagationBuilderTask;
+	template <typename> friend class TiledPropsTask;
 	friend class CachedLeafsGraph;
 	template <typename> friend class SingletonHolder;
 
@@ -245,6 +246,16 @@ public:
 		return true;
 	}
 
+	/**
+	 * Requests interruption of a propagation table computation that is in progress (if any).
+	 * Might be called from any thread (e.g. from a signal handler of an offline baking tool).
+	 * An interrupted computation is considered failed and its results are not saved.
+	 * The request stays in effect until the next {@code Init()} call.
+	 */
+	static void RequestComputationCancellation();
+
+	static bool IsComputationCancelled();
+
 	static PropagationTable *Instance();
 	static void Init();
 	static void Shutdown();
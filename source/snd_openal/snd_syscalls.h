@@ -262,6 +262,10 @@ static inline qbufPipe_t *trap_BufPipe_Create( size_t bufSize, int flags ) {
 	return SOUND_IMPORT.BufPipe_Create( bufSize, flags );
 }
 
+static inline void trap_BufPipe_SetName( qbufPipe_t *queue, const char *name ) {
+	SOUND_IMPORT.BufPipe_SetName( queue, name );
+}
+
 static inline void trap_BufPipe_Destroy( qbufPipe_t **pqueue ) {
 	SOUND_IMPORT.BufPipe_Destroy( pqueue );
 }
@@ -287,4 +291,29 @@ static inline bool trap_GetNumberOfProcessors( unsigned *physical, unsigned *log
 	return SOUND_IMPORT.GetNumberOfProcessors( physical, logical );
 }
 
+static inline unsigned trap_Tasks_NumWorkers( void ) {
+	return SOUND_IMPORT.Tasks_NumWorkers();
+}
+
+static inline struct qtaskgroup_s *trap_TaskGroup_Create( void ) {
+	return SOUND_IMPORT.TaskGroup_Create();
+}
+
+static inline void trap_TaskGroup_Destroy( struct qtaskgroup_s **pgroup ) {
+	SOUND_IMPORT.TaskGroup_Destroy( pgroup );
+}
+
+static inline void trap_TaskGroup_Wait( struct qtaskgroup_s *group ) {
+	SOUND_IMPORT.TaskGroup_Wait( group );
+}
+
+static inline void trap_Task_Spawn( struct qtaskgroup_s *group, qtaskfunc_t func, const void *arg, size_t argSize ) {
+	SOUND_IMPORT.Task_Spawn( group, func, arg, argSize );
+}
+
+static inline void trap_Task_ParallelFor( struct qtaskgroup_s *group, qtaskrangefunc_t func, const void *arg, size_t argSize,
+										  unsigned items, unsigned grain ) {
+	SOUND_IMPORT.Task_ParallelFor( group, func, arg, argSize, items, grain );
+}
+
 #endif
\ No newline at end of file
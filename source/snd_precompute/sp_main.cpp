@@ -0,0 +1,336 @@
+// sp_main.cpp -- a headless tool that precomputes sound environment caches for maps
+// and benchmarks sound environment queries without OpenAL and a window.
+//
+// Usage: snd_precompute [+set <cvar> <value>...] [-benchmark <queries>] [-seed <seed>] [maps...]
+// If no maps are specified, all maps found by the filesystem are processed.
+// Set "developer" to 1 to compute high-quality data that is intended to be shipped along with maps.
+
+#include "../qcommon/qcommon.h"
+#include "../qcommon/compression.h"
+#include "../client/snd_public.h"
+
+#include "sp_public.h"
+
+#include <signal.h>
+
+static cmodel_state_t *sp_cms;
+static char sp_worldModel[MAX_CONFIGSTRING_CHARS];
+static char sp_mapChecksum[MAX_CONFIGSTRING_CHARS];
+
+static mempool_t *sp_mempool;
+
+#ifndef _MSC_VER
+static void SP_Error( const char *msg ) __attribute__( ( noreturn ) );
+#else
+__declspec( noreturn ) static void SP_Error( const char *msg );
+#endif
+
+static void SP_Error( const char *msg ) {
+	Com_Error( ERR_FATAL, "%s", msg );
+}
+
+static void SP_Print( const char *msg ) {
+	Com_Printf( "%s", msg );
+}
+
+static void *SP_MemAlloc( mempool_t *pool, size_t size, const char *filename, int fileline ) {
+	return _Mem_Alloc( pool, size, MEMPOOL_SOUND, 0, filename, fileline );
+}
+
+static void SP_MemFree( void *data, const char *filename, int fileline ) {
+	_Mem_Free( data, MEMPOOL_SOUND, 0, filename, fileline );
+}
+
+static mempool_t *SP_MemAllocPool( const char *name, const char *filename, int fileline ) {
+	return _Mem_AllocPool( sp_mempool, name, MEMPOOL_SOUND, filename, fileline );
+}
+
+static void SP_MemFreePool( mempool_t **pool, const char *filename, int fileline ) {
+	_Mem_FreePool( pool, MEMPOOL_SOUND, 0, filename, fileline );
+}
+
+static void SP_MemEmptyPool( mempool_t *pool, const char *filename, int fileline ) {
+	_Mem_EmptyPool( pool, MEMPOOL_SOUND, 0, filename, fileline );
+}
+
+static void SP_Trace( trace_t *tr, const vec3_t start, const vec3_t end,
+					  const vec3_t mins, const vec3_t maxs, int mask, int topNodeHint ) {
+	CM_TransformedBoxTrace( sp_cms, tr, start, end, mins, maxs, NULL, mask, NULL, NULL, topNodeHint );
+}
+
+static int SP_PointContents( const vec3_t p, int topNodeHint ) {
+	return CM_TransformedPointContents( sp_cms, p, NULL, NULL, NULL, topNodeHint );
+}
+
+static int SP_PointLeafNum( const vec3_t p, int topNodeHint ) {
+	return CM_PointLeafnum( sp_cms, p, topNodeHint );
+}
+
+static int SP_NumLeafs() {
+	return CM_NumLeafs( sp_cms );
+}
+
+static const vec3_t *SP_GetLeafBounds( int leafnum ) {
+	return CM_GetLeafBounds( sp_cms, leafnum );
+}
+
+static bool SP_LeafsInPVS( int leafnum1, int leafnum2 ) {
+	return CM_LeafsInPVS( sp_cms, leafnum1, leafnum2 );
+}
+
+static int SP_FindTopNodeForBox( const vec3_t mins, const vec3_t maxs ) {
+	return CM_FindTopNodeForBox( sp_cms, mins, maxs );
+}
+
+static int SP_FindTopNodeForSphere( const vec3_t center, float radius ) {
+	return CM_FindTopNodeForSphere( sp_cms, center, radius );
+}
+
+static const char *SP_GetConfigString( int index ) {
+	// Only these configstrings are used by sound environment computations
+	if( index == CS_WORLDMODEL ) {
+		return sp_worldModel;
+	}
+	if( index == CS_MAPCHECKSUM ) {
+		return sp_mapChecksum;
+	}
+	return "";
+}
+
+static void SP_InitImport( sound_import_t *import ) {
+	memset( import, 0, sizeof( *import ) );
+
+	import->Error = SP_Error;
+	import->Print = SP_Print;
+
+	import->Cvar_Get = Cvar_Get;
+	import->Cvar_Set = Cvar_Set;
+	import->Cvar_SetValue = Cvar_SetValue;
+	import->Cvar_ForceSet = Cvar_ForceSet;
+	import->Cvar_String = Cvar_String;
+	import->Cvar_Value = Cvar_Value;
+
+	import->Cmd_Argc = Cmd_Argc;
+	import->Cmd_Argv = Cmd_Argv;
+	import->Cmd_Args = Cmd_Args;
+
+	import->Cmd_AddCommand = Cmd_AddCommand;
+	import->Cmd_RemoveCommand = Cmd_RemoveCommand;
+	import->Cmd_ExecuteText = Cbuf_ExecuteText;
+	import->Cmd_Execute = Cbuf_Execute;
+	import->Cmd_SetCompletionFunc = Cmd_SetCompletionFunc;
+
+	import->FS_FOpenFile = FS_FOpenFile;
+	import->FS_Read = FS_Read;
+	import->FS_Write = FS_Write;
+	import->FS_Print = FS_Print;
+	import->FS_Tell = FS_Tell;
+	import->FS_Seek = FS_Seek;
+	import->FS_Eof = FS_Eof;
+	import->FS_Flush = FS_Flush;
+	import->FS_FCloseFile = FS_FCloseFile;
+	import->FS_RemoveFile = FS_RemoveFile;
+	import->FS_GetFileList = FS_GetFileList;
+	import->FS_IsUrl = FS_IsUrl;
+
+	import->Sys_Milliseconds = Sys_Milliseconds;
+	import->Sys_Microseconds = Sys_Microseconds;
+	import->Sys_Sleep = Sys_Sleep;
+
+	import->Sys_LoadLibrary = Com_LoadSysLibrary;
+	import->Sys_UnloadLibrary = Com_UnloadLibrary;
+
+	import->Mem_Alloc = SP_MemAlloc;
+	import->Mem_Free = SP_MemFree;
+	import->Mem_AllocPool = SP_MemAllocPool;
+	import->Mem_FreePool = SP_MemFreePool;
+	import->Mem_EmptyPool = SP_MemEmptyPool;
+
+	import->Trace = SP_Trace;
+	import->PointContents = SP_PointContents;
+	import->PointLeafNum = SP_PointLeafNum;
+	import->NumLeafs = SP_NumLeafs;
+	import->GetLeafBounds = SP_GetLeafBounds;
+	import->LeafsInPVS = SP_LeafsInPVS;
+	import->FindTopNodeForBox = SP_FindTopNodeForBox;
+	import->FindTopNodeForSphere = SP_FindTopNodeForSphere;
+
+	import->GetConfigString = SP_GetConfigString;
+
+	import->Thread_Create = QThread_Create;
+	import->Thread_Join = QThread_Join;
+	import->Thread_Yield = QThread_Yield;
+	import->Mutex_Create = QMutex_Create;
+	import->Mutex_Destroy = QMutex_Destroy;
+	import->Mutex_Lock = QMutex_Lock;
+	import->Mutex_Unlock = QMutex_Unlock;
+
+	import->BufPipe_Create = QBufPipe_Create;
+	import->BufPipe_SetName = QBufPipe_SetName;
+	import->BufPipe_Destroy = QBufPipe_Destroy;
+	import->BufPipe_Finish = QBufPipe_Finish;
+	import->BufPipe_WriteCmd = QBufPipe_WriteCmd;
+	import->BufPipe_ReadCmds = QBufPipe_ReadCmds;
+	import->BufPipe_Wait = QBufPipe_Wait;
+
+	import->GetNumberOfProcessors = Sys_GetNumberOfProcessors;
+
+	import->Tasks_NumWorkers = QTasks_NumWorkers;
+	import->TaskGroup_Create = QTaskGroup_Create;
+	import->TaskGroup_Destroy = QTaskGroup_Destroy;
+	import->TaskGroup_Wait = QTaskGroup_Wait;
+	import->Task_Spawn = QTask_Spawn;
+	import->Task_ParallelFor = QTask_ParallelFor;
+}
+
+static void SP_SignalHandler( int sig ) {
+	// Let a propagation table computation stop gracefully, so the tool does not save partial results
+	SP_RequestCancellation();
+	signal( sig, SIG_DFL );
+}
+
+/*
+* SP_ProcessMap
+*/
+static bool SP_ProcessMap( const char *mapname, unsigned numBenchmarkQueries, unsigned benchmarkSeed ) {
+	unsigned checksum;
+
+	Q_snprintfz( sp_worldModel, sizeof( sp_worldModel ), "maps/%s.bsp", mapname );
+	// CM_LoadMap() fails with a fatal error for missing maps, this should not interrupt processing of other ones
+	if( FS_FOpenFile( sp_worldModel, NULL, FS_READ ) == -1 ) {
+		Com_Printf( S_COLOR_RED "Can't find %s\n", sp_worldModel );
+		return false;
+	}
+	if( !CM_LoadMap( sp_cms, sp_worldModel, false, &checksum ) ) {
+		Com_Printf( S_COLOR_RED "Can't load %s\n", sp_worldModel );
+		return false;
+	}
+	Q_snprintfz( sp_mapChecksum, sizeof( sp_mapChecksum ), "%i", checksum );
+
+	Com_Printf( "Processing %s (%d leaves)\n", sp_worldModel, CM_NumLeafs( sp_cms ) );
+
+	sp_precompute_stats_t stats;
+	SP_PrecomputeMap( &stats );
+	Com_Printf( "%s: leaf props %" PRIi64 " ms, leafs graph %" PRIi64 " ms, propagation table %" PRIi64 " ms\n",
+				mapname, stats.leafPropsMillis, stats.leafsGraphMillis, stats.propagationTableMillis );
+	if( !stats.usesValidData ) {
+		Com_Printf( S_COLOR_YELLOW "%s: some computations have failed, dummy data is used\n", mapname );
+	}
+
+	if( numBenchmarkQueries ) {
+		sp_benchmark_result_t results[SP_MAX_BENCHMARK_RESULTS];
+		const int numResults = SP_RunBenchmark( numBenchmarkQueries, benchmarkSeed, results, SP_MAX_BENCHMARK_RESULTS );
+		for( int i = 0; i < numResults; ++i ) {
+			const sp_benchmark_result_t *result = &results[i];
+			const double perSecond = result->micros ? ( 1000000.0 * result->numQueries ) / result->micros : 0.0;
+			Com_Printf( "%s: benchmark: %s: %u queries in %" PRIi64 " us (%.1f queries/s)\n",
+						mapname, result->name, result->numQueries, result->micros, perSecond );
+		}
+	}
+
+	return stats.usesValidData;
+}
+
+int main( int argc, char **argv ) {
+	unsigned numBenchmarkQueries = 0;
+	unsigned benchmarkSeed = 1;
+
+	QThreads_Init();
+	Memory_Init();
+	COM_InitArgv( argc, argv );
+
+	Cbuf_Init();
+	Cmd_PreInit();
+	Cvar_PreInit();
+	Dynvar_PreInit();
+	Cmd_Init();
+	Cvar_Init();
+	Dynvar_Init();
+
+	// A basepath and a game dir might be specified via +set commands
+	Cbuf_AddEarlyCommands( false );
+	Cbuf_Execute();
+
+	dedicated = Cvar_Get( "dedicated", "1", CVAR_NOSET );
+	developer = Cvar_Get( "developer", "0", 0 );
+
+	Com_LoadCompressionLibraries();
+
+	FS_Init();
+	CM_Init();
+	QTasks_Init();
+
+	sp_mempool = Mem_AllocPool( NULL, "Sound Precompute" );
+	sp_cms = CM_New( NULL );
+	CM_AddReference( sp_cms );
+
+	sound_import_t import;
+	SP_InitImport( &import );
+	SP_Init( &import );
+	// This cvar is normally registered by the sound module initialization
+	Cvar_Get( "s_tiled_propagation", "1", CVAR_ARCHIVE );
+
+	signal( SIGINT, SP_SignalHandler );
+	signal( SIGTERM, SP_SignalHandler );
+
+	// Collect map names skipping cvar commands
+	const char *mapnames[256];
+	int numMapnames = 0;
+	for( int i = 1; i < argc; ++i ) {
+		if( !Q_stricmp( argv[i], "+set" ) ) {
+			i += 2;
+		} else if( !Q_stricmp( argv[i], "-benchmark" ) && i + 1 < argc ) {
+			numBenchmarkQueries = (unsigned)atoi( argv[++i] );
+		} else if( !Q_stricmp( argv[i], "-seed" ) && i + 1 < argc ) {
+			benchmarkSeed = (unsigned)atoi( argv[++i] );
+		} else if( numMapnames < (int)( sizeof( mapnames ) / sizeof( mapnames[0] ) ) ) {
+			mapnames[numMapnames++] = argv[i];
+		}
+	}
+
+	int numFailures = 0;
+	if( numMapnames ) {
+		for( int i = 0; i < numMapnames && !SP_IsCancelled(); ++i ) {
+			numFailures += SP_ProcessMap( mapnames[i], numBenchmarkQueries, benchmarkSeed ) ? 0 : 1;
+		}
+	} else {
+		char buffer[MAX_STRING_CHARS];
+		char mapname[MAX_QPATH];
+		for( int start = 0; !SP_IsCancelled(); ) {
+			const int numFiles = FS_GetFileList( "maps", ".bsp", buffer, sizeof( buffer ), start, 0 );
+			if( !numFiles ) {
+				break;
+			}
+			const char *s = buffer;
+			for( int i = 0; i < numFiles && !SP_IsCancelled(); ++i, s += strlen( s ) + 1 ) {
+				Q_strncpyz( mapname, s, sizeof( mapname ) );
+				COM_StripExtension( mapname );
+				numFailures += SP_ProcessMap( mapname, numBenchmarkQueries, benchmarkSeed ) ? 0 : 1;
+			}
+			start += numFiles;
+		}
+	}
+
+	if( SP_IsCancelled() ) {
+		Com_Printf( S_COLOR_YELLOW "Cancelled, remaining maps have not been processed\n" );
+		numFailures++;
+	}
+
+	SP_Shutdown();
+
+	CM_ReleaseReference( sp_cms );
+	Mem_FreePool( &sp_mempool );
+
+	QTasks_Shutdown();
+	CM_Shutdown();
+	FS_Shutdown();
+	Com_UnloadCompressionLibraries();
+	Dynvar_Shutdown();
+	Cvar_Shutdown();
+	Cmd_Shutdown();
+	Cbuf_Shutdown();
+	Memory_Shutdown();
+	QThreads_Shutdown();
+
+	return numFailures ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+#ifndef QFUSION_SP_PUBLIC_H
+#define QFUSION_SP_PUBLIC_H
+
+// sp_public.h -- an interface between the qcommon part of the headless sound precompute tool
+// and its part that is built from the sound module sources.
+// The sound part accesses the engine only via sound_import_t exactly as the real sound module does.
+
+typedef struct {
+	int64_t leafPropsMillis;
+	int64_t leafsGraphMillis;
+	int64_t propagationTableMillis;
+	bool usesValidData;
+} sp_precompute_stats_t;
+
+typedef struct {
+	const char *name;
+	unsigned numQueries;
+	int64_t micros;
+} sp_benchmark_result_t;
+
+#define SP_MAX_BENCHMARK_RESULTS 8
+
+/*
+* SP_Init
+*
+* Must be called before any other call. The import table is copied.
+*/
+void SP_Init( sound_import_t *import );
+void SP_Shutdown( void );
+
+/*
+* SP_PrecomputeMap
+*
+* Makes all sound environment caches valid for the map that is currently set via the import table.
+* Caches are loaded from the filesystem if they are present and are computed and saved to the cache directory otherwise.
+*/
+void SP_PrecomputeMap( sp_precompute_stats_t *stats );
+
+/*
+* SP_RunBenchmark
+*
+* Runs queries for the current map that are typical for the sound environment sampling.
+* Results are reproducible for the same map, seed and number of queries.
+* Returns a number of filled results.
+*/
+int SP_RunBenchmark( unsigned numQueries, unsigned seed, sp_benchmark_result_t *results, int maxResults );
+
+/*
+* SP_RequestCancellation
+*
+* Might be called from a signal handler.
+*/
+void SP_RequestCancellation( void );
+
+/*
+* SP_IsCancelled
+*
+* Returns true once a cancellation has been requested, the tool must not process other maps then.
+*/
+bool SP_IsCancelled( void );
+
+#endif
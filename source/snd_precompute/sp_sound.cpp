@@ -0,0 +1,213 @@
+#include "../snd_openal/snd_local.h"
+#include "../snd_openal/snd_leaf_props_cache.h"
+#include "../snd_openal/snd_propagation.h"
+#include "../snd_openal/snd_raycast_sampler.h"
+#include "../snd_openal/snd_effect_sampler.h"
+#include "../gameshared/q_collision.h"
+#include "../gameshared/q_comref.h"
+
+#include "sp_public.h"
+
+#include <random>
+
+sound_import_t SOUND_IMPORT;
+
+void SP_Init( sound_import_t *import ) {
+	SOUND_IMPORT = *import;
+
+	soundpool = S_MemAllocPool( "Sound precompute" );
+
+	LeafPropsCache::Init();
+	CachedLeafsGraph::Init();
+	PropagationTable::Init();
+}
+
+void SP_Shutdown( void ) {
+	LeafPropsCache::Shutdown();
+	CachedLeafsGraph::Shutdown();
+	PropagationTable::Shutdown();
+
+	if( soundpool ) {
+		S_MemFreePool( &soundpool );
+	}
+}
+
+void SP_RequestCancellation( void ) {
+	PropagationTable::RequestComputationCancellation();
+}
+
+bool SP_IsCancelled( void ) {
+	return PropagationTable::IsComputationCancelled();
+}
+
+void SP_PrecomputeMap( sp_precompute_stats_t *stats ) {
+	// The order matters as it is the same as in ENV_DispatchEnsureValidCall()
+	int64_t startedAt = trap_Milliseconds();
+	LeafPropsCache::Instance()->EnsureValid();
+	stats->leafPropsMillis = trap_Milliseconds() - startedAt;
+
+	startedAt = trap_Milliseconds();
+	CachedLeafsGraph::Instance()->EnsureValid();
+	stats->leafsGraphMillis = trap_Milliseconds() - startedAt;
+
+	startedAt = trap_Milliseconds();
+	PropagationTable::Instance()->EnsureValid();
+	stats->propagationTableMillis = trap_Milliseconds() - startedAt;
+
+	stats->usesValidData = LeafPropsCache::Instance()->IsUsingValidData();
+	stats->usesValidData &= CachedLeafsGraph::Instance()->IsUsingValidData();
+	stats->usesValidData &= PropagationTable::Instance()->IsUsingValidData();
+}
+
+/**
+ * A sampler that performs the same primary rays emission
+ * as samplers of the sound module do for leaf props and reverb computations.
+ */
+class BenchmarkRaycastSampler final: public GenericRaycastSampler {
+public:
+	enum { NUM_RAYS = MAX_REVERB_PRIMARY_RAY_SAMPLES };
+private:
+	vec3_t rayDirs[NUM_RAYS];
+	vec3_t hitPoints[NUM_RAYS];
+	float hitDistances[NUM_RAYS];
+public:
+	BenchmarkRaycastSampler() {
+		SetupSamplingRayDirs( rayDirs, NUM_RAYS );
+	}
+
+	/**
+	 * Emits rays from the origin and computes environment factors like {@code LeafPropsSampler} does.
+	 * @return an accumulated value of factors that is useful only for preventing optimizing out the computations.
+	 */
+	float Sample( const vec3_t origin ) {
+		ResetMutableState( rayDirs, hitPoints, hitDistances, origin );
+		numPrimaryRays = NUM_RAYS;
+		EmitPrimaryRays();
+		if( !numPrimaryHits ) {
+			return 0.0f;
+		}
+		return ComputeRoomSizeFactor() + ComputeSkyFactor() + ComputeWaterFactor() + ComputeMetalFactor();
+	}
+};
+
+/**
+ * A helper for selection of random points that are not in solid.
+ * A generated sequence is determined by the seed and map leaves only.
+ */
+class RandomPointsGenerator {
+	std::minstd_rand engine;
+	const int numLeafs;
+public:
+	RandomPointsGenerator( unsigned seed, int numLeafs_ ): engine( seed ), numLeafs( numLeafs_ ) {}
+
+	int NextLeaf() {
+		// Skip the zero leaf
+		return 1 + (int)( engine() % ( numLeafs - 1 ) );
+	}
+
+	bool NextPoint( vec3_t point, int *leafNum ) {
+		// Do a bounded number of attempts, there are maps that mostly consist of solid leaves
+		for( int attempt = 0; attempt < 16; ++attempt ) {
+			const int leaf = NextLeaf();
+			const vec3_t *bounds = trap_GetLeafBounds( leaf );
+			for( int i = 0; i < 3; ++i ) {
+				const float frac = ( engine() - engine.min() ) / (float)( engine.max() - engine.min() );
+				point[i] = bounds[0][i] + frac * ( bounds[1][i] - bounds[0][i] );
+			}
+			if( trap_PointContents( point, 0 ) & MASK_SOLID ) {
+				continue;
+			}
+			*leafNum = trap_PointLeafNum( point, 0 );
+			if( *leafNum > 0 ) {
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+static void SP_AddResult( sp_benchmark_result_t *results, int *numResults, int maxResults,
+						  const char *name, unsigned numQueries, int64_t micros ) {
+	if( *numResults >= maxResults ) {
+		return;
+	}
+	sp_benchmark_result_t *result = &results[( *numResults )++];
+	result->name = name;
+	result->numQueries = numQueries;
+	result->micros = micros;
+}
+
+int SP_RunBenchmark( unsigned numQueries, unsigned seed, sp_benchmark_result_t *results, int maxResults ) {
+	const int numLeafs = trap_NumLeafs();
+	if( numLeafs < 2 || !numQueries ) {
+		return 0;
+	}
+
+	const auto *const leafPropsCache = LeafPropsCache::Instance();
+	const auto *const propagationTable = PropagationTable::Instance();
+
+	int numResults = 0;
+	// Prevent optimizing out the queries
+	volatile float sink = 0.0f;
+
+	// Select points first so the selection cost does not affect other results
+	vec3_t *const points = (vec3_t *)S_Malloc( numQueries * sizeof( vec3_t ) );
+	int *const leafNums = (int *)S_Malloc( numQueries * sizeof( int ) );
+	unsigned numPoints = 0;
+	RandomPointsGenerator generator( seed, numLeafs );
+	uint64_t startedAt = trap_Microseconds();
+	for( unsigned i = 0; i < numQueries; ++i ) {
+		if( generator.NextPoint( points[numPoints], &leafNums[numPoints] ) ) {
+			numPoints++;
+		}
+	}
+	SP_AddResult( results, &numResults, maxResults, "point selection", numQueries, trap_Microseconds() - startedAt );
+
+	if( !numPoints ) {
+		S_Free( leafNums );
+		S_Free( points );
+		return numResults;
+	}
+
+	startedAt = trap_Microseconds();
+	for( unsigned i = 0; i < numPoints; ++i ) {
+		sink = sink + trap_PointLeafNum( points[i], 0 );
+	}
+	SP_AddResult( results, &numResults, maxResults, "point leaf lookup", numPoints, trap_Microseconds() - startedAt );
+
+	startedAt = trap_Microseconds();
+	for( unsigned i = 0; i < numPoints; ++i ) {
+		const LeafProps &props = leafPropsCache->GetPropsForLeaf( leafNums[i] );
+		sink = sink + props.RoomSizeFactor() + props.SkyFactor() + props.WaterFactor() + props.MetalFactor();
+	}
+	SP_AddResult( results, &numResults, maxResults, "leaf props lookup", numPoints, trap_Microseconds() - startedAt );
+
+	// Pair adjacent points as a source and a listener
+	startedAt = trap_Microseconds();
+	for( unsigned i = 0; i + 1 < numPoints; ++i ) {
+		vec3_t dir;
+		float distance;
+		const int sourceLeaf = leafNums[i], listenerLeaf = leafNums[i + 1];
+		if( propagationTable->HasDirectPath( sourceLeaf, listenerLeaf ) ) {
+			sink = sink + 1.0f;
+		} else if( propagationTable->GetIndirectPathProps( sourceLeaf, listenerLeaf, dir, &distance ) ) {
+			sink = sink + distance + dir[0];
+		}
+	}
+	SP_AddResult( results, &numResults, maxResults, "propagation lookup", numPoints - 1, trap_Microseconds() - startedAt );
+
+	// Raycasting is orders of magnitude more expensive, use a fraction of points
+	BenchmarkRaycastSampler sampler;
+	const unsigned numSampledPoints = std::max( 1u, numPoints / 16 );
+	startedAt = trap_Microseconds();
+	for( unsigned i = 0; i < numSampledPoints; ++i ) {
+		sink = sink + sampler.Sample( points[i] );
+	}
+	SP_AddResult( results, &numResults, maxResults, "raycast sampling", numSampledPoints, trap_Microseconds() - startedAt );
+
+	S_Free( leafNums );
+	S_Free( points );
+
+	(void)sink;
+	return numResults;
+}
@@ -397,8 +397,10 @@ void ServerInfoFetcher::updateFrame() {
 	// populate active queries with ones on the waiting line
 	if( now > lastQueryTime + QUERY_TIMEOUT_MSEC && numWaiting() > 0 ) {
 		lastQueryTime = now;
-		startQuery( serverQueue.front() );
-		serverQueue.pop();
+		for( unsigned int i = 0; i < QUERY_BATCH_SIZE && numWaiting() > 0; i++ ) {
+			startQuery( serverQueue.front() );
+			serverQueue.pop();
+		}
 	}
 }
 
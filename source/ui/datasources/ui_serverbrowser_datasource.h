@@ -198,7 +198,8 @@ class ServerInfoFetcher
 {
 	// amount if simultaneous queries
 	static const unsigned int TIMEOUT_SEC = 5;      // secs until we replace with another job
-	static const unsigned int QUERY_TIMEOUT_MSEC = 50;      // time between subsequent queries to individual servers
+	static const unsigned int QUERY_TIMEOUT_MSEC = 50;      // time between subsequent batches of queries
+	static const unsigned int QUERY_BATCH_SIZE = 16;        // the client paces the pings itself
 
 	// waiting line
 	typedef std::queue<std::string> StringQueue;